@@ -0,0 +1,158 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+//
+// PolicyRunner drives an Unreal instance that has already been launched (e.g., via spear.Instance with
+// SPEAR.LAUNCH_MODE set to "none") with a trivial policy that always applies a zero action, and reports the
+// number of steps executed per second. This example is intended as a starting point for running a policy
+// entirely in C++, with no Python interpreter in the loop. See tools/build_client_lib.py for build instructions.
+//
+// Usage: policy_runner <port> <num_steps>
+//
+
+#include <stddef.h> // size_t
+#include <stdint.h> // int64_t, uint8_t, uint64_t
+
+#include <chrono>   // std::chrono::duration, std::chrono::steady_clock
+#include <iostream> // std::cout
+#include <map>
+#include <string>
+#include <vector>
+
+#include "SpCore/ArrayDesc.h" // TODO: remove
+#include "SpCore/Assert.h"
+#include "SpCore/Std.h"
+
+#include "SpClient/Client.h"
+#include "SpClient/EngineServiceClient.h"
+#include "SpClient/LegacyServiceClient.h"
+#include "SpClient/Rpclib.h"
+#include "SpClient/SpaceDesc.h"
+#include "SpClient/UnrealServiceClient.h"
+
+static size_t getNumBytes(const ArrayDesc& array_desc)
+{
+    static const std::map<DataType, size_t> s_data_type_num_bytes = {
+        {DataType::UInteger8,  1},
+        {DataType::Integer8,   1},
+        {DataType::UInteger16, 2},
+        {DataType::Integer16,  2},
+        {DataType::UInteger32, 4},
+        {DataType::Integer32,  4},
+        {DataType::Float16,    2},
+        {DataType::Float32,    4},
+        {DataType::Float64,    8}};
+
+    size_t num_elements = 1;
+    for (auto dim : array_desc.shape_) {
+        SP_ASSERT(dim >= 0);
+        num_elements *= dim;
+    }
+    return num_elements*s_data_type_num_bytes.at(array_desc.datatype_);
+}
+
+int main(int argc, char* argv[])
+{
+    SP_ASSERT(argc == 3);
+    int port = std::stoi(argv[1]);
+    int num_steps = std::stoi(argv[2]);
+    int max_num_frames_after_reset = 10; // see SPEAR.ENV.MAX_NUM_FRAMES_AFTER_RESET
+    int64_t timeout_milliseconds = 10000;
+
+    Client client("127.0.0.1", port, timeout_milliseconds);
+    EngineServiceClient engine_service(&client);
+    LegacyServiceClient legacy_service(&client);
+    UnrealServiceClient unreal_service(&client);
+
+    std::cout << "[SPEAR | PolicyRunner.cpp] Connected to Unreal instance: " << engine_service.ping() << std::endl;
+
+    // shared memory action components aren't supported by this example
+    std::map<std::string, std::vector<uint8_t>> action;
+    for (auto& [name, array_desc] : legacy_service.getActionSpace()) {
+        SP_ASSERT(!array_desc.use_shared_memory_);
+        Std::insert(action, name, std::vector<uint8_t>(getNumBytes(array_desc), 0));
+    }
+
+    SpaceDesc observation_space_desc(legacy_service.getObservationSpace());
+
+    // Like spear.Env, we unpause the game at the beginning of each frame and pause it again at the end. The
+    // UGameplayStatics class, its default object, and the SetGamePaused function aren't destroyed when a new
+    // level is opened, so we only need to find them once. These entry points execute on the game thread, so they
+    // must be called between begin_tick and end_tick.
+    engine_service.beginTick();
+    uint64_t gameplay_statics_class = unreal_service.getStaticClass("UGameplayStatics");
+    uint64_t gameplay_statics_default_object = unreal_service.getDefaultObject(gameplay_statics_class, false);
+    uint64_t set_game_paused_func = unreal_service.findFunctionByName(gameplay_statics_class, "SetGamePaused");
+    engine_service.tick();
+    engine_service.endTick();
+
+    clmdep_msgpack::zone zone;
+    std::string world_context = "WorldContextObject";
+    EngineServiceCall unpause_call = EngineServiceClient::makeCall(
+        "unreal_service.call_function", zone, gameplay_statics_default_object, set_game_paused_func, std::map<std::string, std::string>{{"bPaused", "false"}}, world_context);
+    EngineServiceCall pause_call = EngineServiceClient::makeCall(
+        "unreal_service.call_function", zone, gameplay_statics_default_object, set_game_paused_func, std::map<std::string, std::string>{{"bPaused", "true"}}, world_context);
+
+    std::vector<EngineServiceCall> pre_tick_calls = {
+        unpause_call,
+        EngineServiceClient::makeCall("legacy_service.apply_action", zone, action)};
+    std::vector<EngineServiceCall> post_tick_calls = {
+        EngineServiceClient::makeCall("legacy_service.get_observation", zone),
+        EngineServiceClient::makeCall("legacy_service.get_reward", zone),
+        EngineServiceClient::makeCall("legacy_service.is_episode_done", zone),
+        pause_call};
+
+    // Like spear.Env, we reset the task first in case it needs to set the pose of actors, then we reset the agent
+    // so it can refine the pose of actors. We only reset once, and then keep executing frames until the task and
+    // agent are ready, or until we give up.
+    std::vector<EngineServiceCall> reset_pre_tick_calls = {
+        unpause_call,
+        EngineServiceClient::makeCall("legacy_service.reset_task", zone),
+        EngineServiceClient::makeCall("legacy_service.reset_agent", zone)};
+    std::vector<EngineServiceCall> wait_for_ready_pre_tick_calls = {
+        unpause_call};
+    std::vector<EngineServiceCall> wait_for_ready_post_tick_calls = {
+        EngineServiceClient::makeCall("legacy_service.is_task_ready", zone),
+        EngineServiceClient::makeCall("legacy_service.is_agent_ready", zone),
+        pause_call};
+
+    double total_reward = 0.0;
+    int num_failed_resets = 0;
+    auto start_time = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < num_steps; i++) {
+        EngineServiceStepReturnValues return_values = engine_service.step(pre_tick_calls, post_tick_calls);
+        SP_ASSERT(return_values.post_tick_return_values_.size() == 4);
+
+        // non-shared observation components are returned by get_observation, and shared memory observation
+        // components can be read directly from the Unreal instance's shared memory regions
+        auto observation = return_values.post_tick_return_values_.at(0).as<std::map<std::string, std::vector<uint8_t>>>();
+        std::map<std::string, const void*> shared_memory_observation = observation_space_desc.getSharedMemoryData();
+        float reward = return_values.post_tick_return_values_.at(1).as<float>();
+        bool done = return_values.post_tick_return_values_.at(2).as<bool>();
+        total_reward += reward;
+
+        if (done) {
+            bool ready = false;
+            for (int j = 0; j < max_num_frames_after_reset && !ready; j++) {
+                EngineServiceStepReturnValues reset_return_values = engine_service.step(
+                    j == 0 ? reset_pre_tick_calls : wait_for_ready_pre_tick_calls, wait_for_ready_post_tick_calls);
+                SP_ASSERT(reset_return_values.post_tick_return_values_.size() == 3);
+                ready = reset_return_values.post_tick_return_values_.at(0).as<bool>() && reset_return_values.post_tick_return_values_.at(1).as<bool>();
+            }
+            if (!ready) {
+                num_failed_resets++;
+            }
+        }
+    }
+
+    auto end_time = std::chrono::steady_clock::now();
+    double elapsed_time_seconds = std::chrono::duration<double>(end_time - start_time).count();
+
+    std::cout << "[SPEAR | PolicyRunner.cpp] Executed " << num_steps << " steps in " << elapsed_time_seconds << " seconds (" << num_steps/elapsed_time_seconds << " steps per second)." << std::endl;
+    std::cout << "[SPEAR | PolicyRunner.cpp] Total reward: " << total_reward << std::endl;
+    std::cout << "[SPEAR | PolicyRunner.cpp] Number of failed resets: " << num_failed_resets << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,40 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#include "SpClient/Client.h"
+
+#include <stdint.h> // int64_t, uint16_t
+
+#include <future> // std::future
+#include <limits> // std::numeric_limits
+#include <string>
+#include <vector>
+
+#include "SpCore/Assert.h"
+
+#include "SpClient/Rpclib.h"
+
+static uint16_t getPort(int port)
+{
+    SP_ASSERT(port > 0 && port <= std::numeric_limits<uint16_t>::max());
+    return static_cast<uint16_t>(port);
+}
+
+Client::Client(const std::string& address, int port, int64_t timeout_milliseconds) : client_(address, getPort(port))
+{
+    SP_ASSERT(timeout_milliseconds > 0);
+    client_.set_timeout(timeout_milliseconds);
+}
+
+clmdep_msgpack::object_handle Client::callWithObjects(const std::string& name, const std::vector<clmdep_msgpack::object>& args)
+{
+    bool async = false;
+    return callWithObjectsImpl(name, args, async).get();
+}
+
+std::future<clmdep_msgpack::object_handle> Client::callAsyncWithObjects(const std::string& name, const std::vector<clmdep_msgpack::object>& args)
+{
+    bool async = true;
+    return callWithObjectsImpl(name, args, async);
+}
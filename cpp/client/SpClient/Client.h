@@ -0,0 +1,89 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#pragma once
+
+#include <stddef.h> // size_t
+#include <stdint.h> // int64_t
+
+#include <future>      // std::future
+#include <string>
+#include <type_traits> // std::is_same_v, std::is_void_v
+#include <utility>     // std::index_sequence, std::make_index_sequence
+#include <vector>
+
+#include "SpCore/Assert.h"
+
+#include "SpClient/Rpclib.h"
+
+//
+// Client is a native client for the RPC server that runs inside an Unreal instance, and is intended to be used
+// from C++ code that drives the simulation directly (e.g., a policy runner), or from Python via our pybind11
+// bindings in SpClientPython. The typed wrappers for each service (e.g., EngineServiceClient) are implemented
+// on top of this class. If the server doesn't respond within timeout_milliseconds, or the connection fails,
+// then call(...) throws the exception thrown by rpclib, so the caller can retry while the server is starting.
+//
+
+class Client
+{
+public:
+    Client() = delete;
+    Client(const std::string& address, int port, int64_t timeout_milliseconds);
+
+    template <typename TReturnValue, typename... TArgs>
+    TReturnValue call(const std::string& name, const TArgs&... args)
+    {
+        if constexpr (std::is_void_v<TReturnValue>) {
+            client_.call(name, args...);
+        } else if constexpr (std::is_same_v<TReturnValue, clmdep_msgpack::object_handle>) {
+            return client_.call(name, args...); // useful if the caller wants to avoid copying the return value
+        } else {
+            return client_.call(name, args...).get().template as<TReturnValue>();
+        }
+    }
+
+    template <typename... TArgs>
+    std::future<clmdep_msgpack::object_handle> callAsync(const std::string& name, const TArgs&... args)
+    {
+        return client_.async_call(name, args...);
+    }
+
+    // Call an entry point with a list of args whose length is only known at runtime, e.g., when the args have
+    // been converted from Python objects. Each element of args is sent as a separate arg.
+    clmdep_msgpack::object_handle callWithObjects(const std::string& name, const std::vector<clmdep_msgpack::object>& args);
+    std::future<clmdep_msgpack::object_handle> callAsyncWithObjects(const std::string& name, const std::vector<clmdep_msgpack::object>& args);
+
+private:
+    static constexpr size_t k_max_num_args = 16;
+
+    // rpclib only accepts args as a parameter pack, so we dispatch on the number of args at runtime
+    template <size_t TNumArgs = 0>
+    auto callWithObjectsImpl(const std::string& name, const std::vector<clmdep_msgpack::object>& args, bool async)
+    {
+        if constexpr (TNumArgs > k_max_num_args) {
+            SP_ASSERT(false);
+            return std::future<clmdep_msgpack::object_handle>();
+        } else {
+            if (args.size() == TNumArgs) {
+                return callWithObjectsImpl(name, args, async, std::make_index_sequence<TNumArgs>());
+            }
+            return callWithObjectsImpl<TNumArgs + 1>(name, args, async);
+        }
+    }
+
+    template <size_t... TIndices>
+    std::future<clmdep_msgpack::object_handle> callWithObjectsImpl(
+        const std::string& name, const std::vector<clmdep_msgpack::object>& args, bool async, std::index_sequence<TIndices...>)
+    {
+        if (async) {
+            return client_.async_call(name, args.at(TIndices)...);
+        } else {
+            std::promise<clmdep_msgpack::object_handle> promise;
+            promise.set_value(client_.call(name, args.at(TIndices)...));
+            return promise.get_future();
+        }
+    }
+
+    rpc::client client_;
+};
@@ -0,0 +1,61 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#include "SpClient/EngineServiceClient.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "SpCore/Assert.h"
+
+#include "SpServices/Msgpack.h"
+
+#include "SpClient/Client.h"
+#include "SpClient/Rpclib.h"
+
+EngineServiceClient::EngineServiceClient(Client* client)
+{
+    SP_ASSERT(client);
+    client_ = client;
+}
+
+std::string EngineServiceClient::ping()
+{
+    return client_->call<std::string>("engine_service.ping");
+}
+
+void EngineServiceClient::beginTick()
+{
+    client_->call<void>("engine_service.begin_tick");
+}
+
+void EngineServiceClient::tick()
+{
+    client_->call<void>("engine_service.tick");
+}
+
+void EngineServiceClient::endTick()
+{
+    client_->call<void>("engine_service.end_tick");
+}
+
+std::string EngineServiceClient::getByteOrder()
+{
+    return client_->call<std::string>("engine_service.get_byte_order");
+}
+
+EngineServiceStepReturnValues EngineServiceClient::step(const std::vector<EngineServiceCall>& pre_tick_calls, const std::vector<EngineServiceCall>& post_tick_calls)
+{
+    EngineServiceStepReturnValues return_values;
+    return_values.object_handle_ = client_->call<clmdep_msgpack::object_handle>("engine_service.step", pre_tick_calls, post_tick_calls);
+
+    // we don't copy the return values, so they remain valid for as long as return_values.object_handle_
+    std::map<std::string, clmdep_msgpack::object> map = Msgpack::toMap(return_values.object_handle_.get());
+    SP_ASSERT(map.size() == 2);
+    map.at("pre_tick_return_values").convert(return_values.pre_tick_return_values_);
+    map.at("post_tick_return_values").convert(return_values.post_tick_return_values_);
+
+    return return_values;
+}
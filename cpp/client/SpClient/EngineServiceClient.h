@@ -0,0 +1,75 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#pragma once
+
+#include <string>
+#include <tuple>   // std::make_tuple
+#include <utility> // std::move
+#include <vector>
+
+#include "SpCore/Assert.h"
+
+#include "SpServices/Msgpack.h"
+
+#include "SpClient/Client.h"
+#include "SpClient/Rpclib.h"
+
+// EngineServiceCall describes a call to any entry point that executes on the game thread, and can be passed
+// to EngineServiceClient::step(...). args_ must be a msgpack array, and can be created via makeCall(...). The
+// layout of this struct must match cpp/unreal_plugins/SpServices/Source/SpServices/EngineService.h.
+struct EngineServiceCall
+{
+    std::string name_;
+    clmdep_msgpack::object args_; // refers to memory owned by the zone passed to makeCall(...)
+};
+
+struct EngineServiceStepReturnValues
+{
+    std::vector<clmdep_msgpack::object> pre_tick_return_values_;  // refers to memory owned by object_handle_
+    std::vector<clmdep_msgpack::object> post_tick_return_values_; // refers to memory owned by object_handle_
+    clmdep_msgpack::object_handle object_handle_;
+};
+
+class EngineServiceClient
+{
+public:
+    EngineServiceClient() = delete;
+    EngineServiceClient(Client* client);
+
+    template <typename... TArgs>
+    static EngineServiceCall makeCall(const std::string& name, clmdep_msgpack::zone& zone, const TArgs&... args)
+    {
+        EngineServiceCall call;
+        call.name_ = name;
+        call.args_ = clmdep_msgpack::object(std::make_tuple(args...), zone);
+        return call;
+    }
+
+    std::string ping();
+    void beginTick();
+    void tick();
+    void endTick();
+    std::string getByteOrder();
+
+    // Execute an entire frame in a single RPC round-trip, see python/spear/engine_service.py for details.
+    EngineServiceStepReturnValues step(const std::vector<EngineServiceCall>& pre_tick_calls, const std::vector<EngineServiceCall>& post_tick_calls);
+
+private:
+    Client* client_ = nullptr;
+};
+
+template <> // needed to send a custom type as an arg
+struct clmdep_msgpack::adaptor::pack<EngineServiceCall> {
+    template <typename TStream>
+    clmdep_msgpack::packer<TStream>& operator()(clmdep_msgpack::packer<TStream>& packer, EngineServiceCall const& call) const {
+        SP_ASSERT(call.args_.type == clmdep_msgpack::type::ARRAY);
+        packer.pack_map(2);
+        packer.pack(std::string("name"));
+        packer.pack(call.name_);
+        packer.pack(std::string("args"));
+        packer.pack(call.args_);
+        return packer;
+    }
+};
@@ -0,0 +1,94 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#include "SpClient/LegacyServiceClient.h"
+
+#include <stdint.h> // uint8_t
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "SpCore/ArrayDesc.h" // TODO: remove
+#include "SpCore/Assert.h"
+
+#include "SpServices/Legacy/ArrayDescMsgpack.h"
+
+#include "SpClient/Client.h"
+
+LegacyServiceClient::LegacyServiceClient(Client* client)
+{
+    SP_ASSERT(client);
+    client_ = client;
+}
+
+std::map<std::string, ArrayDesc> LegacyServiceClient::getActionSpace()
+{
+    return client_->call<std::map<std::string, ArrayDesc>>("legacy_service.get_action_space");
+}
+
+std::map<std::string, ArrayDesc> LegacyServiceClient::getObservationSpace()
+{
+    return client_->call<std::map<std::string, ArrayDesc>>("legacy_service.get_observation_space");
+}
+
+std::map<std::string, ArrayDesc> LegacyServiceClient::getAgentStepInfoSpace()
+{
+    return client_->call<std::map<std::string, ArrayDesc>>("legacy_service.get_agent_step_info_space");
+}
+
+std::map<std::string, ArrayDesc> LegacyServiceClient::getTaskStepInfoSpace()
+{
+    return client_->call<std::map<std::string, ArrayDesc>>("legacy_service.get_task_step_info_space");
+}
+
+void LegacyServiceClient::applyAction(const std::map<std::string, std::vector<uint8_t>>& action)
+{
+    client_->call<void>("legacy_service.apply_action", action);
+}
+
+std::map<std::string, std::vector<uint8_t>> LegacyServiceClient::getObservation()
+{
+    return client_->call<std::map<std::string, std::vector<uint8_t>>>("legacy_service.get_observation");
+}
+
+float LegacyServiceClient::getReward()
+{
+    return client_->call<float>("legacy_service.get_reward");
+}
+
+bool LegacyServiceClient::isEpisodeDone()
+{
+    return client_->call<bool>("legacy_service.is_episode_done");
+}
+
+std::map<std::string, std::vector<uint8_t>> LegacyServiceClient::getAgentStepInfo()
+{
+    return client_->call<std::map<std::string, std::vector<uint8_t>>>("legacy_service.get_agent_step_info");
+}
+
+std::map<std::string, std::vector<uint8_t>> LegacyServiceClient::getTaskStepInfo()
+{
+    return client_->call<std::map<std::string, std::vector<uint8_t>>>("legacy_service.get_task_step_info");
+}
+
+void LegacyServiceClient::resetAgent()
+{
+    client_->call<void>("legacy_service.reset_agent");
+}
+
+void LegacyServiceClient::resetTask()
+{
+    client_->call<void>("legacy_service.reset_task");
+}
+
+bool LegacyServiceClient::isAgentReady()
+{
+    return client_->call<bool>("legacy_service.is_agent_ready");
+}
+
+bool LegacyServiceClient::isTaskReady()
+{
+    return client_->call<bool>("legacy_service.is_task_ready");
+}
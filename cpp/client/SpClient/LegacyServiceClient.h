@@ -0,0 +1,42 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#pragma once
+
+#include <stdint.h> // uint8_t
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "SpCore/ArrayDesc.h" // TODO: remove
+
+#include "SpClient/Client.h"
+
+class LegacyServiceClient
+{
+public:
+    LegacyServiceClient() = delete;
+    LegacyServiceClient(Client* client);
+
+    std::map<std::string, ArrayDesc> getActionSpace();
+    std::map<std::string, ArrayDesc> getObservationSpace();
+    std::map<std::string, ArrayDesc> getAgentStepInfoSpace();
+    std::map<std::string, ArrayDesc> getTaskStepInfoSpace();
+
+    void applyAction(const std::map<std::string, std::vector<uint8_t>>& action);
+    std::map<std::string, std::vector<uint8_t>> getObservation();
+    float getReward();
+    bool isEpisodeDone();
+    std::map<std::string, std::vector<uint8_t>> getAgentStepInfo();
+    std::map<std::string, std::vector<uint8_t>> getTaskStepInfo();
+
+    void resetAgent();
+    void resetTask();
+    bool isAgentReady();
+    bool isTaskReady();
+
+private:
+    Client* client_ = nullptr;
+};
@@ -0,0 +1,17 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#pragma once
+
+#include <boost/predef.h> // BOOST_OS_MACOS
+
+// See cpp/unreal_plugins/SpServices/Source/SpServices/Rpclib.h for why we need to define MSGPACK_DISABLE_LEGACY_NIL.
+#if BOOST_OS_MACOS
+    #define MSGPACK_DISABLE_LEGACY_NIL
+#endif
+
+#include <rpc/client.h>
+#include <rpc/config.h>
+#include <rpc/msgpack.hpp> // clmdep_msgpack
+#include <rpc/rpc_error.h>
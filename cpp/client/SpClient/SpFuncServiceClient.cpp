@@ -0,0 +1,22 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#include "SpClient/SpFuncServiceClient.h"
+
+#include <string>
+
+#include "SpCore/Assert.h"
+
+#include "SpClient/Client.h"
+
+SpFuncServiceClient::SpFuncServiceClient(Client* client)
+{
+    SP_ASSERT(client);
+    client_ = client;
+}
+
+SpFuncServiceClientDataBundle SpFuncServiceClient::callFunc(const std::string& func_name, const SpFuncServiceClientDataBundle& args)
+{
+    return client_->call<SpFuncServiceClientDataBundle>("sp_func_service.call_func", func_name, args);
+}
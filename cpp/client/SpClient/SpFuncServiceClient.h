@@ -0,0 +1,174 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#pragma once
+
+#include <stdint.h> // int8_t, uint8_t, uint32_t, uint64_t
+
+#include <bit>     // std::endian
+#include <cstring> // std::memcpy
+#include <limits>  // std::numeric_limits
+#include <map>
+#include <string>
+#include <vector>
+
+#include "SpCore/Assert.h"
+#include "SpCore/SpFuncArray.h"
+#include "SpCore/Std.h"
+
+#include "SpServices/Msgpack.h"
+
+#include "SpClient/Client.h"
+#include "SpClient/Rpclib.h"
+
+// SpFuncServiceClientArray owns a copy of its data, unless it refers to an SpFunc shared memory region, in
+// which case shared_memory_name_ is not empty and data_ is empty.
+struct SpFuncServiceClientArray
+{
+    std::vector<uint8_t> data_;
+    std::vector<uint64_t> shape_;
+    SpFuncArrayDataType data_type_ = SpFuncArrayDataType::Invalid;
+    std::string shared_memory_name_;
+};
+
+// must match SpFuncDataBundle in cpp/unreal_plugins/SpCore/Source/SpCore/SpFuncArray.h
+struct SpFuncServiceClientDataBundle
+{
+    std::map<std::string, SpFuncServiceClientArray> packed_arrays_;
+    std::map<std::string, std::string> unreal_obj_strings_;
+    std::string info_;
+};
+
+class SpFuncServiceClient
+{
+public:
+    SpFuncServiceClient() = delete;
+    SpFuncServiceClient(Client* client);
+
+    // see python/spear/sp_func_service.py for details
+    SpFuncServiceClientDataBundle callFunc(const std::string& func_name, const SpFuncServiceClientDataBundle& args);
+
+private:
+    Client* client_ = nullptr;
+};
+
+// must match SpFuncPackedArrayExtHeader in cpp/unreal_plugins/SpServices/Source/SpServices/SpFuncService.h
+struct SpFuncServiceClientArrayExtHeader
+{
+    static constexpr int8_t k_ext_type = 1;
+
+    int8_t data_type_ = -1;
+    char byte_order_ = '<';
+    uint8_t num_dims_ = 0;
+    uint8_t padding_[4] = {};
+
+    static char getNativeByteOrder() { return std::endian::native == std::endian::little ? '<' : '>'; }
+};
+static_assert(sizeof(SpFuncServiceClientArrayExtHeader) == 7);
+
+// must match SpFuncArrayDataSource in cpp/unreal_plugins/SpCore/Source/SpCore/SpFuncArray.h
+MSGPACK_ADD_ENUM(SpFuncArrayDataSource);
+MSGPACK_ADD_ENUM(SpFuncArrayDataType);
+
+template <> // needed to receive a custom type as a return value
+struct clmdep_msgpack::adaptor::convert<SpFuncServiceClientArray> {
+    clmdep_msgpack::object const& operator()(clmdep_msgpack::object const& object, SpFuncServiceClientArray& array) const {
+        if (object.type == clmdep_msgpack::type::MAP) {
+            std::map<std::string, clmdep_msgpack::object> map = Msgpack::toMap(object);
+            SP_ASSERT(Msgpack::to<SpFuncArrayDataSource>(map.at("data_source")) == SpFuncArrayDataSource::Shared);
+            array.data_ = {};
+            array.shape_ = Msgpack::to<std::vector<uint64_t>>(map.at("shape"));
+            array.data_type_ = Msgpack::to<SpFuncArrayDataType>(map.at("data_type"));
+            array.shared_memory_name_ = Msgpack::to<std::string>(map.at("shared_memory_name"));
+            return object;
+        }
+
+        SP_ASSERT(object.type == clmdep_msgpack::type::EXT);
+        SP_ASSERT(object.via.ext.type() == SpFuncServiceClientArrayExtHeader::k_ext_type);
+
+        const char* payload = object.via.ext.data();
+        uint64_t payload_num_bytes = object.via.ext.size;
+
+        SpFuncServiceClientArrayExtHeader header;
+        SP_ASSERT(payload_num_bytes >= sizeof(header));
+        std::memcpy(&header, payload, sizeof(header));
+        SP_ASSERT(header.byte_order_ == SpFuncServiceClientArrayExtHeader::getNativeByteOrder());
+
+        uint64_t shape_num_bytes = header.num_dims_*sizeof(uint64_t);
+        SP_ASSERT(payload_num_bytes >= sizeof(header) + shape_num_bytes);
+        array.shape_.resize(header.num_dims_);
+        std::memcpy(array.shape_.data(), payload + sizeof(header), shape_num_bytes);
+        array.data_type_ = static_cast<SpFuncArrayDataType>(header.data_type_);
+
+        const char* data = payload + sizeof(header) + shape_num_bytes;
+        array.data_ = std::vector<uint8_t>(data, payload + payload_num_bytes);
+        array.shared_memory_name_ = "";
+
+        return object;
+    }
+};
+
+template <> // needed to send a custom type as an arg
+struct clmdep_msgpack::adaptor::pack<SpFuncServiceClientArray> {
+    template <typename TStream>
+    clmdep_msgpack::packer<TStream>& operator()(clmdep_msgpack::packer<TStream>& packer, SpFuncServiceClientArray const& array) const {
+        SP_ASSERT(array.shape_.size() <= std::numeric_limits<uint8_t>::max());
+
+        if (array.shared_memory_name_ != "") {
+            std::map<std::string, clmdep_msgpack::object> map;
+            clmdep_msgpack::zone zone;
+            Std::insert(map, "data", clmdep_msgpack::object(array.data_, zone));
+            Std::insert(map, "data_source", clmdep_msgpack::object(SpFuncArrayDataSource::Shared, zone));
+            Std::insert(map, "shape", clmdep_msgpack::object(array.shape_, zone));
+            Std::insert(map, "data_type", clmdep_msgpack::object(array.data_type_, zone));
+            Std::insert(map, "shared_memory_name", clmdep_msgpack::object(array.shared_memory_name_, zone));
+            packer.pack(map);
+            return packer;
+        }
+
+        SpFuncServiceClientArrayExtHeader header;
+        header.data_type_ = static_cast<int8_t>(array.data_type_);
+        header.byte_order_ = SpFuncServiceClientArrayExtHeader::getNativeByteOrder();
+        header.num_dims_ = static_cast<uint8_t>(array.shape_.size());
+
+        uint64_t shape_num_bytes = array.shape_.size()*sizeof(uint64_t);
+        uint64_t payload_num_bytes = sizeof(header) + shape_num_bytes + array.data_.size();
+        SP_ASSERT(payload_num_bytes <= std::numeric_limits<uint32_t>::max());
+
+        // write the payload directly into the stream, so we don't need to assemble it in a temporary buffer
+        packer.pack_ext(payload_num_bytes, SpFuncServiceClientArrayExtHeader::k_ext_type);
+        packer.pack_ext_body(reinterpret_cast<const char*>(&header), sizeof(header));
+        packer.pack_ext_body(reinterpret_cast<const char*>(array.shape_.data()), static_cast<uint32_t>(shape_num_bytes));
+        packer.pack_ext_body(reinterpret_cast<const char*>(array.data_.data()), static_cast<uint32_t>(array.data_.size()));
+
+        return packer;
+    }
+};
+
+template <> // needed to receive a custom type as a return value
+struct clmdep_msgpack::adaptor::convert<SpFuncServiceClientDataBundle> {
+    clmdep_msgpack::object const& operator()(clmdep_msgpack::object const& object, SpFuncServiceClientDataBundle& data_bundle) const {
+        std::map<std::string, clmdep_msgpack::object> map = Msgpack::toMap(object);
+        SP_ASSERT(map.size() == 3);
+        data_bundle.packed_arrays_ = Msgpack::to<std::map<std::string, SpFuncServiceClientArray>>(map.at("packed_arrays"));
+        data_bundle.unreal_obj_strings_ = Msgpack::to<std::map<std::string, std::string>>(map.at("unreal_obj_strings"));
+        data_bundle.info_ = Msgpack::to<std::string>(map.at("info"));
+        return object;
+    }
+};
+
+template <> // needed to send a custom type as an arg
+struct clmdep_msgpack::adaptor::pack<SpFuncServiceClientDataBundle> {
+    template <typename TStream>
+    clmdep_msgpack::packer<TStream>& operator()(clmdep_msgpack::packer<TStream>& packer, SpFuncServiceClientDataBundle const& data_bundle) const {
+        packer.pack_map(3);
+        packer.pack(std::string("packed_arrays"));
+        packer.pack(data_bundle.packed_arrays_);
+        packer.pack(std::string("unreal_obj_strings"));
+        packer.pack(data_bundle.unreal_obj_strings_);
+        packer.pack(std::string("info"));
+        packer.pack(data_bundle.info_);
+        return packer;
+    }
+};
@@ -0,0 +1,98 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#include "SpClient/SpaceDesc.h"
+
+#include <stdint.h> // uint8_t, uint64_t
+
+#include <string.h> // memcpy
+
+#include <atomic> // std::atomic_ref, std::atomic_thread_fence
+#include <map>
+#include <string>
+#include <vector>
+
+#include "SpCore/ArrayDesc.h" // TODO: remove
+#include "SpCore/Assert.h"
+#include "SpCore/Boost.h"
+#include "SpCore/Std.h"
+
+SpaceDesc::SpaceDesc(const std::map<std::string, ArrayDesc>& array_descs)
+{
+    array_descs_ = array_descs;
+
+    for (auto& [name, array_desc] : array_descs_) {
+        if (!array_desc.use_shared_memory_) {
+            continue;
+        }
+
+        #if BOOST_OS_WINDOWS
+            boost::interprocess::windows_shared_memory windows_shared_memory(
+                boost::interprocess::open_only, array_desc.shared_memory_name_.c_str(), boost::interprocess::read_write);
+            Std::insert(mapped_regions_, name, boost::interprocess::mapped_region(windows_shared_memory, boost::interprocess::read_write));
+        #elif BOOST_OS_MACOS || BOOST_OS_LINUX
+            boost::interprocess::shared_memory_object shared_memory_object(
+                boost::interprocess::open_only, array_desc.shared_memory_name_.c_str(), boost::interprocess::read_write);
+            Std::insert(mapped_regions_, name, boost::interprocess::mapped_region(shared_memory_object, boost::interprocess::read_write));
+        #else
+            #error
+        #endif
+
+        const boost::interprocess::mapped_region& mapped_region = mapped_regions_.at(name);
+        SP_ASSERT(mapped_region.get_address());
+
+        if (array_desc.shared_memory_num_slots_ > 0) {
+            SP_ASSERT(mapped_region.get_size() >= sizeof(SharedMemoryRingBufferHeader));
+            const SharedMemoryRingBufferHeader* header = static_cast<const SharedMemoryRingBufferHeader*>(mapped_region.get_address());
+            SP_ASSERT(header->num_slots_ == array_desc.shared_memory_num_slots_);
+            SP_ASSERT(mapped_region.get_size() >= sizeof(SharedMemoryRingBufferHeader) + header->num_slots_*header->slot_num_bytes_);
+            SP_ASSERT(header->slot_num_bytes_ >= sizeof(SharedMemoryRingBufferSlotHeader));
+            Std::insert(ring_buffer_data_, name, std::vector<uint8_t>(header->slot_num_bytes_ - sizeof(SharedMemoryRingBufferSlotHeader)));
+        }
+    }
+}
+
+std::map<std::string, const void*> SpaceDesc::getSharedMemoryData() const
+{
+    std::map<std::string, const void*> data;
+
+    for (auto& [name, mapped_region] : mapped_regions_) {
+        const ArrayDesc& array_desc = array_descs_.at(name);
+        const uint8_t* ptr = static_cast<const uint8_t*>(mapped_region.get_address());
+
+        if (array_desc.shared_memory_num_slots_ == 0) {
+            Std::insert(data, name, ptr);
+        } else {
+            // See cpp/unreal_plugins/SpCore/Source/SpCore/ArrayDesc.h for details on the memory layout. The Unreal
+            // instance stores 0 in a slot's sequence number before writing to the slot, and stores the slot's new
+            // sequence number after writing to it, so we check the slot's sequence number before and after copying
+            // the slot, and try again with the new latest slot if the Unreal instance started writing to the slot
+            // while we were copying it. See python/spear/env.py for the equivalent Python implementation.
+            SharedMemoryRingBufferHeader* header = reinterpret_cast<SharedMemoryRingBufferHeader*>(const_cast<uint8_t*>(ptr));
+            std::vector<uint8_t>& slot_data = ring_buffer_data_.at(name);
+
+            while (true) {
+                uint64_t latest_sequence = std::atomic_ref<uint64_t>(header->latest_sequence_).load(std::memory_order_acquire);
+                uint64_t slot_index = (latest_sequence > 0 ? latest_sequence - 1 : 0) % header->num_slots_;
+                uint8_t* slot_ptr = const_cast<uint8_t*>(ptr) + sizeof(SharedMemoryRingBufferHeader) + slot_index*header->slot_num_bytes_;
+                SharedMemoryRingBufferSlotHeader* slot_header = reinterpret_cast<SharedMemoryRingBufferSlotHeader*>(slot_ptr);
+                std::atomic_ref<uint64_t> slot_sequence(slot_header->sequence_);
+
+                // if no slots have been written, then there is nothing to check
+                if (latest_sequence > 0 && slot_sequence.load(std::memory_order_acquire) != latest_sequence) {
+                    continue;
+                }
+                memcpy(slot_data.data(), slot_ptr + sizeof(SharedMemoryRingBufferSlotHeader), slot_data.size());
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (latest_sequence == 0 || slot_sequence.load(std::memory_order_relaxed) == latest_sequence) {
+                    break;
+                }
+            }
+
+            Std::insert(data, name, slot_data.data());
+        }
+    }
+
+    return data;
+}
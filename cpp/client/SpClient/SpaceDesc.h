@@ -0,0 +1,38 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#pragma once
+
+#include <stdint.h> // uint8_t
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "SpCore/ArrayDesc.h" // TODO: remove
+#include "SpCore/Boost.h"
+
+// SpaceDesc maps the shared memory regions for all arrays in a space (e.g., the observation space returned by
+// LegacyServiceClient::getObservationSpace()) into this process, so the arrays can be read without copying them
+// through the RPC layer. The regions are owned by the Unreal instance, so they must outlive this object. See
+// python/spear/env.py for the equivalent Python implementation.
+class SpaceDesc
+{
+public:
+    SpaceDesc() = delete;
+    SpaceDesc(const std::map<std::string, ArrayDesc>& array_descs);
+
+    const std::map<std::string, ArrayDesc>& getArrayDescs() const { return array_descs_; }
+
+    // Returns a pointer to the data of each shared memory array. Arrays that don't use a ring buffer are returned
+    // as pointers into shared memory. For each ring buffer, the most recently written slot is copied into memory
+    // owned by this object, and the returned pointer remains valid until the next call to getSharedMemoryData().
+    // Arrays that don't use shared memory are not included.
+    std::map<std::string, const void*> getSharedMemoryData() const;
+
+private:
+    std::map<std::string, ArrayDesc> array_descs_;
+    std::map<std::string, boost::interprocess::mapped_region> mapped_regions_;
+    mutable std::map<std::string, std::vector<uint8_t>> ring_buffer_data_; // one entry per ring buffer
+};
@@ -0,0 +1,62 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#include "SpClient/UnrealServiceClient.h"
+
+#include <stdint.h> // uint64_t
+
+#include <map>
+#include <string>
+
+#include "SpCore/Assert.h"
+
+#include "SpClient/Client.h"
+
+UnrealServiceClient::UnrealServiceClient(Client* client)
+{
+    SP_ASSERT(client);
+    client_ = client;
+}
+
+std::string UnrealServiceClient::getWorldName()
+{
+    return client_->call<std::string>("unreal_service.get_world_name");
+}
+
+uint64_t UnrealServiceClient::getStaticClass(const std::string& class_name)
+{
+    return client_->call<uint64_t>("unreal_service.get_static_class", class_name);
+}
+
+uint64_t UnrealServiceClient::getDefaultObject(uint64_t uclass, bool create_if_needed)
+{
+    return client_->call<uint64_t>("unreal_service.get_default_object", uclass, create_if_needed);
+}
+
+uint64_t UnrealServiceClient::findActorByName(const std::string& class_name, const std::string& name)
+{
+    return client_->call<uint64_t>("unreal_service.find_actor_by_name", class_name, name);
+}
+
+std::string UnrealServiceClient::getObjectPropertiesFromUObject(uint64_t uobject)
+{
+    return client_->call<std::string>("unreal_service.get_object_properties_as_string_from_uobject", uobject);
+}
+
+void UnrealServiceClient::setObjectPropertiesForUObject(uint64_t uobject, const std::string& properties)
+{
+    client_->call<void>("unreal_service.set_object_properties_from_string_for_uobject", uobject, properties);
+}
+
+uint64_t UnrealServiceClient::findFunctionByName(uint64_t uclass, const std::string& name, const std::string& include_super_flag)
+{
+    std::map<std::string, std::string> unreal_obj_strings = {{"IncludeSuperFlag", "{\"Enum\": \"" + include_super_flag + "\"}"}};
+    return client_->call<uint64_t>("unreal_service.find_function_by_name", uclass, name, unreal_obj_strings);
+}
+
+std::map<std::string, std::string> UnrealServiceClient::callFunction(
+    uint64_t uobject, uint64_t ufunction, const std::map<std::string, std::string>& args, const std::string& world_context)
+{
+    return client_->call<std::map<std::string, std::string>>("unreal_service.call_function", uobject, ufunction, args, world_context);
+}
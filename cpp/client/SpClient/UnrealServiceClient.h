@@ -0,0 +1,37 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#pragma once
+
+#include <stdint.h> // uint64_t
+
+#include <map>
+#include <string>
+
+#include "SpClient/Client.h"
+
+// UObject, UClass, and UFunction pointers are represented as uint64_t handles, and object properties are
+// represented as JSON strings, see python/spear/unreal_service.py for details.
+class UnrealServiceClient
+{
+public:
+    UnrealServiceClient() = delete;
+    UnrealServiceClient(Client* client);
+
+    std::string getWorldName();
+
+    uint64_t getStaticClass(const std::string& class_name);
+    uint64_t getDefaultObject(uint64_t uclass, bool create_if_needed = true);
+    uint64_t findActorByName(const std::string& class_name, const std::string& name);
+
+    std::string getObjectPropertiesFromUObject(uint64_t uobject);
+    void setObjectPropertiesForUObject(uint64_t uobject, const std::string& properties);
+
+    uint64_t findFunctionByName(uint64_t uclass, const std::string& name, const std::string& include_super_flag = "IncludeSuper");
+    std::map<std::string, std::string> callFunction(
+        uint64_t uobject, uint64_t ufunction, const std::map<std::string, std::string>& args = {}, const std::string& world_context = "WorldContextObject");
+
+private:
+    Client* client_ = nullptr;
+};
@@ -0,0 +1,247 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#include <stddef.h> // size_t
+#include <stdint.h> // int8_t, int64_t, uint32_t, uint64_t
+#include <string.h> // memcpy
+
+#include <future> // std::future
+#include <memory> // std::make_unique, std::unique_ptr
+#include <string>
+#include <utility> // std::move
+#include <vector>
+
+#include <pybind11/pybind11.h>
+
+#include "SpCore/Assert.h"
+
+#include "SpClient/Client.h"
+#include "SpClient/Rpclib.h"
+
+//
+// The sp_client module exposes Client to Python with the same call(...) interface as msgpackrpc.Client, so it
+// can be used as a drop-in replacement by our Python services (see SPEAR.INSTANCE.RPC_CLIENT). Args are converted
+// from Python objects to msgpack objects using the same rules as the msgpack Python package, and return values
+// are converted back the same way, i.e., buffer objects are sent as BIN, and msgpack.ExtType is sent as EXT.
+//
+
+static clmdep_msgpack::object toObjectRaw(clmdep_msgpack::type::object_type type, const char* data, size_t num_bytes, clmdep_msgpack::zone& zone)
+{
+    char* ptr = static_cast<char*>(zone.allocate_no_align(num_bytes));
+    memcpy(ptr, data, num_bytes);
+
+    clmdep_msgpack::object object;
+    object.type = type;
+    if (type == clmdep_msgpack::type::STR) {
+        object.via.str.ptr = ptr;
+        object.via.str.size = static_cast<uint32_t>(num_bytes);
+    } else if (type == clmdep_msgpack::type::BIN) {
+        object.via.bin.ptr = ptr;
+        object.via.bin.size = static_cast<uint32_t>(num_bytes);
+    } else {
+        SP_ASSERT(false);
+    }
+    return object;
+}
+
+static clmdep_msgpack::object toObject(const pybind11::handle& handle, clmdep_msgpack::zone& zone, const pybind11::object& ext_type_class)
+{
+    clmdep_msgpack::object object;
+
+    if (handle.is_none()) {
+        object.type = clmdep_msgpack::type::NIL;
+
+    // bool must be checked before int, because bool is a subclass of int in Python
+    } else if (pybind11::isinstance<pybind11::bool_>(handle)) {
+        object = clmdep_msgpack::object(handle.cast<bool>());
+
+    } else if (pybind11::isinstance<pybind11::int_>(handle)) {
+        if (handle.cast<pybind11::int_>() >= pybind11::int_(0)) {
+            object = clmdep_msgpack::object(handle.cast<uint64_t>());
+        } else {
+            object = clmdep_msgpack::object(handle.cast<int64_t>());
+        }
+
+    } else if (pybind11::isinstance<pybind11::float_>(handle)) {
+        object = clmdep_msgpack::object(handle.cast<double>());
+
+    } else if (pybind11::isinstance<pybind11::str>(handle)) {
+        std::string str = handle.cast<std::string>();
+        object = toObjectRaw(clmdep_msgpack::type::STR, str.data(), str.size(), zone);
+
+    // ExtType must be checked before tuple, because ExtType is a namedtuple
+    } else if (pybind11::isinstance(handle, ext_type_class)) {
+        int8_t type = handle.attr("code").cast<int8_t>();
+        std::string data = handle.attr("data").cast<std::string>();
+        char* ptr = static_cast<char*>(zone.allocate_no_align(data.size() + 1));
+        ptr[0] = static_cast<char>(type);
+        memcpy(ptr + 1, data.data(), data.size());
+        object.type = clmdep_msgpack::type::EXT;
+        object.via.ext.ptr = ptr;
+        object.via.ext.size = static_cast<uint32_t>(data.size());
+
+    // bytes, bytearray, memoryview, numpy arrays, etc.
+    } else if (PyObject_CheckBuffer(handle.ptr())) {
+        Py_buffer buffer;
+        int status = PyObject_GetBuffer(handle.ptr(), &buffer, PyBUF_CONTIG_RO);
+        if (status != 0) {
+            throw pybind11::error_already_set();
+        }
+        object = toObjectRaw(clmdep_msgpack::type::BIN, static_cast<const char*>(buffer.buf), buffer.len, zone);
+        PyBuffer_Release(&buffer);
+
+    } else if (pybind11::isinstance<pybind11::list>(handle) || pybind11::isinstance<pybind11::tuple>(handle)) {
+        pybind11::sequence sequence = handle.cast<pybind11::sequence>();
+        object.type = clmdep_msgpack::type::ARRAY;
+        object.via.array.size = static_cast<uint32_t>(sequence.size());
+        object.via.array.ptr = static_cast<clmdep_msgpack::object*>(zone.allocate_align(sizeof(clmdep_msgpack::object)*sequence.size()));
+        for (size_t i = 0; i < sequence.size(); i++) {
+            object.via.array.ptr[i] = toObject(sequence[i], zone, ext_type_class);
+        }
+
+    } else if (pybind11::isinstance<pybind11::dict>(handle)) {
+        pybind11::dict dict = handle.cast<pybind11::dict>();
+        object.type = clmdep_msgpack::type::MAP;
+        object.via.map.size = static_cast<uint32_t>(dict.size());
+        object.via.map.ptr = static_cast<clmdep_msgpack::object_kv*>(zone.allocate_align(sizeof(clmdep_msgpack::object_kv)*dict.size()));
+        int i = 0;
+        for (auto [key, value] : dict) {
+            object.via.map.ptr[i].key = toObject(key, zone, ext_type_class);
+            object.via.map.ptr[i].val = toObject(value, zone, ext_type_class);
+            i++;
+        }
+
+    } else {
+        throw pybind11::type_error("Can't convert object of type " + pybind11::str(handle.get_type()).cast<std::string>() + " to msgpack.");
+    }
+
+    return object;
+}
+
+static pybind11::object toPyObject(const clmdep_msgpack::object& object, const pybind11::object& ext_type_class)
+{
+    switch (object.type) {
+        case clmdep_msgpack::type::NIL:
+            return pybind11::none();
+        case clmdep_msgpack::type::BOOLEAN:
+            return pybind11::bool_(object.via.boolean);
+        case clmdep_msgpack::type::POSITIVE_INTEGER:
+            return pybind11::int_(object.via.u64);
+        case clmdep_msgpack::type::NEGATIVE_INTEGER:
+            return pybind11::int_(object.via.i64);
+        case clmdep_msgpack::type::FLOAT32:
+        case clmdep_msgpack::type::FLOAT64:
+            return pybind11::float_(object.via.f64);
+        case clmdep_msgpack::type::STR:
+            return pybind11::str(object.via.str.ptr, object.via.str.size);
+        case clmdep_msgpack::type::BIN:
+            return pybind11::bytes(object.via.bin.ptr, object.via.bin.size);
+        case clmdep_msgpack::type::EXT:
+            return ext_type_class(object.via.ext.type(), pybind11::bytes(object.via.ext.data(), object.via.ext.size));
+        case clmdep_msgpack::type::ARRAY: {
+            pybind11::list list(object.via.array.size);
+            for (unsigned int i = 0; i < object.via.array.size; i++) { // unsigned int needed on Windows
+                list[i] = toPyObject(object.via.array.ptr[i], ext_type_class);
+            }
+            return list;
+        }
+        case clmdep_msgpack::type::MAP: {
+            pybind11::dict dict;
+            for (unsigned int i = 0; i < object.via.map.size; i++) { // unsigned int needed on Windows
+                dict[toPyObject(object.via.map.ptr[i].key, ext_type_class)] = toPyObject(object.via.map.ptr[i].val, ext_type_class);
+            }
+            return dict;
+        }
+        default:
+            SP_ASSERT(false);
+            return pybind11::none();
+    }
+}
+
+static std::vector<clmdep_msgpack::object> toObjects(const pybind11::args& args, clmdep_msgpack::zone& zone, const pybind11::object& ext_type_class)
+{
+    std::vector<clmdep_msgpack::object> objects;
+    for (auto arg : args) {
+        objects.push_back(toObject(arg, zone, ext_type_class));
+    }
+    return objects;
+}
+
+// PyFuture is returned by PyClient::callAsync(...), and has the same get() method as the future returned by
+// msgpackrpc.Client.call_async(...).
+class PyFuture
+{
+public:
+    PyFuture() = delete;
+    PyFuture(std::future<clmdep_msgpack::object_handle>&& future, const pybind11::object& ext_type_class) : future_(std::move(future)), ext_type_class_(ext_type_class) {}
+
+    pybind11::object get()
+    {
+        SP_ASSERT(future_.valid());
+        clmdep_msgpack::object_handle object_handle;
+        {
+            pybind11::gil_scoped_release gil_scoped_release;
+            object_handle = future_.get();
+        }
+        return toPyObject(object_handle.get(), ext_type_class_);
+    }
+
+private:
+    std::future<clmdep_msgpack::object_handle> future_;
+    pybind11::object ext_type_class_;
+};
+
+class PyClient
+{
+public:
+    PyClient() = delete;
+    PyClient(const std::string& address, int port, double timeout_seconds)
+    {
+        client_ = std::make_unique<Client>(address, port, static_cast<int64_t>(timeout_seconds*1000.0));
+        ext_type_class_ = pybind11::module_::import("msgpack").attr("ExtType");
+    }
+
+    pybind11::object call(const std::string& name, const pybind11::args& args)
+    {
+        SP_ASSERT(client_);
+        clmdep_msgpack::zone zone;
+        std::vector<clmdep_msgpack::object> objects = toObjects(args, zone, ext_type_class_);
+        clmdep_msgpack::object_handle object_handle;
+        {
+            pybind11::gil_scoped_release gil_scoped_release;
+            object_handle = client_->callWithObjects(name, objects);
+        }
+        return toPyObject(object_handle.get(), ext_type_class_);
+    }
+
+    // rpclib packs the args before returning from callAsyncWithObjects(...), so zone doesn't need to outlive this function
+    PyFuture callAsync(const std::string& name, const pybind11::args& args)
+    {
+        SP_ASSERT(client_);
+        clmdep_msgpack::zone zone;
+        std::vector<clmdep_msgpack::object> objects = toObjects(args, zone, ext_type_class_);
+        return PyFuture(client_->callAsyncWithObjects(name, objects), ext_type_class_);
+    }
+
+    void close()
+    {
+        client_ = nullptr;
+    }
+
+private:
+    std::unique_ptr<Client> client_;
+    pybind11::object ext_type_class_;
+};
+
+PYBIND11_MODULE(sp_client, module)
+{
+    pybind11::class_<PyFuture>(module, "Future")
+        .def("get", &PyFuture::get);
+
+    pybind11::class_<PyClient>(module, "Client")
+        .def(pybind11::init<const std::string&, int, double>(), pybind11::arg("address"), pybind11::arg("port"), pybind11::arg("timeout_seconds"))
+        .def("call", &PyClient::call)
+        .def("call_async", &PyClient::callAsync)
+        .def("close", &PyClient::close);
+}
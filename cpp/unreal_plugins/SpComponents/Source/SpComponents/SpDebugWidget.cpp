@@ -6,8 +6,9 @@
 
 #include <stdint.h> // uint8_t
 
-#include <memory> // std::make_unique
-#include <ranges> // std::views::transform
+#include <memory>  // std::unique_ptr
+#include <ranges>  // std::views::transform
+#include <utility> // std::move
 
 #include <Components/PoseableMeshComponent.h>
 #include <Components/SkinnedMeshComponent.h> // EBoneSpaces::Type
@@ -22,6 +23,7 @@
 
 #include "SpCore/Assert.h"
 #include "SpCore/Log.h"
+#include "SpCore/SharedMemoryPool.h"
 #include "SpCore/SharedMemoryRegion.h"
 #include "SpCore/SpFuncArray.h"
 #include "SpCore/Std.h"
@@ -487,7 +489,7 @@ void ASpDebugWidget::UpdateData(TMap<FString, FVector>& map_from_string_to_vecto
 void ASpDebugWidget::initializeSpFuncs()
 {
     int shared_memory_num_bytes = 1024;
-    shared_memory_region_ = std::make_unique<SharedMemoryRegion>(shared_memory_num_bytes);
+    shared_memory_region_ = SharedMemoryPool::acquire(shared_memory_num_bytes);
     SP_ASSERT(shared_memory_region_);
 
     shared_memory_view_ = SpFuncSharedMemoryView(shared_memory_region_->getView(), SpFuncSharedMemoryUsageFlags::Arg | SpFuncSharedMemoryUsageFlags::ReturnValue);
@@ -606,5 +608,5 @@ void ASpDebugWidget::terminateSpFuncs()
     SpFuncComponent->unregisterFunc("hello_world");
 
     SpFuncComponent->unregisterSharedMemoryView("my_shared_memory");
-    shared_memory_region_ = nullptr;
+    SharedMemoryPool::release(std::move(shared_memory_region_));
 }
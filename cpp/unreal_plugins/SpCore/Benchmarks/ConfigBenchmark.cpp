@@ -0,0 +1,139 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+//
+// Standalone micro-benchmark for ConfigValue in SpCore/Config.h. This file is not part of any Unreal module. It
+// doesn't need to link against Unreal, because we provide trivial definitions below for the few functions that
+// Config.h depends on. But Config.h includes SpCore/Log.h, which includes <CoreGlobals.h> from Unreal, so this
+// benchmark needs to be built with the Unreal include paths. Config.h also includes SpCore/Boost.h, which includes
+// SpCore/SuppressCompilerWarnings.h, which only supports Clang and MSVC, so on macOS and Linux this benchmark needs
+// to be built with Clang, e.g.,
+//
+//     clang++ -std=c++20 -O2 -DSPCORE_API= -DWITH_EDITOR=0 -I../Source -I/path/to/unreal/include/paths -I/path/to/boost/include -I/path/to/yaml-cpp/include ConfigBenchmark.cpp ../Source/SpCore/Assert.cpp ../Source/SpCore/Std.cpp -L/path/to/yaml-cpp/lib -lyaml-cpp -o ConfigBenchmark
+//
+// We compare three ways of reading the same config value: Config::get(...) with a fully qualified key, which
+// tokenizes the key and traverses the YAML tree on every call; Config::get(...) with a pre-tokenized key, which
+// only traverses the YAML tree; and ConfigValue::get(), which reads from the config system once and then only
+// compares its cached generation with g_config_generation. We also check that all three return the same value,
+// and that ConfigValue::get() returns the new value after the config system is re-initialized. The optional
+// command-line argument is the number of iterations.
+//
+
+#include <stdint.h> // uint64_t
+#include <stdio.h>  // printf
+#include <stdlib.h> // atoi, EXIT_FAILURE, EXIT_SUCCESS
+
+#include <chrono>     // std::chrono::duration, std::chrono::high_resolution_clock
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "SpCore/Config.h"
+#include "SpCore/Log.h"
+#include "SpCore/Std.h"
+#include "SpCore/YamlCpp.h"
+
+//
+// Config.cpp and Log.cpp depend on Unreal, so we provide trivial definitions here. We initialize the config
+// system by assigning to g_config_node directly, and incrementing g_config_generation, which is what
+// Config::requestInitialize() does after loading a config file.
+//
+
+YAML::Node g_config_node;
+uint64_t g_config_generation = 1;
+
+bool Config::isInitialized()
+{
+    return g_config_node.IsDefined() && !g_config_node.IsNull();
+}
+
+std::string Log::getPrefix([[maybe_unused]] const std::filesystem::path& current_file, [[maybe_unused]] int current_line)
+{
+    return "";
+}
+
+void Log::logStdout(const std::string& str)
+{
+    printf("%s\n", str.c_str());
+}
+
+void Log::logUnreal(const std::string& str)
+{
+    printf("%s\n", str.c_str());
+}
+
+static void initializeConfig(float time_delta_seconds)
+{
+    g_config_node = YAML::Load(
+        "SP_SERVICES:\n"
+        "  LEGACY:\n"
+        "    CAMERA_SENSOR:\n"
+        "      USE_SHARED_MEMORY: True\n"
+        "      READ_SURFACE_DATA: True\n"
+        "SPEAR:\n"
+        "  ENV:\n"
+        "    TIME_DELTA_SECONDS: " + std::to_string(time_delta_seconds) + "\n");
+    g_config_generation++;
+}
+
+//
+// Benchmark
+//
+
+static int s_num_failures = 0;
+
+static void check(bool condition, const char* description)
+{
+    if (!condition) {
+        printf("    FAILED: %s\n", description);
+        s_num_failures++;
+    }
+}
+
+template <typename TFunc>
+static void benchmark(const char* name, int num_iterations, TFunc func)
+{
+    // accumulate return values, so the compiler can't optimize away the calls
+    double sum = func(); // warm up
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_iterations; i++) {
+        sum += func();
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+
+    double seconds = std::chrono::duration<double>(end_time - start_time).count() / num_iterations;
+    printf("    %-26s %10.2f ns per lookup (checksum %g)\n", name, seconds*1000000000.0, sum);
+}
+
+int main(int argc, char** argv)
+{
+    int num_iterations = argc > 1 ? atoi(argv[1]) : 1000000;
+
+    std::string key = "SPEAR.ENV.TIME_DELTA_SECONDS";
+    std::vector<std::string> keys = Std::tokenize(key, ".");
+    ConfigValue<float> config_value(key);
+
+    initializeConfig(0.1f);
+    check(Config::get<float>(key) == 0.1f, "Config::get(key)");
+    check(Config::get<float>(keys) == 0.1f, "Config::get(keys)");
+    check(config_value.get() == 0.1f, "ConfigValue::get()");
+
+    // cached values must be invalidated when the config system is re-initialized
+    initializeConfig(0.2f);
+    check(config_value.get() == 0.2f, "ConfigValue::get() after re-initializing");
+
+    printf("float lookup:\n");
+    benchmark("Config::get(key)", num_iterations, [&key]() -> double { return Config::get<float>(key); });
+    benchmark("Config::get(keys)", num_iterations, [&keys]() -> double { return Config::get<float>(keys); });
+    benchmark("ConfigValue::get()", num_iterations, [&config_value]() -> double { return config_value.get(); });
+
+    if (s_num_failures > 0) {
+        printf("%d checks FAILED\n", s_num_failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("All checks passed\n");
+    return EXIT_SUCCESS;
+}
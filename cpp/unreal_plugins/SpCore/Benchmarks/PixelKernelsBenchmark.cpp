@@ -0,0 +1,337 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+//
+// Standalone micro-benchmark for SpCore/PixelKernels.h. PixelKernels doesn't depend on Unreal, so this file is
+// not part of any Unreal module, and is built directly with a C++20 compiler, e.g., on macOS and Linux:
+//
+//     c++ -std=c++20 -O2 -DSPCORE_API= -I../Source -I/path/to/boost/include PixelKernelsBenchmark.cpp ../Source/SpCore/PixelKernels.cpp -o PixelKernelsBenchmark
+//
+// and on Windows:
+//
+//     cl /std:c++20 /O2 /EHsc /DSPCORE_API= /I..\Source /I\path\to\boost\include PixelKernelsBenchmark.cpp ..\Source\SpCore\PixelKernels.cpp
+//
+// For each kernel, we check that its output matches a straightforward scalar reference implementation, and then
+// measure the throughput of the kernel and the reference implementation on a 512x512 image. The optional
+// command-line arguments are the image width, the image height, and the number of iterations.
+//
+
+#include <stdint.h> // int16_t, uint8_t, uint16_t, uint32_t, uint64_t
+#include <stdio.h>  // printf
+#include <stdlib.h> // atoi, EXIT_FAILURE, EXIT_SUCCESS
+#include <string.h> // memcpy
+
+#include <algorithm> // std::clamp, std::max
+#include <chrono>    // std::chrono::duration, std::chrono::high_resolution_clock
+#include <cmath>     // std::abs, std::copysign, std::isnan, std::ldexp, std::nearbyint, std::pow, INFINITY, NAN
+#include <random>    // std::mt19937, std::uniform_int_distribution, std::uniform_real_distribution
+#include <vector>
+
+#include "SpCore/PixelKernels.h"
+
+static int s_num_failures = 0;
+
+static void check(bool condition, const char* kernel_name, uint64_t index)
+{
+    if (!condition) {
+        if (s_num_failures < 10) {
+            printf("    FAILED: %s, index %llu\n", kernel_name, static_cast<unsigned long long>(index));
+        }
+        s_num_failures++;
+    }
+}
+
+template <typename TFunc>
+static void benchmark(const char* name, uint64_t num_bytes, int num_iterations, TFunc func)
+{
+    func(); // warm up
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_iterations; i++) {
+        func();
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+
+    double seconds = std::chrono::duration<double>(end_time - start_time).count() / num_iterations;
+    printf("    %-10s %10.2f us %10.2f GB/s\n", name, seconds*1000000.0, (num_bytes / seconds) / 1000000000.0);
+}
+
+static float float16ToFloat32(uint16_t value)
+{
+    int sign = (value >> 15) & 0x1;
+    int exponent = (value >> 10) & 0x1f;
+    int mantissa = value & 0x3ff;
+    float result;
+    if (exponent == 0) {
+        result = std::ldexp(static_cast<float>(mantissa), -24);
+    } else if (exponent == 31) {
+        result = mantissa == 0 ? INFINITY : NAN;
+    } else {
+        result = std::ldexp(static_cast<float>(mantissa + 1024), exponent - 25);
+    }
+    return sign ? -result : result;
+}
+
+int main(int argc, char** argv)
+{
+    int width = argc > 1 ? atoi(argv[1]) : 512;
+    int height = argc > 2 ? atoi(argv[2]) : 512;
+    int num_iterations = argc > 3 ? atoi(argv[3]) : 100;
+
+    // add a few pixels so the scalar implementation also processes some of the remaining pixels
+    uint64_t num_pixels = static_cast<uint64_t>(width)*height + 5;
+
+    printf("PixelKernels implementation: %s\n", PixelKernels::getImplementationName());
+    printf("%d x %d pixels, %d iterations\n", width, height, num_iterations);
+
+    std::mt19937 random_engine(0);
+    std::uniform_int_distribution<int> uint8_distribution(0, 255);
+    std::uniform_real_distribution<float> unit_distribution(0.0f, 1.0f);
+    std::uniform_real_distribution<float> normal_distribution(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> depth_distribution(0.0f, 100.0f);
+
+    std::vector<uint8_t> bgra8(4*num_pixels);
+    for (auto& value : bgra8) {
+        value = static_cast<uint8_t>(uint8_distribution(random_engine));
+    }
+
+    std::vector<float> rgba32f_depth(4*num_pixels);
+    for (auto& value : rgba32f_depth) {
+        value = depth_distribution(random_engine);
+    }
+
+    std::vector<float> rgba32f_normal(4*num_pixels);
+    for (auto& value : rgba32f_normal) {
+        value = normal_distribution(random_engine);
+    }
+    float zero_length_normal[] = {0.0f, 0.0f, 0.0f, 1.0f};
+    memcpy(rgba32f_normal.data(), zero_length_normal, sizeof(zero_length_normal));
+
+    std::vector<float> rgba32f_linear(4*num_pixels);
+    for (auto& value : rgba32f_linear) {
+        value = unit_distribution(random_engine);
+    }
+
+    //
+    // bgra8ToRgb8
+    //
+
+    {
+        printf("bgra8ToRgb8\n");
+        std::vector<uint8_t> rgb8(3*num_pixels);
+        std::vector<uint8_t> rgb8_reference(3*num_pixels);
+        auto reference = [&]() {
+            for (uint64_t i = 0; i < num_pixels; i++) {
+                rgb8_reference[3*i + 0] = bgra8[4*i + 2];
+                rgb8_reference[3*i + 1] = bgra8[4*i + 1];
+                rgb8_reference[3*i + 2] = bgra8[4*i + 0];
+            }
+        };
+        PixelKernels::bgra8ToRgb8(bgra8.data(), rgb8.data(), num_pixels);
+        reference();
+        for (uint64_t i = 0; i < 3*num_pixels; i++) {
+            check(rgb8.at(i) == rgb8_reference.at(i), "bgra8ToRgb8", i);
+        }
+        benchmark("kernel", 7*num_pixels, num_iterations, [&]() { PixelKernels::bgra8ToRgb8(bgra8.data(), rgb8.data(), num_pixels); });
+        benchmark("reference", 7*num_pixels, num_iterations, reference);
+    }
+
+    //
+    // rgba32fToRgb32f
+    //
+
+    {
+        printf("rgba32fToRgb32f\n");
+        std::vector<float> rgb32f(3*num_pixels);
+        std::vector<float> rgb32f_reference(3*num_pixels);
+        auto reference = [&]() {
+            for (uint64_t i = 0; i < num_pixels; i++) {
+                rgb32f_reference[3*i + 0] = rgba32f_normal[4*i + 0];
+                rgb32f_reference[3*i + 1] = rgba32f_normal[4*i + 1];
+                rgb32f_reference[3*i + 2] = rgba32f_normal[4*i + 2];
+            }
+        };
+        PixelKernels::rgba32fToRgb32f(rgba32f_normal.data(), rgb32f.data(), num_pixels);
+        reference();
+        for (uint64_t i = 0; i < 3*num_pixels; i++) {
+            check(rgb32f.at(i) == rgb32f_reference.at(i), "rgba32fToRgb32f", i);
+        }
+
+        // in-place
+        std::vector<float> in_place = rgba32f_normal;
+        PixelKernels::rgba32fToRgb32f(in_place.data(), in_place.data(), num_pixels);
+        for (uint64_t i = 0; i < 3*num_pixels; i++) {
+            check(in_place.at(i) == rgb32f_reference.at(i), "rgba32fToRgb32f (in-place)", i);
+        }
+
+        benchmark("kernel", 28*num_pixels, num_iterations, [&]() { PixelKernels::rgba32fToRgb32f(rgba32f_normal.data(), rgb32f.data(), num_pixels); });
+        benchmark("reference", 28*num_pixels, num_iterations, reference);
+    }
+
+    //
+    // rgba32fToR32f
+    //
+
+    {
+        printf("rgba32fToR32f\n");
+        std::vector<float> r32f(num_pixels);
+        std::vector<float> r32f_reference(num_pixels);
+        auto reference = [&]() {
+            for (uint64_t i = 0; i < num_pixels; i++) {
+                r32f_reference[i] = rgba32f_depth[4*i + 0];
+            }
+        };
+        PixelKernels::rgba32fToR32f(rgba32f_depth.data(), r32f.data(), num_pixels);
+        reference();
+        for (uint64_t i = 0; i < num_pixels; i++) {
+            check(r32f.at(i) == r32f_reference.at(i), "rgba32fToR32f", i);
+        }
+
+        // in-place
+        std::vector<float> in_place = rgba32f_depth;
+        PixelKernels::rgba32fToR32f(in_place.data(), in_place.data(), num_pixels);
+        for (uint64_t i = 0; i < num_pixels; i++) {
+            check(in_place.at(i) == r32f_reference.at(i), "rgba32fToR32f (in-place)", i);
+        }
+
+        benchmark("kernel", 20*num_pixels, num_iterations, [&]() { PixelKernels::rgba32fToR32f(rgba32f_depth.data(), r32f.data(), num_pixels); });
+        benchmark("reference", 20*num_pixels, num_iterations, reference);
+    }
+
+    //
+    // float32ToFloat16
+    //
+
+    {
+        printf("float32ToFloat16\n");
+
+        // include special values, values that round to subnormals, and values that overflow
+        std::vector<float> float32 = rgba32f_depth;
+        float special_values[] = {0.0f, -0.0f, 1.0f, -2.5f, 65504.0f, 65520.0f, 1.0e6f, -1.0e6f, 5.96e-8f, 6.1e-5f, 1.0e-6f, INFINITY, -INFINITY, NAN};
+        memcpy(float32.data(), special_values, sizeof(special_values));
+
+        std::vector<uint16_t> float16(4*num_pixels);
+        PixelKernels::float32ToFloat16(float32.data(), float16.data(), 4*num_pixels);
+        for (uint64_t i = 0; i < 4*num_pixels; i++) {
+            float expected = float32.at(i);
+            float actual = float16ToFloat32(float16.at(i));
+            if (std::isnan(expected)) {
+                check(std::isnan(actual), "float32ToFloat16", i);
+            } else if (std::abs(expected) >= 65520.0f) {
+                check(actual == std::copysign(INFINITY, expected), "float32ToFloat16", i);
+            } else {
+                // relative error of at most 2^-11 for normals, absolute error of at most 2^-25 for subnormals
+                check(std::abs(actual - expected) <= std::max(std::abs(expected)*std::ldexp(1.0f, -11), std::ldexp(1.0f, -25)), "float32ToFloat16", i);
+            }
+        }
+
+        // the scalar implementation must produce the same results as the SIMD implementations, so we compare
+        // values converted one at a time, which always use the scalar implementation, with the results above
+        for (uint64_t i = 0; i < 4*num_pixels; i += 97) {
+            uint16_t scalar_float16;
+            PixelKernels::float32ToFloat16(float32.data() + i, &scalar_float16, 1);
+            check(std::isnan(float32.at(i)) || scalar_float16 == float16.at(i), "float32ToFloat16 (scalar)", i);
+        }
+
+        benchmark("kernel", 24*num_pixels, num_iterations, [&]() { PixelKernels::float32ToFloat16(rgba32f_depth.data(), float16.data(), 4*num_pixels); });
+    }
+
+    //
+    // linearToSrgb8
+    //
+
+    {
+        printf("linearToSrgb8\n");
+        std::vector<uint8_t> srgb8(4*num_pixels);
+        std::vector<uint8_t> srgb8_reference(4*num_pixels);
+        auto reference = [&]() {
+            for (uint64_t i = 0; i < 4*num_pixels; i++) {
+                float linear = std::clamp(rgba32f_linear[i], 0.0f, 1.0f);
+                float srgb = linear <= 0.0031308f ? 12.92f*linear : 1.055f*std::pow(linear, 1.0f/2.4f) - 0.055f;
+                srgb8_reference[i] = static_cast<uint8_t>(std::nearbyint(srgb*255.0f));
+            }
+        };
+        PixelKernels::linearToSrgb8(rgba32f_linear.data(), srgb8.data(), 4*num_pixels);
+        reference();
+        for (uint64_t i = 0; i < 4*num_pixels; i++) {
+            check(std::abs(srgb8.at(i) - srgb8_reference.at(i)) <= 1, "linearToSrgb8", i);
+        }
+        for (uint64_t i = 0; i < 4*num_pixels; i += 97) {
+            uint8_t scalar_srgb8;
+            PixelKernels::linearToSrgb8(rgba32f_linear.data() + i, &scalar_srgb8, 1);
+            check(scalar_srgb8 == srgb8.at(i), "linearToSrgb8 (scalar)", i);
+        }
+        benchmark("kernel", 20*num_pixels, num_iterations, [&]() { PixelKernels::linearToSrgb8(rgba32f_linear.data(), srgb8.data(), 4*num_pixels); });
+        benchmark("reference", 20*num_pixels, num_iterations, reference);
+    }
+
+    //
+    // bgra8ToSegmentationId
+    //
+
+    {
+        printf("bgra8ToSegmentationId\n");
+        std::vector<uint32_t> segmentation_ids(num_pixels);
+        std::vector<uint32_t> segmentation_ids_reference(num_pixels);
+        auto reference = [&]() {
+            for (uint64_t i = 0; i < num_pixels; i++) {
+                segmentation_ids_reference[i] = (bgra8[4*i + 2] << 16) | (bgra8[4*i + 1] << 8) | bgra8[4*i + 0];
+            }
+        };
+        PixelKernels::bgra8ToSegmentationId(bgra8.data(), segmentation_ids.data(), num_pixels);
+        reference();
+        for (uint64_t i = 0; i < num_pixels; i++) {
+            check(segmentation_ids.at(i) == segmentation_ids_reference.at(i), "bgra8ToSegmentationId", i);
+        }
+        benchmark("kernel", 8*num_pixels, num_iterations, [&]() { PixelKernels::bgra8ToSegmentationId(bgra8.data(), segmentation_ids.data(), num_pixels); });
+        benchmark("reference", 8*num_pixels, num_iterations, reference);
+    }
+
+    //
+    // rgba32fToOctahedral16
+    //
+
+    {
+        printf("rgba32fToOctahedral16\n");
+        std::vector<int16_t> octahedral16(2*num_pixels);
+        std::vector<int16_t> octahedral16_reference(2*num_pixels);
+        auto reference = [&]() {
+            for (uint64_t i = 0; i < num_pixels; i++) {
+                float x = rgba32f_normal[4*i + 0];
+                float y = rgba32f_normal[4*i + 1];
+                float z = rgba32f_normal[4*i + 2];
+                float l1_norm = std::abs(x) + std::abs(y) + std::abs(z);
+                if (l1_norm > 0.0f) {
+                    x /= l1_norm;
+                    y /= l1_norm;
+                }
+                if (z < 0.0f) {
+                    float x_folded = std::copysign(1.0f - std::abs(y), x);
+                    float y_folded = std::copysign(1.0f - std::abs(x), y);
+                    x = x_folded;
+                    y = y_folded;
+                }
+                octahedral16_reference[2*i + 0] = static_cast<int16_t>(std::nearbyint(std::clamp(x, -1.0f, 1.0f)*32767.0f));
+                octahedral16_reference[2*i + 1] = static_cast<int16_t>(std::nearbyint(std::clamp(y, -1.0f, 1.0f)*32767.0f));
+            }
+        };
+        PixelKernels::rgba32fToOctahedral16(rgba32f_normal.data(), octahedral16.data(), num_pixels);
+        reference();
+        for (uint64_t i = 0; i < 2*num_pixels; i++) {
+            // multiplying by the reciprocal and dividing can differ in the last bit
+            check(std::abs(octahedral16.at(i) - octahedral16_reference.at(i)) <= 1, "rgba32fToOctahedral16", i);
+        }
+        check(octahedral16.at(0) == 0 && octahedral16.at(1) == 0, "rgba32fToOctahedral16 (zero-length normal)", 0);
+        benchmark("kernel", 20*num_pixels, num_iterations, [&]() { PixelKernels::rgba32fToOctahedral16(rgba32f_normal.data(), octahedral16.data(), num_pixels); });
+        benchmark("reference", 20*num_pixels, num_iterations, reference);
+    }
+
+    if (s_num_failures > 0) {
+        printf("%d checks failed\n", s_num_failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("All checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,273 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#include "SpCore/ActorIndex.h"
+
+#include <stdint.h> // uint64_t
+
+#include <algorithm> // std::ranges::sort
+#include <map>
+#include <set>
+#include <string>
+#include <utility>   // std::move
+#include <vector>    // std::erase
+
+#include <Delegates/IDelegateInstance.h> // FDelegateHandle
+#include <Engine/Level.h>                // ULevel
+#include <Engine/World.h>                // FOnActorDestroyed, FOnActorSpawned, FWorldDelegates
+#include <EngineUtils.h>                 // TActorIterator
+#include <GameFramework/Actor.h>
+#include <UObject/NameTypes.h>           // FName
+#include <UObject/Object.h>              // IsValid, UObject
+#include <UObject/UnrealType.h>          // FProperty
+
+#include "SpCore/Assert.h"
+#include "SpCore/SpStableNameComponent.h"
+#include "SpCore/Std.h"
+#include "SpCore/Unreal.h"
+
+void ActorIndex::initialize()
+{
+    SP_ASSERT(s_world_indices_.empty());
+
+    s_world_cleanup_handle_ = FWorldDelegates::OnWorldCleanup.AddStatic(&ActorIndex::worldCleanupHandler);
+    s_level_added_to_world_handle_ = FWorldDelegates::LevelAddedToWorld.AddStatic(&ActorIndex::levelAddedToWorldHandler);
+    s_level_removed_from_world_handle_ = FWorldDelegates::LevelRemovedFromWorld.AddStatic(&ActorIndex::levelRemovedFromWorldHandler);
+}
+
+void ActorIndex::terminate()
+{
+    FWorldDelegates::LevelRemovedFromWorld.Remove(s_level_removed_from_world_handle_);
+    FWorldDelegates::LevelAddedToWorld.Remove(s_level_added_to_world_handle_);
+    FWorldDelegates::OnWorldCleanup.Remove(s_world_cleanup_handle_);
+
+    s_level_removed_from_world_handle_.Reset();
+    s_level_added_to_world_handle_.Reset();
+    s_world_cleanup_handle_.Reset();
+
+    s_world_indices_.clear();
+}
+
+std::vector<AActor*> ActorIndex::findActorsByName(const UWorld* world, const std::string& name)
+{
+    WorldIndex& world_index = getWorldIndex(world);
+    return getValidActors(world_index, world_index.name_to_actors_, {name});
+}
+
+std::vector<AActor*> ActorIndex::findActorsByTag(const UWorld* world, const std::string& tag)
+{
+    WorldIndex& world_index = getWorldIndex(world);
+    return getValidActors(world_index, world_index.tag_to_actors_, {tag});
+}
+
+std::vector<AActor*> ActorIndex::findActorsByTagAny(const UWorld* world, const std::vector<std::string>& tags)
+{
+    WorldIndex& world_index = getWorldIndex(world);
+    return getValidActors(world_index, world_index.tag_to_actors_, tags);
+}
+
+void ActorIndex::updateActor(AActor* actor)
+{
+    SP_ASSERT(actor);
+
+    // if the index for the actor's world hasn't been built yet, then the actor will be added when it is built
+    auto world_indices_itr = s_world_indices_.find(actor->GetWorld());
+    if (world_indices_itr == s_world_indices_.end() || world_indices_itr->second.dirty_) {
+        return;
+    }
+
+    // an actor that is already in the index keeps its position in the order that actors are returned
+    WorldIndex& world_index = world_indices_itr->second;
+    auto actor_descs_itr = world_index.actor_descs_.find(actor);
+    uint64_t order = actor_descs_itr != world_index.actor_descs_.end() ? actor_descs_itr->second.order_ : world_index.next_order_++;
+
+    removeActor(world_index, actor);
+    addActor(world_index, actor, order);
+}
+
+void ActorIndex::updateObject(UObject* uobject)
+{
+    SP_ASSERT(uobject);
+
+    if (AActor* actor = Cast<AActor>(uobject)) {
+        updateActor(actor);
+    } else if (USpStableNameComponent* sp_stable_name_component = Cast<USpStableNameComponent>(uobject)) {
+        AActor* actor = sp_stable_name_component->GetOwner();
+        if (actor) {
+            updateActor(actor);
+        }
+    }
+}
+
+void ActorIndex::invalidateIfIndexedProperty(const UWorld* world, const FProperty* property)
+{
+    SP_ASSERT(property);
+
+    // world can be nullptr if there is no game world, in which case there is nothing to invalidate
+    if (!world || !Std::containsKey(s_world_indices_, world)) {
+        return;
+    }
+
+    const UStruct* owner_struct = property->GetOwnerStruct();
+    bool is_tags = owner_struct == AActor::StaticClass() && property->GetFName() == GET_MEMBER_NAME_CHECKED(AActor, Tags);
+    bool is_stable_name = owner_struct == USpStableNameComponent::StaticClass() && property->GetFName() == GET_MEMBER_NAME_CHECKED(USpStableNameComponent, StableName);
+    if (is_tags || is_stable_name) {
+        s_world_indices_.at(world).dirty_ = true;
+    }
+}
+
+ActorIndex::WorldIndex& ActorIndex::getWorldIndex(const UWorld* world)
+{
+    SP_ASSERT(world);
+
+    // AddOnActorSpawnedHandler(...) and AddOnActorDestroyedHandler(...) are non-const, but we don't otherwise
+    // modify the world
+    UWorld* mutable_world = const_cast<UWorld*>(world);
+
+    if (!Std::containsKey(s_world_indices_, world)) {
+        WorldIndex world_index;
+        world_index.actor_spawned_handle_ = mutable_world->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateStatic(&ActorIndex::actorSpawnedHandler));
+        world_index.actor_destroyed_handle_ = mutable_world->AddOnActorDestroyedHandler(FOnActorDestroyed::FDelegate::CreateStatic(&ActorIndex::actorDestroyedHandler));
+        Std::insert(s_world_indices_, world, std::move(world_index));
+    }
+
+    WorldIndex& world_index = s_world_indices_.at(world);
+
+    if (world_index.dirty_) {
+        world_index.next_order_ = 0;
+        world_index.actor_descs_.clear();
+        world_index.name_to_actors_.clear();
+        world_index.tag_to_actors_.clear();
+        for (TActorIterator<AActor> itr(world); itr; ++itr) {
+            AActor* actor = *itr;
+            SP_ASSERT(actor);
+            addActor(world_index, actor, world_index.next_order_++);
+        }
+        world_index.dirty_ = false;
+    }
+
+    return world_index;
+}
+
+void ActorIndex::addActor(WorldIndex& world_index, AActor* actor, uint64_t order)
+{
+    SP_ASSERT(actor);
+    SP_ASSERT(!Std::containsKey(world_index.actor_descs_, actor));
+
+    ActorDesc actor_desc;
+    actor_desc.order_ = order;
+    if (Unreal::hasStableName(actor)) {
+        actor_desc.name_ = Unreal::getStableName(actor);
+        world_index.name_to_actors_[actor_desc.name_].push_back(actor);
+    }
+
+    actor_desc.tags_ = Unreal::getTags(actor);
+    for (auto& tag : actor_desc.tags_) {
+        world_index.tag_to_actors_[tag].push_back(actor);
+    }
+
+    Std::insert(world_index.actor_descs_, actor, std::move(actor_desc));
+}
+
+void ActorIndex::removeActor(WorldIndex& world_index, AActor* actor)
+{
+    SP_ASSERT(actor);
+
+    auto actor_descs_itr = world_index.actor_descs_.find(actor);
+    if (actor_descs_itr == world_index.actor_descs_.end()) {
+        return;
+    }
+
+    const ActorDesc& actor_desc = actor_descs_itr->second;
+
+    if (actor_desc.name_ != "") {
+        std::vector<AActor*>& actors = world_index.name_to_actors_.at(actor_desc.name_);
+        std::erase(actors, actor);
+        if (actors.empty()) {
+            world_index.name_to_actors_.erase(actor_desc.name_);
+        }
+    }
+
+    for (auto& tag : actor_desc.tags_) {
+        std::vector<AActor*>& actors = world_index.tag_to_actors_.at(tag);
+        std::erase(actors, actor);
+        if (actors.empty()) {
+            world_index.tag_to_actors_.erase(tag);
+        }
+    }
+
+    world_index.actor_descs_.erase(actor_descs_itr);
+}
+
+std::vector<AActor*> ActorIndex::getValidActors(const WorldIndex& world_index, const std::map<std::string, std::vector<AActor*>>& key_to_actors, const std::vector<std::string>& keys)
+{
+    // an actor can be stored under more than one of the requested keys, but we only want to return it once
+    std::vector<AActor*> actors;
+    std::set<AActor*> actors_found;
+    for (auto& key : keys) {
+        auto key_to_actors_itr = key_to_actors.find(key);
+        if (key_to_actors_itr == key_to_actors.end()) {
+            continue;
+        }
+        for (auto actor : key_to_actors_itr->second) {
+            // actors that are pending kill are not visible to TActorIterator, so we don't return them either
+            if (IsValid(actor) && !actors_found.contains(actor)) {
+                actors.push_back(actor);
+                actors_found.insert(actor);
+            }
+        }
+    }
+
+    std::ranges::sort(actors, [&world_index](auto lhs, auto rhs) { return world_index.actor_descs_.at(lhs).order_ < world_index.actor_descs_.at(rhs).order_; });
+
+    return actors;
+}
+
+void ActorIndex::worldCleanupHandler(UWorld* world, bool session_ended, bool cleanup_resources)
+{
+    SP_ASSERT(world);
+
+    auto world_indices_itr = s_world_indices_.find(world);
+    if (world_indices_itr != s_world_indices_.end()) {
+        world->RemoveOnActorDestroyededHandler(world_indices_itr->second.actor_destroyed_handle_); // sic, this is how the function is named in Unreal
+        world->RemoveOnActorSpawnedHandler(world_indices_itr->second.actor_spawned_handle_);
+        s_world_indices_.erase(world_indices_itr);
+    }
+}
+
+void ActorIndex::levelAddedToWorldHandler(ULevel* level, UWorld* world)
+{
+    SP_ASSERT(world);
+    if (Std::containsKey(s_world_indices_, world)) {
+        s_world_indices_.at(world).dirty_ = true;
+    }
+}
+
+void ActorIndex::levelRemovedFromWorldHandler(ULevel* level, UWorld* world)
+{
+    // world can be nullptr if the level is being removed from all worlds
+    if (!world) {
+        for (auto& [indexed_world, world_index] : s_world_indices_) {
+            world_index.dirty_ = true;
+        }
+    } else if (Std::containsKey(s_world_indices_, world)) {
+        s_world_indices_.at(world).dirty_ = true;
+    }
+}
+
+void ActorIndex::actorSpawnedHandler(AActor* actor)
+{
+    SP_ASSERT(actor);
+    updateActor(actor);
+}
+
+void ActorIndex::actorDestroyedHandler(AActor* actor)
+{
+    SP_ASSERT(actor);
+
+    auto world_indices_itr = s_world_indices_.find(actor->GetWorld());
+    if (world_indices_itr != s_world_indices_.end() && !world_indices_itr->second.dirty_) {
+        removeActor(world_indices_itr->second, actor);
+    }
+}
@@ -0,0 +1,97 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#pragma once
+
+#include <stdint.h> // uint64_t
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <Delegates/IDelegateInstance.h> // FDelegateHandle
+
+class AActor;
+class FProperty;
+class ULevel;
+class UObject;
+class UWorld;
+
+//
+// ActorIndex maintains a per-world index of actors keyed by stable name and by tag, so Unreal::findActorsByName(...),
+// Unreal::findActorsByTag(...), and similar functions don't need to iterate over every actor in the world. The
+// index for a world is built the first time it is queried, and is then updated incrementally when actors are
+// spawned or destroyed, and when an actor's stable name is changed via Unreal::setStableName(...). The index for
+// a world is rebuilt lazily when a level is added to or removed from the world. Code that modifies an actor's
+// tags or stable name directly must call ActorIndex::updateActor(...) for the change to be visible to queries.
+// Code that modifies an arbitrary object or property on behalf of a client (e.g., UnrealService) can call
+// ActorIndex::updateObject(...) or ActorIndex::invalidateIfIndexedProperty(...) instead, which only do work if
+// the object or property can affect the index.
+//
+// Actors are returned in the order that TActorIterator visited them when the index was built, followed by
+// actors that were spawned since then in the order they were spawned. This matches the order that the previous
+// linear search returned in most cases, but not if an actor is spawned into a streaming level.
+//
+// All functions must be called from the game thread.
+//
+
+class SPCORE_API ActorIndex
+{
+public:
+    ActorIndex() = delete;
+    ~ActorIndex() = delete;
+
+    static void initialize();
+    static void terminate();
+
+    // The returned actors are not filtered by class, and are never pending kill.
+    static std::vector<AActor*> findActorsByName(const UWorld* world, const std::string& name);
+    static std::vector<AActor*> findActorsByTag(const UWorld* world, const std::string& tag);
+    static std::vector<AActor*> findActorsByTagAny(const UWorld* world, const std::vector<std::string>& tags);
+
+    static void updateActor(AActor* actor);
+
+    // Update the actor that owns uobject if uobject is an actor or a USpStableNameComponent, and do nothing otherwise.
+    static void updateObject(UObject* uobject);
+
+    // Mark the index for world as dirty if property is AActor::Tags or USpStableNameComponent::StableName. This is
+    // useful when a property has been modified and the object that owns it isn't known.
+    static void invalidateIfIndexedProperty(const UWorld* world, const FProperty* property);
+
+private:
+    struct ActorDesc
+    {
+        uint64_t order_ = 0; // used to return actors in a consistent order
+        std::string name_;   // empty if the actor doesn't have a stable name
+        std::vector<std::string> tags_;
+    };
+
+    struct WorldIndex
+    {
+        bool dirty_ = true;
+        uint64_t next_order_ = 0;
+        std::map<AActor*, ActorDesc> actor_descs_;
+        std::map<std::string, std::vector<AActor*>> name_to_actors_;
+        std::map<std::string, std::vector<AActor*>> tag_to_actors_;
+        FDelegateHandle actor_spawned_handle_;
+        FDelegateHandle actor_destroyed_handle_;
+    };
+
+    static WorldIndex& getWorldIndex(const UWorld* world);
+    static void addActor(WorldIndex& world_index, AActor* actor, uint64_t order);
+    static void removeActor(WorldIndex& world_index, AActor* actor);
+    static std::vector<AActor*> getValidActors(const WorldIndex& world_index, const std::map<std::string, std::vector<AActor*>>& key_to_actors, const std::vector<std::string>& keys);
+
+    static void worldCleanupHandler(UWorld* world, bool session_ended, bool cleanup_resources);
+    static void levelAddedToWorldHandler(ULevel* level, UWorld* world);
+    static void levelRemovedFromWorldHandler(ULevel* level, UWorld* world);
+    static void actorSpawnedHandler(AActor* actor);
+    static void actorDestroyedHandler(AActor* actor);
+
+    inline static std::map<const UWorld*, WorldIndex> s_world_indices_;
+
+    inline static FDelegateHandle s_world_cleanup_handle_;
+    inline static FDelegateHandle s_level_added_to_world_handle_;
+    inline static FDelegateHandle s_level_removed_from_world_handle_;
+};
@@ -4,7 +4,7 @@
 
 #pragma once
 
-#include <stdint.h> // int64_t
+#include <stdint.h> // int64_t, uint64_t
 
 #include <cmath> // std::nan
 #include <string>
@@ -33,4 +33,29 @@ struct ArrayDesc
     DataType datatype_ = DataType::Invalid;
     bool use_shared_memory_ = false;
     std::string shared_memory_name_;
+    int shared_memory_num_slots_ = 0; // 0 means that the shared memory region contains a single array without a ring buffer header
+    std::vector<std::string> row_names_; // optional, names of the entries along the first dimension of the array
+};
+
+// If ArrayDesc::shared_memory_num_slots_ is greater than 0, then the shared memory region is laid out as a
+// ring buffer. The region begins with a SharedMemoryRingBufferHeader, which is followed by num_slots_ slots.
+// Each slot begins with a SharedMemoryRingBufferSlotHeader, which is followed by the array data, padded to
+// a multiple of k_shared_memory_ring_buffer_alignment bytes. The writer stores 0 in a slot's sequence_ before
+// writing to the slot, and stores the slot's new sequence number after writing to the slot, so a reader can
+// detect if a slot has been overwritten while it was reading. Sequence numbers start at 1, and the slot index
+// for a given sequence number is (sequence - 1) % num_slots_. The layout of these structs must match
+// python/spear/env.py.
+
+constexpr uint64_t k_shared_memory_ring_buffer_alignment = 64;
+
+struct alignas(k_shared_memory_ring_buffer_alignment) SharedMemoryRingBufferHeader
+{
+    uint64_t num_slots_ = 0;
+    uint64_t slot_num_bytes_ = 0;  // distance in bytes between the beginning of consecutive slots
+    uint64_t latest_sequence_ = 0; // sequence number of the most recently written slot, 0 if no slots have been written
+};
+
+struct alignas(k_shared_memory_ring_buffer_alignment) SharedMemoryRingBufferSlotHeader
+{
+    uint64_t sequence_ = 0;
 };
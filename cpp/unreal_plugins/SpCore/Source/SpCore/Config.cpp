@@ -4,6 +4,8 @@
 
 #include "SpCore/Config.h"
 
+#include <stdint.h> // uint64_t
+
 #include <Containers/UnrealString.h> // FString
 #include <HAL/Platform.h>            // TEXT
 #include <Misc/CommandLine.h>
@@ -22,6 +24,7 @@
 //
 
 YAML::Node g_config_node;
+uint64_t g_config_generation = 1;
 
 void Config::requestInitialize()
 {
@@ -35,12 +38,16 @@ void Config::requestInitialize()
     } else {
         s_initialized_ = false;
     }
+
+    // invalidate all cached ConfigValue objects
+    g_config_generation++;
 }
 
 void Config::terminate()
 {
     g_config_node.reset();
     s_initialized_ = false;
+    g_config_generation++;
 }
 
 bool Config::isInitialized()
@@ -4,10 +4,13 @@
 
 #pragma once
 
+#include <stdint.h> // uint64_t
+
 #include <string>
 #include <vector>
 
 #include "SpCore/Assert.h"
+#include "SpCore/Std.h"
 #include "SpCore/Yaml.h"
 #include "SpCore/YamlCpp.h"
 
@@ -21,6 +24,7 @@
 //
 
 extern SPCORE_API YAML::Node g_config_node;
+extern SPCORE_API uint64_t g_config_generation;
 
 class SPCORE_API Config
 {
@@ -67,3 +71,43 @@ public:
 private:
     inline static bool s_initialized_ = false;
 };
+
+// ConfigValue is intended to be used in code that needs to read a config value every frame. Each ConfigValue
+// object tokenizes its key once when it is constructed, and caches its value the first time get() is called
+// after the config system has been initialized. Subsequent calls to get() only need to compare the cached
+// generation with g_config_generation, which is incremented whenever the config system is initialized or
+// terminated. Typical usage is to declare a ConfigValue object with static storage duration in a .cpp file,
+// e.g.,
+//
+//     static ConfigValue<float> s_time_delta_seconds("SIMULATOR.TIME_DELTA_SECONDS");
+//     ...
+//     float time_delta_seconds = s_time_delta_seconds.get();
+//
+// ConfigValue objects are not thread-safe, so each ConfigValue object should only be accessed from a single
+// thread, e.g., the game thread.
+
+template <typename TValue>
+class ConfigValue
+{
+public:
+    ConfigValue() = delete;
+    explicit ConfigValue(const std::string& key)
+    {
+        SP_ASSERT(key != "");
+        keys_ = Std::tokenize(key, ".");
+    }
+
+    const TValue& get() const
+    {
+        if (generation_ != g_config_generation) {
+            value_ = Config::get<TValue>(keys_);
+            generation_ = g_config_generation;
+        }
+        return value_;
+    }
+
+private:
+    std::vector<std::string> keys_;
+    mutable TValue value_ = TValue();
+    mutable uint64_t generation_ = 0; // g_config_generation is never 0, so the first call to get() always reads from the config system
+};
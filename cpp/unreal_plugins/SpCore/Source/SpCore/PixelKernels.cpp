@@ -0,0 +1,502 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#include "SpCore/PixelKernels.h"
+
+#include <stdint.h> // int16_t, int32_t, uint8_t, uint16_t, uint32_t, uint64_t
+#include <string.h> // memcpy
+
+#include <algorithm> // std::clamp, std::min
+#include <array>
+#include <cmath>     // std::abs, std::copysign, std::nearbyint, std::pow
+
+#include <boost/predef.h> // BOOST_ARCH_X86_64, BOOST_COMP_MSVC, BOOST_HW_SIMD_ARM
+
+#if BOOST_ARCH_X86_64
+    #include <immintrin.h>
+    #if BOOST_COMP_MSVC
+        #include <intrin.h> // __cpuid, __cpuidex, _xgetbv
+        #define SP_TARGET_AVX2
+    #else
+        #define SP_TARGET_AVX2 __attribute__((target("avx2,f16c")))
+    #endif
+#elif BOOST_HW_SIMD_ARM
+    #include <arm_neon.h>
+#endif
+
+//
+// Scalar implementations, which are used for the pixels that remain after the SIMD implementations have
+// processed as many pixels as they can, and on CPUs that don't support AVX2 or NEON.
+//
+
+// see https://gist.github.com/rygorous/2156668
+static uint16_t float32ToFloat16Scalar(float value)
+{
+    static constexpr uint32_t k_float32_infinity = 255 << 23;
+    static constexpr uint32_t k_float16_max = (127 + 16) << 23;
+    static constexpr uint32_t k_float16_min_normal = 113 << 23;
+    static constexpr uint32_t k_denorm_magic = ((127 - 15) + (23 - 10) + 1) << 23;
+
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint16_t result;
+    if (bits >= k_float16_max) {
+        result = bits > k_float32_infinity ? 0x7e00 : 0x7c00; // NaN to quiet NaN, too large to infinity
+    } else if (bits < k_float16_min_normal) {
+        // subnormal or zero, let the FPU do the rounding
+        float denorm_magic;
+        memcpy(&denorm_magic, &k_denorm_magic, sizeof(denorm_magic));
+        float tmp;
+        memcpy(&tmp, &bits, sizeof(tmp));
+        tmp += denorm_magic;
+        memcpy(&bits, &tmp, sizeof(bits));
+        result = static_cast<uint16_t>(bits - k_denorm_magic);
+    } else {
+        uint32_t mantissa_odd = (bits >> 13) & 1;
+        bits -= (127 - 15) << 23; // rebias exponent
+        bits += 0xfff + mantissa_odd; // round to nearest even
+        result = static_cast<uint16_t>(bits >> 13);
+    }
+
+    return result | static_cast<uint16_t>(sign >> 16);
+}
+
+static std::array<int32_t, 4096> createLinearToSrgb8Table()
+{
+    std::array<int32_t, 4096> table;
+    for (int i = 0; i < 4096; i++) {
+        double linear = i / 4095.0;
+        double srgb = linear <= 0.0031308 ? 12.92*linear : 1.055*std::pow(linear, 1.0/2.4) - 0.055;
+        table[i] = static_cast<int32_t>(std::nearbyint(std::clamp(srgb, 0.0, 1.0) * 255.0));
+    }
+    return table;
+}
+
+// int32_t entries so the table can be used with AVX2 gather instructions
+static const std::array<int32_t, 4096> s_linear_to_srgb8_table = createLinearToSrgb8Table();
+
+static int16_t encodeOctahedral16(float value)
+{
+    return static_cast<int16_t>(std::nearbyint(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+//
+// AVX2 implementations, each function returns the number of pixels that it processed
+//
+
+#if BOOST_ARCH_X86_64
+
+static bool hasAvx2()
+{
+    #if BOOST_COMP_MSVC
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) {
+            return false;
+        }
+        __cpuid(info, 1);
+        bool has_osxsave = (info[2] & (1 << 27)) != 0;
+        bool has_avx = (info[2] & (1 << 28)) != 0;
+        bool has_f16c = (info[2] & (1 << 29)) != 0;
+        if (!has_osxsave || !has_avx || !has_f16c) {
+            return false;
+        }
+        // the OS must save the upper halves of the YMM registers
+        if ((_xgetbv(0) & 0x6) != 0x6) {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    #else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+    #endif
+}
+
+static const bool s_has_avx2 = hasAvx2();
+
+SP_TARGET_AVX2 static uint64_t bgra8ToRgb8Avx2(const uint8_t* src, uint8_t* dest, uint64_t num_pixels)
+{
+    // each iteration writes 16 bytes, of which the last 4 are overwritten by the next iteration, so we stop
+    // early enough to avoid writing past the end of dest
+    const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    uint64_t i = 0;
+    for (; i + 6 <= num_pixels; i += 4) {
+        __m128i bgra = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4*i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 3*i), _mm_shuffle_epi8(bgra, shuffle));
+    }
+    return i;
+}
+
+SP_TARGET_AVX2 static uint64_t rgba32fToRgb32fAvx2(const float* src, float* dest, uint64_t num_pixels)
+{
+    // each iteration writes 4 floats, of which the last one is overwritten by the next iteration
+    uint64_t i = 0;
+    for (; i + 2 <= num_pixels; i++) {
+        _mm_storeu_ps(dest + 3*i, _mm_loadu_ps(src + 4*i));
+    }
+    return i;
+}
+
+SP_TARGET_AVX2 static uint64_t rgba32fToR32fAvx2(const float* src, float* dest, uint64_t num_pixels)
+{
+    const __m256i indices = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+    uint64_t i = 0;
+    for (; i + 8 <= num_pixels; i += 8) {
+        _mm256_storeu_ps(dest + i, _mm256_i32gather_ps(src + 4*i, indices, 4));
+    }
+    return i;
+}
+
+SP_TARGET_AVX2 static uint64_t float32ToFloat16Avx2(const float* src, uint16_t* dest, uint64_t num_values)
+{
+    uint64_t i = 0;
+    for (; i + 8 <= num_values; i += 8) {
+        __m128i float16s = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), float16s);
+    }
+    return i;
+}
+
+SP_TARGET_AVX2 static uint64_t linearToSrgb8Avx2(const float* src, uint8_t* dest, uint64_t num_values)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 scale = _mm256_set1_ps(4095.0f);
+    const __m256i pack = _mm256_setr_epi8(
+        0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    uint64_t i = 0;
+    for (; i + 8 <= num_values; i += 8) {
+        // _mm256_cvtps_epi32 rounds to nearest even, same as std::nearbyint in the scalar implementation
+        __m256 values = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i), zero), one);
+        __m256i indices = _mm256_cvtps_epi32(_mm256_mul_ps(values, scale));
+        __m256i srgb = _mm256_shuffle_epi8(_mm256_i32gather_epi32(s_linear_to_srgb8_table.data(), indices, 4), pack);
+        uint32_t lo = static_cast<uint32_t>(_mm256_extract_epi32(srgb, 0));
+        uint32_t hi = static_cast<uint32_t>(_mm256_extract_epi32(srgb, 4));
+        memcpy(dest + i, &lo, sizeof(lo));
+        memcpy(dest + i + 4, &hi, sizeof(hi));
+    }
+    return i;
+}
+
+SP_TARGET_AVX2 static uint64_t bgra8ToSegmentationIdAvx2(const uint8_t* src, uint32_t* dest, uint64_t num_pixels)
+{
+    const __m256i mask = _mm256_set1_epi32(0x00ffffff);
+    uint64_t i = 0;
+    for (; i + 8 <= num_pixels; i += 8) {
+        __m256i bgra = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 4*i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), _mm256_and_si256(bgra, mask));
+    }
+    return i;
+}
+
+SP_TARGET_AVX2 static uint64_t rgba32fToOctahedral16Avx2(const float* src, int16_t* dest, uint64_t num_pixels)
+{
+    const __m256i indices = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+    const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 minus_one = _mm256_set1_ps(-1.0f);
+    const __m256 scale = _mm256_set1_ps(32767.0f);
+    uint64_t i = 0;
+    for (; i + 8 <= num_pixels; i += 8) {
+        __m256 x = _mm256_i32gather_ps(src + 4*i + 0, indices, 4);
+        __m256 y = _mm256_i32gather_ps(src + 4*i + 1, indices, 4);
+        __m256 z = _mm256_i32gather_ps(src + 4*i + 2, indices, 4);
+
+        // project onto the octahedron
+        __m256 abs_x = _mm256_andnot_ps(sign_mask, x);
+        __m256 abs_y = _mm256_andnot_ps(sign_mask, y);
+        __m256 abs_z = _mm256_andnot_ps(sign_mask, z);
+        __m256 l1_norm = _mm256_add_ps(_mm256_add_ps(abs_x, abs_y), abs_z);
+        __m256 inv_l1_norm = _mm256_and_ps(_mm256_div_ps(one, l1_norm), _mm256_cmp_ps(l1_norm, zero, _CMP_GT_OQ));
+        x = _mm256_mul_ps(x, inv_l1_norm);
+        y = _mm256_mul_ps(y, inv_l1_norm);
+
+        // fold the lower hemisphere
+        abs_x = _mm256_andnot_ps(sign_mask, x);
+        abs_y = _mm256_andnot_ps(sign_mask, y);
+        __m256 x_folded = _mm256_or_ps(_mm256_sub_ps(one, abs_y), _mm256_and_ps(x, sign_mask));
+        __m256 y_folded = _mm256_or_ps(_mm256_sub_ps(one, abs_x), _mm256_and_ps(y, sign_mask));
+        __m256 lower = _mm256_cmp_ps(z, zero, _CMP_LT_OQ);
+        x = _mm256_blendv_ps(x, x_folded, lower);
+        y = _mm256_blendv_ps(y, y_folded, lower);
+
+        x = _mm256_min_ps(_mm256_max_ps(x, minus_one), one);
+        y = _mm256_min_ps(_mm256_max_ps(y, minus_one), one);
+        __m256i x_int32 = _mm256_cvtps_epi32(_mm256_mul_ps(x, scale));
+        __m256i y_int32 = _mm256_cvtps_epi32(_mm256_mul_ps(y, scale));
+
+        // interleave and pack, packing operates within each 128-bit lane, which results in the order we want
+        __m256i xy_lo = _mm256_unpacklo_epi32(x_int32, y_int32); // x0 y0 x1 y1 | x4 y4 x5 y5
+        __m256i xy_hi = _mm256_unpackhi_epi32(x_int32, y_int32); // x2 y2 x3 y3 | x6 y6 x7 y7
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + 2*i), _mm256_packs_epi32(xy_lo, xy_hi));
+    }
+    return i;
+}
+
+#endif
+
+//
+// NEON implementations, each function returns the number of pixels that it processed
+//
+
+#if BOOST_HW_SIMD_ARM
+
+static uint64_t bgra8ToRgb8Neon(const uint8_t* src, uint8_t* dest, uint64_t num_pixels)
+{
+    uint64_t i = 0;
+    for (; i + 16 <= num_pixels; i += 16) {
+        uint8x16x4_t bgra = vld4q_u8(src + 4*i);
+        uint8x16x3_t rgb = {bgra.val[2], bgra.val[1], bgra.val[0]};
+        vst3q_u8(dest + 3*i, rgb);
+    }
+    return i;
+}
+
+static uint64_t rgba32fToRgb32fNeon(const float* src, float* dest, uint64_t num_pixels)
+{
+    uint64_t i = 0;
+    for (; i + 4 <= num_pixels; i += 4) {
+        float32x4x4_t rgba = vld4q_f32(src + 4*i);
+        float32x4x3_t rgb = {rgba.val[0], rgba.val[1], rgba.val[2]};
+        vst3q_f32(dest + 3*i, rgb);
+    }
+    return i;
+}
+
+static uint64_t rgba32fToR32fNeon(const float* src, float* dest, uint64_t num_pixels)
+{
+    uint64_t i = 0;
+    for (; i + 4 <= num_pixels; i += 4) {
+        vst1q_f32(dest + i, vld4q_f32(src + 4*i).val[0]);
+    }
+    return i;
+}
+
+static uint64_t float32ToFloat16Neon(const float* src, uint16_t* dest, uint64_t num_values)
+{
+    uint64_t i = 0;
+    for (; i + 4 <= num_values; i += 4) {
+        vst1_u16(dest + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(src + i))));
+    }
+    return i;
+}
+
+static uint64_t linearToSrgb8Neon(const float* src, uint8_t* dest, uint64_t num_values)
+{
+    // NEON doesn't have gather instructions, so we only vectorize the index computation
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    uint64_t i = 0;
+    for (; i + 4 <= num_values; i += 4) {
+        float32x4_t values = vminq_f32(vmaxq_f32(vld1q_f32(src + i), zero), one);
+        int32_t indices[4];
+        vst1q_s32(indices, vcvtnq_s32_f32(vmulq_n_f32(values, 4095.0f)));
+        dest[i + 0] = static_cast<uint8_t>(s_linear_to_srgb8_table[indices[0]]);
+        dest[i + 1] = static_cast<uint8_t>(s_linear_to_srgb8_table[indices[1]]);
+        dest[i + 2] = static_cast<uint8_t>(s_linear_to_srgb8_table[indices[2]]);
+        dest[i + 3] = static_cast<uint8_t>(s_linear_to_srgb8_table[indices[3]]);
+    }
+    return i;
+}
+
+static uint64_t bgra8ToSegmentationIdNeon(const uint8_t* src, uint32_t* dest, uint64_t num_pixels)
+{
+    const uint32x4_t mask = vdupq_n_u32(0x00ffffff);
+    uint64_t i = 0;
+    for (; i + 4 <= num_pixels; i += 4) {
+        vst1q_u32(dest + i, vandq_u32(vreinterpretq_u32_u8(vld1q_u8(src + 4*i)), mask));
+    }
+    return i;
+}
+
+static uint64_t rgba32fToOctahedral16Neon(const float* src, int16_t* dest, uint64_t num_pixels)
+{
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t minus_one = vdupq_n_f32(-1.0f);
+    const uint32x4_t sign_mask = vdupq_n_u32(0x80000000u);
+    uint64_t i = 0;
+    for (; i + 4 <= num_pixels; i += 4) {
+        float32x4x4_t rgba = vld4q_f32(src + 4*i);
+        float32x4_t x = rgba.val[0];
+        float32x4_t y = rgba.val[1];
+        float32x4_t z = rgba.val[2];
+
+        // project onto the octahedron
+        float32x4_t l1_norm = vaddq_f32(vaddq_f32(vabsq_f32(x), vabsq_f32(y)), vabsq_f32(z));
+        uint32x4_t positive = vcgtq_f32(l1_norm, zero);
+        float32x4_t inv_l1_norm = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(vdivq_f32(one, l1_norm)), positive));
+        x = vmulq_f32(x, inv_l1_norm);
+        y = vmulq_f32(y, inv_l1_norm);
+
+        // fold the lower hemisphere, vbslq_f32(sign_mask, a, b) takes the sign bit from a and all other bits from b
+        float32x4_t x_folded = vbslq_f32(sign_mask, x, vsubq_f32(one, vabsq_f32(y)));
+        float32x4_t y_folded = vbslq_f32(sign_mask, y, vsubq_f32(one, vabsq_f32(x)));
+        uint32x4_t lower = vcltq_f32(z, zero);
+        x = vbslq_f32(lower, x_folded, x);
+        y = vbslq_f32(lower, y_folded, y);
+
+        x = vminq_f32(vmaxq_f32(x, minus_one), one);
+        y = vminq_f32(vmaxq_f32(y, minus_one), one);
+        int16x4x2_t xy = {vqmovn_s32(vcvtnq_s32_f32(vmulq_n_f32(x, 32767.0f))), vqmovn_s32(vcvtnq_s32_f32(vmulq_n_f32(y, 32767.0f)))};
+        vst2_s16(dest + 2*i, xy);
+    }
+    return i;
+}
+
+#endif
+
+//
+// Public functions, each function calls the SIMD implementation for the current CPU if there is one, and then
+// processes any remaining pixels with the scalar implementation.
+//
+
+void PixelKernels::bgra8ToRgb8(const uint8_t* src, uint8_t* dest, uint64_t num_pixels)
+{
+    uint64_t i = 0;
+    #if BOOST_ARCH_X86_64
+        if (s_has_avx2) {
+            i = bgra8ToRgb8Avx2(src, dest, num_pixels);
+        }
+    #elif BOOST_HW_SIMD_ARM
+        i = bgra8ToRgb8Neon(src, dest, num_pixels);
+    #endif
+
+    for (; i < num_pixels; i++) {
+        dest[3*i + 0] = src[4*i + 2];
+        dest[3*i + 1] = src[4*i + 1];
+        dest[3*i + 2] = src[4*i + 0];
+    }
+}
+
+void PixelKernels::rgba32fToRgb32f(const float* src, float* dest, uint64_t num_pixels)
+{
+    uint64_t i = 0;
+    #if BOOST_ARCH_X86_64
+        if (s_has_avx2) {
+            i = rgba32fToRgb32fAvx2(src, dest, num_pixels);
+        }
+    #elif BOOST_HW_SIMD_ARM
+        i = rgba32fToRgb32fNeon(src, dest, num_pixels);
+    #endif
+
+    for (; i < num_pixels; i++) {
+        dest[3*i + 0] = src[4*i + 0];
+        dest[3*i + 1] = src[4*i + 1];
+        dest[3*i + 2] = src[4*i + 2];
+    }
+}
+
+void PixelKernels::rgba32fToR32f(const float* src, float* dest, uint64_t num_pixels)
+{
+    uint64_t i = 0;
+    #if BOOST_ARCH_X86_64
+        if (s_has_avx2) {
+            i = rgba32fToR32fAvx2(src, dest, num_pixels);
+        }
+    #elif BOOST_HW_SIMD_ARM
+        i = rgba32fToR32fNeon(src, dest, num_pixels);
+    #endif
+
+    for (; i < num_pixels; i++) {
+        dest[i] = src[4*i + 0];
+    }
+}
+
+void PixelKernels::float32ToFloat16(const float* src, uint16_t* dest, uint64_t num_values)
+{
+    uint64_t i = 0;
+    #if BOOST_ARCH_X86_64
+        if (s_has_avx2) {
+            i = float32ToFloat16Avx2(src, dest, num_values);
+        }
+    #elif BOOST_HW_SIMD_ARM
+        i = float32ToFloat16Neon(src, dest, num_values);
+    #endif
+
+    for (; i < num_values; i++) {
+        dest[i] = float32ToFloat16Scalar(src[i]);
+    }
+}
+
+void PixelKernels::linearToSrgb8(const float* src, uint8_t* dest, uint64_t num_values)
+{
+    uint64_t i = 0;
+    #if BOOST_ARCH_X86_64
+        if (s_has_avx2) {
+            i = linearToSrgb8Avx2(src, dest, num_values);
+        }
+    #elif BOOST_HW_SIMD_ARM
+        i = linearToSrgb8Neon(src, dest, num_values);
+    #endif
+
+    for (; i < num_values; i++) {
+        float value = src[i] > 0.0f ? std::min(src[i], 1.0f) : 0.0f; // NaN is mapped to 0.0, same as _mm256_max_ps
+        int index = static_cast<int>(std::nearbyint(value * 4095.0f));
+        dest[i] = static_cast<uint8_t>(s_linear_to_srgb8_table[index]);
+    }
+}
+
+void PixelKernels::bgra8ToSegmentationId(const uint8_t* src, uint32_t* dest, uint64_t num_pixels)
+{
+    uint64_t i = 0;
+    #if BOOST_ARCH_X86_64
+        if (s_has_avx2) {
+            i = bgra8ToSegmentationIdAvx2(src, dest, num_pixels);
+        }
+    #elif BOOST_HW_SIMD_ARM
+        i = bgra8ToSegmentationIdNeon(src, dest, num_pixels);
+    #endif
+
+    for (; i < num_pixels; i++) {
+        dest[i] = (static_cast<uint32_t>(src[4*i + 2]) << 16) | (static_cast<uint32_t>(src[4*i + 1]) << 8) | static_cast<uint32_t>(src[4*i + 0]);
+    }
+}
+
+void PixelKernels::rgba32fToOctahedral16(const float* src, int16_t* dest, uint64_t num_pixels)
+{
+    uint64_t i = 0;
+    #if BOOST_ARCH_X86_64
+        if (s_has_avx2) {
+            i = rgba32fToOctahedral16Avx2(src, dest, num_pixels);
+        }
+    #elif BOOST_HW_SIMD_ARM
+        i = rgba32fToOctahedral16Neon(src, dest, num_pixels);
+    #endif
+
+    for (; i < num_pixels; i++) {
+        float x = src[4*i + 0];
+        float y = src[4*i + 1];
+        float z = src[4*i + 2];
+        float l1_norm = std::abs(x) + std::abs(y) + std::abs(z);
+        float inv_l1_norm = l1_norm > 0.0f ? 1.0f/l1_norm : 0.0f;
+        x *= inv_l1_norm;
+        y *= inv_l1_norm;
+        if (z < 0.0f) {
+            float x_folded = std::copysign(1.0f - std::abs(y), x);
+            float y_folded = std::copysign(1.0f - std::abs(x), y);
+            x = x_folded;
+            y = y_folded;
+        }
+        dest[2*i + 0] = encodeOctahedral16(x);
+        dest[2*i + 1] = encodeOctahedral16(y);
+    }
+}
+
+const char* PixelKernels::getImplementationName()
+{
+    #if BOOST_ARCH_X86_64
+        return s_has_avx2 ? "avx2" : "scalar";
+    #elif BOOST_HW_SIMD_ARM
+        return "neon";
+    #else
+        return "scalar";
+    #endif
+}
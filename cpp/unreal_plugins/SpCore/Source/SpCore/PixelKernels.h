@@ -0,0 +1,53 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#pragma once
+
+#include <stdint.h> // int16_t, uint8_t, uint16_t, uint32_t, uint64_t
+
+//
+// PixelKernels contains the per-pixel conversions that we apply to image data every frame, e.g., after reading
+// back a render target and before writing an observation to shared memory. Each function has an AVX2 or NEON
+// implementation, and a scalar implementation that is used for any remaining pixels and on CPUs that don't
+// support AVX2. On x86-64, AVX2 support is detected at runtime, so callers don't need to be compiled with any
+// special flags. PixelKernels doesn't depend on Unreal, so it can be compiled and benchmarked on its own, see
+// cpp/unreal_plugins/SpCore/Benchmarks/PixelKernelsBenchmark.cpp.
+//
+// Unless otherwise noted, the source and destination buffers must not overlap. All functions are thread-safe.
+//
+
+class SPCORE_API PixelKernels
+{
+public:
+    PixelKernels() = delete;
+    ~PixelKernels() = delete;
+
+    // 4 x uint8 BGRA (e.g., FColor) to 3 x uint8 RGB.
+    static void bgra8ToRgb8(const uint8_t* src, uint8_t* dest, uint64_t num_pixels);
+
+    // 4 x float32 RGBA (e.g., FLinearColor) to 3 x float32 RGB. Can be called in-place, i.e., with src == dest.
+    static void rgba32fToRgb32f(const float* src, float* dest, uint64_t num_pixels);
+
+    // 4 x float32 RGBA to 1 x float32 R. Can be called in-place, i.e., with src == dest.
+    static void rgba32fToR32f(const float* src, float* dest, uint64_t num_pixels);
+
+    // float32 to float16, rounding to nearest even. Values that are too large are converted to infinity.
+    static void float32ToFloat16(const float* src, uint16_t* dest, uint64_t num_values);
+
+    // Linear float32 in [0.0, 1.0] to sRGB-encoded uint8, via a lookup table with 4096 entries, so the result
+    // can differ from the exact result by 1. Values outside [0.0, 1.0] are clamped. This function is applied
+    // per-value, so callers should convert alpha channels separately.
+    static void linearToSrgb8(const float* src, uint8_t* dest, uint64_t num_values);
+
+    // 4 x uint8 BGRA segmentation color to a uint32 segmentation ID, i.e., (R << 16) | (G << 8) | B. Can be
+    // called in-place, i.e., with src == dest.
+    static void bgra8ToSegmentationId(const uint8_t* src, uint32_t* dest, uint64_t num_pixels);
+
+    // 4 x float32 RGBA normal to 2 x int16 octahedral encoding, see https://jcgt.org/published/0003/02/01.
+    // Normals don't need to be unit length, and normals with zero length are encoded as (0, 0).
+    static void rgba32fToOctahedral16(const float* src, int16_t* dest, uint64_t num_pixels);
+
+    // Returns "avx2", "neon", or "scalar", depending on which implementation is used on the current CPU.
+    static const char* getImplementationName();
+};
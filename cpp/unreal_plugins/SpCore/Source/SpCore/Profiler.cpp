@@ -0,0 +1,208 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#include "SpCore/Profiler.h"
+
+#include <stdint.h> // uint64_t
+
+#include <algorithm> // std::max, std::min, std::sort
+#include <atomic>    // std::atomic_thread_fence
+#include <chrono>
+#include <cmath>     // std::ceil
+#include <fstream>
+#include <limits>    // std::numeric_limits
+#include <map>
+#include <memory>    // std::make_shared, std::make_unique, std::shared_ptr
+#include <mutex>     // std::lock_guard
+#include <stdexcept> // std::runtime_error
+#include <string>
+#include <vector>
+
+#include "SpCore/Assert.h"
+#include "SpCore/Config.h"
+#include "SpCore/Log.h"
+#include "SpCore/Std.h"
+
+struct ProfilerEventDesc
+{
+    std::string name_;
+    uint64_t thread_index_ = 0;
+    uint64_t begin_time_nanoseconds_ = 0;
+    uint64_t end_time_nanoseconds_ = 0;
+};
+
+static double getPercentile(const std::vector<double>& sorted_values, double percentile)
+{
+    SP_ASSERT(!sorted_values.empty());
+
+    // nearest-rank method, i.e., the smallest value such that at least percentile of all values are less than or equal to it
+    uint64_t rank = static_cast<uint64_t>(std::ceil(percentile * sorted_values.size()));
+    return sorted_values.at(std::min(std::max(rank, static_cast<uint64_t>(1)), static_cast<uint64_t>(sorted_values.size())) - 1);
+}
+
+void Profiler::initialize()
+{
+    std::lock_guard<std::mutex> lock(s_mutex_);
+
+    SP_ASSERT(s_thread_events_.empty());
+
+    if (Config::isInitialized()) {
+        s_num_events_per_thread_ = Config::get<uint64_t>("SP_CORE.PROFILER.NUM_EVENTS_PER_THREAD");
+        s_enabled_.store(Config::get<bool>("SP_CORE.PROFILER.ENABLED"), std::memory_order_relaxed);
+    }
+    SP_ASSERT(s_num_events_per_thread_ > 0);
+}
+
+void Profiler::terminate()
+{
+    std::lock_guard<std::mutex> lock(s_mutex_);
+
+    // each thread's ring buffer remains valid until its thread exits, because the thread holds its own reference
+    s_enabled_.store(false, std::memory_order_relaxed);
+    s_thread_events_.clear();
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+    s_enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+uint64_t Profiler::getTimeNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::record(const char* name, uint64_t begin_time_nanoseconds, uint64_t end_time_nanoseconds)
+{
+    SP_ASSERT(name);
+
+    ThreadEvents* thread_events = getThreadEvents();
+    SP_ASSERT(thread_events);
+
+    // This is the writer side of a seqlock. We claim the slot by incrementing write_position_ before writing to
+    // it, and publish it by incrementing committed_position_ afterwards. If getStats(...) observes any of our
+    // writes to the slot, then the fences guarantee that it also observes our increment of write_position_.
+    uint64_t position = thread_events->write_position_.load(std::memory_order_relaxed);
+    thread_events->write_position_.store(position + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Event& event = thread_events->events_[position % thread_events->num_events_];
+    event.name_.store(name, std::memory_order_relaxed);
+    event.begin_time_nanoseconds_.store(begin_time_nanoseconds, std::memory_order_relaxed);
+    event.end_time_nanoseconds_.store(end_time_nanoseconds, std::memory_order_relaxed);
+
+    thread_events->committed_position_.store(position + 1, std::memory_order_release);
+}
+
+std::map<std::string, ProfilerScopeStats> Profiler::getStats(const std::string& chrome_trace_file)
+{
+    // chrome_trace_file is provided by the client, so we open it before consuming any events, and return an error to
+    // the client if it can't be opened
+    std::ofstream fs;
+    if (chrome_trace_file != "") {
+        fs.open(chrome_trace_file);
+        if (!fs.is_open()) {
+            throw std::runtime_error("Couldn't open the Chrome trace file \"" + chrome_trace_file + "\" for writing.");
+        }
+    }
+
+    std::vector<ProfilerEventDesc> event_descs;
+
+    s_mutex_.lock();
+    {
+        for (auto& thread_events : s_thread_events_) {
+            uint64_t num_events = thread_events->num_events_;
+            uint64_t committed_position = thread_events->committed_position_.load(std::memory_order_acquire);
+            uint64_t begin_position = std::max(thread_events->read_position_, committed_position > num_events ? committed_position - num_events : 0);
+
+            std::vector<ProfilerEventDesc> thread_event_descs;
+            for (uint64_t position = begin_position; position < committed_position; position++) {
+                const Event& event = thread_events->events_[position % num_events];
+                ProfilerEventDesc event_desc;
+                event_desc.name_ = event.name_.load(std::memory_order_relaxed);
+                event_desc.thread_index_ = thread_events->thread_index_;
+                event_desc.begin_time_nanoseconds_ = event.begin_time_nanoseconds_.load(std::memory_order_relaxed);
+                event_desc.end_time_nanoseconds_ = event.end_time_nanoseconds_.load(std::memory_order_relaxed);
+                thread_event_descs.push_back(std::move(event_desc));
+            }
+
+            // This is the reader side of the seqlock in record(...). Any event that the owning thread might have
+            // started overwriting while we were reading it is discarded.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t write_position = thread_events->write_position_.load(std::memory_order_relaxed);
+            uint64_t valid_begin_position = write_position > num_events ? write_position - num_events : 0;
+            for (uint64_t position = begin_position; position < committed_position; position++) {
+                if (position >= valid_begin_position) {
+                    event_descs.push_back(std::move(thread_event_descs.at(position - begin_position)));
+                }
+            }
+
+            thread_events->read_position_ = committed_position;
+        }
+    }
+    s_mutex_.unlock();
+
+    // aggregate durations per scope
+    std::map<std::string, std::vector<double>> durations_ms;
+    for (auto& event_desc : event_descs) {
+        durations_ms[event_desc.name_].push_back((event_desc.end_time_nanoseconds_ - event_desc.begin_time_nanoseconds_) / 1000000.0);
+    }
+
+    std::map<std::string, ProfilerScopeStats> stats;
+    for (auto& [name, scope_durations_ms] : durations_ms) {
+        std::sort(scope_durations_ms.begin(), scope_durations_ms.end());
+        ProfilerScopeStats scope_stats;
+        scope_stats.count_ = scope_durations_ms.size();
+        for (auto duration_ms : scope_durations_ms) {
+            scope_stats.total_ms_ += duration_ms;
+        }
+        scope_stats.mean_ms_ = scope_stats.total_ms_ / scope_stats.count_;
+        scope_stats.p50_ms_ = getPercentile(scope_durations_ms, 0.50);
+        scope_stats.p90_ms_ = getPercentile(scope_durations_ms, 0.90);
+        scope_stats.p99_ms_ = getPercentile(scope_durations_ms, 0.99);
+        scope_stats.max_ms_ = scope_durations_ms.back();
+        Std::insert(stats, name, std::move(scope_stats));
+    }
+
+    // write complete events ("ph": "X") in the Chrome trace event format, timestamps are in microseconds
+    if (chrome_trace_file != "") {
+        uint64_t min_begin_time_nanoseconds = std::numeric_limits<uint64_t>::max();
+        for (auto& event_desc : event_descs) {
+            min_begin_time_nanoseconds = std::min(min_begin_time_nanoseconds, event_desc.begin_time_nanoseconds_);
+        }
+
+        fs << "{\"traceEvents\": [" << std::endl;
+        for (uint64_t i = 0; i < event_descs.size(); i++) {
+            const ProfilerEventDesc& event_desc = event_descs.at(i);
+            fs << "    {\"name\": \"" << event_desc.name_ << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << event_desc.thread_index_ <<
+                ", \"ts\": " << (event_desc.begin_time_nanoseconds_ - min_begin_time_nanoseconds) / 1000.0 <<
+                ", \"dur\": " << (event_desc.end_time_nanoseconds_ - event_desc.begin_time_nanoseconds_) / 1000.0 << "}" <<
+                (i + 1 < event_descs.size() ? "," : "") << std::endl;
+        }
+        fs << "]}" << std::endl;
+        fs.close();
+
+        SP_LOG("Wrote ", event_descs.size(), " profiler events to ", chrome_trace_file);
+    }
+
+    return stats;
+}
+
+Profiler::ThreadEvents* Profiler::getThreadEvents()
+{
+    // Each thread allocates and registers its ring buffer the first time it records an event. Both the thread and
+    // s_thread_events_ hold a reference, so getStats(...) can read a thread's remaining events after it exits.
+    thread_local std::shared_ptr<ThreadEvents> thread_events = nullptr;
+
+    if (!thread_events) {
+        std::lock_guard<std::mutex> lock(s_mutex_);
+        thread_events = std::make_shared<ThreadEvents>();
+        thread_events->thread_index_ = s_next_thread_index_++;
+        thread_events->num_events_ = s_num_events_per_thread_;
+        thread_events->events_ = std::make_unique<Event[]>(s_num_events_per_thread_);
+        s_thread_events_.push_back(thread_events);
+    }
+
+    return thread_events.get();
+}
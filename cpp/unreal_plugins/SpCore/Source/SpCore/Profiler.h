@@ -0,0 +1,124 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#pragma once
+
+#include <stdint.h> // uint64_t
+
+#include <atomic>
+#include <map>
+#include <memory> // std::shared_ptr, std::unique_ptr
+#include <mutex>
+#include <string>
+#include <vector>
+
+// SP_PROFILE_SCOPE records the time between the point where it is declared and the end of the enclosing scope.
+// name must be a string literal, or some other string with static storage duration, because we only store a
+// pointer to it. These need to be macros rather than plain ProfilerScope objects, so each scope gets a unique
+// variable name, and so a scope can be declared without naming a variable.
+#define SP_PROFILE_SCOPE_CONCAT_IMPL(a, b) a##b
+#define SP_PROFILE_SCOPE_CONCAT(a, b) SP_PROFILE_SCOPE_CONCAT_IMPL(a, b)
+#define SP_PROFILE_SCOPE(name) ProfilerScope SP_PROFILE_SCOPE_CONCAT(sp_profile_scope_, __LINE__)(name)
+
+struct ProfilerScopeStats
+{
+    uint64_t count_ = 0;
+    double total_ms_ = 0.0;
+    double mean_ms_ = 0.0;
+    double p50_ms_ = 0.0;
+    double p90_ms_ = 0.0;
+    double p99_ms_ = 0.0;
+    double max_ms_ = 0.0;
+};
+
+//
+// Profiler collects timed scopes from any thread with very low overhead. Each thread writes into its own
+// fixed-size ring buffer of events, so recording an event never takes a lock or allocates memory after the
+// first event on a thread. getStats(...) consumes all events that have been recorded since it was last called,
+// and aggregates them per scope. If a thread records more events than fit in its ring buffer between two calls
+// to getStats(...), then the oldest events are dropped. Profiling is disabled by default, in which case
+// SP_PROFILE_SCOPE does nothing except check a flag, see the SP_CORE.PROFILER config parameters. All functions
+// are thread-safe.
+//
+
+class SPCORE_API Profiler
+{
+public:
+    Profiler() = delete;
+    ~Profiler() = delete;
+
+    static void initialize();
+    static void terminate();
+
+    static bool isEnabled() { return s_enabled_.load(std::memory_order_relaxed); }
+    static void setEnabled(bool enabled);
+
+    // monotonic time in nanoseconds, only meaningful relative to other values returned by this function
+    static uint64_t getTimeNanoseconds();
+
+    // records an event on the calling thread, typically called by ProfilerScope, but can also be called directly
+    // for intervals that begin and end in different functions
+    static void record(const char* name, uint64_t begin_time_nanoseconds, uint64_t end_time_nanoseconds);
+
+    // Aggregates and consumes all events that have been recorded since the previous call. If chrome_trace_file
+    // is not empty, the events are also written to chrome_trace_file in the Chrome trace event format, which
+    // can be viewed in chrome://tracing or https://ui.perfetto.dev. Throws std::runtime_error if chrome_trace_file
+    // can't be opened, in which case no events are consumed.
+    static std::map<std::string, ProfilerScopeStats> getStats(const std::string& chrome_trace_file = "");
+
+private:
+    // we store each field as a relaxed atomic, because getStats(...) might read an event while its owning thread
+    // is overwriting it, in which case getStats(...) detects that the event has been overwritten and discards it
+    struct Event
+    {
+        std::atomic<const char*> name_ = nullptr;
+        std::atomic<uint64_t> begin_time_nanoseconds_ = 0;
+        std::atomic<uint64_t> end_time_nanoseconds_ = 0;
+    };
+
+    struct ThreadEvents
+    {
+        uint64_t thread_index_ = 0;
+        uint64_t num_events_ = 0;
+        std::unique_ptr<Event[]> events_;
+        std::atomic<uint64_t> write_position_ = 0;     // only written by the owning thread, incremented before writing an event
+        std::atomic<uint64_t> committed_position_ = 0; // only written by the owning thread, incremented after writing an event
+        uint64_t read_position_ = 0;                   // only accessed by getStats(...) while holding s_mutex_
+    };
+
+    static ThreadEvents* getThreadEvents();
+
+    inline static std::atomic<bool> s_enabled_ = false;
+    inline static std::mutex s_mutex_;
+    inline static std::vector<std::shared_ptr<ThreadEvents>> s_thread_events_; // one entry per thread that has recorded an event
+    inline static uint64_t s_num_events_per_thread_ = 65536;
+    inline static uint64_t s_next_thread_index_ = 0;
+};
+
+class ProfilerScope
+{
+public:
+    ProfilerScope() = delete;
+    ProfilerScope(const char* name)
+    {
+        if (Profiler::isEnabled()) {
+            name_ = name;
+            begin_time_nanoseconds_ = Profiler::getTimeNanoseconds();
+        }
+    }
+
+    ~ProfilerScope()
+    {
+        if (name_) {
+            Profiler::record(name_, begin_time_nanoseconds_, Profiler::getTimeNanoseconds());
+        }
+    }
+
+    ProfilerScope(const ProfilerScope&) = delete;
+    ProfilerScope& operator=(const ProfilerScope&) = delete;
+
+private:
+    const char* name_ = nullptr;
+    uint64_t begin_time_nanoseconds_ = 0;
+};
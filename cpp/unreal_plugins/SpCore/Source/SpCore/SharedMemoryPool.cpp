@@ -0,0 +1,136 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#include "SpCore/SharedMemoryPool.h"
+
+#include <stdint.h> // uint8_t, uint64_t
+
+#include <bit>     // std::bit_ceil
+#include <limits>  // std::numeric_limits
+#include <map>
+#include <memory>  // std::make_unique, std::unique_ptr
+#include <mutex>   // std::lock_guard
+#include <utility> // std::move
+#include <vector>
+
+#include "SpCore/Assert.h"
+#include "SpCore/Boost.h"
+#include "SpCore/Config.h"
+#include "SpCore/Log.h"
+#include "SpCore/SharedMemoryRegion.h"
+
+#if BOOST_OS_MACOS || BOOST_OS_LINUX
+    #include <sys/mman.h> // madvise, mlock
+#endif
+
+// the smallest size class is a single page on all of our supported platforms
+static constexpr uint64_t k_min_size_class_num_bytes = 4096;
+
+void SharedMemoryPool::initialize()
+{
+    std::lock_guard<std::mutex> lock(s_mutex_);
+
+    SP_ASSERT(s_free_regions_.empty());
+
+    s_prefault_ = Config::isInitialized() && Config::get<bool>("SP_CORE.SHARED_MEMORY_POOL.PREFAULT");
+    s_lock_ = Config::isInitialized() && Config::get<bool>("SP_CORE.SHARED_MEMORY_POOL.LOCK");
+    s_use_huge_pages_ = Config::isInitialized() && Config::get<bool>("SP_CORE.SHARED_MEMORY_POOL.USE_HUGE_PAGES");
+}
+
+void SharedMemoryPool::terminate()
+{
+    std::lock_guard<std::mutex> lock(s_mutex_);
+
+    // destroy all free regions, any regions that are still acquired are destroyed when they are released
+    s_free_regions_.clear();
+}
+
+std::unique_ptr<SharedMemoryRegion> SharedMemoryPool::acquire(uint64_t num_bytes)
+{
+    SP_ASSERT(num_bytes > 0);
+
+    uint64_t size_class_num_bytes = getSizeClassNumBytes(num_bytes);
+    std::unique_ptr<SharedMemoryRegion> shared_memory_region = nullptr;
+
+    s_mutex_.lock();
+    {
+        auto free_regions_itr = s_free_regions_.find(size_class_num_bytes);
+        if (free_regions_itr != s_free_regions_.end() && !free_regions_itr->second.empty()) {
+            shared_memory_region = std::move(free_regions_itr->second.back());
+            free_regions_itr->second.pop_back();
+        }
+    }
+    s_mutex_.unlock();
+
+    // create the region outside of our lock, because creating a region can be expensive
+    if (!shared_memory_region) {
+        shared_memory_region = createRegion(size_class_num_bytes);
+    }
+
+    SP_ASSERT(shared_memory_region);
+    return shared_memory_region;
+}
+
+void SharedMemoryPool::release(std::unique_ptr<SharedMemoryRegion>&& shared_memory_region)
+{
+    SP_ASSERT(shared_memory_region);
+
+    uint64_t size_class_num_bytes = shared_memory_region->getView().num_bytes_;
+    SP_ASSERT(size_class_num_bytes == getSizeClassNumBytes(size_class_num_bytes));
+
+    std::lock_guard<std::mutex> lock(s_mutex_);
+    s_free_regions_[size_class_num_bytes].push_back(std::move(shared_memory_region));
+}
+
+uint64_t SharedMemoryPool::getSizeClassNumBytes(uint64_t num_bytes)
+{
+    if (num_bytes <= k_min_size_class_num_bytes) {
+        return k_min_size_class_num_bytes;
+    } else {
+        return std::bit_ceil(num_bytes);
+    }
+}
+
+std::unique_ptr<SharedMemoryRegion> SharedMemoryPool::createRegion(uint64_t num_bytes)
+{
+    // SharedMemoryRegion expects an int
+    SP_ASSERT(num_bytes <= std::numeric_limits<int>::max());
+
+    auto shared_memory_region = std::make_unique<SharedMemoryRegion>(static_cast<int>(num_bytes));
+    SP_ASSERT(shared_memory_region);
+
+    SharedMemoryView view = shared_memory_region->getView();
+    SP_ASSERT(view.data_);
+
+    // Request transparent huge pages before the region is faulted in. For POSIX shared memory objects, this
+    // only has an effect if /sys/kernel/mm/transparent_hugepage/shmem_enabled is set to "advise" or "always".
+    if (s_use_huge_pages_) {
+        #if BOOST_OS_LINUX
+            if (madvise(view.data_, view.num_bytes_, MADV_HUGEPAGE) != 0) {
+                SP_LOG("Couldn't enable huge pages for shared memory region: ", view.id_);
+            }
+        #endif
+    }
+
+    // Touch each page, so the client and the engine don't pay the cost of faulting in the region when they
+    // first access it. SharedMemoryRegion zero-initializes its memory, so writing zeros doesn't change the
+    // contents of the region.
+    if (s_prefault_) {
+        uint64_t page_num_bytes = boost::interprocess::mapped_region::get_page_size();
+        uint8_t* data = static_cast<uint8_t*>(view.data_);
+        for (uint64_t i = 0; i < view.num_bytes_; i += page_num_bytes) {
+            data[i] = 0;
+        }
+    }
+
+    if (s_lock_) {
+        #if BOOST_OS_MACOS || BOOST_OS_LINUX
+            if (mlock(view.data_, view.num_bytes_) != 0) {
+                SP_LOG("Couldn't lock shared memory region into physical memory: ", view.id_);
+            }
+        #endif
+    }
+
+    return shared_memory_region;
+}
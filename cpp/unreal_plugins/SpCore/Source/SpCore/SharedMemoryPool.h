@@ -0,0 +1,50 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#pragma once
+
+#include <stdint.h> // uint64_t
+
+#include <map>
+#include <memory> // std::unique_ptr
+#include <mutex>
+#include <vector>
+
+#include "SpCore/SharedMemoryRegion.h"
+
+//
+// SharedMemoryPool hands out SharedMemoryRegion objects whose sizes are rounded up to a power-of-two size
+// class. When a region is released, it is kept in the pool instead of being destroyed, so it can be reused
+// by a subsequent call to acquire(...) with the same size class, e.g., when a sensor is re-created after a
+// level transition. Creating a new region requires several system calls and page faults, so reusing regions
+// is significantly cheaper. Newly created regions can optionally be pre-faulted, locked into physical memory,
+// and backed by huge pages (on Linux only), depending on the SP_CORE.SHARED_MEMORY_POOL config parameters.
+//
+// Since regions are reused, the contents of a region returned by acquire(...) are undefined, and the ID of a
+// region should not be used to identify the system that acquired it. All functions are thread-safe.
+//
+
+class SPCORE_API SharedMemoryPool
+{
+public:
+    SharedMemoryPool() = delete;
+    ~SharedMemoryPool() = delete;
+
+    static void initialize();
+    static void terminate();
+
+    static std::unique_ptr<SharedMemoryRegion> acquire(uint64_t num_bytes);
+    static void release(std::unique_ptr<SharedMemoryRegion>&& shared_memory_region);
+
+    static uint64_t getSizeClassNumBytes(uint64_t num_bytes);
+
+private:
+    static std::unique_ptr<SharedMemoryRegion> createRegion(uint64_t num_bytes);
+
+    inline static std::mutex s_mutex_;
+    inline static std::map<uint64_t, std::vector<std::unique_ptr<SharedMemoryRegion>>> s_free_regions_; // size class -> free regions
+    inline static bool s_prefault_ = false;
+    inline static bool s_lock_ = false;
+    inline static bool s_use_huge_pages_ = false;
+};
@@ -10,6 +10,7 @@
 
 #include "SpCore/Assert.h"
 #include "SpCore/Boost.h"
+#include "SpCore/Config.h"
 
 // TODO: remove platform-specific include
 #if BOOST_COMP_MSVC
@@ -67,11 +68,26 @@ uint64_t SharedMemoryRegion::getUniqueId()
 
 std::string SharedMemoryRegion::getUniqueIdString(uint64_t id)
 {
+    // A non-empty prefix is needed to run multiple Unreal instances on the same machine, because otherwise
+    // each instance would generate the same sequence of names.
+    std::string prefix = Config::isInitialized() ? Config::get<std::string>("SP_CORE.SHARED_MEMORY_NAME_PREFIX") : "";
+
     // TODO: remove platform-specific logic
     #if BOOST_COMP_MSVC
-        return std::format("__SP_SMEM_{:#018x}__", id); // don't use leading slash on Windows
+        if (prefix == "") {
+            return std::format("__SP_SMEM_{:#018x}__", id); // don't use leading slash on Windows
+        } else {
+            return std::format("__SP_SMEM_{}_{:#x}__", prefix, id);
+        }
     #elif BOOST_COMP_CLANG
-        return (boost::format("/__SP_SMEM_0x%016x__")%id).str(); // use leading slash on macOS and Linux, must be 31 chars or less
+        std::string id_string;
+        if (prefix == "") {
+            id_string = (boost::format("/__SP_SMEM_0x%016x__")%id).str(); // use leading slash on macOS and Linux, must be 31 chars or less
+        } else {
+            id_string = (boost::format("/__SP_SMEM_%s_0x%x__")%prefix%id).str(); // don't pad id so there is room for the prefix
+        }
+        SP_ASSERT(id_string.size() <= 31);
+        return id_string;
     #else
         #error
     #endif
@@ -8,8 +8,11 @@
 
 #include <Modules/ModuleManager.h> // IMPLEMENT_GAME_MODULE, IMPLEMENT_MODULE
 
+#include "SpCore/ActorIndex.h"
 #include "SpCore/Config.h"
 #include "SpCore/Log.h"
+#include "SpCore/Profiler.h"
+#include "SpCore/SharedMemoryPool.h"
 #include "SpCore/UnrealClassRegistrar.h"
 
 void SpCore::StartupModule()
@@ -17,6 +20,9 @@ void SpCore::StartupModule()
     SP_LOG_CURRENT_FUNCTION();
 
     Config::requestInitialize();
+    SharedMemoryPool::initialize();
+    Profiler::initialize();
+    ActorIndex::initialize();
     UnrealClassRegistrar::initialize();
 
     // Wait for keyboard input, which is useful when attempting to attach a debugger to the running executable.
@@ -31,6 +37,9 @@ void SpCore::ShutdownModule()
     SP_LOG_CURRENT_FUNCTION();
 
     UnrealClassRegistrar::terminate();
+    ActorIndex::terminate();
+    Profiler::terminate();
+    SharedMemoryPool::terminate();
     Config::terminate();
 }
 
@@ -65,6 +65,12 @@ public:
     template <> SpFuncArrayDataType getDataType<float>()    { return SpFuncArrayDataType::Float32; }
     template <> SpFuncArrayDataType getDataType<double>()   { return SpFuncArrayDataType::Float64; }
 
+    // data types received from clients must be validated before they are passed to getSizeOf(...)
+    static bool isValid(int8_t data_type)
+    {
+        return data_type >= static_cast<int8_t>(SpFuncArrayDataType::UInt8) && data_type <= static_cast<int8_t>(SpFuncArrayDataType::Float64);
+    }
+
     static int getSizeOf(SpFuncArrayDataType data_type)
     {
         switch (data_type) {
@@ -5,6 +5,7 @@
 #include "SpCore/Unreal.h"
 
 #include <stdint.h> // uint8_t
+#include <string.h> // memcpy, memset
 
 #include <map>
 #include <ranges>  // std::views::transform
@@ -31,6 +32,7 @@
 #include <UObject/UnrealType.h>      // FArrayProperty, FBoolProperty, FByteProperty, FDoubleProperty, FFloatProperty, FIntProperty, FMapProperty, FProperty,
                                      // FScriptArrayHelper, FScriptMapHelper, FScriptSetHelper, FSetProperty, FStrProperty, FStructProperty, TFieldIterator
 
+#include "SpCore/ActorIndex.h"
 #include "SpCore/Assert.h"
 #include "SpCore/Log.h"
 #include "SpCore/SpSpecialStructActor.h"
@@ -92,108 +94,8 @@ Unreal::PropertyDesc Unreal::findPropertyByName(UObject* uobject, const std::str
 
 Unreal::PropertyDesc Unreal::findPropertyByName(void* value_ptr, const UStruct* ustruct, const std::string& name)
 {
-    SP_ASSERT(value_ptr);
-    SP_ASSERT(ustruct);
-
-    std::vector<std::string> property_names = Std::tokenize(name, ".");
-
-    PropertyDesc property_desc;
-    property_desc.value_ptr_ = value_ptr;
-
-    for (int i = 0; i < property_names.size(); i++) {
-
-        std::string& property_name = property_names.at(i);
-        std::vector<std::string> property_name_tokens = Std::tokenize(property_name, "[]");
-        SP_ASSERT(property_name_tokens.size() >= 1 && property_name_tokens.size() <= 2);
-
-        property_desc.property_ = ustruct->FindPropertyByName(Unreal::toFName(property_name_tokens.at(0)));
-        SP_ASSERT(property_desc.property_);
-        property_desc.value_ptr_ = property_desc.property_->ContainerPtrToValuePtr<void>(property_desc.value_ptr_);
-        SP_ASSERT(property_desc.value_ptr_);
-
-        // If the current property is an array or map property, and the name includes the index operator,
-        // then update the current property to refer to the array or map element based on the index. For map
-        // properties, we expect an index string that is enclosed enclosed in "" quotes if the key type is a
-        // string, and not enclosed in quotes otherwise. The index string must exactly match whatever is
-        // returned by getPropertyValueAsString(...) for the key.
-
-        if (property_desc.property_->IsA(FArrayProperty::StaticClass()) && property_name_tokens.size() == 2) {
-            int index = std::atoi(property_name_tokens.at(1).c_str());
-            FArrayProperty* array_property = static_cast<FArrayProperty*>(property_desc.property_);
-            FScriptArrayHelper array_helper(array_property, property_desc.value_ptr_);
-            SP_ASSERT(index < array_helper.Num());
-
-            property_desc.property_ = array_property->Inner;
-            SP_ASSERT(property_desc.property_);
-            property_desc.value_ptr_ = array_property->GetValueAddressAtIndex_Direct(property_desc.property_, property_desc.value_ptr_, index);
-            SP_ASSERT(property_desc.value_ptr_);
-
-        } else if (property_desc.property_->IsA(FMapProperty::StaticClass()) && property_name_tokens.size() == 2) {
-
-            FMapProperty* map_property = static_cast<FMapProperty*>(property_desc.property_);
-            FScriptMapHelper map_helper(map_property, property_desc.value_ptr_);
-
-            property_desc.property_ = map_property->ValueProp;
-            SP_ASSERT(property_desc.property_);
-
-            bool found = false;
-            for (int j = 0; j < map_helper.Num(); j++) {
-                PropertyDesc inner_key_property_desc;
-                inner_key_property_desc.property_ = map_property->KeyProp;
-                inner_key_property_desc.value_ptr_ = map_property->GetValueAddressAtIndex_Direct(map_property->KeyProp, property_desc.value_ptr_, j);
-                SP_ASSERT(inner_key_property_desc.value_ptr_);
-                std::string inner_key_string = getPropertyValueAsString(inner_key_property_desc);
-
-                // If the key type is a string, then we expect the index string to be enclosed in quotes,
-                // otherwise we expect it not to be enclosed in quotes.
-                if (inner_key_property_desc.property_->IsA(FBoolProperty::StaticClass()) ||
-                    inner_key_property_desc.property_->IsA(FIntProperty::StaticClass())  ||
-                    inner_key_property_desc.property_->IsA(FByteProperty::StaticClass())) {
-                    if (property_name_tokens.at(1) == inner_key_string) {
-                        found = true;
-                    }
-                } else if (inner_key_property_desc.property_->IsA(FStrProperty::StaticClass())) {
-                    if (property_name_tokens.at(1) == "\"" + inner_key_string + "\"") {
-                        found = true;
-                    }
-                } else {
-                    SP_LOG(property_name, " has an unsupported key type: ", toStdString(map_property->KeyProp->GetClass()->GetName()));
-                    SP_ASSERT(false);
-                }
-                if (found) {
-                    property_desc.value_ptr_ = map_property->GetValueAddressAtIndex_Direct(map_property->ValueProp, property_desc.value_ptr_, j);
-                    SP_ASSERT(property_desc.value_ptr_);
-                    break;
-                }
-            }
-            SP_ASSERT(found);
-        }
-
-        // If the current property name is not the last name in our sequence, then by definition the current
-        // property refers to something with named properties (i.e., a struct or an object). In this case,
-        // we need to update our ustruct pointer, and potentially our value_ptr if our current property
-        // refers to an object. In contrast, if the current property name is the last name in our sequence,
-        // then there is nothing more to do, because we have already filled in our PropertyDesc object.
-
-        if (i < property_names.size() - 1) {
-            if (property_desc.property_->IsA(FObjectProperty::StaticClass())) {
-                FObjectProperty* object_property = static_cast<FObjectProperty*>(property_desc.property_);
-                UObject* uobject = object_property->GetObjectPropertyValue(property_desc.value_ptr_);
-                SP_ASSERT(uobject);
-                property_desc.value_ptr_ = uobject;
-                ustruct = uobject->GetClass();
-
-            } else if (property_desc.property_->IsA(FStructProperty::StaticClass())) {
-                FStructProperty* struct_property = static_cast<FStructProperty*>(property_desc.property_);
-                ustruct = struct_property->Struct;
-
-            } else {
-                SP_LOG(property_name, " is an unsupported type: ", toStdString(property_desc.property_->GetClass()->GetName()));
-                SP_ASSERT(false);
-            }
-        }
-    }
-
+    PropertyDesc property_desc = findPropertyByChain(value_ptr, getPropertyChain(value_ptr, ustruct, name));
+    SP_ASSERT(property_desc.property_);
     return property_desc;
 }
 
@@ -369,6 +271,176 @@ void Unreal::setPropertyValueFromString(const Unreal::PropertyDesc& property_des
     }
 }
 
+//
+// Find property by chain
+//
+
+Unreal::PropertyChain Unreal::getPropertyChain(UObject* uobject, const std::string& name)
+{
+    SP_ASSERT(uobject);
+    return getPropertyChain(uobject, uobject->GetClass(), name);
+}
+
+Unreal::PropertyChain Unreal::getPropertyChain(void* value_ptr, const UStruct* ustruct, const std::string& name)
+{
+    SP_ASSERT(value_ptr);
+    SP_ASSERT(ustruct);
+
+    std::vector<std::string> property_names = Std::tokenize(name, ".");
+
+    PropertyChain property_chain;
+
+    for (int i = 0; i < property_names.size(); i++) {
+
+        std::string& property_name = property_names.at(i);
+        std::vector<std::string> property_name_tokens = Std::tokenize(property_name, "[]");
+        SP_ASSERT(property_name_tokens.size() >= 1 && property_name_tokens.size() <= 2);
+
+        PropertyChainLink property_chain_link;
+        property_chain_link.property_ = ustruct->FindPropertyByName(Unreal::toFName(property_name_tokens.at(0)));
+        SP_ASSERT(property_chain_link.property_);
+        if (property_name_tokens.size() == 2) {
+            property_chain_link.index_string_ = property_name_tokens.at(1);
+            if (property_chain_link.property_->IsA(FArrayProperty::StaticClass())) {
+                property_chain_link.array_index_ = std::atoi(property_chain_link.index_string_.c_str());
+            }
+        }
+        property_chain.links_.push_back(std::move(property_chain_link));
+
+        // If the current property name is not the last name in our sequence, then by definition the current
+        // property refers to something with named properties (i.e., a struct or an object), and we need to
+        // update our ustruct pointer. If the current property refers to an object, then we resolve the chain
+        // so far to find the object, because the object's class might be more derived than the property's
+        // declared class.
+
+        if (i < property_names.size() - 1) {
+            PropertyDesc property_desc = findPropertyByChain(value_ptr, property_chain);
+            SP_ASSERT(property_desc.property_);
+
+            if (property_desc.property_->IsA(FObjectProperty::StaticClass())) {
+                FObjectProperty* object_property = static_cast<FObjectProperty*>(property_desc.property_);
+                UObject* uobject = object_property->GetObjectPropertyValue(property_desc.value_ptr_);
+                SP_ASSERT(uobject);
+                ustruct = uobject->GetClass();
+
+            } else if (property_desc.property_->IsA(FStructProperty::StaticClass())) {
+                FStructProperty* struct_property = static_cast<FStructProperty*>(property_desc.property_);
+                ustruct = struct_property->Struct;
+
+            } else {
+                SP_LOG(property_name, " is an unsupported type: ", toStdString(property_desc.property_->GetClass()->GetName()));
+                SP_ASSERT(false);
+            }
+        }
+    }
+
+    return property_chain;
+}
+
+Unreal::PropertyDesc Unreal::findPropertyByChain(void* value_ptr, const PropertyChain& property_chain)
+{
+    SP_ASSERT(value_ptr);
+    SP_ASSERT(!property_chain.links_.empty());
+
+    PropertyDesc property_desc;
+    property_desc.value_ptr_ = value_ptr;
+
+    for (int i = 0; i < property_chain.links_.size(); i++) {
+
+        const PropertyChainLink& property_chain_link = property_chain.links_.at(i);
+        SP_ASSERT(property_chain_link.property_);
+
+        // If the current link is not the first link in our sequence, then by definition the previous link
+        // refers to something with named properties (i.e., a struct or an object). If the previous link
+        // refers to an object, then we need to update our value_ptr, and we need to check that the object
+        // has the current property, because a different object might have been assigned to the previous
+        // property since the chain was created. If the previous link refers to a struct, then there is
+        // nothing to check, because the type of a struct property can't change.
+
+        if (i > 0) {
+            if (property_desc.property_->IsA(FObjectProperty::StaticClass())) {
+                FObjectProperty* object_property = static_cast<FObjectProperty*>(property_desc.property_);
+                UObject* uobject = object_property->GetObjectPropertyValue(property_desc.value_ptr_);
+                SP_ASSERT(uobject);
+                if (!uobject->GetClass()->IsChildOf(property_chain_link.property_->GetOwnerStruct())) {
+                    return PropertyDesc();
+                }
+                property_desc.value_ptr_ = uobject;
+
+            } else if (!property_desc.property_->IsA(FStructProperty::StaticClass())) {
+                SP_LOG(toStdString(property_desc.property_->GetName()), " is an unsupported type: ", toStdString(property_desc.property_->GetClass()->GetName()));
+                SP_ASSERT(false);
+            }
+        }
+
+        property_desc.property_ = property_chain_link.property_;
+        property_desc.value_ptr_ = property_desc.property_->ContainerPtrToValuePtr<void>(property_desc.value_ptr_);
+        SP_ASSERT(property_desc.value_ptr_);
+
+        if (!property_chain_link.index_string_.empty()) {
+            applyIndexOperator(property_desc, property_chain_link);
+        }
+    }
+
+    return property_desc;
+}
+
+//
+// Get and set many property values at once
+//
+
+Unreal::PropertyValues Unreal::getPropertyValues(const std::vector<PropertyDesc>& property_descs)
+{
+    PropertyValues property_values;
+
+    for (auto& property_desc : property_descs) {
+        SP_ASSERT(property_desc.property_);
+        SP_ASSERT(property_desc.value_ptr_);
+
+        property_values.cpp_types_.push_back(toStdString(property_desc.property_->GetCPPType()));
+
+        if (isPodProperty(property_desc.property_)) {
+            int num_bytes = property_desc.property_->GetSize();
+            const uint8_t* value_ptr = static_cast<const uint8_t*>(property_desc.value_ptr_);
+            property_values.packed_values_.insert(property_values.packed_values_.end(), value_ptr, value_ptr + num_bytes);
+            property_values.num_bytes_.push_back(num_bytes);
+            property_values.value_strings_.push_back("");
+        } else {
+            property_values.num_bytes_.push_back(0);
+            property_values.value_strings_.push_back(getPropertyValueAsString(property_desc));
+        }
+    }
+
+    return property_values;
+}
+
+void Unreal::setPropertyValues(
+    const std::vector<PropertyDesc>& property_descs, const std::vector<uint8_t>& packed_values, const std::vector<int>& num_bytes, const std::vector<std::string>& value_strings)
+{
+    SP_ASSERT(num_bytes.size() == property_descs.size());
+    SP_ASSERT(value_strings.size() == property_descs.size());
+
+    int offset = 0;
+    for (int i = 0; i < property_descs.size(); i++) {
+        const PropertyDesc& property_desc = property_descs.at(i);
+        SP_ASSERT(property_desc.property_);
+        SP_ASSERT(property_desc.value_ptr_);
+
+        if (num_bytes.at(i) > 0) {
+            SP_ASSERT(isPodProperty(property_desc.property_));
+            SP_ASSERT(num_bytes.at(i) == property_desc.property_->GetSize());
+            SP_ASSERT(offset + num_bytes.at(i) <= packed_values.size());
+            memcpy(property_desc.value_ptr_, packed_values.data() + offset, num_bytes.at(i));
+            offset += num_bytes.at(i);
+        } else {
+            setPropertyValueFromString(property_desc, value_strings.at(i));
+        }
+    }
+
+    // Packed values must refer to the POD values in property_descs.
+    SP_ASSERT(offset == packed_values.size());
+}
+
 //
 // Find function by name, call function, world can't be const because we cast it to void*, uobject can't be
 // const because we call uobject->ProcessEvent(...) which is non-const, ufunction can't be const because we
@@ -452,6 +524,109 @@ std::map<std::string, std::string> Unreal::callFunction(UWorld* world, UObject*
     return return_values;
 }
 
+Unreal::PreparedFunction Unreal::prepareFunction(UObject* uobject, UFunction* ufunction, const std::string& world_context)
+{
+    SP_ASSERT(uobject);
+    SP_ASSERT(ufunction);
+
+    PreparedFunction prepared_function;
+    prepared_function.uobject_ = uobject;
+    prepared_function.ufunction_ = ufunction;
+    prepared_function.num_bytes_ = ufunction->ParmsSize;
+
+    for (TFieldIterator<FProperty> itr(ufunction); itr; ++itr) {
+        PreparedFunctionParam param;
+        param.property_ = *itr;
+        SP_ASSERT(param.property_);
+        SP_ASSERT(param.property_->HasAnyPropertyFlags(EPropertyFlags::CPF_Parm));
+
+        param.name_ = toStdString(param.property_->GetName());
+        param.cpp_type_ = toStdString(param.property_->GetCPPType());
+        param.offset_ = param.property_->GetOffset_ForUFunction();
+        param.num_bytes_ = param.property_->GetSize();
+        SP_ASSERT(param.offset_ >= 0);
+        SP_ASSERT(param.offset_ + param.num_bytes_ <= prepared_function.num_bytes_);
+
+        // Values that aren't POD (or that we don't copy directly, see isPodProperty(...)) are converted to and
+        // from strings.
+        param.is_pod_ = isPodProperty(param.property_);
+
+        // The world context arg must be an object pointer, because we set it directly in callPreparedFunction(...).
+        param.is_world_context_ = param.name_ == world_context;
+        SP_ASSERT(!param.is_world_context_ || param.property_->IsA(FObjectProperty::StaticClass()));
+
+        prepared_function.params_.push_back(std::move(param));
+    }
+
+    return prepared_function;
+}
+
+Unreal::PreparedFunctionReturnValues Unreal::callPreparedFunction(
+    UWorld* world, const PreparedFunction& prepared_function, const std::vector<uint8_t>& packed_args, const std::map<std::string, std::string>& arg_strings)
+{
+    SP_ASSERT(world);
+    SP_ASSERT(prepared_function.uobject_);
+    SP_ASSERT(prepared_function.ufunction_);
+
+    // Copy all args into our parameter buffer, and then zero out all non-POD values, so they are in a valid
+    // default state before we assign them from strings. If packed_args is empty, all args are zero.
+    std::vector<uint8_t> args_vector;
+    if (packed_args.empty()) {
+        args_vector.resize(prepared_function.num_bytes_, 0);
+    } else {
+        SP_ASSERT(packed_args.size() == prepared_function.num_bytes_);
+        args_vector = packed_args;
+    }
+
+    for (auto& param : prepared_function.params_) {
+        if (!param.is_pod_) {
+            memset(args_vector.data() + param.offset_, 0, param.num_bytes_);
+        }
+    }
+
+    int num_arg_strings_used = 0;
+    for (auto& param : prepared_function.params_) {
+        if (param.is_world_context_) {
+            SP_ASSERT(!Std::containsKey(arg_strings, param.name_));
+            FObjectProperty* object_property = static_cast<FObjectProperty*>(param.property_);
+            SP_ASSERT(world->IsA(object_property->PropertyClass));
+            object_property->SetObjectPropertyValue(args_vector.data() + param.offset_, world);
+
+        } else if (Std::containsKey(arg_strings, param.name_)) {
+            SP_ASSERT(!param.is_pod_);
+            PropertyDesc property_desc;
+            property_desc.property_ = param.property_;
+            property_desc.value_ptr_ = args_vector.data() + param.offset_;
+            setPropertyValueFromString(property_desc, arg_strings.at(param.name_));
+            num_arg_strings_used++;
+        }
+    }
+
+    // Input arg strings must refer to the function's non-POD args.
+    SP_ASSERT(num_arg_strings_used == arg_strings.size());
+
+    // Call function.
+    prepared_function.uobject_->ProcessEvent(prepared_function.ufunction_, args_vector.data());
+
+    // Convert non-POD values to strings, destroy them, and zero them out, so the packed return values only
+    // contain POD values. We return all values because they might have been modified by the function we called.
+    PreparedFunctionReturnValues return_values;
+    for (auto& param : prepared_function.params_) {
+        if (!param.is_pod_) {
+            PropertyDesc property_desc;
+            property_desc.property_ = param.property_;
+            property_desc.value_ptr_ = args_vector.data() + param.offset_;
+            Std::insert(return_values.return_value_strings_, param.name_, getPropertyValueAsString(property_desc));
+            param.property_->DestroyValue(property_desc.value_ptr_);
+            memset(property_desc.value_ptr_, 0, param.num_bytes_);
+        }
+    }
+
+    return_values.packed_return_values_ = std::move(args_vector);
+
+    return return_values;
+}
+
 //
 // Find actors unconditionally and return an std::vector or an std::map
 //
@@ -525,6 +700,7 @@ void Unreal::setStableName(const AActor* actor, const std::string& stable_name)
 {
     USpStableNameComponent* sp_stable_name_component = getComponentByType<USpStableNameComponent>(actor);
     sp_stable_name_component->StableName = toFString(stable_name);
+    ActorIndex::updateActor(const_cast<AActor*>(actor));
 }
 
 #if WITH_EDITOR // defined in an auto-generated header
@@ -534,6 +710,7 @@ void Unreal::setStableName(const AActor* actor, const std::string& stable_name)
         std::vector<USpStableNameComponent*> sp_stable_name_components = getComponentsByType<USpStableNameComponent>(actor, include_from_child_actors);
         if (sp_stable_name_components.size() == 1) {
             sp_stable_name_components.at(0)->requestUpdate();
+            ActorIndex::updateActor(const_cast<AActor*>(actor));
         }
     }
 #endif
@@ -608,6 +785,80 @@ FName Unreal::toFName(const std::string& str)
     return FName(str.c_str());
 }
 
+//
+// Helper functions for finding properties and copying property values
+//
+
+void Unreal::applyIndexOperator(PropertyDesc& property_desc, const PropertyChainLink& property_chain_link)
+{
+    // If the current property is an array or map property, and the name includes the index operator, then
+    // update the current property to refer to the array or map element based on the index. For map
+    // properties, we expect an index string that is enclosed enclosed in "" quotes if the key type is a
+    // string, and not enclosed in quotes otherwise. The index string must exactly match whatever is returned
+    // by getPropertyValueAsString(...) for the key.
+
+    if (property_desc.property_->IsA(FArrayProperty::StaticClass())) {
+        int index = property_chain_link.array_index_;
+        FArrayProperty* array_property = static_cast<FArrayProperty*>(property_desc.property_);
+        FScriptArrayHelper array_helper(array_property, property_desc.value_ptr_);
+        SP_ASSERT(index < array_helper.Num());
+
+        property_desc.property_ = array_property->Inner;
+        SP_ASSERT(property_desc.property_);
+        property_desc.value_ptr_ = array_property->GetValueAddressAtIndex_Direct(property_desc.property_, property_desc.value_ptr_, index);
+        SP_ASSERT(property_desc.value_ptr_);
+
+    } else if (property_desc.property_->IsA(FMapProperty::StaticClass())) {
+
+        FMapProperty* map_property = static_cast<FMapProperty*>(property_desc.property_);
+        FScriptMapHelper map_helper(map_property, property_desc.value_ptr_);
+
+        property_desc.property_ = map_property->ValueProp;
+        SP_ASSERT(property_desc.property_);
+
+        bool found = false;
+        for (int j = 0; j < map_helper.Num(); j++) {
+            PropertyDesc inner_key_property_desc;
+            inner_key_property_desc.property_ = map_property->KeyProp;
+            inner_key_property_desc.value_ptr_ = map_property->GetValueAddressAtIndex_Direct(map_property->KeyProp, property_desc.value_ptr_, j);
+            SP_ASSERT(inner_key_property_desc.value_ptr_);
+            std::string inner_key_string = getPropertyValueAsString(inner_key_property_desc);
+
+            // If the key type is a string, then we expect the index string to be enclosed in quotes,
+            // otherwise we expect it not to be enclosed in quotes.
+            if (inner_key_property_desc.property_->IsA(FBoolProperty::StaticClass()) ||
+                inner_key_property_desc.property_->IsA(FIntProperty::StaticClass())  ||
+                inner_key_property_desc.property_->IsA(FByteProperty::StaticClass())) {
+                if (property_chain_link.index_string_ == inner_key_string) {
+                    found = true;
+                }
+            } else if (inner_key_property_desc.property_->IsA(FStrProperty::StaticClass())) {
+                if (property_chain_link.index_string_ == "\"" + inner_key_string + "\"") {
+                    found = true;
+                }
+            } else {
+                SP_LOG(toStdString(map_property->GetName()), " has an unsupported key type: ", toStdString(map_property->KeyProp->GetClass()->GetName()));
+                SP_ASSERT(false);
+            }
+            if (found) {
+                property_desc.value_ptr_ = map_property->GetValueAddressAtIndex_Direct(map_property->ValueProp, property_desc.value_ptr_, j);
+                SP_ASSERT(property_desc.value_ptr_);
+                break;
+            }
+        }
+        SP_ASSERT(found);
+    }
+}
+
+bool Unreal::isPodProperty(const FProperty* property)
+{
+    SP_ASSERT(property);
+    if (property->IsA(FBoolProperty::StaticClass()) && !static_cast<const FBoolProperty*>(property)->IsNativeBool()) {
+        return false;
+    }
+    return property->HasAnyPropertyFlags(EPropertyFlags::CPF_IsPlainOldData) && !property->IsA(FObjectProperty::StaticClass());
+}
+
 //
 // Helper functions for formatting container properties as strings in the same style as Unreal
 //
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <stdint.h> // uint8_t
+
 #include <concepts>    // std::derived_from
 #include <map>
 #include <ranges>      // std::views::filter, std::views::transform
@@ -25,6 +27,7 @@
 #include <UObject/Object.h>          // UObject
 #include <UObject/UnrealType.h>      // FProperty
 
+#include "SpCore/ActorIndex.h"
 #include "SpCore/Assert.h"
 #include "SpCore/Std.h"
 
@@ -137,6 +140,52 @@ public:
     static std::string getPropertyValueAsString(const PropertyDesc& property_desc);
     static void setPropertyValueFromString(const PropertyDesc& property_desc, const std::string& string);
 
+    //
+    // Find property by chain. A PropertyChain caches the FProperty for each name in a dotted property name
+    // (e.g., "RootComponent.RelativeLocation.X"), so the name only needs to be tokenized and looked up once
+    // for a given UStruct. Array indices are parsed once, but map keys are looked up every time the chain is
+    // resolved, because the layout of a map depends on its contents. If a chain passes through an object
+    // property, then it is only valid for objects whose class is a child of the class that owns the next
+    // property in the chain, so findPropertyByChain(...) returns a PropertyDesc whose property_ is nullptr if
+    // the chain can't be resolved for a given value_ptr.
+    //
+
+    struct PropertyChainLink
+    {
+        FProperty* property_ = nullptr;
+        std::string index_string_; // empty if the name doesn't include the index operator
+        int array_index_ = -1;     // only valid if index_string_ is not empty and property_ is an FArrayProperty
+    };
+
+    struct PropertyChain
+    {
+        std::vector<PropertyChainLink> links_;
+    };
+
+    static PropertyChain getPropertyChain(UObject* uobject, const std::string& name);
+    static PropertyChain getPropertyChain(void* value_ptr, const UStruct* ustruct, const std::string& name);
+    static PropertyDesc findPropertyByChain(void* value_ptr, const PropertyChain& property_chain);
+
+    //
+    // Get and set many property values at once. POD values (e.g., bool, int32, float, double, FVector) are
+    // copied directly to and from a packed buffer, in the order that they appear in property_descs. Non-POD
+    // values are converted to and from strings in the same way as getPropertyValueAsString(...) and
+    // setPropertyValueFromString(...). When setting values, num_bytes must contain the size of each value in
+    // packed_values, or 0 if the value is specified as a string in value_strings instead.
+    //
+
+    struct PropertyValues
+    {
+        std::vector<uint8_t> packed_values_;     // POD values only
+        std::vector<int> num_bytes_;             // one per property, 0 for non-POD values
+        std::vector<std::string> cpp_types_;     // one per property
+        std::vector<std::string> value_strings_; // one per property, empty for POD values
+    };
+
+    static PropertyValues getPropertyValues(const std::vector<PropertyDesc>& property_descs);
+    static void setPropertyValues(
+        const std::vector<PropertyDesc>& property_descs, const std::vector<uint8_t>& packed_values, const std::vector<int>& num_bytes, const std::vector<std::string>& value_strings);
+
     //
     // Find function by name, call function, world can't be const because we cast it to void*, uobject can't
     // be const because we call uobject->ProcessEvent(...) which is non-const, ufunction can't be const
@@ -146,6 +195,44 @@ public:
     static UFunction* findFunctionByName(const UClass* uclass, const std::string& name, EIncludeSuperFlag::Type include_super_flag = EIncludeSuperFlag::IncludeSuper);
     static std::map<std::string, std::string> callFunction(UWorld* world, UObject* uobject, UFunction* ufunction, const std::map<std::string, std::string>& args = {}, const std::string& world_context = "WorldContextObject");
 
+    //
+    // Prepare function and call prepared function. A PreparedFunction caches the parameter layout of a
+    // UFunction, so the function can be called repeatedly without iterating over its properties. POD args
+    // are copied directly from a packed buffer that has the same layout as the UFunction's parameter buffer,
+    // and POD return values are copied directly into a packed buffer with the same layout. Only non-POD args
+    // and return values are converted to and from strings. The world context arg is set directly from the
+    // world pointer passed to callPreparedFunction(...).
+    //
+
+    struct PreparedFunctionParam
+    {
+        FProperty* property_ = nullptr;
+        std::string name_;
+        std::string cpp_type_;
+        int offset_ = -1;
+        int num_bytes_ = -1;
+        bool is_pod_ = false;
+        bool is_world_context_ = false;
+    };
+
+    struct PreparedFunction
+    {
+        UObject* uobject_ = nullptr;
+        UFunction* ufunction_ = nullptr;
+        int num_bytes_ = -1;
+        std::vector<PreparedFunctionParam> params_;
+    };
+
+    struct PreparedFunctionReturnValues
+    {
+        std::vector<uint8_t> packed_return_values_;               // same layout as the parameter buffer, non-POD values are zeroed
+        std::map<std::string, std::string> return_value_strings_; // non-POD values only
+    };
+
+    static PreparedFunction prepareFunction(UObject* uobject, UFunction* ufunction, const std::string& world_context = "WorldContextObject");
+    static PreparedFunctionReturnValues callPreparedFunction(
+        UWorld* world, const PreparedFunction& prepared_function, const std::vector<uint8_t>& packed_args, const std::map<std::string, std::string>& arg_strings = {});
+
     //
     // Find special struct by name. For this function to behave as expected, ASpSpecialStructActor must have
     // a UPROPERTY defined on it named TypeName_ of type TypeName.
@@ -283,12 +370,14 @@ public:
     static std::vector<TReturnAsActor*> findActorsByName(const UWorld* world, const std::vector<std::string>& names, bool return_null_if_not_found = true)
     {
         std::vector<TReturnAsActor*> actors;
-        std::map<std::string, TReturnAsActor*> actor_map = toMap(findActorsByType<TActor, TReturnAsActor>(world));
-        if (return_null_if_not_found) {
-            actors = Std::at(actor_map, names, nullptr);
-        } else {
-            auto names_found_in_actor_map = Std::toVector<std::string>(names | std::views::filter([&actor_map](const auto& name) { return Std::containsKey(actor_map, name); }));
-            actors = Std::at(actor_map, names_found_in_actor_map);
+        for (auto& name : names) {
+            std::vector<TReturnAsActor*> actors_with_name = filterActorsByType<TActor, TReturnAsActor>(ActorIndex::findActorsByName(world, name));
+            SP_ASSERT(actors_with_name.size() <= 1);
+            if (!actors_with_name.empty()) {
+                actors.push_back(actors_with_name.at(0));
+            } else if (return_null_if_not_found) {
+                actors.push_back(nullptr);
+            }
         }
         return actors;
     }
@@ -304,17 +393,21 @@ public:
         std::derived_from<TActor, TReturnAsActor>
     static std::vector<TReturnAsActor*> findActorsByTagAny(const UWorld* world, const std::vector<std::string>& tags)
     {
-        return Std::toVector<TReturnAsActor*>(
-            findActorsByType<TActor, TReturnAsActor>(world) |
-            std::views::filter([&tags](auto actor) { return Std::any(Std::contains(getTags(actor), tags)); }));
+        return filterActorsByType<TActor, TReturnAsActor>(ActorIndex::findActorsByTagAny(world, tags));
     }
 
     template <CActor TActor = AActor, CActor TReturnAsActor = TActor> requires
         std::derived_from<TActor, TReturnAsActor>
     static std::vector<TReturnAsActor*> findActorsByTagAll(const UWorld* world, const std::vector<std::string>& tags)
     {
+        // every actor has all of the tags in an empty list
+        if (tags.empty()) {
+            return findActorsByType<TActor, TReturnAsActor>(world);
+        }
+
+        // only actors that have the first tag can have all of the tags
         return Std::toVector<TReturnAsActor*>(
-            findActorsByType<TActor, TReturnAsActor>(world) |
+            filterActorsByType<TActor, TReturnAsActor>(ActorIndex::findActorsByTag(world, tags.at(0))) |
             std::views::filter([&tags](auto actor) { return Std::all(Std::contains(getTags(actor), tags)); }));
     }
 
@@ -961,6 +1054,16 @@ private:
             std::views::transform([](auto object) { return std::make_pair(getStableName(object), object); }));
     }
 
+    template <CActor TActor, CActor TReturnAsActor> requires
+        std::derived_from<TActor, TReturnAsActor>
+    static std::vector<TReturnAsActor*> filterActorsByType(const std::vector<AActor*>& actors)
+    {
+        return Std::toVector<TReturnAsActor*>(
+            actors |
+            std::views::filter([](auto actor) { return actor->IsA(TActor::StaticClass()); }) |
+            std::views::transform([](auto actor) { return static_cast<TReturnAsActor*>(actor); }));
+    }
+
     template <typename TValue>
     static const TValue& getItem(const std::vector<TValue>& vector)
     {
@@ -968,6 +1071,16 @@ private:
         return vector.at(0);
     }
 
+    //
+    // Helper functions for finding properties and copying property values
+    //
+
+    static void applyIndexOperator(PropertyDesc& property_desc, const PropertyChainLink& property_chain_link);
+
+    // We don't copy object pointers directly, even though they are POD, because the client might send an
+    // arbitrary value. We don't copy bitfield bools directly, because they share a byte with other values.
+    static bool isPodProperty(const FProperty* property);
+
     //
     // Helper functions for formatting container properties as strings in the same style as Unreal
     //
@@ -0,0 +1,342 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+//
+// Standalone micro-benchmark for the custom msgpack adaptors in SpServices/Msgpack.h. Msgpack doesn't depend on
+// Unreal, so this file is not part of any Unreal module, and is built directly with a C++20 compiler, e.g., on
+// macOS and Linux:
+//
+//     c++ -std=c++20 -O2 -DSPCORE_API= -I../Source -I../../SpCore/Source -I../../../../third_party/rpclib/include -I/path/to/boost/include MsgpackBenchmark.cpp ../Source/SpServices/Msgpack.cpp ../../SpCore/Source/SpCore/Assert.cpp -o MsgpackBenchmark
+//
+// On Windows, SpCore/Windows.h includes a header file from Unreal, so this benchmark needs to be built with the
+// Unreal include paths.
+//
+// We compare two sets of adaptors for a bundle of packed arrays that mirrors SpFuncDataBundle and
+// SpFuncPackedArray. The first set of adaptors decodes via Msgpack::toMap(...) and encodes via an intermediate
+// std::map, which is how most custom types in SpServices are sent and received. The second set of adaptors uses
+// MsgpackStructDesc. For each bundle size, we check that both sets of adaptors produce the same result, and then
+// measure the time and the number of heap allocations needed to decode and encode the bundle. The optional
+// command-line argument is the number of iterations.
+//
+
+#include <stddef.h> // size_t
+#include <stdint.h> // int8_t, uint8_t, uint64_t
+#include <stdio.h>  // printf
+#include <stdlib.h> // atoi, free, malloc, EXIT_FAILURE, EXIT_SUCCESS
+
+#include <chrono>  // std::chrono::duration, std::chrono::high_resolution_clock
+#include <map>
+#include <new>     // std::bad_alloc
+#include <string>
+#include <tuple>   // std::make_tuple
+#include <utility> // std::move
+#include <vector>
+
+#include "SpServices/Msgpack.h"
+#include "SpServices/Rpclib.h"
+
+//
+// Count heap allocations so we can report them per iteration.
+//
+
+static uint64_t s_num_allocations = 0;
+
+void* operator new(size_t num_bytes)
+{
+    s_num_allocations++;
+    void* ptr = malloc(num_bytes > 0 ? num_bytes : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, [[maybe_unused]] size_t num_bytes) noexcept
+{
+    free(ptr);
+}
+
+//
+// Types that mirror SpFuncPackedArray and SpFuncDataBundle. We need two otherwise identical copies of each type,
+// so we can specialize the msgpack adaptors differently for each copy.
+//
+
+enum class BenchmarkArrayDataSource : int8_t
+{
+    Invalid  = -1,
+    Internal = 0,
+    External = 1,
+    Shared   = 2
+};
+
+enum class BenchmarkArrayDataType : int8_t
+{
+    Invalid = -1,
+    UInt8   = 0,
+    Float32 = 9
+};
+
+MSGPACK_ADD_ENUM(BenchmarkArrayDataSource);
+MSGPACK_ADD_ENUM(BenchmarkArrayDataType);
+
+struct PackedArray
+{
+    std::vector<uint8_t> data_;
+    BenchmarkArrayDataSource data_source_ = BenchmarkArrayDataSource::Invalid;
+    std::vector<uint64_t> shape_;
+    BenchmarkArrayDataType data_type_ = BenchmarkArrayDataType::Invalid;
+    std::string shared_memory_name_;
+};
+
+struct MapPackedArray : PackedArray {};
+struct StructDescPackedArray : PackedArray {};
+
+template <typename TPackedArray>
+struct DataBundle
+{
+    std::map<std::string, TPackedArray> packed_arrays_;
+    std::map<std::string, std::string> unreal_obj_strings_;
+    std::string info_;
+};
+
+using MapDataBundle = DataBundle<MapPackedArray>;
+using StructDescDataBundle = DataBundle<StructDescPackedArray>;
+
+//
+// Adaptors based on Msgpack::toMap(...)
+//
+
+template <>
+struct clmdep_msgpack::adaptor::convert<MapPackedArray> {
+    clmdep_msgpack::object const& operator()(clmdep_msgpack::object const& object, MapPackedArray& packed_array) const {
+        std::map<std::string, clmdep_msgpack::object> map = Msgpack::toMap(object);
+        SP_ASSERT(map.size() == 5);
+        packed_array.data_ = Msgpack::to<std::vector<uint8_t>>(map.at("data"));
+        packed_array.data_source_ = Msgpack::to<BenchmarkArrayDataSource>(map.at("data_source"));
+        packed_array.shape_ = Msgpack::to<std::vector<uint64_t>>(map.at("shape"));
+        packed_array.data_type_ = Msgpack::to<BenchmarkArrayDataType>(map.at("data_type"));
+        packed_array.shared_memory_name_ = Msgpack::to<std::string>(map.at("shared_memory_name"));
+        return object;
+    }
+};
+
+template <>
+struct clmdep_msgpack::adaptor::object_with_zone<MapPackedArray> {
+    void operator()(clmdep_msgpack::object::with_zone& object, MapPackedArray const& packed_array) const {
+        std::map<std::string, clmdep_msgpack::object> map = {
+            {"data", clmdep_msgpack::object(packed_array.data_, object.zone)},
+            {"data_source", clmdep_msgpack::object(packed_array.data_source_, object.zone)},
+            {"shape", clmdep_msgpack::object(packed_array.shape_, object.zone)},
+            {"data_type", clmdep_msgpack::object(packed_array.data_type_, object.zone)},
+            {"shared_memory_name", clmdep_msgpack::object(packed_array.shared_memory_name_, object.zone)}};
+        Msgpack::toObject(object, map);
+    }
+};
+
+template <>
+struct clmdep_msgpack::adaptor::convert<MapDataBundle> {
+    clmdep_msgpack::object const& operator()(clmdep_msgpack::object const& object, MapDataBundle& data_bundle) const {
+        std::map<std::string, clmdep_msgpack::object> map = Msgpack::toMap(object);
+        SP_ASSERT(map.size() == 3);
+        data_bundle.packed_arrays_ = Msgpack::to<std::map<std::string, MapPackedArray>>(map.at("packed_arrays"));
+        data_bundle.unreal_obj_strings_ = Msgpack::to<std::map<std::string, std::string>>(map.at("unreal_obj_strings"));
+        data_bundle.info_ = Msgpack::to<std::string>(map.at("info"));
+        return object;
+    }
+};
+
+template <>
+struct clmdep_msgpack::adaptor::object_with_zone<MapDataBundle> {
+    void operator()(clmdep_msgpack::object::with_zone& object, MapDataBundle const& data_bundle) const {
+        std::map<std::string, clmdep_msgpack::object> map = {
+            {"packed_arrays", clmdep_msgpack::object(data_bundle.packed_arrays_, object.zone)},
+            {"unreal_obj_strings", clmdep_msgpack::object(data_bundle.unreal_obj_strings_, object.zone)},
+            {"info", clmdep_msgpack::object(data_bundle.info_, object.zone)}};
+        Msgpack::toObject(object, map);
+    }
+};
+
+//
+// Adaptors based on MsgpackStructDesc
+//
+
+template <>
+struct MsgpackStructDesc<StructDescPackedArray> {
+    static constexpr auto k_field_descs = std::make_tuple(
+        Msgpack::fieldDesc("data", &StructDescPackedArray::data_),
+        Msgpack::fieldDesc("data_source", &StructDescPackedArray::data_source_),
+        Msgpack::fieldDesc("shape", &StructDescPackedArray::shape_),
+        Msgpack::fieldDesc("data_type", &StructDescPackedArray::data_type_),
+        Msgpack::fieldDesc("shared_memory_name", &StructDescPackedArray::shared_memory_name_));
+};
+
+template <>
+struct clmdep_msgpack::adaptor::convert<StructDescPackedArray> {
+    clmdep_msgpack::object const& operator()(clmdep_msgpack::object const& object, StructDescPackedArray& packed_array) const {
+        Msgpack::toStruct(object, packed_array);
+        return object;
+    }
+};
+
+template <>
+struct clmdep_msgpack::adaptor::object_with_zone<StructDescPackedArray> {
+    void operator()(clmdep_msgpack::object::with_zone& object, StructDescPackedArray const& packed_array) const {
+        Msgpack::toObject(object, packed_array);
+    }
+};
+
+template <>
+struct MsgpackStructDesc<StructDescDataBundle> {
+    static constexpr auto k_field_descs = std::make_tuple(
+        Msgpack::fieldDesc("packed_arrays", &StructDescDataBundle::packed_arrays_),
+        Msgpack::fieldDesc("unreal_obj_strings", &StructDescDataBundle::unreal_obj_strings_),
+        Msgpack::fieldDesc("info", &StructDescDataBundle::info_));
+};
+
+template <>
+struct clmdep_msgpack::adaptor::convert<StructDescDataBundle> {
+    clmdep_msgpack::object const& operator()(clmdep_msgpack::object const& object, StructDescDataBundle& data_bundle) const {
+        Msgpack::toStruct(object, data_bundle);
+        return object;
+    }
+};
+
+template <>
+struct clmdep_msgpack::adaptor::object_with_zone<StructDescDataBundle> {
+    void operator()(clmdep_msgpack::object::with_zone& object, StructDescDataBundle const& data_bundle) const {
+        Msgpack::toObject(object, data_bundle);
+    }
+};
+
+//
+// Benchmark
+//
+
+static int s_num_failures = 0;
+
+static void check(bool condition, const char* description, int num_arrays)
+{
+    if (!condition) {
+        printf("    FAILED: %s, num_arrays %d\n", description, num_arrays);
+        s_num_failures++;
+    }
+}
+
+template <typename TDataBundle>
+static TDataBundle createDataBundle(int num_arrays)
+{
+    TDataBundle data_bundle;
+    for (int i = 0; i < num_arrays; i++) {
+        typename decltype(data_bundle.packed_arrays_)::mapped_type packed_array;
+        packed_array.data_.resize(4*3*sizeof(float));
+        for (int j = 0; j < packed_array.data_.size(); j++) {
+            packed_array.data_.at(j) = static_cast<uint8_t>(i + j);
+        }
+        packed_array.data_source_ = BenchmarkArrayDataSource::Internal;
+        packed_array.shape_ = {4, 3};
+        packed_array.data_type_ = BenchmarkArrayDataType::Float32;
+        packed_array.shared_memory_name_ = "";
+        data_bundle.packed_arrays_["array_" + std::to_string(i)] = std::move(packed_array);
+    }
+    data_bundle.unreal_obj_strings_["actor"] = "\"Actor_0\"";
+    data_bundle.info_ = "benchmark";
+    return data_bundle;
+}
+
+template <typename TDataBundleA, typename TDataBundleB>
+static bool isEqual(const TDataBundleA& a, const TDataBundleB& b)
+{
+    if (a.packed_arrays_.size() != b.packed_arrays_.size() || a.unreal_obj_strings_ != b.unreal_obj_strings_ || a.info_ != b.info_) {
+        return false;
+    }
+    for (auto& [name, packed_array] : a.packed_arrays_) {
+        if (!b.packed_arrays_.contains(name)) {
+            return false;
+        }
+        auto& other = b.packed_arrays_.at(name);
+        if (packed_array.data_ != other.data_ || packed_array.data_source_ != other.data_source_ || packed_array.shape_ != other.shape_ ||
+            packed_array.data_type_ != other.data_type_ || packed_array.shared_memory_name_ != other.shared_memory_name_) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename TFunc>
+static void benchmark(const char* name, int num_iterations, TFunc func)
+{
+    func(); // warm up
+
+    uint64_t num_allocations = s_num_allocations;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_iterations; i++) {
+        func();
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    num_allocations = s_num_allocations - num_allocations;
+
+    double seconds = std::chrono::duration<double>(end_time - start_time).count() / num_iterations;
+    printf("    %-26s %10.2f us %10.1f allocations\n", name, seconds*1000000.0, static_cast<double>(num_allocations) / num_iterations);
+}
+
+template <typename TDataBundle>
+static void benchmarkDataBundle(const char* name, int num_arrays, int num_iterations)
+{
+    TDataBundle data_bundle = createDataBundle<TDataBundle>(num_arrays);
+
+    // the encoded buffer is what an RPC client would send as an arg, and the unpacked object is what our adaptors receive
+    clmdep_msgpack::zone zone;
+    clmdep_msgpack::sbuffer buffer;
+    clmdep_msgpack::pack(buffer, clmdep_msgpack::object(data_bundle, zone));
+    clmdep_msgpack::object_handle object_handle = clmdep_msgpack::unpack(buffer.data(), buffer.size());
+    zone.clear();
+
+    std::string decode_name = std::string(name) + " decode";
+    benchmark(decode_name.c_str(), num_iterations, [&object_handle]() -> void {
+        TDataBundle decoded_data_bundle;
+        object_handle.get().convert(decoded_data_bundle);
+    });
+
+    std::string encode_name = std::string(name) + " encode";
+    benchmark(encode_name.c_str(), num_iterations, [&data_bundle, &zone]() -> void {
+        clmdep_msgpack::object object(data_bundle, zone);
+        zone.clear();
+    });
+}
+
+int main(int argc, char** argv)
+{
+    int num_iterations = argc > 1 ? atoi(argv[1]) : 10000;
+
+    for (int num_arrays : {1, 2, 4, 8, 16, 32, 64}) {
+        printf("num_arrays %d:\n", num_arrays);
+
+        // encode with each set of adaptors, decode with the other set, and check that we get the original bundle back
+        MapDataBundle map_data_bundle = createDataBundle<MapDataBundle>(num_arrays);
+        StructDescDataBundle struct_desc_data_bundle = createDataBundle<StructDescDataBundle>(num_arrays);
+        check(isEqual(map_data_bundle, struct_desc_data_bundle), "createDataBundle", num_arrays);
+
+        clmdep_msgpack::zone zone;
+        clmdep_msgpack::object map_object(map_data_bundle, zone);
+        clmdep_msgpack::object struct_desc_object(struct_desc_data_bundle, zone);
+        check(isEqual(map_data_bundle, struct_desc_object.as<StructDescDataBundle>()), "MsgpackStructDesc decode", num_arrays);
+        check(isEqual(struct_desc_data_bundle, map_object.as<MapDataBundle>()), "MsgpackStructDesc encode", num_arrays);
+
+        benchmarkDataBundle<MapDataBundle>("toMap", num_arrays, num_iterations);
+        benchmarkDataBundle<StructDescDataBundle>("MsgpackStructDesc", num_arrays, num_iterations);
+    }
+
+    if (s_num_failures > 0) {
+        printf("%d checks FAILED\n", s_num_failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("All checks passed\n");
+    return EXIT_SUCCESS;
+}
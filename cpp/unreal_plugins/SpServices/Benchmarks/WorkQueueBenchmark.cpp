@@ -0,0 +1,315 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+//
+// Standalone micro-benchmark for SpServices/WorkQueue.h. WorkQueue doesn't depend on Unreal, so this file is not
+// part of any Unreal module, and is built directly with a C++20 compiler. SpCore/SuppressCompilerWarnings.h only
+// supports Clang and MSVC, so on macOS and Linux this benchmark needs to be built with Clang, e.g.,
+//
+//     clang++ -std=c++20 -O2 -pthread -DSPCORE_API= -I../Source -I../../SpCore/Source -I/path/to/boost/include WorkQueueBenchmark.cpp ../Source/SpServices/WorkQueue.cpp ../../SpCore/Source/SpCore/Assert.cpp -o WorkQueueBenchmark
+//
+// On Windows, SpCore/Windows.h includes a header file from Unreal, so this benchmark needs to be built with the
+// Unreal include paths.
+//
+// We compare WorkQueue against AsioWorkQueue, which is a copy of the boost::asio implementation that WorkQueue
+// replaced. First, we measure the per-task overhead of scheduling non-blocking tasks, and the frame drain latency,
+// i.e., the time needed for run() to execute all tasks that have been scheduled before the beginning of a frame.
+// Second, for each number of producer threads, the main thread plays the role of the game thread and calls run()
+// once per frame, while the producer threads play the role of RPC worker threads and each schedule a number of
+// blocking calls before the last one calls reset(). We report the average time per call, which includes the
+// round-trip between the producer thread and the main thread. We also check that return values and exceptions
+// thrown on the main thread are returned to the producer threads, and that scheduling a non-blocking task throws
+// when the queue is full. The optional command-line arguments are the number of frames and the number of calls
+// per producer thread per frame, which must be at most WorkQueue::getMaxNumTasks().
+//
+
+#include <stdint.h> // uint64_t
+#include <stdio.h>  // printf
+#include <stdlib.h> // atoi, EXIT_FAILURE, EXIT_SUCCESS
+
+#include <atomic>
+#include <chrono>    // std::chrono::duration, std::chrono::high_resolution_clock
+#include <future>
+#include <mutex>
+#include <new>       // operator new
+#include <stdexcept> // std::runtime_error
+#include <thread>
+#include <utility>   // std::forward, std::move
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "SpCore/Profiler.h"
+
+#include "SpServices/WorkQueue.h"
+
+//
+// WorkQueue records profiler events via SP_PROFILE_SCOPE, but Profiler.cpp depends on Unreal, so we provide
+// trivial definitions here. Profiling is disabled by default, so these functions are never called.
+//
+
+uint64_t Profiler::getTimeNanoseconds()
+{
+    return 0;
+}
+
+void Profiler::record([[maybe_unused]] const char* name, [[maybe_unused]] uint64_t begin_time_nanoseconds, [[maybe_unused]] uint64_t end_time_nanoseconds) {}
+
+//
+// Copy of the boost::asio implementation that WorkQueue replaced, with the same interface as WorkQueue.
+//
+
+class AsioWorkQueue {
+public:
+    AsioWorkQueue() : io_context_(), executor_work_guard_(io_context_.get_executor()) {}
+
+    void run()
+    {
+        io_context_.run();
+
+        mutex_.lock();
+        io_context_.restart();
+        new(&executor_work_guard_) boost::asio::executor_work_guard<boost::asio::io_context::executor_type>(io_context_.get_executor());
+        mutex_.unlock();
+    }
+
+    void reset()
+    {
+        mutex_.lock();
+        executor_work_guard_.reset();
+        mutex_.unlock();
+    }
+
+    template <typename TFunc>
+    static auto wrapFuncToExecuteInWorkQueueBlocking(AsioWorkQueue& work_queue, const TFunc& func)
+    {
+        return [&work_queue, func](int& arg) -> int {
+            return work_queue.scheduleFunc(func, arg).get();
+        };
+    }
+
+    template <typename TFunc>
+    static auto wrapFuncToExecuteInWorkQueueNonBlocking(AsioWorkQueue& work_queue, const TFunc& func)
+    {
+        return [&work_queue, func](int& arg) -> std::future<int> {
+            return work_queue.scheduleFunc(func, arg);
+        };
+    }
+
+private:
+    template <typename TFunc>
+    std::future<int> scheduleFunc(const TFunc& func, int& arg)
+    {
+        auto task = CopyConstructiblePackagedTask<int>([func, arg]() mutable -> int { return func(arg); });
+        std::future<int> future = task.get_future();
+        boost::asio::post(io_context_, std::move(task));
+        return future;
+    }
+
+    template <typename TReturn>
+    struct CopyConstructiblePackagedTask : std::packaged_task<TReturn()>
+    {
+        CopyConstructiblePackagedTask(auto&& func) : std::packaged_task<TReturn()>(std::forward<decltype(func)>(func)) {};
+    };
+
+    boost::asio::io_context io_context_;
+    std::mutex mutex_;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> executor_work_guard_;
+};
+
+//
+// Benchmark
+//
+
+static int s_num_failures = 0;
+
+static void check(bool condition, const char* description, int num_producer_threads)
+{
+    if (!condition) {
+        printf("    FAILED: %s, num_producer_threads %d\n", description, num_producer_threads);
+        s_num_failures++;
+    }
+}
+
+template <typename TWorkQueue>
+static void benchmark(const char* name, int num_producer_threads, int num_frames, int num_calls_per_thread_per_frame)
+{
+    TWorkQueue work_queue;
+    auto func = TWorkQueue::wrapFuncToExecuteInWorkQueueBlocking(work_queue, [](int& arg) -> int { return arg + 1; });
+
+    std::atomic<uint64_t> num_incorrect_return_values = 0;
+    double seconds = 0.0;
+
+    for (int frame = 0; frame < num_frames; frame++) {
+        std::atomic<int> num_active_producer_threads = num_producer_threads;
+        std::vector<std::thread> producer_threads;
+
+        auto start_time = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < num_producer_threads; i++) {
+            producer_threads.emplace_back([&]() -> void {
+                for (int j = 0; j < num_calls_per_thread_per_frame; j++) {
+                    if (func(j) != j + 1) {
+                        num_incorrect_return_values++;
+                    }
+                }
+                // the last producer thread to finish allows run() to return
+                if (--num_active_producer_threads == 0) {
+                    work_queue.reset();
+                }
+            });
+        }
+        work_queue.run();
+        auto end_time = std::chrono::high_resolution_clock::now();
+
+        for (auto& producer_thread : producer_threads) {
+            producer_thread.join();
+        }
+        seconds += std::chrono::duration<double>(end_time - start_time).count();
+    }
+
+    check(num_incorrect_return_values == 0, name, num_producer_threads);
+
+    double num_calls = static_cast<double>(num_frames)*num_producer_threads*num_calls_per_thread_per_frame;
+    printf("    %-14s %10.3f us per call %12.1f calls per second\n", name, (seconds / num_calls)*1000000.0, num_calls / seconds);
+}
+
+// Measures the per-task overhead of scheduling non-blocking tasks, and the time needed for run() to drain the
+// scheduled tasks at the beginning of a frame. Tasks are scheduled and executed on the main thread, so these
+// measurements don't include any thread wakeups.
+template <typename TWorkQueue>
+static void benchmarkDrain(const char* name, int num_frames, int num_tasks_per_frame)
+{
+    TWorkQueue work_queue;
+    auto func = TWorkQueue::wrapFuncToExecuteInWorkQueueNonBlocking(work_queue, [](int& arg) -> int { return arg + 1; });
+
+    uint64_t num_incorrect_return_values = 0;
+    double schedule_seconds = 0.0;
+    double drain_seconds = 0.0;
+
+    for (int frame = 0; frame < num_frames; frame++) {
+        std::vector<std::future<int>> futures;
+        futures.reserve(num_tasks_per_frame);
+
+        auto start_time = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < num_tasks_per_frame; i++) {
+            futures.push_back(func(i));
+        }
+        auto schedule_end_time = std::chrono::high_resolution_clock::now();
+
+        // run() executes all scheduled tasks and returns immediately, because reset() has already been called
+        work_queue.reset();
+        work_queue.run();
+        auto drain_end_time = std::chrono::high_resolution_clock::now();
+
+        for (int i = 0; i < num_tasks_per_frame; i++) {
+            if (futures.at(i).get() != i + 1) {
+                num_incorrect_return_values++;
+            }
+        }
+        schedule_seconds += std::chrono::duration<double>(schedule_end_time - start_time).count();
+        drain_seconds += std::chrono::duration<double>(drain_end_time - schedule_end_time).count();
+    }
+
+    check(num_incorrect_return_values == 0, name, 0);
+
+    double num_tasks = static_cast<double>(num_frames)*num_tasks_per_frame;
+    printf("    %-14s %10.3f us per task to schedule %10.3f us per task to drain %10.3f us to drain each frame\n",
+        name, (schedule_seconds / num_tasks)*1000000.0, (drain_seconds / num_tasks)*1000000.0, (drain_seconds / num_frames)*1000000.0);
+}
+
+static void checkExceptions()
+{
+    WorkQueue work_queue;
+    auto func = WorkQueue::wrapFuncToExecuteInWorkQueueBlocking(work_queue, [](int& arg) -> int {
+        if (arg < 0) {
+            throw std::runtime_error("negative arg");
+        }
+        return arg;
+    });
+
+    // an exception thrown on the main thread must be rethrown on the producer thread, and must not prevent
+    // subsequent calls from executing
+    bool exception_caught = false;
+    int return_value = -1;
+    std::thread producer_thread([&]() -> void {
+        try {
+            int arg = -1;
+            func(arg);
+        } catch (const std::runtime_error&) {
+            exception_caught = true;
+        }
+        int arg = 1;
+        return_value = func(arg);
+        work_queue.reset();
+    });
+    work_queue.run();
+    producer_thread.join();
+
+    check(exception_caught, "exception rethrown on producer thread", 1);
+    check(return_value == 1, "call after exception", 1);
+}
+
+static void checkQueueFull()
+{
+    WorkQueue work_queue;
+    auto func = WorkQueue::wrapFuncToExecuteInWorkQueueNonBlocking(work_queue, [](int& arg) -> int { return arg; });
+
+    // scheduling a non-blocking task must throw instead of waiting when the queue is full, and the queue must
+    // accept new tasks after the main thread has executed the scheduled tasks
+    std::vector<std::future<int>> futures;
+    for (int i = 0; i < static_cast<int>(WorkQueue::getMaxNumTasks()); i++) {
+        futures.push_back(func(i));
+    }
+    bool exception_caught = false;
+    try {
+        int arg = -1;
+        futures.push_back(func(arg));
+    } catch (const std::runtime_error&) {
+        exception_caught = true;
+    }
+    work_queue.reset();
+    work_queue.run();
+
+    int arg = 1;
+    std::future<int> future = func(arg);
+    work_queue.reset();
+    work_queue.run();
+
+    check(exception_caught, "exception thrown when queue is full", 0);
+    check(futures.size() == WorkQueue::getMaxNumTasks() && futures.back().get() == static_cast<int>(WorkQueue::getMaxNumTasks()) - 1, "tasks scheduled before queue is full", 0);
+    check(future.get() == 1, "task scheduled after queue is drained", 0);
+}
+
+int main(int argc, char** argv)
+{
+    int num_frames = argc > 1 ? atoi(argv[1]) : 100;
+    int num_calls_per_thread_per_frame = argc > 2 ? atoi(argv[2]) : 1000;
+
+    // non-blocking tasks can't be scheduled when the queue is full
+    if (num_calls_per_thread_per_frame > static_cast<int>(WorkQueue::getMaxNumTasks())) {
+        printf("The number of calls per frame must be at most %d\n", static_cast<int>(WorkQueue::getMaxNumTasks()));
+        return EXIT_FAILURE;
+    }
+
+    checkExceptions();
+    checkQueueFull();
+
+    printf("non-blocking tasks, %d per frame:\n", num_calls_per_thread_per_frame);
+    benchmarkDrain<AsioWorkQueue>("AsioWorkQueue", num_frames, num_calls_per_thread_per_frame);
+    benchmarkDrain<WorkQueue>("WorkQueue", num_frames, num_calls_per_thread_per_frame);
+
+    for (int num_producer_threads : {1, 2, 4, 8}) {
+        printf("num_producer_threads %d:\n", num_producer_threads);
+        benchmark<AsioWorkQueue>("AsioWorkQueue", num_producer_threads, num_frames, num_calls_per_thread_per_frame);
+        benchmark<WorkQueue>("WorkQueue", num_producer_threads, num_frames, num_calls_per_thread_per_frame);
+    }
+
+    if (s_num_failures > 0) {
+        printf("%d checks FAILED\n", s_num_failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("All checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -4,20 +4,34 @@
 
 #pragma once
 
-#include <stdint.h> // uint8_t
+#include <stdint.h> // uint8_t, uint64_t
 
 #include <atomic>
-#include <future> // std::promise, std::future
+#include <exception>  // std::current_exception, std::exception_ptr, std::rethrow_exception
+#include <functional> // std::function
+#include <future>     // std::promise, std::future
+#include <map>
+#include <memory>     // std::make_shared, std::make_unique, std::shared_ptr
 #include <mutex>
+#include <stdexcept>  // std::runtime_error
 #include <string>
+#include <tuple>      // std::apply
+#include <type_traits>
+#include <utility>    // std::move
+#include <vector>
 
 #include <Containers/UnrealString.h>     // FString::operator*
 #include <Delegates/IDelegateInstance.h> // FDelegateHandle
 #include <Misc/CoreDelegates.h>
 
 #include "SpCore/Assert.h"
+#include "SpCore/Profiler.h"
+#include "SpCore/Std.h"
 
 #include "SpServices/EntryPointBinder.h"
+#include "SpServices/FuncInfo.h"
+#include "SpServices/Msgpack.h"
+#include "SpServices/Rpclib.h"
 #include "SpServices/WorkQueue.h"
 
 #if !WITH_EDITOR
@@ -32,9 +46,26 @@ enum class FrameState : int8_t
     Idle              = 0,
     RequestPreTick    = 1,
     ExecutingPreTick  = 2,
-    ExecutingTick     = 3,
-    ExecutingPostTick = 4,
-    Closing           = 5
+    RequestTick       = 3,
+    ExecutingTick     = 4,
+    ExecutingPostTick = 5,
+    RequestIdle       = 6,
+    Closing           = 7
+};
+
+// EngineServiceCall describes a call to an entry point that has been bound via EngineService::bindFuncUnreal(...).
+// A list of these calls can be passed to the "engine_service.step" entry point, which executes an entire frame
+// in a single RPC round-trip.
+struct EngineServiceCall
+{
+    std::string name_;
+    clmdep_msgpack::object args_; // refers to memory owned by the RPC server, only valid for the duration of an RPC call
+};
+
+struct EngineServiceStepReturnValues
+{
+    std::vector<clmdep_msgpack::object_handle> pre_tick_return_values_;
+    std::vector<clmdep_msgpack::object_handle> post_tick_return_values_;
 };
 
 template <CEntryPointBinder TEntryPointBinder>
@@ -73,59 +104,159 @@ public:
         });
 
         entry_point_binder_->bind("engine_service.begin_tick", [this]() -> void {
-            
-            // We need to lock frame_state_mutex_ here, because the game thread might call close() any time
-            // before, while, or after executing this function. If close() is executed after we check if
-            // frame_state_ == FrameState::Idle but before we set frame_state_ = FrameState::RequestPreTick,
-            // then we will deadlock because frame_state_executing_pre_tick_future_.wait() will never return.
-            // We avoid this problematic case by locking frame_state_mutex_.
-            frame_state_mutex_.lock();
-            {
-                SP_ASSERT(frame_state_ == FrameState::Idle || frame_state_ == FrameState::Closing);
+            beginTick();
+        });
 
-                if (frame_state_ == FrameState::Idle) {
-                    // Reset promises and futures.
-                    frame_state_idle_promise_ = std::promise<void>();
-                    frame_state_executing_pre_tick_promise_ = std::promise<void>();
-                    frame_state_executing_post_tick_promise_ = std::promise<void>();
+        entry_point_binder_->bind("engine_service.tick", [this]() -> void {
+            tick();
+        });
 
-                    frame_state_idle_future_ = frame_state_idle_promise_.get_future();
-                    frame_state_executing_pre_tick_future_ = frame_state_executing_pre_tick_promise_.get_future();
-                    frame_state_executing_post_tick_future_ = frame_state_executing_post_tick_promise_.get_future();
+        entry_point_binder_->bind("engine_service.end_tick", [this]() -> void {
+            endTick();
+        });
 
-                    // Allow beginFrameHandler() to start executing.
-                    frame_state_ = FrameState::RequestPreTick;
+        // The "engine_service.step" entry point executes an entire frame, i.e., the equivalent of calling
+        // begin_tick, a sequence of pre-tick entry points, tick, a sequence of post-tick entry points, and
+        // end_tick, in a single RPC round-trip. All pre-tick calls are executed back-to-back in a single task
+        // during beginFrameHandler(), and all post-tick calls are executed back-to-back in a single task during
+        // endFrameHandler(). We reject calls to unknown entry points before beginning the frame. If a call
+        // throws an exception, we skip the remaining calls in its batch, but we still finish executing the
+        // frame, because otherwise the game thread would wait in beginFrameHandler() or endFrameHandler()
+        // forever. After the frame has finished executing, we rethrow the first exception, which the RPC server
+        // returns to the client as an error.
+        auto call_funcs_unreal = WorkQueue::wrapFuncToExecuteInWorkQueueBlocking(work_queue_,
+            [this](std::vector<EngineServiceCall>& calls) -> std::vector<clmdep_msgpack::object_handle> {
+                std::vector<clmdep_msgpack::object_handle> return_values;
+                for (auto& call : calls) {
+                    return_values.push_back(funcs_unreal_.at(call.name_)(call.args_));
                 }
-            }
-            frame_state_mutex_.unlock();
+                return return_values;
+            });
+
+        entry_point_binder_->bind("engine_service.step",
+            [this, call_funcs_unreal](std::vector<EngineServiceCall>& pre_tick_calls, std::vector<EngineServiceCall>& post_tick_calls) -> EngineServiceStepReturnValues {
+                validateCalls("engine_service.step", pre_tick_calls);
+                validateCalls("engine_service.step", post_tick_calls);
+
+                EngineServiceStepReturnValues return_values;
+                std::exception_ptr exception = nullptr;
+
+                beginTick();
+                try {
+                    return_values.pre_tick_return_values_ = call_funcs_unreal(pre_tick_calls);
+                } catch (...) {
+                    exception = std::current_exception();
+                }
+                tick();
+                try {
+                    return_values.post_tick_return_values_ = call_funcs_unreal(post_tick_calls);
+                } catch (...) {
+                    if (!exception) {
+                        exception = std::current_exception();
+                    }
+                }
+                endTick();
 
-            if (frame_state_ == FrameState::RequestPreTick) {
-                // Wait here until beginFrameHandler() or close() updates frame_state_ and calls frame_state_executing_pre_tick_promise_.set_value().
-                frame_state_executing_pre_tick_future_.wait();
-                SP_ASSERT(frame_state_ == FrameState::ExecutingPreTick || frame_state_ == FrameState::Closing);
+                if (exception) {
+                    std::rethrow_exception(exception);
+                }
+                return return_values;
+            });
+
+        // The "engine_service.call_async" entry point schedules a call to an entry point that has been bound
+        // via bindFuncUnreal(...), and returns a handle immediately, without waiting for the game thread to
+        // execute the call. The "engine_service.call_async_batch" entry point does the same for a list of
+        // calls, and returns a list of handles, so a client can pipeline many calls within a single frame
+        // using a single RPC round-trip. In either case, the game thread will execute the calls back-to-back
+        // during a single call to WorkQueue::run(). The calls within a batch execute in the order they appear
+        // in the batch, but separate requests might be dispatched to different RPC worker threads concurrently,
+        // so calls from separate requests are only ordered if the client waits for each response before
+        // sending the next request. The return values can be retrieved by passing the handles to the
+        // "engine_service.get_future_results" entry point, which blocks until the calls have finished
+        // executing. Since WorkQueue::run() executes all scheduled work before returning, the return values
+        // can also be retrieved after calling tick, but they must be retrieved before calling end_tick, because
+        // endTick() discards all return values that haven't been retrieved. The work queue can hold at most
+        // WorkQueue::getMaxNumTasks() calls per frame. If it is full, the entry point throws an exception
+        // instead of waiting, because waiting would block an RPC worker thread that might be needed to serve
+        // the tick request that drains the queue. In this case, the calls in a batch that were scheduled before
+        // the queue filled up will still execute, but their handles are not returned, so their return values
+        // are discarded by endTick().
+        auto call_func_unreal_non_blocking = WorkQueue::wrapFuncToExecuteInWorkQueueNonBlocking(work_queue_,
+            [this](std::string& name, std::shared_ptr<clmdep_msgpack::object_handle>& args) -> clmdep_msgpack::object_handle {
+                return funcs_unreal_.at(name)(args->get());
+            });
+
+        auto schedule_call = [this, call_func_unreal_non_blocking](EngineServiceCall& call) -> uint64_t {
+            // call.args_ refers to memory owned by the RPC server, so we deep-copy it into a zone that will
+            // remain valid until the game thread has finished executing the call.
+            auto zone = std::make_unique<clmdep_msgpack::zone>();
+            clmdep_msgpack::object args(call.args_, *zone);
+            auto args_handle = std::make_shared<clmdep_msgpack::object_handle>(args, std::move(zone));
+
+            std::future<clmdep_msgpack::object_handle> future = call_func_unreal_non_blocking(call.name_, args_handle);
+
+            uint64_t handle;
+            futures_mutex_.lock();
+            {
+                handle = next_future_handle_++;
+                Std::insert(futures_, handle, std::move(future));
             }
-        });
+            futures_mutex_.unlock();
 
-        entry_point_binder_->bind("engine_service.tick", [this]() -> void {
-            SP_ASSERT(frame_state_ == FrameState::ExecutingPreTick);
+            return handle;
+        };
 
-            // Allow beginFrameHandler() to finish executing.
-            work_queue_.reset();
+        entry_point_binder_->bind("engine_service.call_async", [this, schedule_call](EngineServiceCall& call) -> uint64_t {
+            validateCalls("engine_service.call_async", {call});
+            return schedule_call(call);
+        });
 
-            // Wait here until endFrameHandler() updates frame_state_ and calls frame_state_executing_post_tick_promise_.set_value().
-            frame_state_executing_post_tick_future_.wait();
-            SP_ASSERT(frame_state_ == FrameState::ExecutingPostTick);
+        // We validate the entire batch before scheduling any calls, so an invalid batch doesn't schedule any work.
+        entry_point_binder_->bind("engine_service.call_async_batch", [this, schedule_call](std::vector<EngineServiceCall>& calls) -> std::vector<uint64_t> {
+            if (calls.size() > WorkQueue::getMaxNumTasks()) {
+                throw std::runtime_error(
+                    "engine_service.call_async_batch can schedule at most " + std::to_string(WorkQueue::getMaxNumTasks()) +
+                    " calls per frame, but received a batch of " + std::to_string(calls.size()) + " calls.");
+            }
+            validateCalls("engine_service.call_async_batch", calls);
+            std::vector<uint64_t> handles;
+            for (auto& call : calls) {
+                handles.push_back(schedule_call(call));
+            }
+            return handles;
         });
 
-        entry_point_binder_->bind("engine_service.end_tick", [this]() -> void {
-            SP_ASSERT(frame_state_ == FrameState::ExecutingPostTick);
+        entry_point_binder_->bind("engine_service.get_future_results",
+            [this](std::vector<uint64_t>& handles) -> std::vector<clmdep_msgpack::object_handle> {
+                std::vector<std::future<clmdep_msgpack::object_handle>> futures;
+                futures_mutex_.lock();
+                {
+                    for (auto handle : handles) {
+                        futures.push_back(std::move(futures_.at(handle)));
+                        Std::remove(futures_, handle);
+                    }
+                }
+                futures_mutex_.unlock();
 
-            // Allow endFrameHandler() to finish executing.
-            work_queue_.reset();
+                // We wait for each future outside of futures_mutex_, so other worker threads can continue to
+                // schedule calls while we're waiting.
+                std::vector<clmdep_msgpack::object_handle> return_values;
+                for (auto& future : futures) {
+                    return_values.push_back(future.get());
+                }
+                return return_values;
+            });
+
+        // The "engine_service.get_frame_stats" entry point returns timing statistics for each scope that has been
+        // recorded via SP_PROFILE_SCOPE since the previous call, and optionally writes all recorded events to a
+        // Chrome trace file. Profiling must be enabled via SP_CORE.PROFILER.ENABLED or the
+        // "engine_service.set_profiler_enabled" entry point.
+        entry_point_binder_->bind("engine_service.get_frame_stats", [](std::string& chrome_trace_file) -> std::map<std::string, ProfilerScopeStats> {
+            return Profiler::getStats(chrome_trace_file);
+        });
 
-            // Wait here until endFrameHandler() updates frame_state_ and calls frame_state_idle_promise_.set_value().
-            frame_state_idle_future_.wait();
-            SP_ASSERT(frame_state_ == FrameState::Idle);
+        entry_point_binder_->bind("engine_service.set_profiler_enabled", [](bool& enabled) -> void {
+            Profiler::setEnabled(enabled);
         });
 
         entry_point_binder_->bind("engine_service.get_byte_order", []() -> std::string {
@@ -153,7 +284,21 @@ public:
 
     void bindFuncUnreal(const std::string& service_name, const std::string& func_name, const auto& func)
     {
-        entry_point_binder_->bind(service_name + "." + func_name, WorkQueue::wrapFuncToExecuteInWorkQueueBlocking(work_queue_, func));
+        std::string name = service_name + "." + func_name;
+        entry_point_binder_->bind(name, WorkQueue::wrapFuncToExecuteInWorkQueueBlocking(work_queue_, func));
+
+        // We also store a version of func that can be called directly from the game thread with msgpack args,
+        // so it can be executed as part of a call to the "engine_service.step" entry point.
+        Std::insert(funcs_unreal_, name, wrapFuncToExecuteWithMsgpackArgs(func));
+    }
+
+    // Returns a function that can be called from any thread, schedules func to execute on the game thread via our
+    // work queue, and returns a std::future without waiting for func to execute. func isn't bound to an RPC entry
+    // point. Useful for services that receive requests through some other transport mechanism, and need to stop
+    // waiting for the game thread when they shut down.
+    auto wrapFuncUnrealNonBlocking(const auto& func)
+    {
+        return WorkQueue::wrapFuncToExecuteInWorkQueueNonBlocking(work_queue_, func);
     }
 
     void close()
@@ -179,6 +324,123 @@ public:
     }
 
 private:
+    // With more than one RPC worker thread, the "engine_service.begin_tick", "engine_service.tick",
+    // "engine_service.end_tick", and "engine_service.step" entry points can be called concurrently, e.g., by
+    // multiple clients connected to the same instance. But only one client can drive a frame at a time, so
+    // each of these functions checks and updates frame_state_ while holding frame_state_mutex_, and rejects
+    // the call by throwing an exception, which the RPC server returns to the client as an error, if the frame
+    // is not in the expected state. For example, if two clients call begin_tick at the same time, then one of
+    // them will drive the next frame and the other one will receive an error. All other entry points can be
+    // called concurrently from any thread.
+
+    void beginTick()
+    {
+        SP_PROFILE_SCOPE("EngineService::beginTick");
+
+        // We need to lock frame_state_mutex_ here, because the game thread might call close() any time
+        // before, while, or after executing this function. If close() is executed after we check if
+        // frame_state_ == FrameState::Idle but before we set frame_state_ = FrameState::RequestPreTick,
+        // then we will deadlock because frame_state_executing_pre_tick_future_.wait() will never return.
+        // We avoid this problematic case by locking frame_state_mutex_.
+        bool request_pre_tick = false;
+        frame_state_mutex_.lock();
+        {
+            if (frame_state_ == FrameState::Idle) {
+                // Reset promises and futures.
+                frame_state_idle_promise_ = std::promise<void>();
+                frame_state_executing_pre_tick_promise_ = std::promise<void>();
+                frame_state_executing_post_tick_promise_ = std::promise<void>();
+
+                frame_state_idle_future_ = frame_state_idle_promise_.get_future();
+                frame_state_executing_pre_tick_future_ = frame_state_executing_pre_tick_promise_.get_future();
+                frame_state_executing_post_tick_future_ = frame_state_executing_post_tick_promise_.get_future();
+
+                // Allow beginFrameHandler() to start executing.
+                frame_state_ = FrameState::RequestPreTick;
+                request_pre_tick = true;
+
+            } else if (frame_state_ != FrameState::Closing) {
+                frame_state_mutex_.unlock();
+                throw std::runtime_error("engine_service.begin_tick can only be called when no other frame is in progress.");
+            }
+        }
+        frame_state_mutex_.unlock();
+
+        if (request_pre_tick) {
+            // Wait here until beginFrameHandler() or close() updates frame_state_ and calls frame_state_executing_pre_tick_promise_.set_value().
+            frame_state_executing_pre_tick_future_.wait();
+            SP_ASSERT(frame_state_ == FrameState::ExecutingPreTick || frame_state_ == FrameState::Closing);
+        }
+    }
+
+    void tick()
+    {
+        SP_PROFILE_SCOPE("EngineService::tick");
+
+        if (!tryUpdateFrameState(FrameState::ExecutingPreTick, FrameState::RequestTick)) {
+            throw std::runtime_error("engine_service.tick can only be called after engine_service.begin_tick.");
+        }
+
+        // Allow beginFrameHandler() to finish executing.
+        work_queue_.reset();
+
+        // Wait here until endFrameHandler() updates frame_state_ and calls frame_state_executing_post_tick_promise_.set_value().
+        frame_state_executing_post_tick_future_.wait();
+        SP_ASSERT(frame_state_ == FrameState::ExecutingPostTick);
+    }
+
+    void endTick()
+    {
+        SP_PROFILE_SCOPE("EngineService::endTick");
+
+        if (!tryUpdateFrameState(FrameState::ExecutingPostTick, FrameState::RequestIdle)) {
+            throw std::runtime_error("engine_service.end_tick can only be called after engine_service.tick.");
+        }
+
+        // Allow endFrameHandler() to finish executing.
+        work_queue_.reset();
+
+        // Wait here until endFrameHandler() updates frame_state_ and calls frame_state_idle_promise_.set_value().
+        frame_state_idle_future_.wait();
+        SP_ASSERT(frame_state_ == FrameState::Idle);
+
+        // All calls scheduled via "engine_service.call_async" during this frame have finished executing, so we
+        // discard any return values that the client hasn't retrieved, to avoid accumulating them indefinitely.
+        futures_mutex_.lock();
+        {
+            futures_.clear();
+        }
+        futures_mutex_.unlock();
+    }
+
+    // Throws an exception, which the RPC server returns to the client as an error, if any call refers to an entry
+    // point that hasn't been bound via bindFuncUnreal(...). funcs_unreal_ is only modified before the RPC server
+    // starts, so this function can be called from any thread.
+    void validateCalls(const std::string& entry_point_name, const std::vector<EngineServiceCall>& calls) const
+    {
+        for (auto& call : calls) {
+            if (!Std::containsKey(funcs_unreal_, call.name_)) {
+                throw std::runtime_error(entry_point_name + " can only call entry points that execute on the game thread, but received a call to " + call.name_ + ".");
+            }
+        }
+    }
+
+    // Updates frame_state_ from expected_frame_state to frame_state while holding frame_state_mutex_. Returns
+    // false without updating frame_state_ if frame_state_ != expected_frame_state. Can be called from any thread.
+    bool tryUpdateFrameState(FrameState expected_frame_state, FrameState frame_state)
+    {
+        bool success = false;
+        frame_state_mutex_.lock();
+        {
+            if (frame_state_ == expected_frame_state) {
+                frame_state_ = frame_state;
+                success = true;
+            }
+        }
+        frame_state_mutex_.unlock();
+        return success;
+    }
+
     void beginFrameHandler()
     {
         // Works around a platform-specific rendering bug. See comment in the constructor above.
@@ -191,42 +453,100 @@ private:
         #endif
 
         if (frame_state_ == FrameState::RequestPreTick) {
-            // Allow begin_tick() to finish executing. There is no need to lock frame_state_mutex_ here,
-            // because if frame_state_ == FrameState::RequestPreTick, then we know the RPC worker thread is
-            // currently waiting in begin_tick() at a point where it will not attempt to make any further
-            // modifications to frame_state_.
-            frame_state_ = FrameState::ExecutingPreTick;
+            SP_PROFILE_SCOPE("EngineService::beginFrameHandler");
+
+            // Allow begin_tick() to finish executing. If frame_state_ == FrameState::RequestPreTick, then we
+            // know the RPC worker thread is currently waiting in begin_tick(), and all other entry points that
+            // modify frame_state_ will reject the call, but we lock frame_state_mutex_ anyway so every
+            // transition is ordered with respect to the checks in beginTick(), tick(), and endTick().
+            bool success = tryUpdateFrameState(FrameState::RequestPreTick, FrameState::ExecutingPreTick);
+            SP_ASSERT(success);
             frame_state_executing_pre_tick_promise_.set_value();
 
             // Execute all pre-tick work and wait until tick() calls work_queue_.reset().
             work_queue_.run();
 
-            // Update frame state.
-            frame_state_ = FrameState::ExecutingTick;
+            // Update frame state. work_queue_.run() only returns after tick() has called work_queue_.reset(),
+            // so we know that tick() has already updated frame_state_.
+            success = tryUpdateFrameState(FrameState::RequestTick, FrameState::ExecutingTick);
+            SP_ASSERT(success);
+
+            // the engine tick is the time between the end of beginFrameHandler() and the beginning of endFrameHandler()
+            engine_tick_begin_time_nanoseconds_ = Profiler::isEnabled() ? Profiler::getTimeNanoseconds() : 0;
         }
     }
 
     void endFrameHandler()
     {
         if (frame_state_ == FrameState::ExecutingTick) {
-            // Allow tick() to finish executing. There is no need to lock frame_state_mutex_ here, because
-            // if frame_state_ == FrameState::ExecutingTick, then we know the RPC worker thread is currently
-            // waiting in tick(), and tick() doesn't modify frame_state_.
-            frame_state_ = FrameState::ExecutingPostTick;
+            if (Profiler::isEnabled() && engine_tick_begin_time_nanoseconds_ > 0) {
+                Profiler::record("EngineService::engineTick", engine_tick_begin_time_nanoseconds_, Profiler::getTimeNanoseconds());
+            }
+
+            SP_PROFILE_SCOPE("EngineService::endFrameHandler");
+
+            // Allow tick() to finish executing.
+            bool success = tryUpdateFrameState(FrameState::ExecutingTick, FrameState::ExecutingPostTick);
+            SP_ASSERT(success);
             frame_state_executing_post_tick_promise_.set_value();
 
-            // Execute all pre-tick work and wait until end_tick() calls work_queue_.reset().
+            // Execute all post-tick work and wait until end_tick() calls work_queue_.reset().
             work_queue_.run();
 
             // Allow end_tick() to finish executing.
-            frame_state_ = FrameState::Idle;
+            success = tryUpdateFrameState(FrameState::RequestIdle, FrameState::Idle);
+            SP_ASSERT(success);
             frame_state_idle_promise_.set_value();
         }
     }
 
+    template <typename TFunc>
+    static auto wrapFuncToExecuteWithMsgpackArgs(const TFunc& func)
+    {
+        return wrapFuncToExecuteWithMsgpackArgsImpl(func, FuncInfo<TFunc>());
+    }
+
+    template <typename TFunc, typename TReturn, typename... TArgs> requires
+        CFuncReturnsAndIsCallableWithArgs<TFunc, TReturn, TArgs&...>
+    static auto wrapFuncToExecuteWithMsgpackArgsImpl(const TFunc& func, const FuncInfo<TReturn(*)(TArgs...)>& fi)
+    {
+        // The lambda returned here converts a msgpack array into the user's argument types, calls the user's
+        // function, and converts the return value into a msgpack object that owns its own zone, so it remains
+        // valid after the lambda returns. As in WorkQueue, the user's function accepts all arguments by
+        // non-const reference, so args_tuple is not copied again when calling the user's function.
+
+        return [func](const clmdep_msgpack::object& args) -> clmdep_msgpack::object_handle {
+            SP_ASSERT(args.type == clmdep_msgpack::type::ARRAY);
+            SP_ASSERT(args.via.array.size == sizeof...(TArgs));
+
+            std::tuple<std::remove_cvref_t<TArgs>...> args_tuple;
+            if constexpr (sizeof...(TArgs) > 0) {
+                args.convert(args_tuple);
+            }
+
+            auto zone = std::make_unique<clmdep_msgpack::zone>();
+            clmdep_msgpack::object return_value;
+            if constexpr (std::is_void_v<TReturn>) {
+                std::apply(func, args_tuple);
+            } else {
+                return_value = clmdep_msgpack::object(std::apply(func, args_tuple), *zone);
+            }
+            return clmdep_msgpack::object_handle(return_value, std::move(zone));
+        };
+    }
+
     TEntryPointBinder* entry_point_binder_ = nullptr;
     WorkQueue work_queue_;
 
+    // all entry points bound via bindFuncUnreal(...), callable from the game thread with msgpack args
+    std::map<std::string, std::function<clmdep_msgpack::object_handle(const clmdep_msgpack::object&)>> funcs_unreal_;
+
+    // futures for all calls that have been scheduled via the "engine_service.call_async" entry point during the
+    // current frame but not yet retrieved via the "engine_service.get_future_results" entry point
+    std::map<uint64_t, std::future<clmdep_msgpack::object_handle>> futures_;
+    std::mutex futures_mutex_;
+    uint64_t next_future_handle_ = 0;
+
     FDelegateHandle begin_frame_handle_;
     FDelegateHandle end_frame_handle_;
 
@@ -241,8 +561,75 @@ private:
     std::future<void> frame_state_executing_pre_tick_future_;
     std::future<void> frame_state_executing_post_tick_future_;
 
+    // only accessed by the game thread
+    uint64_t engine_tick_begin_time_nanoseconds_ = 0;
+
     #if !WITH_EDITOR
         IConsoleVariable* r_lumen_diffuse_indirect_allow_cvar_ = nullptr;        
         int r_lumen_diffuse_indirect_allow_cvar_initial_value_ = -1;
     #endif
 };
+
+//
+// EngineServiceCall
+//
+
+template <> // needed to receive a custom type as an arg
+struct clmdep_msgpack::adaptor::convert<EngineServiceCall> {
+    clmdep_msgpack::object const& operator()(clmdep_msgpack::object const& object, EngineServiceCall& call) const {
+        std::map<std::string, clmdep_msgpack::object> map = Msgpack::toMap(object);
+        SP_ASSERT(map.size() == 2);
+        call.name_ = Msgpack::to<std::string>(map.at("name"));
+        call.args_ = map.at("args");
+        return object;
+    }
+};
+
+//
+// clmdep_msgpack::object_handle
+//
+
+template <> // needed to send a custom type as a return value
+struct clmdep_msgpack::adaptor::object_with_zone<clmdep_msgpack::object_handle> {
+    void operator()(clmdep_msgpack::object::with_zone& object, clmdep_msgpack::object_handle const& object_handle) const {
+        SP_PROFILE_SCOPE("clmdep_msgpack::adaptor::object_with_zone<clmdep_msgpack::object_handle>");
+
+        // performs a deep copy into object.zone, so object_handle doesn't need to outlive this function
+        clmdep_msgpack::adaptor::object_with_zone<clmdep_msgpack::object>()(object, object_handle.get());
+    }
+};
+
+//
+// EngineServiceStepReturnValues
+//
+
+template <> // needed to send a custom type as a return value
+struct clmdep_msgpack::adaptor::object_with_zone<EngineServiceStepReturnValues> {
+    void operator()(clmdep_msgpack::object::with_zone& object, EngineServiceStepReturnValues const& return_values) const {
+        SP_PROFILE_SCOPE("clmdep_msgpack::adaptor::object_with_zone<EngineServiceStepReturnValues>");
+
+        std::map<std::string, clmdep_msgpack::object> map = {
+            {"pre_tick_return_values", clmdep_msgpack::object(return_values.pre_tick_return_values_, object.zone)},
+            {"post_tick_return_values", clmdep_msgpack::object(return_values.post_tick_return_values_, object.zone)}};
+        Msgpack::toObject(object, map);
+    }
+};
+
+//
+// ProfilerScopeStats
+//
+
+template <> // needed to send a custom type as a return value
+struct clmdep_msgpack::adaptor::object_with_zone<ProfilerScopeStats> {
+    void operator()(clmdep_msgpack::object::with_zone& object, ProfilerScopeStats const& scope_stats) const {
+        std::map<std::string, clmdep_msgpack::object> map = {
+            {"count", clmdep_msgpack::object(scope_stats.count_, object.zone)},
+            {"total_ms", clmdep_msgpack::object(scope_stats.total_ms_, object.zone)},
+            {"mean_ms", clmdep_msgpack::object(scope_stats.mean_ms_, object.zone)},
+            {"p50_ms", clmdep_msgpack::object(scope_stats.p50_ms_, object.zone)},
+            {"p90_ms", clmdep_msgpack::object(scope_stats.p90_ms_, object.zone)},
+            {"p99_ms", clmdep_msgpack::object(scope_stats.p99_ms_, object.zone)},
+            {"max_ms", clmdep_msgpack::object(scope_stats.max_ms_, object.zone)}};
+        Msgpack::toObject(object, map);
+    }
+};
@@ -15,4 +15,5 @@ concept CUnrealEntryPointBinder =
     requires(TUnrealEntryPointBinder unreal_entry_point_binder) {
         { unreal_entry_point_binder.bindFuncNoUnreal("", "", []() -> void {}) } -> std::same_as<void>;
         { unreal_entry_point_binder.bindFuncUnreal("", "", []() -> void {}) } -> std::same_as<void>;
+        { unreal_entry_point_binder.wrapFuncUnrealNonBlocking([]() -> void {}) };
     };
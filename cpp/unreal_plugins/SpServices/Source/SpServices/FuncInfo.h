@@ -0,0 +1,46 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#pragma once
+
+#include <concepts>    // std::same_as
+#include <type_traits> // std::invoke_result_t, std::is_invocable_v
+
+template <typename TFunc>
+concept CFuncIsCallableWithNoArgs = std::is_invocable_v<TFunc>;
+
+template <typename TFunc, typename... TArgs>
+concept CFuncIsCallableWithArgs = std::is_invocable_v<TFunc, TArgs...>;
+
+template <typename TFunc, typename TReturn, typename... TArgs>
+concept CFuncReturnsAndIsCallableWithArgs = std::same_as<TReturn, std::invoke_result_t<TFunc, TArgs...>>;
+
+// FuncInfo is used to recover the return type and argument types of a user function (e.g., a lambda that is
+// intended to be bound to an RPC entry point), so that code that wraps the user function can be specialized
+// on these types. Typical usage is to dispatch to an implementation function that accepts a FuncInfo as its
+// last argument, e.g.,
+//
+//     template <typename TFunc>
+//     static auto wrapFunc(const TFunc& func)
+//     {
+//         return wrapFuncImpl(func, FuncInfo<TFunc>());
+//     }
+//
+//     template <typename TFunc, typename TReturn, typename... TArgs>
+//     static auto wrapFuncImpl(const TFunc& func, const FuncInfo<TReturn(*)(TArgs...)>& fi) { ... }
+
+template <typename TClass>
+struct FuncInfo : public FuncInfo<decltype(&TClass::operator())> {};
+
+template <typename TClass, typename TReturn, typename... TArgs>
+struct FuncInfo<TReturn(TClass::*)(TArgs...)> : public FuncInfo<TReturn(*)(TArgs...)> {};
+
+template <typename TClass, typename TReturn, typename... TArgs>
+struct FuncInfo<TReturn(TClass::*)(TArgs...) const> : public FuncInfo<TReturn(*)(TArgs...)> {};
+
+template <class T>
+struct FuncInfo<T&> : public FuncInfo<T> {};
+
+template <typename TReturn, typename... TArgs>
+struct FuncInfo<TReturn(*)(TArgs...)> {};
@@ -0,0 +1,55 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#pragma once
+
+#include <tuple> // std::make_tuple
+
+#include "SpCore/ArrayDesc.h" // TODO: remove
+
+#include "SpServices/Msgpack.h"
+#include "SpServices/Rpclib.h"
+
+//
+// The msgpack adaptors for ArrayDesc don't depend on Unreal, so they are shared by LegacyService and by our
+// native client library in cpp/client.
+//
+
+//
+// Enums
+//
+
+MSGPACK_ADD_ENUM(DataType);
+
+//
+// ArrayDesc
+//
+
+template <>
+struct MsgpackStructDesc<ArrayDesc> {
+    static constexpr auto k_field_descs = std::make_tuple(
+        Msgpack::fieldDesc("low_", &ArrayDesc::low_),
+        Msgpack::fieldDesc("high_", &ArrayDesc::high_),
+        Msgpack::fieldDesc("shape_", &ArrayDesc::shape_),
+        Msgpack::fieldDesc("datatype_", &ArrayDesc::datatype_),
+        Msgpack::fieldDesc("use_shared_memory_", &ArrayDesc::use_shared_memory_),
+        Msgpack::fieldDesc("shared_memory_name_", &ArrayDesc::shared_memory_name_),
+        Msgpack::fieldDesc("shared_memory_num_slots_", &ArrayDesc::shared_memory_num_slots_),
+        Msgpack::fieldDesc("row_names_", &ArrayDesc::row_names_));
+};
+
+template <> // needed to receive a custom type as an arg
+struct clmdep_msgpack::adaptor::convert<ArrayDesc> {
+    clmdep_msgpack::object const& operator()(clmdep_msgpack::object const& object, ArrayDesc& array_desc) const {
+        Msgpack::toStruct(object, array_desc);
+        return object;
+    }
+};
+
+template <> // needed to send a custom type as a return value
+struct clmdep_msgpack::adaptor::object_with_zone<ArrayDesc> {
+    void operator()(clmdep_msgpack::object::with_zone& object, ArrayDesc const& array_desc) const {
+        Msgpack::toObject(object, array_desc);
+    }
+};
@@ -18,6 +18,7 @@
 #include <Engine/World.h>           // FActorSpawnParameters
 #include <GameFramework/Actor.h>
 #include <Math/Rotator.h>
+#include <Math/Transform.h>
 #include <Math/Vector.h>
 
 #include "SpCore/ArrayDesc.h" // TODO: remove
@@ -27,6 +28,7 @@
 #include "SpCore/Unreal.h"
 
 #include "SpServices/Legacy/CameraSensor.h"
+#include "SpServices/Legacy/MultiCameraSensor.h"
 
 struct FHitResult;
 
@@ -75,6 +77,28 @@ CameraAgent::CameraAgent(UWorld* world)
             Config::get<float>("SP_SERVICES.LEGACY.CAMERA_AGENT.CAMERA.FOV"));
         SP_ASSERT(camera_sensor_);
     }
+
+    if (Std::contains(observation_components, "multi_camera")) {
+        auto view_locations = Config::get<std::vector<std::vector<double>>>("SP_SERVICES.LEGACY.CAMERA_AGENT.MULTI_CAMERA.VIEW_LOCATIONS");
+        auto view_rotations = Config::get<std::vector<std::vector<double>>>("SP_SERVICES.LEGACY.CAMERA_AGENT.MULTI_CAMERA.VIEW_ROTATIONS");
+        SP_ASSERT(view_locations.size() == view_rotations.size());
+
+        std::vector<FTransform> view_transforms;
+        for (int i = 0; i < view_locations.size(); i++) {
+            view_transforms.push_back(FTransform(
+                FRotator(Std::at(view_rotations.at(i), 0), Std::at(view_rotations.at(i), 1), Std::at(view_rotations.at(i), 2)),
+                FVector(Std::at(view_locations.at(i), 0), Std::at(view_locations.at(i), 1), Std::at(view_locations.at(i), 2))));
+        }
+
+        multi_camera_sensor_ = std::make_unique<MultiCameraSensor>(
+            camera_actor_->GetCameraComponent(),
+            view_transforms,
+            Config::get<std::vector<std::string>>("SP_SERVICES.LEGACY.CAMERA_AGENT.MULTI_CAMERA.RENDER_PASSES"),
+            Config::get<unsigned int>("SP_SERVICES.LEGACY.CAMERA_AGENT.MULTI_CAMERA.IMAGE_WIDTH"),
+            Config::get<unsigned int>("SP_SERVICES.LEGACY.CAMERA_AGENT.MULTI_CAMERA.IMAGE_HEIGHT"),
+            Config::get<float>("SP_SERVICES.LEGACY.CAMERA_AGENT.MULTI_CAMERA.FOV"));
+        SP_ASSERT(multi_camera_sensor_);
+    }
 }
 
 CameraAgent::~CameraAgent()
@@ -86,6 +110,11 @@ CameraAgent::~CameraAgent()
         camera_sensor_ = nullptr;
     }
 
+    if (Std::contains(observation_components, "multi_camera")) {
+        SP_ASSERT(multi_camera_sensor_);
+        multi_camera_sensor_ = nullptr;
+    }
+
     SP_ASSERT(camera_actor_);
     camera_actor_->Destroy();
     camera_actor_ = nullptr;
@@ -129,12 +158,27 @@ std::map<std::string, ArrayDesc> CameraAgent::getObservationSpace() const
         Std::insert(observation_space, camera_sensor_->getObservationSpace());
     }
 
+    if (Std::contains(observation_components, "multi_camera")) {
+        Std::insert(observation_space, multi_camera_sensor_->getObservationSpace());
+    }
+
     return observation_space;
 }
 
 std::map<std::string, ArrayDesc> CameraAgent::getStepInfoSpace() const
 {
-    return {};
+    std::map<std::string, ArrayDesc> step_info_space;
+    auto observation_components = Config::get<std::vector<std::string>>("SP_SERVICES.LEGACY.CAMERA_AGENT.OBSERVATION_COMPONENTS");
+
+    if (Std::contains(observation_components, "camera")) {
+        Std::insert(step_info_space, camera_sensor_->getStepInfoSpace());
+    }
+
+    if (Std::contains(observation_components, "multi_camera")) {
+        Std::insert(step_info_space, multi_camera_sensor_->getStepInfoSpace());
+    }
+
+    return step_info_space;
 }
 
 void CameraAgent::applyAction(const std::map<std::string, std::vector<uint8_t>>& action)
@@ -164,15 +208,39 @@ std::map<std::string, std::vector<uint8_t>> CameraAgent::getObservation() const
         Std::insert(observation, camera_sensor_->getObservation());
     }
 
+    if (Std::contains(observation_components, "multi_camera")) {
+        Std::insert(observation, multi_camera_sensor_->getObservation());
+    }
+
     return observation;
 }
 
 std::map<std::string, std::vector<uint8_t>> CameraAgent::getStepInfo() const
 {
-    return {};
+    std::map<std::string, std::vector<uint8_t>> step_info;
+    auto observation_components = Config::get<std::vector<std::string>>("SP_SERVICES.LEGACY.CAMERA_AGENT.OBSERVATION_COMPONENTS");
+
+    if (Std::contains(observation_components, "camera")) {
+        Std::insert(step_info, camera_sensor_->getStepInfo());
+    }
+
+    if (Std::contains(observation_components, "multi_camera")) {
+        Std::insert(step_info, multi_camera_sensor_->getStepInfo());
+    }
+
+    return step_info;
 }
 
-void CameraAgent::reset() {}
+void CameraAgent::reset()
+{
+    if (camera_sensor_) {
+        camera_sensor_->reset();
+    }
+
+    if (multi_camera_sensor_) {
+        multi_camera_sensor_->reset();
+    }
+}
 
 bool CameraAgent::isReady() const
 {
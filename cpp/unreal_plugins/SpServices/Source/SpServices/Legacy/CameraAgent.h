@@ -20,6 +20,7 @@ class ACameraActor;
 class UWorld;
 
 class CameraSensor;
+class MultiCameraSensor;
 
 class CameraAgent : public Agent
 {
@@ -46,6 +47,7 @@ private:
     ACameraActor* camera_actor_ = nullptr;
 
     std::unique_ptr<CameraSensor> camera_sensor_;
+    std::unique_ptr<MultiCameraSensor> multi_camera_sensor_;
 
     inline static auto s_class_registration_handler_ = ClassRegistrationUtils::registerClass<CameraAgent>(Agent::s_class_registrar_, "CameraAgent");
 };
@@ -4,45 +4,96 @@
 
 #include "SpServices/Legacy/CameraSensor.h"
 
-#include <stdint.h> // uint8_t
+#include <stdint.h> // int16_t, uint8_t, uint16_t, uint32_t, uint64_t
+#include <string.h> // memcpy, memset
 
-#include <limits>  // std::numeric_limits
+#include <algorithm> // std::max
+#include <atomic>    // std::atomic_ref
+#include <limits>    // std::numeric_limits
+#include <new>       // placement new
 #include <map>
+#include <memory>    // std::make_unique
 #include <string>
-#include <utility> // std::move
+#include <utility>   // std::move
 #include <vector>
 
 #include <Camera/CameraComponent.h>
 #include <Components/SceneCaptureComponent2D.h>
 #include <Engine/TextureRenderTarget2D.h> // ETextureRenderTargetFormat
 #include <GameFramework/Actor.h>
+#include <HAL/Platform.h>                 // int32
 #include <Materials/MaterialInstanceDynamic.h>
+#include <RenderCommandFence.h>
+#include <RenderingThread.h>              // ENQUEUE_RENDER_COMMAND, FlushRenderingCommands
+#include <RHICommandList.h>               // FRHICommandListImmediate
+#include <RHIGPUReadback.h>               // FRHIGPUTextureReadback
+#include <TextureResource.h>              // FTextureRenderTargetResource
 #include <UObject/UObjectGlobals.h>       // LoadObject, NewObject
 
 #include "SpCore/ArrayDesc.h" // TODO: remove
 #include "SpCore/Assert.h"
 #include "SpCore/Boost.h"
 #include "SpCore/Config.h"
+#include "SpCore/Log.h"
+#include "SpCore/PixelKernels.h"
+#include "SpCore/Profiler.h"
+#include "SpCore/SharedMemoryPool.h"
+#include "SpCore/SharedMemoryRegion.h"
 #include "SpCore/Std.h"
 #include "SpCore/Unreal.h"
 
 struct FColor;
 struct FLinearColor;
 
-// Unfortunately, Unreal's ReadPixels functions all assume 4 channels of output. For greater efficiency, we could
-// potentially combine depth and/or world-space position and/or normal data into a single rendering pass. Similarly,
-// we could also combine segmentation data and instance data into a single pass.
-const std::map<std::string, int> RENDER_PASS_NUM_CHANNELS = {
-    {"depth",        4},
-    {"final_color",  4},
-    {"normal",       4},
-    {"segmentation", 4}};
-
-const std::map<std::string, int> RENDER_PASS_NUM_BYTES_PER_CHANNEL = {
-    {"depth",        4},
-    {"final_color",  1},
-    {"normal",       4},
-    {"segmentation", 1}};
+// Unfortunately, Unreal's ReadPixels functions all assume 4 channels of output, and each of our post-process materials
+// writes a single render pass, so each render pass needs its own USceneCaptureComponent2D, and renders the scene once.
+// Combining depth, normal, and segmentation data into a single render pass would require a post-process material that
+// writes all of them into one 4-channel render target, e.g., depth in R, an octahedral-encoded normal in G and B, and
+// the segmentation ID in A. Such a material needs to be authored in the editor, and doesn't exist yet. Packing the
+// outputs of our existing materials after they have been rendered would reduce the number of readbacks, but it
+// wouldn't avoid rendering the scene once per render pass.
+
+// Each render pass can be returned in a more compact format than the 4-channel format of its render target, see
+// SP_SERVICES.LEGACY.CAMERA_SENSOR.RENDER_PASS_FORMATS. In this case, we read the render target into an intermediate
+// buffer, and convert it on the CPU using the SIMD kernels in SpCore/PixelKernels.h before writing it to shared memory.
+// The final_color uint8x3 format is in RGB order, unlike the BGRA render target. For the segmentation render pass,
+// the uint32 format contains the full 24-bit segmentation ID, and the uint8 and uint16 formats contain its lowest 8
+// or 16 bits, i.e., the B and G channels. So the uint8 and uint16 formats are only lossless if all segmentation IDs
+// in the scene are less than 256 or 65536 respectively. Otherwise, different objects can end up with the same ID,
+// so we log a warning the first time we encounter an ID that doesn't fit.
+struct RenderPassFormatDesc
+{
+    int num_channels_ = -1;
+    int num_bytes_per_channel_ = -1;
+    DataType channel_datatype_ = DataType::Invalid;
+    double low_ = 0.0;
+    double high_ = 0.0;
+};
+
+const std::map<std::string, std::string> RENDER_PASS_RENDER_TARGET_FORMAT = {
+    {"depth",        "float32x4"},
+    {"final_color",  "uint8x4"},
+    {"normal",       "float32x4"},
+    {"segmentation", "uint8x4"}};
+
+const std::map<std::string, std::map<std::string, RenderPassFormatDesc>> RENDER_PASS_FORMAT_DESCS = {
+    {"depth", {
+        {"float16",            {1, 2, DataType::Float16,     0.0,                                   std::numeric_limits<double>::max()}},
+        {"float32",            {1, 4, DataType::Float32,     0.0,                                   std::numeric_limits<double>::max()}},
+        {"float32x4",          {4, 4, DataType::Float32,     0.0,                                   std::numeric_limits<double>::max()}}}},
+    {"final_color", {
+        {"uint8x3",            {3, 1, DataType::UInteger8,   0.0,                                   255.0}},
+        {"uint8x4",            {4, 1, DataType::UInteger8,   0.0,                                   255.0}}}},
+    {"normal", {
+        // Unreal can return normals that are not unit length
+        {"float16x3",          {3, 2, DataType::Float16,     std::numeric_limits<double>::lowest(), std::numeric_limits<double>::max()}},
+        {"float32x4",          {4, 4, DataType::Float32,     std::numeric_limits<double>::lowest(), std::numeric_limits<double>::max()}},
+        {"int16x2_octahedral", {2, 2, DataType::Integer16,   -32767.0,                              32767.0}}}},
+    {"segmentation", {
+        {"uint8",              {1, 1, DataType::UInteger8,   0.0,                                   255.0}},
+        {"uint16",             {1, 2, DataType::UInteger16,  0.0,                                   65535.0}},
+        {"uint32",             {1, 4, DataType::UInteger32,  0.0,                                   16777215.0}},
+        {"uint8x4",            {4, 1, DataType::UInteger8,   0.0,                                   255.0}}}}};
 
 const std::map<std::string, ETextureRenderTargetFormat> RENDER_PASS_TEXTURE_RENDER_TARGET_FORMAT = {
     {"depth",        ETextureRenderTargetFormat::RTF_RGBA32f},
@@ -55,110 +106,100 @@ const std::map<std::string, std::string> RENDER_PASS_MATERIAL = {
     {"normal",       "/SpServices/Materials/PPM_Normal.PPM_Normal"},
     {"segmentation", "/SpServices/Materials/PPM_Segmentation.PPM_Segmentation"}};
 
-const std::map<std::string, double> RENDER_PASS_LOW = {
-    {"depth",        0.0},
-    {"final_color",  0.0},
-    {"normal",       std::numeric_limits<double>::lowest()}, // Unreal can return normals that are not unit length
-    {"segmentation", 0.0}};
-
-const std::map<std::string, double> RENDER_PASS_HIGH = {
-    {"depth",        std::numeric_limits<double>::max()},
-    {"final_color",  255.0},
-    {"normal",       std::numeric_limits<double>::max()}, // Unreal can return normals that are not unit length
-    {"segmentation", 255.0}};
+// In async readback mode, i.e., if SP_SERVICES.LEGACY.CAMERA_SENSOR.READBACK_LATENCY is greater than 0, we don't
+// read from each render target directly, because ReadPixels flushes all rendering commands and waits for the GPU.
+// Instead, getObservation() enqueues a GPU copy of each render target into a ring of FRHIGPUTextureReadback objects,
+// and returns the frame that was enqueued READBACK_LATENCY calls ago, which the GPU has most likely finished copying
+// by then. This allows the GPU to render frame N while the CPU simulates frame N+1, at the cost of a fixed latency.
+// The index of the returned frame is reported in the agent's step info as camera.frame_index.
+//
+// An observation must never contain a frame from a previous episode, so reset() discards all frames that have been
+// enqueued so far. The first call to getObservation() after reset() returns the frame it enqueues itself, i.e., it
+// waits for the GPU like READBACK_LATENCY == 0. The next READBACK_LATENCY calls return that same frame again, until
+// enough new frames have been enqueued to return frames with the usual latency. In other words, an observation is
+// at most READBACK_LATENCY frames old, and is never older than the most recent call to reset().
+//
+// Batched sensors, i.e., the views of a MultiCameraSensor, always read through readbacks, even if READBACK_LATENCY
+// is 0. In this case, the ring has a single readback, each observation returns the frame it enqueues itself, and the
+// game thread waits for the GPU once for all views, rather than once per render pass per view in ReadPixels.
 
-const std::map<std::string, DataType> RENDER_PASS_CHANNEL_DATATYPE = {
-    {"depth",        DataType::Float32},
-    {"final_color",  DataType::UInteger8},
-    {"normal",       DataType::Float32},
-    {"segmentation", DataType::UInteger8}};
+// this config value is read once per observation in readRenderPasses(...), so we cache it
+static ConfigValue<bool> s_read_surface_data("SP_SERVICES.LEGACY.CAMERA_SENSOR.READ_SURFACE_DATA");
 
 CameraSensor::CameraSensor(
-    UCameraComponent* camera_component, const std::vector<std::string>& render_pass_names, unsigned int width, unsigned int height, float fov)
+    UCameraComponent* camera_component, const std::vector<std::string>& render_pass_names, unsigned int width, unsigned int height, float fov, bool is_batched)
 {
     SP_ASSERT(camera_component);
 
+    is_batched_ = is_batched;
+    use_shared_memory_ = !is_batched_ && Config::get<bool>("SP_SERVICES.LEGACY.CAMERA_SENSOR.USE_SHARED_MEMORY");
+
     actor_ = camera_component->GetWorld()->SpawnActor<AActor>();
     SP_ASSERT(actor_);
-    
+
+    auto render_pass_formats = Config::get<std::map<std::string, std::string>>("SP_SERVICES.LEGACY.CAMERA_SENSOR.RENDER_PASS_FORMATS");
+
     for (auto& render_pass_name : render_pass_names) {
         RenderPassDesc render_pass_desc;
 
         render_pass_desc.width_ = width;
         render_pass_desc.height_ = height;
-        render_pass_desc.num_bytes_ = height * width * RENDER_PASS_NUM_CHANNELS.at(render_pass_name) * RENDER_PASS_NUM_BYTES_PER_CHANNEL.at(render_pass_name);
-
-        // create TextureRenderTarget2D
-        auto texture_render_target_2d = NewObject<UTextureRenderTarget2D>(actor_, Unreal::toFName("texture_render_target_2d_" + render_pass_name));
-        SP_ASSERT(texture_render_target_2d);
-
-        bool clear_render_target = true;
-        texture_render_target_2d->RenderTargetFormat = RENDER_PASS_TEXTURE_RENDER_TARGET_FORMAT.at(render_pass_name);
-        texture_render_target_2d->InitAutoFormat(width, height);
-        texture_render_target_2d->UpdateResourceImmediate(clear_render_target);
+        render_pass_desc.format_ =
+            Std::containsKey(render_pass_formats, render_pass_name) ? render_pass_formats.at(render_pass_name) : RENDER_PASS_RENDER_TARGET_FORMAT.at(render_pass_name);
+        SP_ASSERT(Std::containsKey(RENDER_PASS_FORMAT_DESCS.at(render_pass_name), render_pass_desc.format_));
+        const RenderPassFormatDesc& format_desc = RENDER_PASS_FORMAT_DESCS.at(render_pass_name).at(render_pass_desc.format_);
+        render_pass_desc.num_bytes_ = height * width * format_desc.num_channels_ * format_desc.num_bytes_per_channel_;
+
+        // if the render pass needs to be converted, allocate an intermediate buffer for the render target data
+        if (render_pass_desc.format_ != RENDER_PASS_RENDER_TARGET_FORMAT.at(render_pass_name)) {
+            const RenderPassFormatDesc& render_target_format_desc =
+                RENDER_PASS_FORMAT_DESCS.at(render_pass_name).at(RENDER_PASS_RENDER_TARGET_FORMAT.at(render_pass_name));
+            Std::insert(render_target_data_, render_pass_name, {});
+            render_target_data_.at(render_pass_name).resize(height * width * render_target_format_desc.num_channels_ * render_target_format_desc.num_bytes_per_channel_);
+        }
 
-        // create SceneCaptureComponent2D
-        render_pass_desc.scene_capture_component_2d_ = 
-            Unreal::createComponentOutsideOwnerConstructor<USceneCaptureComponent2D>(actor_, camera_component, "scene_capture_component_2d_" + render_pass_name);
+        render_pass_desc.scene_capture_component_2d_ = createSceneCaptureComponent2D(camera_component, render_pass_name, width, height, fov);
         SP_ASSERT(render_pass_desc.scene_capture_component_2d_);
-        render_pass_desc.scene_capture_component_2d_->TextureTarget = texture_render_target_2d;
-        render_pass_desc.scene_capture_component_2d_->FOVAngle = fov;
-        render_pass_desc.scene_capture_component_2d_->CaptureSource = ESceneCaptureSource::SCS_FinalToneCurveHDR;
-        render_pass_desc.scene_capture_component_2d_->SetVisibility(true);
-
-        if (render_pass_name == "final_color") {
-            // need to override these settings to obtain the same rendering quality as in a default game viewport
-            render_pass_desc.scene_capture_component_2d_->PostProcessSettings.bOverride_DynamicGlobalIlluminationMethod = true;
-            render_pass_desc.scene_capture_component_2d_->PostProcessSettings.DynamicGlobalIlluminationMethod           = EDynamicGlobalIlluminationMethod::Lumen;
-            render_pass_desc.scene_capture_component_2d_->PostProcessSettings.bOverride_ReflectionMethod = true;
-            render_pass_desc.scene_capture_component_2d_->PostProcessSettings.ReflectionMethod           = EReflectionMethod::Lumen;
-            render_pass_desc.scene_capture_component_2d_->PostProcessSettings.bOverride_LumenSurfaceCacheResolution = true;
-            render_pass_desc.scene_capture_component_2d_->PostProcessSettings.LumenSurfaceCacheResolution           = 1.0f;
-        } else {
-            // TODO (MR): turn off as many rendering features as possible for efficiency
-            auto material = LoadObject<UMaterial>(nullptr, *Unreal::toFString(RENDER_PASS_MATERIAL.at(render_pass_name)));
-            SP_ASSERT(material);
-            render_pass_desc.scene_capture_component_2d_->PostProcessSettings.AddBlendable(UMaterialInstanceDynamic::Create(material, actor_), 1.0f);
-        }
-
-        // create shared_memory_object
-        if (Config::get<bool>("SP_SERVICES.LEGACY.CAMERA_SENSOR.USE_SHARED_MEMORY")) {
-            render_pass_desc.shared_memory_name_ = "camera." + render_pass_name;
-
-            #if BOOST_OS_WINDOWS
-                render_pass_desc.shared_memory_id_ = render_pass_desc.shared_memory_name_; // don't use leading slash on Windows
-                boost::interprocess::windows_shared_memory windows_shared_memory(
-                    boost::interprocess::create_only,
-                    render_pass_desc.shared_memory_id_.c_str(),
-                    boost::interprocess::read_write,
-                    render_pass_desc.num_bytes_);
-                render_pass_desc.shared_memory_mapped_region_ = boost::interprocess::mapped_region(windows_shared_memory, boost::interprocess::read_write);
-            #elif BOOST_OS_MACOS || BOOST_OS_LINUX
-                render_pass_desc.shared_memory_id_ = "/" + render_pass_desc.shared_memory_name_; // use leading slash on macOS and Linux
-                boost::interprocess::shared_memory_object::remove(render_pass_desc.shared_memory_id_.c_str());
-                boost::interprocess::shared_memory_object shared_memory_object(
-                    boost::interprocess::create_only,
-                    render_pass_desc.shared_memory_id_.c_str(),
-                    boost::interprocess::read_write);
-                shared_memory_object.truncate(render_pass_desc.num_bytes_);
-                render_pass_desc.shared_memory_mapped_region_ = boost::interprocess::mapped_region(shared_memory_object, boost::interprocess::read_write);
-            #else
-                #error
-            #endif
+
+        // acquire shared memory region
+        if (use_shared_memory_) {
+            acquireSharedMemory(render_pass_desc);
         }
 
         // update render_pass_descs_
         Std::insert(render_pass_descs_, render_pass_name, std::move(render_pass_desc));
     }
+
+    for (auto& [render_pass_name, render_pass_desc] : render_pass_descs_) {
+        Std::insert(scene_capture_components_2d_, render_pass_name, render_pass_desc.scene_capture_component_2d_);
+    }
+
+    // create readbacks
+    readback_latency_ = Config::get<int>("SP_SERVICES.LEGACY.CAMERA_SENSOR.READBACK_LATENCY");
+    SP_ASSERT(readback_latency_ >= 0);
+    use_readbacks_ = readback_latency_ > 0 || is_batched_;
+    if (use_readbacks_) {
+        for (auto& [readback_name, scene_capture_component_2d] : scene_capture_components_2d_) {
+            std::vector<std::unique_ptr<FRHIGPUTextureReadback>> readbacks;
+            for (int i = 0; i < readback_latency_ + 1; i++) {
+                readbacks.push_back(std::make_unique<FRHIGPUTextureReadback>(Unreal::toFName("camera_sensor_readback_" + readback_name)));
+            }
+            Std::insert(readbacks_, readback_name, std::move(readbacks));
+        }
+    }
 }
 
 CameraSensor::~CameraSensor()
 {
-    for (auto& [render_pass_name, render_pass_desc] : render_pass_descs_) {
-        if (Config::get<bool>("SP_SERVICES.LEGACY.CAMERA_SENSOR.USE_SHARED_MEMORY")) {
-            #if BOOST_OS_MACOS || BOOST_OS_LINUX
-                boost::interprocess::shared_memory_object::remove(render_pass_desc.shared_memory_id_.c_str());
-            #endif
+    // the render thread might still refer to our readbacks
+    if (use_readbacks_) {
+        FlushRenderingCommands();
+        readbacks_.clear();
+    }
+
+    if (use_shared_memory_) {
+        for (auto& [render_pass_name, render_pass_desc] : render_pass_descs_) {
+            releaseSharedMemory(render_pass_desc);
         }
     }
 
@@ -167,62 +208,451 @@ CameraSensor::~CameraSensor()
     actor_ = nullptr;
 }
 
+USceneCaptureComponent2D* CameraSensor::createSceneCaptureComponent2D(
+    UCameraComponent* camera_component, const std::string& render_pass_name, unsigned int width, unsigned int height, float fov)
+{
+    // create TextureRenderTarget2D
+    auto texture_render_target_2d = NewObject<UTextureRenderTarget2D>(actor_, Unreal::toFName("texture_render_target_2d_" + render_pass_name));
+    SP_ASSERT(texture_render_target_2d);
+
+    bool clear_render_target = true;
+    texture_render_target_2d->RenderTargetFormat = RENDER_PASS_TEXTURE_RENDER_TARGET_FORMAT.at(render_pass_name);
+    texture_render_target_2d->InitAutoFormat(width, height);
+    texture_render_target_2d->UpdateResourceImmediate(clear_render_target);
+
+    // create SceneCaptureComponent2D
+    auto scene_capture_component_2d =
+        Unreal::createComponentOutsideOwnerConstructor<USceneCaptureComponent2D>(actor_, camera_component, "scene_capture_component_2d_" + render_pass_name);
+    SP_ASSERT(scene_capture_component_2d);
+    scene_capture_component_2d->TextureTarget = texture_render_target_2d;
+    scene_capture_component_2d->FOVAngle = fov;
+    scene_capture_component_2d->CaptureSource = ESceneCaptureSource::SCS_FinalToneCurveHDR;
+    scene_capture_component_2d->SetVisibility(true);
+
+    // batched sensors are captured explicitly in captureScene()
+    if (is_batched_) {
+        scene_capture_component_2d->bCaptureEveryFrame = false;
+        scene_capture_component_2d->bCaptureOnMovement = false;
+    }
+
+    if (render_pass_name == "final_color") {
+        // need to override these settings to obtain the same rendering quality as in a default game viewport
+        scene_capture_component_2d->PostProcessSettings.bOverride_DynamicGlobalIlluminationMethod = true;
+        scene_capture_component_2d->PostProcessSettings.DynamicGlobalIlluminationMethod           = EDynamicGlobalIlluminationMethod::Lumen;
+        scene_capture_component_2d->PostProcessSettings.bOverride_ReflectionMethod = true;
+        scene_capture_component_2d->PostProcessSettings.ReflectionMethod           = EReflectionMethod::Lumen;
+        scene_capture_component_2d->PostProcessSettings.bOverride_LumenSurfaceCacheResolution = true;
+        scene_capture_component_2d->PostProcessSettings.LumenSurfaceCacheResolution           = 1.0f;
+    } else {
+        // TODO (MR): turn off as many rendering features as possible for efficiency
+        auto material = LoadObject<UMaterial>(nullptr, *Unreal::toFString(RENDER_PASS_MATERIAL.at(render_pass_name)));
+        SP_ASSERT(material);
+        scene_capture_component_2d->PostProcessSettings.AddBlendable(UMaterialInstanceDynamic::Create(material, actor_), 1.0f);
+    }
+
+    return scene_capture_component_2d;
+}
+
 std::map<std::string, ArrayDesc> CameraSensor::getObservationSpace() const
 {
     std::map<std::string, ArrayDesc> observation_space;
 
     for (auto& [render_pass_name, render_pass_desc] : render_pass_descs_) {
+        const RenderPassFormatDesc& format_desc = RENDER_PASS_FORMAT_DESCS.at(render_pass_name).at(render_pass_desc.format_);
         ArrayDesc array_desc;
-        array_desc.low_ = RENDER_PASS_LOW.at(render_pass_name);
-        array_desc.high_ = RENDER_PASS_HIGH.at(render_pass_name);
-        array_desc.shape_ = {render_pass_desc.height_, render_pass_desc.width_, RENDER_PASS_NUM_CHANNELS.at(render_pass_name)};
-        array_desc.datatype_ = RENDER_PASS_CHANNEL_DATATYPE.at(render_pass_name);
-        array_desc.use_shared_memory_ = Config::get<bool>("SP_SERVICES.LEGACY.CAMERA_SENSOR.USE_SHARED_MEMORY");
+        array_desc.low_ = format_desc.low_;
+        array_desc.high_ = format_desc.high_;
+        array_desc.shape_ = {render_pass_desc.height_, render_pass_desc.width_, format_desc.num_channels_};
+        array_desc.datatype_ = format_desc.channel_datatype_;
+        array_desc.use_shared_memory_ = use_shared_memory_;
         array_desc.shared_memory_name_ = render_pass_desc.shared_memory_name_;
+        if (array_desc.use_shared_memory_) {
+            array_desc.shared_memory_num_slots_ = render_pass_desc.shared_memory_num_slots_;
+        }
         Std::insert(observation_space, "camera." + render_pass_name, std::move(array_desc));
     }
 
     return observation_space;
 }
 
+std::map<std::string, ArrayDesc> CameraSensor::getStepInfoSpace() const
+{
+    std::map<std::string, ArrayDesc> step_info_space;
+
+    if (readback_latency_ > 0) {
+        ArrayDesc array_desc;
+        array_desc.low_ = 0.0;
+        array_desc.high_ = std::numeric_limits<uint32_t>::max();
+        array_desc.shape_ = {1};
+        array_desc.datatype_ = DataType::UInteger32;
+        Std::insert(step_info_space, "camera.frame_index", std::move(array_desc));
+    }
+
+    return step_info_space;
+}
+
 std::map<std::string, std::vector<uint8_t>> CameraSensor::getObservation() const
 {
-    std::map<std::string, std::vector<uint8_t>> observation;
+    SP_PROFILE_SCOPE("CameraSensor::getObservation");
 
-    for (auto& [render_pass_name, render_pass_desc] : render_pass_descs_) {
+    std::map<std::string, std::vector<uint8_t>> observation;
+    std::map<std::string, void*> dest_ptrs;
 
-        void* dest_ptr = nullptr;
-        if (Config::get<bool>("SP_SERVICES.LEGACY.CAMERA_SENSOR.USE_SHARED_MEMORY")) {
-            dest_ptr = render_pass_desc.shared_memory_mapped_region_.get_address();
-        } else {
+    // all render passes for this observation are written to the same slot index in their respective ring buffers
+    if (use_shared_memory_) {
+        shared_memory_sequence_++;
+        for (auto& [render_pass_name, render_pass_desc] : render_pass_descs_) {
+            Std::insert(dest_ptrs, render_pass_name, beginSharedMemoryWrite(render_pass_desc, shared_memory_sequence_));
+        }
+    } else {
+        for (auto& [render_pass_name, render_pass_desc] : render_pass_descs_) {
             Std::insert(observation, "camera." + render_pass_name, {});
             observation.at("camera." + render_pass_name).resize(render_pass_desc.num_bytes_);
-            dest_ptr = observation.at("camera." + render_pass_name).data();
-        }
-        SP_ASSERT(dest_ptr);
-
-        if (Config::get<bool>("SP_SERVICES.LEGACY.CAMERA_SENSOR.READ_SURFACE_DATA")) {
-            FTextureRenderTargetResource* texture_render_target_resource =
-                render_pass_desc.scene_capture_component_2d_->TextureTarget->GameThread_GetRenderTargetResource();
-            SP_ASSERT(texture_render_target_resource);
-
-            if (render_pass_name == "final_color" || render_pass_name == "segmentation") {
-                // ReadPixelsPtr assumes 4 channels per pixel, 1 byte per channel, so it can be used to read
-                // the following ETextureRenderTargetFormat formats:
-                //     final_color:  RTF_RGBA8
-                //     segmentation: RTF_RGBA8_SRGB
-                texture_render_target_resource->ReadPixelsPtr(static_cast<FColor*>(dest_ptr));
-            } else if (render_pass_name == "depth" || render_pass_name == "normal") {
-                // ReadLinearColorPixelsPtr assumes 4 channels per pixel, 4 bytes per channel, so it can be used
-                // to read the following ETextureRenderTargetFormat formats:
-                //     depth:  RTF_RGBA32f
-                //     normal: RTF_RGBA32f
-                texture_render_target_resource->ReadLinearColorPixelsPtr(static_cast<FLinearColor*>(dest_ptr));
-            } else {
-                SP_ASSERT(false);
-            }
+            Std::insert(dest_ptrs, render_pass_name, observation.at("camera." + render_pass_name).data());
+        }
+    }
+
+    readRenderPasses(dest_ptrs);
+
+    if (use_shared_memory_) {
+        for (auto& [render_pass_name, render_pass_desc] : render_pass_descs_) {
+            endSharedMemoryWrite(render_pass_desc, shared_memory_sequence_);
         }
     }
 
     return observation;
 }
+
+std::map<std::string, std::vector<uint8_t>> CameraSensor::getStepInfo() const
+{
+    std::map<std::string, std::vector<uint8_t>> step_info;
+
+    if (readback_latency_ > 0) {
+        SP_ASSERT(observation_frame_index_ <= std::numeric_limits<uint32_t>::max());
+        Std::insert(step_info, "camera.frame_index", Std::reinterpretAsVector<uint8_t, uint32_t>({static_cast<uint32_t>(observation_frame_index_)}));
+    }
+
+    return step_info;
+}
+
+void CameraSensor::reset()
+{
+    // frames enqueued before this point belong to the previous episode, see the comment at the top of this file
+    reset_frame_index_ = readback_frame_index_;
+}
+
+void CameraSensor::captureScene() const
+{
+    SP_ASSERT(is_batched_);
+
+    // CaptureScene() enqueues the scene render on the render thread and returns without waiting for it
+    for (auto& [scene_capture_component_2d_name, scene_capture_component_2d] : scene_capture_components_2d_) {
+        scene_capture_component_2d->CaptureScene();
+    }
+}
+
+void CameraSensor::readRenderPasses(const std::map<std::string, void*>& dest_ptrs) const
+{
+    enqueueReadRenderPasses(dest_ptrs);
+    waitForReadRenderPasses();
+    convertRenderPasses(dest_ptrs);
+}
+
+void CameraSensor::enqueueReadRenderPasses(const std::map<std::string, void*>& dest_ptrs) const
+{
+    if (use_readbacks_) {
+        enqueueReadbacks();
+    }
+
+    if (!s_read_surface_data.get()) {
+        return;
+    }
+
+    for (auto& [render_pass_name, render_pass_desc] : render_pass_descs_) {
+        // if the render pass needs to be converted, we read the render target into an intermediate buffer
+        void* render_target_data_ptr = getRenderTargetDataPtr(render_pass_name, dest_ptrs);
+
+        if (use_readbacks_) {
+            const RenderPassFormatDesc& render_target_format_desc =
+                RENDER_PASS_FORMAT_DESCS.at(render_pass_name).at(RENDER_PASS_RENDER_TARGET_FORMAT.at(render_pass_name));
+            int num_bytes_per_pixel = render_target_format_desc.num_channels_ * render_target_format_desc.num_bytes_per_channel_;
+            readReadback(render_pass_name, render_target_data_ptr, render_pass_desc.width_, render_pass_desc.height_, num_bytes_per_pixel);
+        } else {
+            readSurfaceData(render_pass_desc.scene_capture_component_2d_, render_target_data_ptr);
+        }
+    }
+}
+
+void CameraSensor::waitForReadRenderPasses() const
+{
+    // readSurfaceData(...) is synchronous, so there is nothing to wait for
+    if (!use_readbacks_) {
+        return;
+    }
+
+    // readReadback(...) only enqueues render commands, so we wait for the render thread to execute all of them at once,
+    // rather than waiting once per render pass
+    FRenderCommandFence render_command_fence;
+    render_command_fence.BeginFence();
+    render_command_fence.Wait();
+}
+
+void CameraSensor::convertRenderPasses(const std::map<std::string, void*>& dest_ptrs) const
+{
+    if (!s_read_surface_data.get()) {
+        return;
+    }
+
+    for (auto& [render_pass_name, render_pass_desc] : render_pass_descs_) {
+        if (Std::containsKey(render_target_data_, render_pass_name)) {
+            convertRenderPass(render_pass_name, getRenderTargetDataPtr(render_pass_name, dest_ptrs), dest_ptrs.at(render_pass_name));
+        }
+    }
+}
+
+void* CameraSensor::getRenderTargetDataPtr(const std::string& render_pass_name, const std::map<std::string, void*>& dest_ptrs) const
+{
+    void* dest_ptr = dest_ptrs.at(render_pass_name);
+    SP_ASSERT(dest_ptr);
+    return Std::containsKey(render_target_data_, render_pass_name) ? render_target_data_.at(render_pass_name).data() : dest_ptr;
+}
+
+void CameraSensor::acquireSharedMemory(RenderPassDesc& render_pass_desc)
+{
+    SP_ASSERT(render_pass_desc.num_bytes_ > 0);
+
+    // Each render pass is written into a ring buffer of slots, so the engine can write ahead while the
+    // client is still reading older observations. See ArrayDesc.h for details on the memory layout.
+    render_pass_desc.shared_memory_num_slots_ = Config::get<int>("SP_SERVICES.LEGACY.CAMERA_SENSOR.SHARED_MEMORY_NUM_SLOTS");
+    SP_ASSERT(render_pass_desc.shared_memory_num_slots_ > 0);
+    uint64_t slot_num_data_bytes =
+        ((render_pass_desc.num_bytes_ + k_shared_memory_ring_buffer_alignment - 1) / k_shared_memory_ring_buffer_alignment) * k_shared_memory_ring_buffer_alignment;
+    render_pass_desc.shared_memory_slot_num_bytes_ = sizeof(SharedMemoryRingBufferSlotHeader) + slot_num_data_bytes;
+    uint64_t shared_memory_num_bytes =
+        sizeof(SharedMemoryRingBufferHeader) + render_pass_desc.shared_memory_num_slots_*render_pass_desc.shared_memory_slot_num_bytes_;
+
+    // the region might be larger than shared_memory_num_bytes, because the pool rounds up to a size class
+    render_pass_desc.shared_memory_region_ = SharedMemoryPool::acquire(shared_memory_num_bytes);
+    SP_ASSERT(render_pass_desc.shared_memory_region_);
+    render_pass_desc.shared_memory_view_ = render_pass_desc.shared_memory_region_->getView();
+
+    #if BOOST_OS_WINDOWS
+        render_pass_desc.shared_memory_name_ = render_pass_desc.shared_memory_view_.id_;
+    #elif BOOST_OS_MACOS || BOOST_OS_LINUX
+        // Python's SharedMemory class expects a name without a leading slash on macOS and Linux
+        SP_ASSERT(render_pass_desc.shared_memory_view_.id_.starts_with("/"));
+        render_pass_desc.shared_memory_name_ = render_pass_desc.shared_memory_view_.id_.substr(1);
+    #else
+        #error
+    #endif
+
+    // initialize ring buffer header and slot headers
+    uint8_t* shared_memory_ptr = static_cast<uint8_t*>(render_pass_desc.shared_memory_view_.data_);
+    SP_ASSERT(shared_memory_ptr);
+    SharedMemoryRingBufferHeader* header = new(shared_memory_ptr) SharedMemoryRingBufferHeader();
+    header->num_slots_ = render_pass_desc.shared_memory_num_slots_;
+    header->slot_num_bytes_ = render_pass_desc.shared_memory_slot_num_bytes_;
+    for (int i = 0; i < render_pass_desc.shared_memory_num_slots_; i++) {
+        new(shared_memory_ptr + sizeof(SharedMemoryRingBufferHeader) + i*render_pass_desc.shared_memory_slot_num_bytes_) SharedMemoryRingBufferSlotHeader();
+    }
+}
+
+void CameraSensor::releaseSharedMemory(RenderPassDesc& render_pass_desc)
+{
+    SP_ASSERT(render_pass_desc.shared_memory_region_);
+    SharedMemoryPool::release(std::move(render_pass_desc.shared_memory_region_));
+}
+
+void* CameraSensor::beginSharedMemoryWrite(const RenderPassDesc& render_pass_desc, uint64_t sequence)
+{
+    SP_ASSERT(sequence > 0);
+
+    uint8_t* shared_memory_ptr = static_cast<uint8_t*>(render_pass_desc.shared_memory_view_.data_);
+    SP_ASSERT(shared_memory_ptr);
+    int slot_index = (sequence - 1) % render_pass_desc.shared_memory_num_slots_;
+    uint8_t* slot_ptr = shared_memory_ptr + sizeof(SharedMemoryRingBufferHeader) + slot_index*render_pass_desc.shared_memory_slot_num_bytes_;
+
+    // mark the slot as being written
+    SharedMemoryRingBufferSlotHeader* slot_header = reinterpret_cast<SharedMemoryRingBufferSlotHeader*>(slot_ptr);
+    std::atomic_ref<uint64_t>(slot_header->sequence_).store(0, std::memory_order_release);
+
+    return slot_ptr + sizeof(SharedMemoryRingBufferSlotHeader);
+}
+
+void CameraSensor::endSharedMemoryWrite(const RenderPassDesc& render_pass_desc, uint64_t sequence)
+{
+    SP_ASSERT(sequence > 0);
+
+    uint8_t* shared_memory_ptr = static_cast<uint8_t*>(render_pass_desc.shared_memory_view_.data_);
+    SP_ASSERT(shared_memory_ptr);
+    int slot_index = (sequence - 1) % render_pass_desc.shared_memory_num_slots_;
+    uint8_t* slot_ptr = shared_memory_ptr + sizeof(SharedMemoryRingBufferHeader) + slot_index*render_pass_desc.shared_memory_slot_num_bytes_;
+
+    // publish the slot
+    SharedMemoryRingBufferHeader* header = reinterpret_cast<SharedMemoryRingBufferHeader*>(shared_memory_ptr);
+    SharedMemoryRingBufferSlotHeader* slot_header = reinterpret_cast<SharedMemoryRingBufferSlotHeader*>(slot_ptr);
+    std::atomic_ref<uint64_t>(slot_header->sequence_).store(sequence, std::memory_order_release);
+    std::atomic_ref<uint64_t>(header->latest_sequence_).store(sequence, std::memory_order_release);
+}
+
+void CameraSensor::readSurfaceData(USceneCaptureComponent2D* scene_capture_component_2d, void* dest_ptr) const
+{
+    SP_PROFILE_SCOPE("CameraSensor::readSurfaceData");
+
+    SP_ASSERT(scene_capture_component_2d);
+    SP_ASSERT(dest_ptr);
+
+    FTextureRenderTargetResource* texture_render_target_resource = scene_capture_component_2d->TextureTarget->GameThread_GetRenderTargetResource();
+    SP_ASSERT(texture_render_target_resource);
+
+    ETextureRenderTargetFormat texture_render_target_format = scene_capture_component_2d->TextureTarget->RenderTargetFormat;
+    if (texture_render_target_format == ETextureRenderTargetFormat::RTF_RGBA8 || texture_render_target_format == ETextureRenderTargetFormat::RTF_RGBA8_SRGB) {
+        // ReadPixelsPtr assumes 4 channels per pixel, 1 byte per channel, so it can be used to read
+        // the following ETextureRenderTargetFormat formats:
+        //     final_color:  RTF_RGBA8_SRGB
+        //     segmentation: RTF_RGBA8
+        texture_render_target_resource->ReadPixelsPtr(static_cast<FColor*>(dest_ptr));
+    } else if (texture_render_target_format == ETextureRenderTargetFormat::RTF_RGBA32f) {
+        // ReadLinearColorPixelsPtr assumes 4 channels per pixel, 4 bytes per channel, so it can be used
+        // to read the following ETextureRenderTargetFormat formats:
+        //     depth:  RTF_RGBA32f
+        //     normal: RTF_RGBA32f
+        texture_render_target_resource->ReadLinearColorPixelsPtr(static_cast<FLinearColor*>(dest_ptr));
+    } else {
+        SP_ASSERT(false);
+    }
+}
+
+void CameraSensor::enqueueReadbacks() const
+{
+    int slot_index = readback_frame_index_ % (readback_latency_ + 1);
+
+    for (auto& [readback_name, scene_capture_component_2d] : scene_capture_components_2d_) {
+        FTextureRenderTargetResource* texture_render_target_resource = scene_capture_component_2d->TextureTarget->GameThread_GetRenderTargetResource();
+        SP_ASSERT(texture_render_target_resource);
+        FRHIGPUTextureReadback* readback = readbacks_.at(readback_name).at(slot_index).get();
+        SP_ASSERT(readback);
+
+        ENQUEUE_RENDER_COMMAND(CameraSensorEnqueueCopy)([texture_render_target_resource, readback](FRHICommandListImmediate& rhi_command_list) {
+            readback->EnqueueCopy(rhi_command_list, texture_render_target_resource->GetRenderTargetTexture());
+        });
+    }
+
+    // until readback_latency_ frames have been enqueued since the most recent call to reset(), we return the oldest
+    // frame that was enqueued since then
+    observation_frame_index_ = std::max(readback_frame_index_, reset_frame_index_ + readback_latency_) - readback_latency_;
+    readback_frame_index_++;
+}
+
+void CameraSensor::readReadback(const std::string& readback_name, void* dest_ptr, int width, int height, int num_bytes_per_pixel) const
+{
+    SP_PROFILE_SCOPE("CameraSensor::readReadback");
+
+    SP_ASSERT(dest_ptr);
+
+    FRHIGPUTextureReadback* readback = readbacks_.at(readback_name).at(observation_frame_index_ % (readback_latency_ + 1)).get();
+    SP_ASSERT(readback);
+
+    // Lock(...) must be called on the render thread. Our caller waits for the render thread to execute the command
+    // below, see waitForReadRenderPasses(), but that doesn't wait for the GPU to finish copying. The GPU has most likely
+    // finished copying the requested frame, but if it hasn't, e.g., for the first frame after reset(), then we
+    // explicitly wait for it, because calling Lock(...) on a readback that isn't ready is not guaranteed to block.
+    ENQUEUE_RENDER_COMMAND(CameraSensorReadReadback)([readback, dest_ptr, width, height, num_bytes_per_pixel](FRHICommandListImmediate& rhi_command_list) {
+        uint8_t* dest = static_cast<uint8_t*>(dest_ptr);
+        uint64_t dest_row_num_bytes = width * num_bytes_per_pixel;
+
+        if (!readback->IsReady()) {
+            rhi_command_list.BlockUntilGPUIdle();
+        }
+
+        int32 src_row_pitch_in_pixels = 0;
+        uint8_t* src = readback->IsReady() ? static_cast<uint8_t*>(readback->Lock(src_row_pitch_in_pixels)) : nullptr;
+
+        // the null RHI doesn't return any data, so we return zeros, and we also return zeros if the readback still isn't
+        // ready, which we don't expect to happen after waiting for the GPU
+        if (src) {
+            uint64_t src_row_num_bytes = src_row_pitch_in_pixels * num_bytes_per_pixel;
+            for (int i = 0; i < height; i++) {
+                memcpy(dest + i*dest_row_num_bytes, src + i*src_row_num_bytes, dest_row_num_bytes);
+            }
+            readback->Unlock();
+        } else {
+            memset(dest, 0, height*dest_row_num_bytes);
+        }
+    });
+}
+
+void CameraSensor::convertRenderPass(const std::string& render_pass_name, void* src_ptr, void* dest_ptr) const
+{
+    SP_PROFILE_SCOPE("CameraSensor::convertRenderPass");
+
+    const RenderPassDesc& render_pass_desc = render_pass_descs_.at(render_pass_name);
+    uint64_t num_pixels = render_pass_desc.width_ * render_pass_desc.height_;
+
+    // src_ptr points to the intermediate buffer for this render pass, so we can use it as scratch space
+    if (render_pass_name == "depth") {
+        float* src = static_cast<float*>(src_ptr);
+        if (render_pass_desc.format_ == "float16") {
+            PixelKernels::rgba32fToR32f(src, src, num_pixels);
+            PixelKernels::float32ToFloat16(src, static_cast<uint16_t*>(dest_ptr), num_pixels);
+        } else if (render_pass_desc.format_ == "float32") {
+            PixelKernels::rgba32fToR32f(src, static_cast<float*>(dest_ptr), num_pixels);
+        } else {
+            SP_ASSERT(false);
+        }
+
+    } else if (render_pass_name == "final_color") {
+        // the final_color render pass is returned as BGRA
+        const uint8_t* src = static_cast<const uint8_t*>(src_ptr);
+        if (render_pass_desc.format_ == "uint8x3") {
+            PixelKernels::bgra8ToRgb8(src, static_cast<uint8_t*>(dest_ptr), num_pixels);
+        } else {
+            SP_ASSERT(false);
+        }
+
+    } else if (render_pass_name == "normal") {
+        float* src = static_cast<float*>(src_ptr);
+        if (render_pass_desc.format_ == "float16x3") {
+            PixelKernels::rgba32fToRgb32f(src, src, num_pixels);
+            PixelKernels::float32ToFloat16(src, static_cast<uint16_t*>(dest_ptr), 3*num_pixels);
+        } else if (render_pass_desc.format_ == "int16x2_octahedral") {
+            PixelKernels::rgba32fToOctahedral16(src, static_cast<int16_t*>(dest_ptr), num_pixels);
+        } else {
+            SP_ASSERT(false);
+        }
+
+    } else if (render_pass_name == "segmentation") {
+        // the segmentation render pass is returned as BGRA, so we decode the segmentation ID in-place before
+        // truncating it to the requested number of bits
+        uint32_t* src = static_cast<uint32_t*>(src_ptr);
+        PixelKernels::bgra8ToSegmentationId(static_cast<const uint8_t*>(src_ptr), src, num_pixels);
+        uint32_t truncated_bits = 0; // the bitwise OR of all bits that don't fit in the requested format
+        if (render_pass_desc.format_ == "uint8") {
+            uint8_t* dest = static_cast<uint8_t*>(dest_ptr);
+            for (uint64_t i = 0; i < num_pixels; i++) {
+                truncated_bits |= src[i] & ~static_cast<uint32_t>(std::numeric_limits<uint8_t>::max());
+                dest[i] = static_cast<uint8_t>(src[i]);
+            }
+        } else if (render_pass_desc.format_ == "uint16") {
+            uint16_t* dest = static_cast<uint16_t*>(dest_ptr);
+            for (uint64_t i = 0; i < num_pixels; i++) {
+                truncated_bits |= src[i] & ~static_cast<uint32_t>(std::numeric_limits<uint16_t>::max());
+                dest[i] = static_cast<uint16_t>(src[i]);
+            }
+        } else if (render_pass_desc.format_ == "uint32") {
+            memcpy(dest_ptr, src, num_pixels*sizeof(uint32_t));
+        } else {
+            SP_ASSERT(false);
+        }
+
+        if (truncated_bits && !segmentation_id_truncation_logged_) {
+            SP_LOG(
+                "WARNING: Segmentation IDs don't fit in the ", render_pass_desc.format_, " format, so different objects might have the same ID. ",
+                "Set SP_SERVICES.LEGACY.CAMERA_SENSOR.RENDER_PASS_FORMATS.segmentation to \"uint32\" to return the full 24-bit ID.");
+            segmentation_id_truncation_logged_ = true;
+        }
+
+    } else {
+        SP_ASSERT(false);
+    }
+}
@@ -4,16 +4,18 @@
 
 #pragma once
 
-#include <stdint.h> // uint8_t
+#include <stdint.h> // uint8_t, uint64_t
 
 #include <map>
+#include <memory> // std::unique_ptr
 #include <string>
 #include <vector>
 
 #include "SpCore/ArrayDesc.h" // TODO: remove
-#include "SpCore/Boost.h"
+#include "SpCore/SharedMemoryRegion.h"
 
 class AActor;
+class FRHIGPUTextureReadback;
 class UCameraComponent;
 class USceneCaptureComponent2D;
 
@@ -25,27 +27,85 @@ struct RenderPassDesc
     int width_ = -1;
     int height_ = -1;
     int num_bytes_ = -1;
+    std::string format_; // see SP_SERVICES.LEGACY.CAMERA_SENSOR.RENDER_PASS_FORMATS
 
     // only used if SIMULATION_CONTROLLER.CAMERA_SENSOR.USE_SHARED_MEMORY is set to True
     std::string shared_memory_name_; // externally visible name
-    std::string shared_memory_id_;   // ID used to manage the shared memory resource internally
-    boost::interprocess::mapped_region shared_memory_mapped_region_;
+    std::unique_ptr<SharedMemoryRegion> shared_memory_region_ = nullptr; // acquired from SharedMemoryPool
+    SharedMemoryView shared_memory_view_;
+    int shared_memory_num_slots_ = -1;
+    uint64_t shared_memory_slot_num_bytes_ = 0;
 };
 
 class CameraSensor
 {
 public:
     CameraSensor() = delete;
-    CameraSensor(UCameraComponent* camera_component, const std::vector<std::string>& render_pass_names, unsigned int width, unsigned int height, float fov);
+    CameraSensor(
+        UCameraComponent* camera_component, const std::vector<std::string>& render_pass_names, unsigned int width, unsigned int height, float fov, bool is_batched = false);
     ~CameraSensor();
 
     // Used by Agents.
     std::map<std::string, ArrayDesc> getObservationSpace() const;
+    std::map<std::string, ArrayDesc> getStepInfoSpace() const;
     std::map<std::string, std::vector<uint8_t>> getObservation() const;
+    std::map<std::string, std::vector<uint8_t>> getStepInfo() const;
+
+    // Used by Agents. Must be called when the agent is reset, so getObservation() doesn't return a frame from the
+    // previous episode if SP_SERVICES.LEGACY.CAMERA_SENSOR.READBACK_LATENCY is greater than 0.
+    void reset();
+
+    // Used by MultiCameraSensor. A batched CameraSensor doesn't capture the scene every frame and doesn't acquire
+    // shared memory. Instead, its owner calls captureScene() on each of its batched CameraSensors before reading
+    // any of them, so the scene captures for all views are enqueued together, and written to memory that is owned
+    // by the caller. readRenderPasses(...) is equivalent to calling enqueueReadRenderPasses(...),
+    // waitForReadRenderPasses(), and convertRenderPasses(...). waitForReadRenderPasses() waits for all pending render
+    // commands, so the owner of several CameraSensors with the same readback latency can call
+    // enqueueReadRenderPasses(...) on each of them before calling waitForReadRenderPasses() on any one of them.
+    void captureScene() const;
+    void readRenderPasses(const std::map<std::string, void*>& dest_ptrs) const;
+    void enqueueReadRenderPasses(const std::map<std::string, void*>& dest_ptrs) const;
+    void waitForReadRenderPasses() const;
+    void convertRenderPasses(const std::map<std::string, void*>& dest_ptrs) const;
+
+    // Used by MultiCameraSensor to manage shared memory ring buffers, see ArrayDesc.h for details on the memory
+    // layout. beginSharedMemoryWrite(...) returns a pointer to the slot for the given sequence number.
+    static void acquireSharedMemory(RenderPassDesc& render_pass_desc);
+    static void releaseSharedMemory(RenderPassDesc& render_pass_desc);
+    static void* beginSharedMemoryWrite(const RenderPassDesc& render_pass_desc, uint64_t sequence);
+    static void endSharedMemoryWrite(const RenderPassDesc& render_pass_desc, uint64_t sequence);
 
     // Unreal resources for each render pass are public in case they need to be modified by user code.
     std::map<std::string, RenderPassDesc> render_pass_descs_;
 
 private:
+    USceneCaptureComponent2D* createSceneCaptureComponent2D(
+        UCameraComponent* camera_component, const std::string& render_pass_name, unsigned int width, unsigned int height, float fov);
+    void convertRenderPass(const std::string& render_pass_name, void* src_ptr, void* dest_ptr) const;
+    void* getRenderTargetDataPtr(const std::string& render_pass_name, const std::map<std::string, void*>& dest_ptrs) const;
+    void readSurfaceData(USceneCaptureComponent2D* scene_capture_component_2d, void* dest_ptr) const;
+    void enqueueReadbacks() const;
+    void readReadback(const std::string& readback_name, void* dest_ptr, int width, int height, int num_bytes_per_pixel) const;
+
     AActor* actor_ = nullptr;
+    bool is_batched_ = false;
+    bool use_shared_memory_ = false;
+
+    // one entry per render pass
+    std::map<std::string, USceneCaptureComponent2D*> scene_capture_components_2d_;
+
+    // only used for render passes whose format is different from the format of their render target
+    mutable std::map<std::string, std::vector<uint8_t>> render_target_data_;
+    mutable bool segmentation_id_truncation_logged_ = false; // we only log a warning once per sensor
+
+    // only used if SP_SERVICES.LEGACY.CAMERA_SENSOR.READBACK_LATENCY is greater than 0, or if the sensor is batched
+    int readback_latency_ = 0;
+    bool use_readbacks_ = false;
+    std::map<std::string, std::vector<std::unique_ptr<FRHIGPUTextureReadback>>> readbacks_; // ring of readback_latency_+1 readbacks per entry in scene_capture_components_2d_
+    mutable uint64_t readback_frame_index_ = 0; // index of the next frame to be enqueued
+    mutable uint64_t observation_frame_index_ = 0; // index of the frame returned by the most recent call to getObservation()
+    uint64_t reset_frame_index_ = 0; // index of the first frame enqueued after the most recent call to reset()
+
+    // sequence number of the most recent observation written to shared memory, shared by all render passes
+    mutable uint64_t shared_memory_sequence_ = 0;
 };
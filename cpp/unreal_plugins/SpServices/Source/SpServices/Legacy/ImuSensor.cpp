@@ -32,6 +32,9 @@
 
 struct FActorComponentTickFunction;
 
+// DEBUG_RENDER is read in our tick callback, so we cache it
+static ConfigValue<bool> s_debug_render("SP_SERVICES.LEGACY.IMU_SENSOR.DEBUG_RENDER");
+
 ImuSensor::ImuSensor(UPrimitiveComponent* primitive_component)
 {
     SP_ASSERT(primitive_component);
@@ -63,7 +66,7 @@ ImuSensor::ImuSensor(UPrimitiveComponent* primitive_component)
         angular_velocity_body_ = primitive_component_->GetComponentTransform().GetRotation().UnrotateVector(component_angular_velocity_world);
 
         // Debug render
-        if (Config::get<bool>("SP_SERVICES.LEGACY.IMU_SENSOR.DEBUG_RENDER")) {
+        if (s_debug_render.get()) {
             UWorld* world = primitive_component_->GetWorld();
             FTransform transform = primitive_component_->GetComponentTransform();
             FRotator rotation = transform.Rotator();
@@ -0,0 +1,196 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#include "SpServices/Legacy/MultiCameraSensor.h"
+
+#include <stdint.h> // uint8_t, uint64_t
+
+#include <map>
+#include <memory>  // std::make_unique
+#include <string>
+#include <utility> // std::move
+#include <vector>
+
+#include <Camera/CameraComponent.h>
+#include <Engine/World.h>
+#include <GameFramework/Actor.h>
+#include <Math/Transform.h>
+
+#include "SpCore/ArrayDesc.h" // TODO: remove
+#include "SpCore/Assert.h"
+#include "SpCore/Config.h"
+#include "SpCore/Profiler.h"
+#include "SpCore/Std.h"
+#include "SpCore/Unreal.h"
+
+#include "SpServices/Legacy/CameraSensor.h"
+
+MultiCameraSensor::MultiCameraSensor(
+    UCameraComponent* camera_component,
+    const std::vector<FTransform>& view_transforms,
+    const std::vector<std::string>& render_pass_names,
+    unsigned int width,
+    unsigned int height,
+    float fov)
+{
+    SP_ASSERT(camera_component);
+    SP_ASSERT(!view_transforms.empty());
+
+    actor_ = camera_component->GetWorld()->SpawnActor<AActor>();
+    SP_ASSERT(actor_);
+
+    for (int i = 0; i < view_transforms.size(); i++) {
+        UCameraComponent* view_camera_component =
+            Unreal::createComponentOutsideOwnerConstructor<UCameraComponent>(actor_, camera_component, "camera_component_" + std::to_string(i));
+        SP_ASSERT(view_camera_component);
+        view_camera_component->SetRelativeTransform(view_transforms.at(i));
+        view_camera_component->FieldOfView = fov;
+        view_camera_component->AspectRatio = static_cast<float>(width) / static_cast<float>(height);
+        camera_components_.push_back(view_camera_component);
+
+        bool is_batched = true;
+        auto camera_sensor = std::make_unique<CameraSensor>(view_camera_component, render_pass_names, width, height, fov, is_batched);
+        SP_ASSERT(camera_sensor);
+        camera_sensors_.push_back(std::move(camera_sensor));
+    }
+
+    use_shared_memory_ = Config::get<bool>("SP_SERVICES.LEGACY.CAMERA_SENSOR.USE_SHARED_MEMORY");
+
+    // all views have the same layout, so the data for each render pass is num_views times the data for a single view
+    for (auto& [render_pass_name, view_render_pass_desc] : camera_sensors_.at(0)->render_pass_descs_) {
+        RenderPassDesc render_pass_desc;
+        render_pass_desc.width_ = view_render_pass_desc.width_;
+        render_pass_desc.height_ = view_render_pass_desc.height_;
+        render_pass_desc.num_bytes_ = camera_sensors_.size() * view_render_pass_desc.num_bytes_;
+        render_pass_desc.format_ = view_render_pass_desc.format_;
+
+        if (use_shared_memory_) {
+            CameraSensor::acquireSharedMemory(render_pass_desc);
+        }
+
+        Std::insert(render_pass_descs_, render_pass_name, std::move(render_pass_desc));
+    }
+}
+
+MultiCameraSensor::~MultiCameraSensor()
+{
+    if (use_shared_memory_) {
+        for (auto& [render_pass_name, render_pass_desc] : render_pass_descs_) {
+            CameraSensor::releaseSharedMemory(render_pass_desc);
+        }
+    }
+    render_pass_descs_.clear();
+
+    camera_sensors_.clear();
+    camera_components_.clear();
+
+    SP_ASSERT(actor_);
+    actor_->Destroy();
+    actor_ = nullptr;
+}
+
+std::map<std::string, ArrayDesc> MultiCameraSensor::getObservationSpace() const
+{
+    std::map<std::string, ArrayDesc> observation_space;
+
+    // prepend the number of views to the shape of each render pass
+    std::map<std::string, ArrayDesc> view_observation_space = camera_sensors_.at(0)->getObservationSpace();
+    for (auto& [render_pass_name, render_pass_desc] : render_pass_descs_) {
+        ArrayDesc array_desc = view_observation_space.at("camera." + render_pass_name);
+        array_desc.shape_.insert(array_desc.shape_.begin(), static_cast<int64_t>(camera_sensors_.size()));
+        array_desc.use_shared_memory_ = use_shared_memory_;
+        array_desc.shared_memory_name_ = render_pass_desc.shared_memory_name_;
+        if (array_desc.use_shared_memory_) {
+            array_desc.shared_memory_num_slots_ = render_pass_desc.shared_memory_num_slots_;
+        }
+        Std::insert(observation_space, "multi_camera." + render_pass_name, std::move(array_desc));
+    }
+
+    return observation_space;
+}
+
+std::map<std::string, ArrayDesc> MultiCameraSensor::getStepInfoSpace() const
+{
+    std::map<std::string, ArrayDesc> step_info_space;
+
+    // all views are captured and read back together, so they all report the same step info
+    for (auto& [name, array_desc] : camera_sensors_.at(0)->getStepInfoSpace()) {
+        SP_ASSERT(name.starts_with("camera."));
+        Std::insert(step_info_space, "multi_" + name, array_desc);
+    }
+
+    return step_info_space;
+}
+
+std::map<std::string, std::vector<uint8_t>> MultiCameraSensor::getObservation() const
+{
+    SP_PROFILE_SCOPE("MultiCameraSensor::getObservation");
+
+    std::map<std::string, std::vector<uint8_t>> observation;
+    std::map<std::string, uint8_t*> dest_ptrs;
+
+    // all render passes for this observation are written to the same slot index in their respective ring buffers
+    if (use_shared_memory_) {
+        shared_memory_sequence_++;
+        for (auto& [render_pass_name, render_pass_desc] : render_pass_descs_) {
+            Std::insert(dest_ptrs, render_pass_name, static_cast<uint8_t*>(CameraSensor::beginSharedMemoryWrite(render_pass_desc, shared_memory_sequence_)));
+        }
+    } else {
+        for (auto& [render_pass_name, render_pass_desc] : render_pass_descs_) {
+            Std::insert(observation, "multi_camera." + render_pass_name, {});
+            observation.at("multi_camera." + render_pass_name).resize(render_pass_desc.num_bytes_);
+            Std::insert(dest_ptrs, render_pass_name, observation.at("multi_camera." + render_pass_name).data());
+        }
+    }
+
+    // enqueue the scene captures for all views before reading any of them
+    for (auto& camera_sensor : camera_sensors_) {
+        camera_sensor->captureScene();
+    }
+
+    // each view is written to its own [height, width, num_channels] sub-array
+    std::vector<std::map<std::string, void*>> view_dest_ptrs(camera_sensors_.size());
+    for (int i = 0; i < camera_sensors_.size(); i++) {
+        for (auto& [render_pass_name, view_render_pass_desc] : camera_sensors_.at(i)->render_pass_descs_) {
+            Std::insert(view_dest_ptrs.at(i), render_pass_name, dest_ptrs.at(render_pass_name) + i*view_render_pass_desc.num_bytes_);
+        }
+    }
+
+    // enqueue the reads for all views before waiting for any of them, all views are batched and therefore read through
+    // readbacks with the same latency, so we only need to wait once
+    for (int i = 0; i < camera_sensors_.size(); i++) {
+        camera_sensors_.at(i)->enqueueReadRenderPasses(view_dest_ptrs.at(i));
+    }
+    camera_sensors_.at(0)->waitForReadRenderPasses();
+    for (int i = 0; i < camera_sensors_.size(); i++) {
+        camera_sensors_.at(i)->convertRenderPasses(view_dest_ptrs.at(i));
+    }
+
+    if (use_shared_memory_) {
+        for (auto& [render_pass_name, render_pass_desc] : render_pass_descs_) {
+            CameraSensor::endSharedMemoryWrite(render_pass_desc, shared_memory_sequence_);
+        }
+    }
+
+    return observation;
+}
+
+void MultiCameraSensor::reset()
+{
+    for (auto& camera_sensor : camera_sensors_) {
+        camera_sensor->reset();
+    }
+}
+
+std::map<std::string, std::vector<uint8_t>> MultiCameraSensor::getStepInfo() const
+{
+    std::map<std::string, std::vector<uint8_t>> step_info;
+
+    for (auto& [name, data] : camera_sensors_.at(0)->getStepInfo()) {
+        SP_ASSERT(name.starts_with("camera."));
+        Std::insert(step_info, "multi_" + name, data);
+    }
+
+    return step_info;
+}
@@ -0,0 +1,61 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#pragma once
+
+#include <stdint.h> // uint8_t, uint64_t
+
+#include <map>
+#include <memory> // std::unique_ptr
+#include <string>
+#include <vector>
+
+#include <Math/Transform.h>
+
+#include "SpCore/ArrayDesc.h" // TODO: remove
+
+#include "SpServices/Legacy/CameraSensor.h"
+
+class AActor;
+class UCameraComponent;
+
+// MultiCameraSensor captures several views of the same scene, e.g., a stereo pair or a surround rig, and returns
+// each render pass as a single [num_views, height, width, num_channels] array. Each view is a batched CameraSensor
+// attached to camera_component with its own relative transform. All scene captures are enqueued together before any
+// of them is read, so the render thread renders all views back-to-back. Batched CameraSensors always read through GPU
+// readbacks, even if SP_SERVICES.LEGACY.CAMERA_SENSOR.READBACK_LATENCY is 0, so the game thread waits for the GPU
+// once per observation, rather than once per render pass per view.
+class MultiCameraSensor
+{
+public:
+    MultiCameraSensor() = delete;
+    MultiCameraSensor(
+        UCameraComponent* camera_component,
+        const std::vector<FTransform>& view_transforms,
+        const std::vector<std::string>& render_pass_names,
+        unsigned int width,
+        unsigned int height,
+        float fov);
+    ~MultiCameraSensor();
+
+    // Used by Agents.
+    std::map<std::string, ArrayDesc> getObservationSpace() const;
+    std::map<std::string, ArrayDesc> getStepInfoSpace() const;
+    std::map<std::string, std::vector<uint8_t>> getObservation() const;
+    std::map<std::string, std::vector<uint8_t>> getStepInfo() const;
+    void reset();
+
+    // One CameraSensor per view, public in case they need to be modified by user code.
+    std::vector<std::unique_ptr<CameraSensor>> camera_sensors_;
+
+private:
+    AActor* actor_ = nullptr;
+    std::vector<UCameraComponent*> camera_components_; // one per view, attached to the camera_component passed to our constructor
+
+    // one entry per render pass, num_bytes_ and shared memory refer to the data for all views
+    std::map<std::string, RenderPassDesc> render_pass_descs_;
+
+    bool use_shared_memory_ = false;
+    mutable uint64_t shared_memory_sequence_ = 0;
+};
@@ -4,25 +4,80 @@
 
 #include "SpServices/Legacy/NavMesh.h"
 
-#include <stdint.h> // uint8_t
+#include <stdint.h> // int32_t, uint8_t, uint64_t
+#include <string.h> // memcpy
+
+#include <algorithm>    // std::min
+#include <chrono>
+#include <filesystem>
+#include <fstream>      // std::ifstream, std::ofstream
+#include <ios>          // std::streamoff
 #include <string>
+#include <system_error> // std::error_code
+#include <utility>      // std::move
 #include <vector>
 
 #include <AI/NavDataGenerator.h>           // FNavDataGenerator::ExportNavigationData
-#include <AI/Navigation/NavigationTypes.h> // FNavAgentProperties, FNavLocation
+#include <AI/Navigation/NavigationTypes.h> // FNavAgentProperties, FNavLocation, FNavPathPoint
+#include <Async/ParallelFor.h>
 #include <Containers/Array.h>
+#include <Detour/DetourAlloc.h>            // dtAlloc, dtFree, DT_ALLOC_PERM
+#include <Detour/DetourNavMesh.h>          // dtAllocNavMesh, dtFreeNavMesh, dtMeshTile, dtNavMesh, dtNavMeshParams, dtPolyRef, DT_TILE_FREE_DATA
+#include <Detour/DetourNavMeshQuery.h>     // dtNavMeshQuery, dtQueryFilter
+#include <Detour/DetourStatus.h>           // dtStatus, dtStatusSucceed
+#include <Engine/LevelStreaming.h>         // ULevelStreaming
+#include <Engine/World.h>
+#include <HAL/FileManager.h>               // IFileManager
+#include <HAL/PlatformProcess.h>           // FPlatformProcess
+#include <Math/RandomStream.h>             // FRandomStream
+#include <Math/UnrealMathUtility.h>        // FMath
 #include <Misc/Build.h>                    // UE_BUILD_SHIPPING, UE_BUILD_TEST
+#include <Misc/EngineVersion.h>            // FEngineVersion
+#include <Misc/Guid.h>                     // FGuid
+#include <Misc/PackageName.h>              // FPackageName
+#include <Misc/SecureHash.h>               // FMD5, FMD5Hash
 #include <NavigationData.h>                // FPathFindingResult
 #include <NavigationSystem.h>
 #include <NavigationSystemTypes.h>         // FPathFindingQuery
+#include <NavMesh/PImplRecastNavMesh.h>    // FPImplRecastNavMesh
+#include <NavMesh/RecastHelpers.h>         // Recast2UnrealPoint, Unreal2RecastPoint
 #include <NavMesh/RecastNavMesh.h>
+#include <NavMesh/RecastQueryFilter.h>     // FRecastQueryFilter
 #include <Templates/Casts.h>
+#include <UObject/Package.h>               // UPackage
 
 #include "SpCore/Assert.h"
 #include "SpCore/Config.h"
 #include "SpCore/Log.h"
+#include "SpCore/Std.h"
 #include "SpCore/Unreal.h"
 
+// increment this value if the layout of a navmesh cache file changes
+static constexpr uint64_t k_cache_file_version = 1;
+
+struct NavMeshCacheFileHeader
+{
+    uint64_t version_ = 0;
+    double build_time_seconds_ = 0.0;
+    dtNavMeshParams nav_mesh_params_ = {};
+    uint64_t num_tiles_ = 0;
+};
+
+// The number of queries that share a dtNavMeshQuery object in NavMesh::getRandomReachablePointsInRadius(...).
+// Initializing a dtNavMeshQuery object allocates its node pool, so we initialize one object per batch of queries.
+static constexpr int k_num_queries_per_batch = 64;
+
+// dtNavMeshQuery::findRandomPointAroundCircle(...) expects a plain function pointer, so we can't bind a random stream
+// to it directly. Instead, each query sets this thread-local pointer to its own stream before calling Detour. This
+// function is only called from worker threads, so we don't call SP_ASSERT(...) here. The pointer is always valid,
+// because it is set on the same thread immediately before calling Detour.
+static thread_local FRandomStream* t_random_stream = nullptr;
+
+static float getRandomFloatFromThreadLocalStream()
+{
+    return t_random_stream->FRand();
+}
+
 void NavMesh::findObjectReferences(UWorld* world)
 {
     SP_ASSERT(world);
@@ -83,9 +138,24 @@ void NavMesh::findObjectReferences(UWorld* world)
     recast_nav_mesh_->NavMeshResolutionParams[static_cast<uint8>(ENavigationDataResolution::High)].CellSize = cell_size;
     recast_nav_mesh_->NavMeshResolutionParams[static_cast<uint8>(ENavigationDataResolution::High)].CellHeight = cell_height;
 
-    SP_LOG("Building navigation mesh...");
+    // Building the navmesh can dominate the time it takes to open a level, so we optionally cache the navmesh tiles on
+    // disk, keyed by the level and all of the navmesh build parameters set above.
+    std::string cache_file = getCacheFile();
+    bool loaded_from_cache = cache_file != "" && loadFromCache(cache_file);
+
+    if (!loaded_from_cache) {
+        SP_LOG("Building navigation mesh...");
 
-    navigation_system_v1_->Build();
+        std::chrono::time_point build_begin_time_point = std::chrono::high_resolution_clock::now();
+        navigation_system_v1_->Build();
+        double build_time_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - build_begin_time_point).count();
+
+        SP_LOG("Built navigation mesh in ", build_time_seconds, " seconds.");
+
+        if (cache_file != "") {
+            saveToCache(cache_file, build_time_seconds);
+        }
+    }
 
     // We need to wrap this call with guards because ExportNavigationData(...) is only implemented in non-shipping builds, see:
     //     Engine/Source/Runtime/Engine/Public/AI/NavDataGenerator.h
@@ -99,7 +169,8 @@ void NavMesh::findObjectReferences(UWorld* world)
         debug_navigation_data_file = Config::get<std::string>("SP_SERVICES.LEGACY.NAVMESH.DEBUG_NAVIGATION_DATA_FILE");
     }
 
-    if (debug_navigation_data_file != "") {
+    // if we loaded the navmesh from our cache, then there might not be a generator
+    if (debug_navigation_data_file != "" && recast_nav_mesh_->GetGenerator()) {
         recast_nav_mesh_->GetGenerator()->ExportNavigationData(Unreal::toFString(debug_navigation_data_file));
     }
 #endif
@@ -126,53 +197,338 @@ std::vector<double> NavMesh::getRandomPoints(int num_points)
     return points;
 }
 
+std::string NavMesh::getCacheFile() const
+{
+    std::string cache_dir = "";
+    if (Config::isInitialized()) {
+        cache_dir = Config::get<std::string>("SP_SERVICES.LEGACY.NAVMESH.CACHE_DIR");
+    }
+
+    if (cache_dir == "") {
+        return "";
+    }
+
+    // We identify the level by the package names and checksums of the package files for the persistent level and all
+    // streaming levels, so a cached navmesh is invalidated if any of them is modified. If we can't find a package file,
+    // e.g., when playing in the editor, then we don't use the cache.
+    std::vector<FString> package_names = {world_->GetOutermost()->GetName()};
+    for (auto level_streaming : world_->GetStreamingLevels()) {
+        if (level_streaming) {
+            package_names.push_back(level_streaming->GetWorldAssetPackageName());
+        }
+    }
+
+    std::string package_key = "";
+    for (auto& package_name : package_names) {
+        FString package_file;
+        bool found = FPackageName::TryConvertLongPackageNameToFilename(package_name, package_file, FPackageName::GetMapPackageExtension());
+        if (!found || !IFileManager::Get().FileExists(*package_file)) {
+            SP_LOG("Can't find package file, so the navigation mesh won't be cached: ", Unreal::toStdString(package_name));
+            return "";
+        }
+
+        FMD5Hash package_file_hash = FMD5Hash::HashFile(*package_file);
+        if (!package_file_hash.IsValid()) {
+            SP_LOG("Can't read package file, so the navigation mesh won't be cached: ", Unreal::toStdString(package_file));
+            return "";
+        }
+
+        package_key += ";" + Unreal::toStdString(package_name) + ";" + Unreal::toStdString(LexToString(package_file_hash));
+    }
+
+    // all parameters that affect the navmesh, see findObjectReferences(...)
+    std::vector<double> params = {
+        static_cast<double>(recast_nav_mesh_->TilePoolSize),
+        recast_nav_mesh_->TileSizeUU,
+        recast_nav_mesh_->AgentRadius,
+        recast_nav_mesh_->AgentHeight,
+        recast_nav_mesh_->AgentMaxSlope,
+        recast_nav_mesh_->AgentMaxStepHeight,
+        recast_nav_mesh_->MinRegionArea,
+        recast_nav_mesh_->MergeRegionSize,
+        recast_nav_mesh_->MaxSimplificationError};
+    for (auto resolution : {ENavigationDataResolution::Low, ENavigationDataResolution::Default, ENavigationDataResolution::High}) {
+        params.push_back(recast_nav_mesh_->NavMeshResolutionParams[static_cast<uint8>(resolution)].CellSize);
+        params.push_back(recast_nav_mesh_->NavMeshResolutionParams[static_cast<uint8>(resolution)].CellHeight);
+    }
+
+    // the layout of the cached tiles depends on the engine version
+    std::string key =
+        std::to_string(k_cache_file_version) + ";" +
+        Unreal::toStdString(FEngineVersion::Current().ToString()) +
+        package_key;
+    for (auto param : params) {
+        key += ";" + std::to_string(param);
+    }
+
+    std::string key_hash = Unreal::toStdString(FMD5::HashAnsiString(*Unreal::toFString(key)));
+    return (std::filesystem::path(cache_dir) / (key_hash + ".navmesh")).string();
+}
+
+bool NavMesh::loadFromCache(const std::string& cache_file)
+{
+    std::chrono::time_point load_begin_time_point = std::chrono::high_resolution_clock::now();
+
+    std::ifstream fs(cache_file, std::ios::binary | std::ios::ate);
+    if (!fs.is_open()) {
+        SP_LOG("Navigation mesh not found in cache: ", cache_file);
+        return false;
+    }
+
+    // we check each tile size against the size of the file, so a corrupt file can't make us allocate a huge tile
+    std::streamoff file_num_bytes = fs.tellg();
+    fs.seekg(0);
+
+    // read the entire file before allocating any Detour objects, so we don't need to clean up if the file is invalid
+    NavMeshCacheFileHeader header;
+    fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!fs || header.version_ != k_cache_file_version) {
+        SP_LOG("Invalid navigation mesh cache file: ", cache_file);
+        return false;
+    }
+
+    std::vector<std::vector<uint8_t>> tiles;
+    for (uint64_t i = 0; i < header.num_tiles_; i++) {
+        int32_t tile_num_bytes = 0;
+        fs.read(reinterpret_cast<char*>(&tile_num_bytes), sizeof(tile_num_bytes));
+        if (!fs || tile_num_bytes <= 0 || tile_num_bytes > file_num_bytes - static_cast<std::streamoff>(fs.tellg())) {
+            SP_LOG("Invalid navigation mesh cache file: ", cache_file);
+            return false;
+        }
+
+        std::vector<uint8_t> tile(tile_num_bytes);
+        fs.read(reinterpret_cast<char*>(tile.data()), tile_num_bytes);
+        if (!fs) {
+            SP_LOG("Invalid navigation mesh cache file: ", cache_file);
+            return false;
+        }
+
+        tiles.push_back(std::move(tile));
+    }
+
+    // The file can still be invalid even if it has the expected layout, e.g., if it was truncated and then padded, so
+    // we return false if Detour rejects it, and our caller will build the navmesh instead.
+    dtNavMesh* detour_nav_mesh = dtAllocNavMesh();
+    SP_ASSERT(detour_nav_mesh);
+    dtStatus status = detour_nav_mesh->init(&header.nav_mesh_params_);
+    if (!dtStatusSucceed(status)) {
+        SP_LOG("Invalid navigation mesh cache file: ", cache_file);
+        dtFreeNavMesh(detour_nav_mesh);
+        return false;
+    }
+
+    // Detour takes ownership of each tile's data because we pass in DT_TILE_FREE_DATA, so we need to allocate it with
+    // dtAlloc(...), and we only need to free it ourselves if Detour doesn't accept it
+    for (auto& tile : tiles) {
+        unsigned char* tile_data = static_cast<unsigned char*>(dtAlloc(tile.size(), DT_ALLOC_PERM));
+        SP_ASSERT(tile_data);
+        memcpy(tile_data, tile.data(), tile.size());
+        status = detour_nav_mesh->addTile(tile_data, tile.size(), DT_TILE_FREE_DATA, 0, nullptr);
+        if (!dtStatusSucceed(status)) {
+            SP_LOG("Invalid navigation mesh cache file: ", cache_file);
+            dtFree(tile_data, DT_ALLOC_PERM);
+            dtFreeNavMesh(detour_nav_mesh);
+            return false;
+        }
+    }
+
+    // FPImplRecastNavMesh takes ownership of detour_nav_mesh
+    recast_nav_mesh_->GetRecastNavMeshImpl()->SetRecastMesh(detour_nav_mesh);
+
+    double load_time_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - load_begin_time_point).count();
+
+    SP_LOG("Loaded navigation mesh from cache in ", load_time_seconds, " seconds: ", cache_file);
+    SP_LOG("Building the navigation mesh took ", header.build_time_seconds_, " seconds when it was cached, so we saved ", header.build_time_seconds_ - load_time_seconds, " seconds.");
+
+    return true;
+}
+
+void NavMesh::saveToCache(const std::string& cache_file, double build_time_seconds) const
+{
+    const dtNavMesh* detour_nav_mesh = recast_nav_mesh_->GetRecastMesh();
+    if (!detour_nav_mesh) {
+        SP_LOG("Navigation mesh is empty, so it won't be cached.");
+        return;
+    }
+
+    std::vector<const dtMeshTile*> tiles;
+    for (int i = 0; i < detour_nav_mesh->getMaxTiles(); i++) {
+        const dtMeshTile* tile = detour_nav_mesh->getTile(i);
+        if (tile && tile->header && tile->data && tile->dataSize > 0) {
+            tiles.push_back(tile);
+        }
+    }
+
+    // the cache is optional, so if we can't write to it, then we log an error and continue without caching
+    std::error_code error_code;
+    std::filesystem::create_directories(std::filesystem::path(cache_file).parent_path(), error_code);
+    if (error_code) {
+        SP_LOG("ERROR: Can't create navigation mesh cache directory, so the navigation mesh won't be cached: ", error_code.message());
+        return;
+    }
+
+    // Write to a temporary file and rename it, so other processes never observe a partially written cache file. The
+    // temporary file name is unique to this process and this call, so concurrent instances that are caching the same
+    // navmesh never write to the same temporary file. Renaming is atomic, so the last instance to finish wins.
+    std::string temp_cache_file =
+        cache_file + "." + std::to_string(FPlatformProcess::GetCurrentProcessId()) + "." + Unreal::toStdString(FGuid::NewGuid().ToString()) + ".tmp";
+    std::ofstream fs(temp_cache_file, std::ios::binary);
+    if (!fs.is_open()) {
+        SP_LOG("ERROR: Can't open temporary navigation mesh cache file, so the navigation mesh won't be cached: ", temp_cache_file);
+        return;
+    }
+
+    NavMeshCacheFileHeader header;
+    header.version_ = k_cache_file_version;
+    header.build_time_seconds_ = build_time_seconds;
+    header.nav_mesh_params_ = *detour_nav_mesh->getParams();
+    header.num_tiles_ = tiles.size();
+    fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (auto tile : tiles) {
+        int32_t tile_num_bytes = tile->dataSize;
+        fs.write(reinterpret_cast<const char*>(&tile_num_bytes), sizeof(tile_num_bytes));
+        fs.write(reinterpret_cast<const char*>(tile->data), tile_num_bytes);
+    }
+
+    fs.close();
+    if (!fs) {
+        SP_LOG("ERROR: Can't write temporary navigation mesh cache file, so the navigation mesh won't be cached: ", temp_cache_file);
+        std::filesystem::remove(temp_cache_file, error_code);
+        return;
+    }
+
+    std::filesystem::rename(temp_cache_file, cache_file, error_code);
+    if (error_code) {
+        SP_LOG("ERROR: Can't rename temporary navigation mesh cache file, so the navigation mesh won't be cached: ", error_code.message());
+        std::filesystem::remove(temp_cache_file, error_code);
+        return;
+    }
+
+    SP_LOG("Saved navigation mesh to cache: ", cache_file);
+}
+
+// The navmesh queries below are executed in parallel. ARecastNavMesh's query functions are safe to call from worker
+// threads as long as the navmesh isn't being modified, which is guaranteed here because the game thread is blocked
+// until all queries have finished. When called from a thread other than the game thread, each query function
+// initializes its own dtNavMeshQuery object internally, rather than using the navmesh's shared query object. We don't
+// call SP_ASSERT(...) from worker threads, so we record whether or not each query succeeded, and check the results
+// on the calling thread after all queries have finished.
+
 std::vector<double> NavMesh::getRandomReachablePointsInRadius(const std::vector<double>& reference_points, float radius)
 {
     SP_ASSERT(reference_points.size() % 3 == 0);
 
-    std::vector<double> reachable_points;
+    int num_points = reference_points.size() / 3;
+    std::vector<double> reachable_points(reference_points.size());
+    std::vector<uint8_t> found(num_points, 0); // not std::vector<bool>, because worker threads write to it concurrently
 
-    for (int i = 0; i < reference_points.size(); i += 3) {
+    // ARecastNavMesh::GetRandomReachablePointInRadius(...) draws from FMath::FRand(), so its results would depend on
+    // how queries are scheduled across worker threads. Instead, we draw a seed for each query on the calling thread,
+    // and give each query its own FRandomStream, so the results only depend on the state of FMath's random number
+    // generator when this function is called. This means that we need to call Detour directly, but we set up each
+    // query in the same way as ARecastNavMesh::GetRandomReachablePointInRadius(...).
+    std::vector<int32> seeds;
+    for (int i = 0; i < num_points; i++) {
+        seeds.push_back(FMath::Rand());
+    }
 
-        FVector reference_point = {reference_points.at(i), reference_points.at(i + 1), reference_points.at(i + 2)};
-        FNavLocation nav_location;
+    // accessing the default query filter isn't thread-safe, so we do it on the calling thread
+    const dtNavMesh* detour_nav_mesh = recast_nav_mesh_->GetRecastMesh();
+    SP_ASSERT(detour_nav_mesh);
+    FSharedConstNavQueryFilter nav_query_filter = recast_nav_mesh_->GetDefaultQueryFilter();
+    SP_ASSERT(nav_query_filter.IsValid());
+    const FRecastQueryFilter* recast_query_filter = static_cast<const FRecastQueryFilter*>(nav_query_filter->GetImplementation());
+    SP_ASSERT(recast_query_filter);
+    const dtQueryFilter* detour_query_filter = recast_query_filter->GetAsDetourQueryFilter();
+    SP_ASSERT(detour_query_filter);
+    int max_search_nodes = nav_query_filter->GetMaxSearchNodes();
+    FVector query_extent = recast_nav_mesh_->GetDefaultQueryExtent();
+    dtReal detour_query_extent[3] = {query_extent.X, query_extent.Z, query_extent.Y}; // Recast is y-up
+
+    SP_ASSERT(seeds.size() == num_points);
+
+    int num_batches = (num_points + k_num_queries_per_batch - 1) / k_num_queries_per_batch;
+    ParallelFor(num_batches, [num_points, &reference_points, &reachable_points, &found, &seeds, detour_nav_mesh, detour_query_filter, max_search_nodes, &detour_query_extent, radius](int32 batch) -> void {
+        dtNavMeshQuery detour_nav_mesh_query;
+        if (!dtStatusSucceed(detour_nav_mesh_query.init(detour_nav_mesh, max_search_nodes))) {
+            return;
+        }
 
-        bool found = recast_nav_mesh_->GetRandomReachablePointInRadius(reference_point, radius, nav_location);
-        SP_ASSERT(found);
+        int end = std::min((batch + 1)*k_num_queries_per_batch, num_points);
+        for (int i = batch*k_num_queries_per_batch; i < end; i++) {
+            FVector reference_point = {reference_points.at(3*i), reference_points.at(3*i + 1), reference_points.at(3*i + 2)};
+            FVector detour_reference_point = Unreal2RecastPoint(reference_point);
+
+            dtPolyRef reference_poly = 0;
+            dtStatus status = detour_nav_mesh_query.findNearestPoly(&detour_reference_point.X, detour_query_extent, detour_query_filter, &reference_poly, nullptr);
+            if (!dtStatusSucceed(status) || !reference_poly) {
+                continue;
+            }
+
+            FRandomStream random_stream(seeds.at(i));
+            t_random_stream = &random_stream;
+            dtPolyRef reachable_poly = 0;
+            dtReal detour_reachable_point[3];
+            status = detour_nav_mesh_query.findRandomPointAroundCircle(
+                reference_poly, &detour_reference_point.X, radius, detour_query_filter, getRandomFloatFromThreadLocalStream, &reachable_poly, detour_reachable_point);
+            t_random_stream = nullptr;
+            if (!dtStatusSucceed(status)) {
+                continue;
+            }
+
+            FVector reachable_point = Recast2UnrealPoint(detour_reachable_point);
+            reachable_points.at(3*i)     = reachable_point.X;
+            reachable_points.at(3*i + 1) = reachable_point.Y;
+            reachable_points.at(3*i + 2) = reachable_point.Z;
+            found.at(i) = 1;
+        }
+    });
 
-        reachable_points.push_back(nav_location.Location.X);
-        reachable_points.push_back(nav_location.Location.Y);
-        reachable_points.push_back(nav_location.Location.Z);
-    }
+    SP_ASSERT(Std::all(found));
 
     return reachable_points;
 }
 
-std::vector<std::vector<double>> NavMesh::getPaths(const std::vector<double>& initial_points, const std::vector<double>& goal_points)
+NavMeshPaths NavMesh::getPaths(const std::vector<double>& initial_points, const std::vector<double>& goal_points)
 {
     SP_ASSERT(initial_points.size() == goal_points.size());
     SP_ASSERT(initial_points.size() % 3 == 0);
 
-    std::vector<std::vector<double>> paths;
+    int num_paths = initial_points.size() / 3;
+
+    // constructing a query accesses the navmesh's default query filter, so we construct all queries on the game thread
+    std::vector<FPathFindingQuery> path_finding_queries;
+    for (int i = 0; i < num_paths; i++) {
+        FVector initial_point = {initial_points.at(3*i), initial_points.at(3*i + 1), initial_points.at(3*i + 2)};
+        FVector goal_point = {goal_points.at(3*i), goal_points.at(3*i + 1), goal_points.at(3*i + 2)};
+        path_finding_queries.push_back(FPathFindingQuery(world_, *recast_nav_mesh_, initial_point, goal_point));
+    }
+
+    std::vector<TArray<FNavPathPoint>> nav_path_points(num_paths);
+    std::vector<uint8_t> found(num_paths, 0); // not std::vector<bool>, because worker threads write to it concurrently
+    ParallelFor(num_paths, [this, &path_finding_queries, &nav_path_points, &found](int32 i) -> void {
+        const FPathFindingQuery& path_finding_query = path_finding_queries.at(i);
+        FPathFindingResult path_finding_result = recast_nav_mesh_->FindPath(path_finding_query.NavAgentProperties, path_finding_query);
+        if (!path_finding_result.IsSuccessful() || !path_finding_result.Path.IsValid()) {
+            return;
+        }
 
-    for (int i = 0; i < initial_points.size(); i += 3) {
-        FVector initial_point = {initial_points.at(i), initial_points.at(i + 1), initial_points.at(i + 2)};
-        FVector goal_point = {goal_points.at(i), goal_points.at(i + 1), goal_points.at(i + 2)};
-        FPathFindingQuery path_finding_query = FPathFindingQuery(world_, *recast_nav_mesh_, initial_point, goal_point);
-        FPathFindingResult path_finding_result = navigation_system_v1_->FindPathSync(path_finding_query, EPathFindingMode::Type::Regular);
-        SP_ASSERT(path_finding_result.IsSuccessful());
-        SP_ASSERT(path_finding_result.Path.IsValid());
+        nav_path_points.at(i) = path_finding_result.Path->GetPathPoints();
+        found.at(i) = nav_path_points.at(i).Num() >= 2;
+    });
 
-        TArray<FNavPathPoint> nav_path_points = path_finding_result.Path->GetPathPoints();
-        SP_ASSERT(nav_path_points.Num() >= 2);
+    SP_ASSERT(Std::all(found));
 
-        std::vector<double> path;
-        for (auto& point : nav_path_points) {
-            path.push_back(point.Location.X);
-            path.push_back(point.Location.Y);
-            path.push_back(point.Location.Z);
+    NavMeshPaths paths;
+    paths.offsets_.push_back(0);
+    for (auto& points : nav_path_points) {
+        for (auto& point : points) {
+            paths.points_.push_back(point.Location.X);
+            paths.points_.push_back(point.Location.Y);
+            paths.points_.push_back(point.Location.Z);
         }
-        paths.push_back(path);
+        paths.offsets_.push_back(paths.points_.size() / 3);
     }
 
     return paths;
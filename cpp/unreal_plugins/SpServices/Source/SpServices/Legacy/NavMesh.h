@@ -4,12 +4,23 @@
 
 #pragma once
 
+#include <stdint.h> // uint64_t
+
+#include <string>
 #include <vector>
 
 class ARecastNavMesh;
 class UNavigationSystemV1;
 class UWorld;
 
+// Paths are stored in a compressed sparse row (CSR) layout, i.e., the points for path i are stored in rows
+// offsets_[i] through offsets_[i+1]-1 of points_, so we can return many paths without nested containers.
+struct NavMeshPaths
+{
+    std::vector<double> points_;    // num_points x 3
+    std::vector<uint64_t> offsets_; // num_paths + 1
+};
+
 class NavMesh
 {
 public:    
@@ -18,9 +29,13 @@ public:
 
     std::vector<double> getRandomPoints(const int num_points);
     std::vector<double> getRandomReachablePointsInRadius(const std::vector<double>& initial_points, const float radius);
-    std::vector<std::vector<double>> getPaths(const std::vector<double>& initial_points, const std::vector<double>& goal_points);
+    NavMeshPaths getPaths(const std::vector<double>& initial_points, const std::vector<double>& goal_points);
 
 private:
+    std::string getCacheFile() const;
+    bool loadFromCache(const std::string& cache_file);
+    void saveToCache(const std::string& cache_file, double build_time_seconds) const;
+
     UWorld* world_ = nullptr;
     UNavigationSystemV1* navigation_system_v1_ = nullptr;
     ARecastNavMesh* recast_nav_mesh_ = nullptr;
@@ -30,6 +30,10 @@
 #include "SpServices/Legacy/ActorHitComponent.h"
 #include "SpServices/Legacy/StandaloneComponent.h"
 
+// the reward constants are read in getReward(), which is called every frame, so we cache them
+static ConfigValue<float> s_reward_hit_goal("SP_SERVICES.LEGACY.POINT_GOAL_NAV_TASK.REWARD.HIT_GOAL");
+static ConfigValue<float> s_reward_hit_obstacle("SP_SERVICES.LEGACY.POINT_GOAL_NAV_TASK.REWARD.HIT_OBSTACLE");
+
 PointGoalNavTask::PointGoalNavTask(UWorld* world)
 {
     // Spawn actor
@@ -133,9 +137,9 @@ float PointGoalNavTask::getReward() const
     float reward;
 
     if (hit_goal_) {
-        reward = Config::get<float>("SP_SERVICES.LEGACY.POINT_GOAL_NAV_TASK.REWARD.HIT_GOAL");
+        reward = s_reward_hit_goal.get();
     } else if (hit_obstacle_) {
-        reward = Config::get<float>("SP_SERVICES.LEGACY.POINT_GOAL_NAV_TASK.REWARD.HIT_OBSTACLE");
+        reward = s_reward_hit_obstacle.get();
     } else {
         FVector agent_to_goal = goal_actor_->GetActorLocation() - agent_actor_->GetActorLocation();
         reward = -agent_to_goal.Size();
@@ -223,6 +223,12 @@ std::map<std::string, ArrayDesc> SphereAgent::getStepInfoSpace() const
         Std::insert(step_info_space, "debug", std::move(array_desc));
     }
 
+    auto observation_components = Config::get<std::vector<std::string>>("SP_SERVICES.LEGACY.SPHERE_AGENT.OBSERVATION_COMPONENTS");
+
+    if (Std::contains(observation_components, "camera")) {
+        Std::insert(step_info_space, camera_sensor_->getStepInfoSpace());
+    }
+
     return step_info_space;
 }
 
@@ -272,6 +278,12 @@ std::map<std::string, std::vector<uint8_t>> SphereAgent::getStepInfo() const
         Std::insert(step_info, "debug", Std::reinterpretAsVector<uint8_t, double>({0.0, 1.0, 2.0, 3.0, 4.0, 5.0}));
     }
 
+    auto observation_components = Config::get<std::vector<std::string>>("SP_SERVICES.LEGACY.SPHERE_AGENT.OBSERVATION_COMPONENTS");
+
+    if (Std::contains(observation_components, "camera")) {
+        Std::insert(step_info, camera_sensor_->getStepInfo());
+    }
+
     return step_info;
 }
 
@@ -283,6 +295,10 @@ void SphereAgent::reset()
     static_mesh_component_->GetBodyInstance()->ClearForces();
 
     rotation_ = FRotator::ZeroRotator;
+
+    if (camera_sensor_) {
+        camera_sensor_->reset();
+    }
 }
 
 bool SphereAgent::isReady() const
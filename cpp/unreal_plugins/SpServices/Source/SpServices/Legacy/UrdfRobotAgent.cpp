@@ -128,7 +128,14 @@ std::map<std::string, ArrayDesc> UrdfRobotAgent::getObservationSpace() const
 
 std::map<std::string, ArrayDesc> UrdfRobotAgent::getStepInfoSpace() const
 {
-    return {};
+    std::map<std::string, ArrayDesc> step_info_space;
+    auto observation_components = Config::get<std::vector<std::string>>("SP_SERVICES.LEGACY.URDF_ROBOT_AGENT.OBSERVATION_COMPONENTS");
+
+    if (Std::contains(observation_components, "camera")) {
+        Std::insert(step_info_space, camera_sensor_->getStepInfoSpace());
+    }
+
+    return step_info_space;
 }
 
 void UrdfRobotAgent::applyAction(const std::map<std::string, std::vector<uint8_t>>& action)
@@ -154,13 +161,24 @@ std::map<std::string, std::vector<uint8_t>> UrdfRobotAgent::getObservation() con
 
 std::map<std::string, std::vector<uint8_t>> UrdfRobotAgent::getStepInfo() const
 {
-    return {};
+    std::map<std::string, std::vector<uint8_t>> step_info;
+    auto observation_components = Config::get<std::vector<std::string>>("SP_SERVICES.LEGACY.URDF_ROBOT_AGENT.OBSERVATION_COMPONENTS");
+
+    if (Std::contains(observation_components, "camera")) {
+        Std::insert(step_info, camera_sensor_->getStepInfo());
+    }
+
+    return step_info;
 }
 
 void UrdfRobotAgent::reset()
 {
     SP_ASSERT(urdf_robot_pawn_->UrdfRobotComponent);
     urdf_robot_pawn_->UrdfRobotComponent->reset();
+
+    if (camera_sensor_) {
+        camera_sensor_->reset();
+    }
 }
 
 bool UrdfRobotAgent::isReady() const
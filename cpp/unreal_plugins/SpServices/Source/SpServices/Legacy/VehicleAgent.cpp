@@ -145,7 +145,14 @@ std::map<std::string, ArrayDesc> VehicleAgent::getObservationSpace() const
 
 std::map<std::string, ArrayDesc> VehicleAgent::getStepInfoSpace() const
 {
-    return {};
+    std::map<std::string, ArrayDesc> step_info_space;
+    auto observation_components = Config::get<std::vector<std::string>>("SP_SERVICES.LEGACY.VEHICLE_AGENT.OBSERVATION_COMPONENTS");
+
+    if (Std::contains(observation_components, "camera")) {
+        Std::insert(step_info_space, camera_sensor_->getStepInfoSpace());
+    }
+
+    return step_info_space;
 }
 
 void VehicleAgent::applyAction(const std::map<std::string, std::vector<uint8_t>>& action)
@@ -173,12 +180,23 @@ std::map<std::string, std::vector<uint8_t>> VehicleAgent::getObservation() const
 
 std::map<std::string, std::vector<uint8_t>> VehicleAgent::getStepInfo() const
 {
-    return {};
+    std::map<std::string, std::vector<uint8_t>> step_info;
+    auto observation_components = Config::get<std::vector<std::string>>("SP_SERVICES.LEGACY.VEHICLE_AGENT.OBSERVATION_COMPONENTS");
+
+    if (Std::contains(observation_components, "camera")) {
+        Std::insert(step_info, camera_sensor_->getStepInfo());
+    }
+
+    return step_info;
 }
 
 void VehicleAgent::reset()
 {
     vehicle_pawn_->GetVehicleMovementComponent()->ResetVehicle();
+
+    if (camera_sensor_) {
+        camera_sensor_->reset();
+    }
 }
 
 bool VehicleAgent::isReady() const
@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <stdint.h> // uint8_t
+
+#include <map>
 #include <string>
 #include <vector>
 
@@ -12,12 +15,13 @@
 
 #include "SpCore/ArrayDesc.h" // TODO: remove
 #include "SpCore/Assert.h"
+#include "SpCore/Std.h"
 
 #include "SpServices/EntryPointBinder.h"
-#include "SpServices/Msgpack.h"
 #include "SpServices/Rpclib.h"
 
 #include "SpServices/Legacy/Agent.h"
+#include "SpServices/Legacy/ArrayDescMsgpack.h"
 #include "SpServices/Legacy/NavMesh.h"
 #include "SpServices/Legacy/Task.h"
 
@@ -99,19 +103,23 @@ public:
             return task_->isReady();
         });
 
-        unreal_entry_point_binder->bindFuncUnreal("legacy_service", "get_random_points", [this](int& num_points) -> std::vector<double> {
+        // Points are sent and received as packed float64 arrays, which have a more efficient MSGPACK representation than
+        // arrays of doubles. Paths are returned in the CSR layout described in NavMesh.h, with packed uint64 offsets.
+
+        unreal_entry_point_binder->bindFuncUnreal("legacy_service", "get_random_points", [this](int& num_points) -> std::vector<uint8_t> {
             SP_ASSERT(nav_mesh_);
-            return nav_mesh_->getRandomPoints(num_points);
+            return Std::reinterpretAsVectorOf<uint8_t>(nav_mesh_->getRandomPoints(num_points));
         });
 
-        unreal_entry_point_binder->bindFuncUnreal("legacy_service", "get_random_reachable_points_in_radius", [this](std::vector<double>& initial_points, float& radius) -> std::vector<double> {
+        unreal_entry_point_binder->bindFuncUnreal("legacy_service", "get_random_reachable_points_in_radius", [this](std::vector<uint8_t>& initial_points, float& radius) -> std::vector<uint8_t> {
             SP_ASSERT(nav_mesh_);
-            return nav_mesh_->getRandomReachablePointsInRadius(initial_points, radius);
+            return Std::reinterpretAsVectorOf<uint8_t>(nav_mesh_->getRandomReachablePointsInRadius(Std::reinterpretAsVectorOf<double>(initial_points), radius));
         });
 
-        unreal_entry_point_binder->bindFuncUnreal("legacy_service", "get_paths", [this](std::vector<double>& initial_points, std::vector<double>& goal_points) -> std::vector<std::vector<double>> {
+        unreal_entry_point_binder->bindFuncUnreal("legacy_service", "get_paths", [this](std::vector<uint8_t>& initial_points, std::vector<uint8_t>& goal_points) -> std::map<std::string, std::vector<uint8_t>> {
             SP_ASSERT(nav_mesh_);
-            return nav_mesh_->getPaths(initial_points, goal_points);
+            NavMeshPaths paths = nav_mesh_->getPaths(Std::reinterpretAsVectorOf<double>(initial_points), Std::reinterpretAsVectorOf<double>(goal_points));
+            return {{"points", Std::reinterpretAsVectorOf<uint8_t>(paths.points_)}, {"offsets", Std::reinterpretAsVectorOf<uint8_t>(paths.offsets_)}};
         });
     }
 
@@ -150,42 +158,3 @@ private:
     // Navmesh helper object
     std::unique_ptr<NavMesh> nav_mesh_ = nullptr;
 };
-
-//
-// Enums
-//
-
-MSGPACK_ADD_ENUM(DataType);
-
-//
-// ArrayDesc
-//
-
-template <> // needed to receive a custom type as an arg
-struct clmdep_msgpack::adaptor::convert<ArrayDesc> {
-    clmdep_msgpack::object const& operator()(clmdep_msgpack::object const& object, ArrayDesc& array_desc) const {
-        std::map<std::string, clmdep_msgpack::object> map = Msgpack::toMap(object);
-        SP_ASSERT(map.size() == 6);
-        array_desc.low_ = Msgpack::to<double>(map.at("low_"));
-        array_desc.high_ = Msgpack::to<double>(map.at("high_"));
-        array_desc.shape_ = Msgpack::to<std::vector<int64_t>>(map.at("shape_"));
-        array_desc.datatype_ = Msgpack::to<DataType>(map.at("datatype_"));
-        array_desc.use_shared_memory_ = Msgpack::to<bool>(map.at("use_shared_memory_"));
-        array_desc.shared_memory_name_ = Msgpack::to<std::string>(map.at("shared_memory_name_"));
-        return object;
-    }
-};
-
-template <> // needed to send a custom type as a return value
-struct clmdep_msgpack::adaptor::object_with_zone<ArrayDesc> {
-    void operator()(clmdep_msgpack::object::with_zone& object, ArrayDesc const& array_desc) const {
-        std::map<std::string, clmdep_msgpack::object> map = {
-            {"low_", clmdep_msgpack::object(array_desc.low_, object.zone)},
-            {"high_", clmdep_msgpack::object(array_desc.high_, object.zone)},
-            {"shape_", clmdep_msgpack::object(array_desc.shape_, object.zone)},
-            {"datatype_", clmdep_msgpack::object(array_desc.datatype_, object.zone)},
-            {"use_shared_memory_", clmdep_msgpack::object(array_desc.use_shared_memory_, object.zone)},
-            {"shared_memory_name_", clmdep_msgpack::object(array_desc.shared_memory_name_, object.zone)}};
-        Msgpack::toObject(object, map);
-    }
-};
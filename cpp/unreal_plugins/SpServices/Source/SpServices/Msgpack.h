@@ -4,21 +4,64 @@
 
 #pragma once
 
-#include <stddef.h> // uint64_t
+#include <stddef.h> // size_t
+#include <stdint.h> // uint32_t, uint64_t
 
 #include <map>
 #include <string>
+#include <string_view>
+#include <tuple>       // std::get, std::make_tuple, std::tuple_size_v
+#include <type_traits> // std::remove_cvref_t
+#include <utility>     // std::index_sequence, std::make_index_sequence
 
 #include "SpCore/Assert.h"
 
 #include "SpServices/Rpclib.h"
 
+//
+// MsgpackFieldDesc describes a single member variable of a struct, i.e., the key that identifies the member
+// variable in a msgpack map, and a pointer-to-member that identifies the member variable itself. The key must
+// have static storage duration, because we refer to it directly rather than copying it when sending a struct.
+//
+
+template <typename TStruct, typename TMember>
+struct MsgpackFieldDesc
+{
+    std::string_view key_;
+    TMember TStruct::* member_;
+};
+
+//
+// Specialize MsgpackStructDesc for a struct to send and receive it as a msgpack map via Msgpack::toStruct(...)
+// and Msgpack::toObject(...), e.g.,
+//
+//     template <>
+//     struct MsgpackStructDesc<MyStruct> {
+//         static constexpr auto k_field_descs = std::make_tuple(
+//             Msgpack::fieldDesc("my_int", &MyStruct::my_int_),
+//             Msgpack::fieldDesc("my_string", &MyStruct::my_string_));
+//     };
+//
+// Since the field descriptors are known at compile time, these functions don't need to build an intermediate
+// std::map<std::string, clmdep_msgpack::object>, and therefore don't allocate any memory other than what is
+// needed for the member variables themselves.
+//
+
+template <typename TStruct>
+struct MsgpackStructDesc;
+
 class Msgpack
 {
 public:
     Msgpack() = delete;
     ~Msgpack() = delete;
 
+    template <typename TStruct, typename TMember>
+    static constexpr MsgpackFieldDesc<TStruct, TMember> fieldDesc(std::string_view key, TMember TStruct::* member)
+    {
+        return {key, member};
+    }
+
     //
     // functions for receiving custom types as args
     //
@@ -42,10 +85,85 @@ public:
         return reinterpret_cast<T*>(ptr);
     };
 
+    // Decode a msgpack map into a struct in a single pass over the map. The map must contain exactly one entry
+    // for each field in MsgpackStructDesc<TStruct>::k_field_descs, in any order.
+    template <typename TStruct>
+    static void toStruct(clmdep_msgpack::object const& object, TStruct& t)
+    {
+        constexpr size_t num_fields = getNumFields<TStruct>();
+        static_assert(num_fields <= 64);
+
+        SP_ASSERT(object.type == clmdep_msgpack::type::MAP);
+        SP_ASSERT(object.via.map.size == num_fields);
+
+        uint64_t fields_found = 0;
+        for (unsigned int i = 0; i < object.via.map.size; i++) { // unsigned int needed on Windows
+            clmdep_msgpack::object_kv const& object_kv = object.via.map.ptr[i];
+            SP_ASSERT(object_kv.key.type == clmdep_msgpack::type::STR);
+            std::string_view key(object_kv.key.via.str.ptr, object_kv.key.via.str.size);
+            bool found = convertField(key, object_kv.val, t, fields_found, std::make_index_sequence<num_fields>());
+            SP_ASSERT(found);
+        }
+    }
+
     //
     // functions for sending custom types as return values
     //
 
     static clmdep_msgpack::object toObject(void* ptr, clmdep_msgpack::zone& zone); // use instead of clmdep_msgpack::object(ptr, zone) for pointers
     static void toObject(clmdep_msgpack::object::with_zone& object, const std::map<std::string, clmdep_msgpack::object>& objects);
+
+    // Encode a struct as a msgpack map directly into object.zone, with one entry for each field in
+    // MsgpackStructDesc<TStruct>::k_field_descs.
+    template <typename TStruct>
+    static void toObject(clmdep_msgpack::object::with_zone& object, TStruct const& t)
+    {
+        constexpr size_t num_fields = getNumFields<TStruct>();
+
+        object.type = clmdep_msgpack::type::MAP;
+        object.via.map.size = num_fields;
+        object.via.map.ptr = static_cast<clmdep_msgpack::object_kv*>(object.zone.allocate_align(sizeof(clmdep_msgpack::object_kv)*num_fields));
+        toObjectFields(object, t, std::make_index_sequence<num_fields>());
+    }
+
+private:
+    template <typename TStruct>
+    static constexpr size_t getNumFields()
+    {
+        return std::tuple_size_v<std::remove_cvref_t<decltype(MsgpackStructDesc<TStruct>::k_field_descs)>>;
+    }
+
+    template <typename TStruct, size_t... TIndices>
+    static bool convertField(std::string_view key, clmdep_msgpack::object const& object, TStruct& t, uint64_t& fields_found, std::index_sequence<TIndices...>)
+    {
+        // expands to a chain of string comparisons against each key in k_field_descs, which stops at the first match
+        return ((key == std::get<TIndices>(MsgpackStructDesc<TStruct>::k_field_descs).key_ && convertFieldAtIndex<TIndices>(object, t, fields_found)) || ...);
+    }
+
+    template <size_t TIndex, typename TStruct>
+    static bool convertFieldAtIndex(clmdep_msgpack::object const& object, TStruct& t, uint64_t& fields_found)
+    {
+        SP_ASSERT(!(fields_found & (static_cast<uint64_t>(1) << TIndex))); // each key must appear only once
+        fields_found |= static_cast<uint64_t>(1) << TIndex;
+        object.convert(t.*(std::get<TIndex>(MsgpackStructDesc<TStruct>::k_field_descs).member_));
+        return true;
+    }
+
+    template <typename TStruct, size_t... TIndices>
+    static void toObjectFields(clmdep_msgpack::object::with_zone& object, TStruct const& t, std::index_sequence<TIndices...>)
+    {
+        (toObjectFieldAtIndex<TIndices>(object.via.map.ptr[TIndices], t, object.zone), ...);
+    }
+
+    template <size_t TIndex, typename TStruct>
+    static void toObjectFieldAtIndex(clmdep_msgpack::object_kv& object_kv, TStruct const& t, clmdep_msgpack::zone& zone)
+    {
+        constexpr auto field_desc = std::get<TIndex>(MsgpackStructDesc<TStruct>::k_field_descs);
+
+        // the key refers to a string with static storage duration, so we don't need to copy it into the zone
+        object_kv.key.type = clmdep_msgpack::type::STR;
+        object_kv.key.via.str.ptr = field_desc.key_.data();
+        object_kv.key.via.str.size = static_cast<uint32_t>(field_desc.key_.size());
+        object_kv.val = clmdep_msgpack::object(t.*(field_desc.member_), zone);
+    }
 };
@@ -4,6 +4,9 @@
 
 #include "SpServices/SpFuncService.h"
 
+#include <map>
+#include <string>
+
 #include <Components/SceneComponent.h>
 #include <Engine/Engine.h>  // GEngine
 #include <Engine/World.h>
@@ -12,6 +15,7 @@
 
 #include "SpCore/Assert.h"
 #include "SpCore/Log.h"
+#include "SpCore/SpFuncArray.h"
 #include "SpCore/Unreal.h"
 
 #include "SpComponents/SpFuncComponent.h"
@@ -37,6 +41,31 @@ void SpFuncService::worldCleanupHandler(UWorld* world, bool session_ended, bool
     }
 }
 
+SpFuncDataBundle SpFuncService::callFunc(std::string& func_name, SpFuncDataBundle& args)
+{
+    SP_ASSERT(world_);
+
+    // TODO: make the object ptr an input to this function
+    UObject* uobject = ASpFuncServiceDebugActor::StaticClass()->GetDefaultObject();
+    SP_ASSERT(uobject);
+
+    // get SpFuncComponent and shared memory views
+    USpFuncComponent* sp_func_component = getSpFuncComponent(uobject);
+    const std::map<std::string, SpFuncSharedMemoryView>& shared_memory_views = sp_func_component->getSharedMemoryViews();
+
+    // resolve references to shared memory and validate args
+    SpFuncArrayUtils::resolve(args.packed_arrays_, shared_memory_views);
+    SpFuncArrayUtils::validate(args.packed_arrays_, SpFuncSharedMemoryUsageFlags::Arg);
+
+    // call SpFunc
+    SpFuncDataBundle return_values = sp_func_component->callFunc(func_name, args);
+
+    // validate return values
+    SpFuncArrayUtils::validate(return_values.packed_arrays_, SpFuncSharedMemoryUsageFlags::ReturnValue);
+
+    return return_values;
+}
+
 USpFuncComponent* SpFuncService::getSpFuncComponent(const UObject* uobject)
 {
     USpFuncComponent* sp_func_component = nullptr;
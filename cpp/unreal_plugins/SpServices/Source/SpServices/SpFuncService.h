@@ -4,16 +4,27 @@
 
 #pragma once
 
-#include <stdint.h> // int8_t, uint8_t, uint64_t
+#include <stdint.h> // int8_t, uint8_t, uint32_t, uint64_t, uintptr_t
 
+#include <bit>        // std::endian
+#include <cstring>    // std::memcpy
+#include <functional> // std::function, std::multiplies
+#include <future>
+#include <limits>     // std::numeric_limits
 #include <map>
+#include <memory>     // std::make_unique, std::unique_ptr
+#include <mutex>
+#include <numeric>    // std::accumulate
+#include <stdexcept>  // std::runtime_error
 #include <string>
+#include <tuple>      // std::make_tuple
 #include <vector>
 
 #include <Delegates/IDelegateInstance.h> // FDelegateHandle
 #include <Engine/Engine.h>               // GEngine
 
 #include "SpCore/Assert.h"
+#include "SpCore/Profiler.h"
 #include "SpCore/SharedMemoryRegion.h"
 #include "SpCore/SpFuncArray.h"
 #include "SpCore/Std.h"
@@ -23,6 +34,7 @@
 #include "SpServices/EntryPointBinder.h"
 #include "SpServices/Msgpack.h"
 #include "SpServices/Rpclib.h"
+#include "SpServices/SpFuncSharedMemoryTransport.h"
 
 // TODO: remove these headers when ASpFuncServiceDebugActor is removed as the hard-coded target for function calls
 #include "SpCore/Log.h"
@@ -80,27 +92,7 @@ public:
         world_cleanup_handle_ = FWorldDelegates::OnWorldCleanup.AddRaw(this, &SpFuncService::worldCleanupHandler);
 
         unreal_entry_point_binder->bindFuncUnreal("sp_func_service", "call_func", [this](std::string& func_name, SpFuncDataBundle& args) -> SpFuncDataBundle {
-            SP_ASSERT(world_);
-
-            // TODO: make the object ptr an input to this function
-            UObject* uobject = ASpFuncServiceDebugActor::StaticClass()->GetDefaultObject();
-            SP_ASSERT(uobject);
-
-            // get SpFuncComponent and shared memory views
-            USpFuncComponent* sp_func_component = getSpFuncComponent(uobject);
-            const std::map<std::string, SpFuncSharedMemoryView>& shared_memory_views = sp_func_component->getSharedMemoryViews();
-
-            // resolve references to shared memory and validate args
-            SpFuncArrayUtils::resolve(args.packed_arrays_, shared_memory_views);
-            SpFuncArrayUtils::validate(args.packed_arrays_, SpFuncSharedMemoryUsageFlags::Arg);
-
-            // call SpFunc
-            SpFuncDataBundle return_values = sp_func_component->callFunc(func_name, args);
-
-            // validate return values
-            SpFuncArrayUtils::validate(return_values.packed_arrays_, SpFuncSharedMemoryUsageFlags::ReturnValue);
-            
-            return return_values;
+            return callFunc(func_name, args);
         });
 
         unreal_entry_point_binder->bindFuncUnreal("sp_func_service", "get_shared_memory_views", [this]() -> std::map<std::string, SpFuncSharedMemoryView> {
@@ -114,10 +106,36 @@ public:
             USpFuncComponent* sp_func_component = getSpFuncComponent(uobject);
             return sp_func_component->getSharedMemoryViews();
         });
+
+        // The shared memory transport receives requests on its own thread, so it needs a version of callFunc(...)
+        // that executes on the game thread but isn't bound to an RPC entry point. This version doesn't block, so
+        // the transport's thread can stop waiting for the game thread when the transport is destroyed.
+        call_func_unreal_ = unreal_entry_point_binder->wrapFuncUnrealNonBlocking([this](std::string& func_name, SpFuncDataBundle& args) -> SpFuncDataBundle {
+            return callFunc(func_name, args);
+        });
+
+        // We create and destroy the shared memory transport on a worker thread, because destroying it waits for
+        // its internal thread to finish. The internal thread stops waiting for the game thread as soon as it is
+        // asked to stop, so destroying the transport on the game thread in ~SpFuncService() doesn't deadlock.
+        unreal_entry_point_binder->bindFuncNoUnreal("sp_func_service", "create_shared_memory_transport", [this](int& payload_num_bytes) -> SpFuncSharedMemoryView {
+            std::lock_guard<std::mutex> lock(shared_memory_transport_mutex_);
+            SP_ASSERT(!shared_memory_transport_);
+            shared_memory_transport_ = std::make_unique<SpFuncSharedMemoryTransport>(payload_num_bytes, call_func_unreal_);
+            SP_ASSERT(shared_memory_transport_);
+            return shared_memory_transport_->getView();
+        });
+
+        unreal_entry_point_binder->bindFuncNoUnreal("sp_func_service", "destroy_shared_memory_transport", [this]() -> void {
+            std::lock_guard<std::mutex> lock(shared_memory_transport_mutex_);
+            SP_ASSERT(shared_memory_transport_);
+            shared_memory_transport_ = nullptr;
+        });
     }
 
     ~SpFuncService()
     {
+        shared_memory_transport_ = nullptr;
+
         FWorldDelegates::OnWorldCleanup.Remove(world_cleanup_handle_);
         FWorldDelegates::OnPostWorldInitialization.Remove(post_world_initialization_handle_);
 
@@ -129,11 +147,17 @@ private:
     void postWorldInitializationHandler(UWorld* world, const UWorld::InitializationValues initialization_values);
     void worldCleanupHandler(UWorld* world, bool session_ended, bool cleanup_resources);
 
+    SpFuncDataBundle callFunc(std::string& func_name, SpFuncDataBundle& args);
+
     static USpFuncComponent* getSpFuncComponent(const UObject* uobject);
 
     FDelegateHandle post_world_initialization_handle_;
     FDelegateHandle world_cleanup_handle_;
     UWorld* world_ = nullptr;
+
+    std::function<std::future<SpFuncDataBundle>(std::string&, SpFuncDataBundle&)> call_func_unreal_;
+    std::unique_ptr<SpFuncSharedMemoryTransport> shared_memory_transport_ = nullptr;
+    std::mutex shared_memory_transport_mutex_;
 };
 
 //
@@ -148,14 +172,19 @@ MSGPACK_ADD_ENUM(SpFuncSharedMemoryUsageFlags);
 // SpFuncDataBundle
 //
 
+template <>
+struct MsgpackStructDesc<SpFuncDataBundle> {
+    static constexpr auto k_field_descs = std::make_tuple(
+        Msgpack::fieldDesc("packed_arrays", &SpFuncDataBundle::packed_arrays_),
+        Msgpack::fieldDesc("unreal_obj_strings", &SpFuncDataBundle::unreal_obj_strings_),
+        Msgpack::fieldDesc("info", &SpFuncDataBundle::info_));
+};
+
 template <> // needed to receive a custom type as an arg
 struct clmdep_msgpack::adaptor::convert<SpFuncDataBundle> {
     clmdep_msgpack::object const& operator()(clmdep_msgpack::object const& object, SpFuncDataBundle& data_bundle) const {
-        std::map<std::string, clmdep_msgpack::object> map = Msgpack::toMap(object);
-        SP_ASSERT(map.size() == 3);
-        data_bundle.packed_arrays_ = Msgpack::to<std::map<std::string, SpFuncPackedArray>>(map.at("packed_arrays"));
-        data_bundle.unreal_obj_strings_ = Msgpack::to<std::map<std::string, std::string>>(map.at("unreal_obj_strings"));
-        data_bundle.info_ = Msgpack::to<std::string>(map.at("info"));
+        SP_PROFILE_SCOPE("clmdep_msgpack::adaptor::convert<SpFuncDataBundle>");
+        Msgpack::toStruct(object, data_bundle);
         return object;
     }
 };
@@ -163,11 +192,8 @@ struct clmdep_msgpack::adaptor::convert<SpFuncDataBundle> {
 template <> // needed to send a custom type as a return value
 struct clmdep_msgpack::adaptor::object_with_zone<SpFuncDataBundle> {
     void operator()(clmdep_msgpack::object::with_zone& object, SpFuncDataBundle const& data_bundle) const {
-        std::map<std::string, clmdep_msgpack::object> map = {
-            {"packed_arrays", clmdep_msgpack::object(data_bundle.packed_arrays_, object.zone)},
-            {"unreal_obj_strings", clmdep_msgpack::object(data_bundle.unreal_obj_strings_, object.zone)},
-            {"info", clmdep_msgpack::object(data_bundle.info_, object.zone)}};
-        Msgpack::toObject(object, map);
+        SP_PROFILE_SCOPE("clmdep_msgpack::adaptor::object_with_zone<SpFuncDataBundle>");
+        Msgpack::toObject(object, data_bundle);
     }
 };
 
@@ -175,16 +201,95 @@ struct clmdep_msgpack::adaptor::object_with_zone<SpFuncDataBundle> {
 // SpFuncPackedArray
 //
 
+// SpFuncPackedArray objects that refer to shared memory are sent and received as msgpack maps. All other
+// SpFuncPackedArray objects are sent and received as a msgpack ext type, where the payload consists of an
+// SpFuncPackedArrayExtHeader, followed by num_dims_ uint64_t values for the shape, followed by the array data.
+// When receiving an arg, we set the packed array's view_ to point directly at the data inside the msgpack zone
+// that holds the incoming RPC message, rather than copying the data into data_. The zone remains valid for the
+// duration of the call, so an SpFuncArrayView can consume the arg without any copies. The layout of the payload
+// must match python/spear/sp_func_service.py.
+
+struct SpFuncPackedArrayExtHeader
+{
+    static constexpr int8_t k_ext_type = 1;
+
+    int8_t data_type_ = -1;  // SpFuncArrayDataType
+    char byte_order_ = '<';  // '<' for little-endian or '>' for big-endian, applies to the shape and the data
+    uint8_t num_dims_ = 0;
+    uint8_t padding_[4] = {}; // the ext type is stored in the byte before the header, so the shape is 8-byte aligned relative to it
+
+    static char getNativeByteOrder() { return std::endian::native == std::endian::little ? '<' : '>'; }
+};
+static_assert(sizeof(SpFuncPackedArrayExtHeader) == 7);
+
+template <>
+struct MsgpackStructDesc<SpFuncPackedArray> {
+    static constexpr auto k_field_descs = std::make_tuple(
+        Msgpack::fieldDesc("data", &SpFuncPackedArray::data_),
+        Msgpack::fieldDesc("data_source", &SpFuncPackedArray::data_source_),
+        Msgpack::fieldDesc("shape", &SpFuncPackedArray::shape_),
+        Msgpack::fieldDesc("data_type", &SpFuncPackedArray::data_type_),
+        Msgpack::fieldDesc("shared_memory_name", &SpFuncPackedArray::shared_memory_name_));
+};
+
 template <> // needed to receive a custom type as an arg
 struct clmdep_msgpack::adaptor::convert<SpFuncPackedArray> {
     clmdep_msgpack::object const& operator()(clmdep_msgpack::object const& object, SpFuncPackedArray& packed_array) const {
-        std::map<std::string, clmdep_msgpack::object> map = Msgpack::toMap(object);
-        SP_ASSERT(map.size() == 5);
-        packed_array.data_ = Msgpack::to<std::vector<uint8_t>>(map.at("data"));
-        packed_array.data_source_ = Msgpack::to<SpFuncArrayDataSource>(map.at("data_source"));
-        packed_array.shape_ = Msgpack::to<std::vector<uint64_t>>(map.at("shape"));
-        packed_array.data_type_ = Msgpack::to<SpFuncArrayDataType>(map.at("data_type"));
-        packed_array.shared_memory_name_ = Msgpack::to<std::string>(map.at("shared_memory_name"));
+        if (object.type == clmdep_msgpack::type::MAP) {
+            Msgpack::toStruct(object, packed_array);
+            if (!SpFuncArrayDataTypeUtils::isValid(static_cast<int8_t>(packed_array.data_type_))) {
+                throw std::runtime_error("Invalid data type for SpFuncPackedArray: " + std::to_string(static_cast<int8_t>(packed_array.data_type_)));
+            }
+            if (packed_array.data_source_ == SpFuncArrayDataSource::Internal) {
+                packed_array.view_ = packed_array.data_.data();
+            }
+            return object;
+        }
+
+        SP_ASSERT(object.type == clmdep_msgpack::type::EXT);
+        SP_ASSERT(object.via.ext.type() == SpFuncPackedArrayExtHeader::k_ext_type);
+
+        const char* payload = object.via.ext.data();
+        uint64_t payload_num_bytes = object.via.ext.size;
+
+        SpFuncPackedArrayExtHeader header;
+        SP_ASSERT(payload_num_bytes >= sizeof(header));
+        std::memcpy(&header, payload, sizeof(header));
+        SP_ASSERT(header.byte_order_ == SpFuncPackedArrayExtHeader::getNativeByteOrder());
+
+        uint64_t shape_num_bytes = header.num_dims_*sizeof(uint64_t);
+        SP_ASSERT(payload_num_bytes >= sizeof(header) + shape_num_bytes);
+        packed_array.shape_.resize(header.num_dims_);
+        std::memcpy(packed_array.shape_.data(), payload + sizeof(header), shape_num_bytes);
+
+        // the data type comes directly from the client, so we reject it before passing it to getSizeOf(...)
+        if (!SpFuncArrayDataTypeUtils::isValid(header.data_type_)) {
+            throw std::runtime_error("Invalid data type for SpFuncPackedArray: " + std::to_string(header.data_type_));
+        }
+        packed_array.data_type_ = static_cast<SpFuncArrayDataType>(header.data_type_);
+
+        uint64_t num_elements = 0;
+        if (!packed_array.shape_.empty()) {
+            num_elements = std::accumulate(packed_array.shape_.begin(), packed_array.shape_.end(), uint64_t{1}, std::multiplies<uint64_t>());
+        }
+        int element_num_bytes = SpFuncArrayDataTypeUtils::getSizeOf(packed_array.data_type_);
+        uint64_t data_num_bytes = num_elements*element_num_bytes;
+        SP_ASSERT(payload_num_bytes == sizeof(header) + shape_num_bytes + data_num_bytes);
+
+        // msgpack doesn't guarantee any alignment for ext payloads, so we fall back to copying the data if it
+        // isn't suitably aligned for its data type
+        const char* data = payload + sizeof(header) + shape_num_bytes;
+        if (reinterpret_cast<uintptr_t>(data) % element_num_bytes == 0) {
+            packed_array.data_ = {};
+            packed_array.view_ = const_cast<char*>(data);
+            packed_array.data_source_ = SpFuncArrayDataSource::External;
+        } else {
+            packed_array.data_ = std::vector<uint8_t>(data, data + data_num_bytes);
+            packed_array.view_ = packed_array.data_.data();
+            packed_array.data_source_ = SpFuncArrayDataSource::Internal;
+        }
+        packed_array.shared_memory_name_ = "";
+
         return object;
     }
 };
@@ -192,13 +297,42 @@ struct clmdep_msgpack::adaptor::convert<SpFuncPackedArray> {
 template <> // needed to send a custom type as a return value
 struct clmdep_msgpack::adaptor::object_with_zone<SpFuncPackedArray> {
     void operator()(clmdep_msgpack::object::with_zone& object, SpFuncPackedArray const& packed_array) const {
-        std::map<std::string, clmdep_msgpack::object> map = {
-            {"data", clmdep_msgpack::object(packed_array.data_, object.zone)},
-            {"data_source", clmdep_msgpack::object(packed_array.data_source_, object.zone)},
-            {"shape", clmdep_msgpack::object(packed_array.shape_, object.zone)},
-            {"data_type", clmdep_msgpack::object(packed_array.data_type_, object.zone)},
-            {"shared_memory_name", clmdep_msgpack::object(packed_array.shared_memory_name_, object.zone)}};
-        Msgpack::toObject(object, map);
+        if (packed_array.data_source_ == SpFuncArrayDataSource::Shared) {
+            Msgpack::toObject(object, packed_array);
+            return;
+        }
+
+        SP_ASSERT(packed_array.data_source_ == SpFuncArrayDataSource::Internal || packed_array.data_source_ == SpFuncArrayDataSource::External);
+        SP_ASSERT(packed_array.shape_.size() <= std::numeric_limits<uint8_t>::max());
+
+        uint64_t num_elements = 0;
+        if (!packed_array.shape_.empty()) {
+            num_elements = std::accumulate(packed_array.shape_.begin(), packed_array.shape_.end(), uint64_t{1}, std::multiplies<uint64_t>());
+        }
+
+        SpFuncPackedArrayExtHeader header;
+        header.data_type_ = static_cast<int8_t>(packed_array.data_type_);
+        header.byte_order_ = SpFuncPackedArrayExtHeader::getNativeByteOrder();
+        header.num_dims_ = static_cast<uint8_t>(packed_array.shape_.size());
+
+        uint64_t shape_num_bytes = packed_array.shape_.size()*sizeof(uint64_t);
+        uint64_t data_num_bytes = num_elements*SpFuncArrayDataTypeUtils::getSizeOf(packed_array.data_type_);
+        uint64_t payload_num_bytes = sizeof(header) + shape_num_bytes + data_num_bytes;
+        SP_ASSERT(payload_num_bytes <= std::numeric_limits<uint32_t>::max());
+
+        // the ext type is stored in the first byte, followed by the payload
+        char* ptr = static_cast<char*>(object.zone.allocate_align(payload_num_bytes + 1));
+        ptr[0] = SpFuncPackedArrayExtHeader::k_ext_type;
+        std::memcpy(ptr + 1, &header, sizeof(header));
+        std::memcpy(ptr + 1 + sizeof(header), packed_array.shape_.data(), shape_num_bytes);
+        if (data_num_bytes > 0) {
+            SP_ASSERT(packed_array.view_);
+            std::memcpy(ptr + 1 + sizeof(header) + shape_num_bytes, packed_array.view_, data_num_bytes);
+        }
+
+        object.type = clmdep_msgpack::type::EXT;
+        object.via.ext.ptr = ptr;
+        object.via.ext.size = static_cast<uint32_t>(payload_num_bytes);
     }
 };
 
@@ -206,14 +340,18 @@ struct clmdep_msgpack::adaptor::object_with_zone<SpFuncPackedArray> {
 // SpFuncSharedMemoryView
 //
 
+template <>
+struct MsgpackStructDesc<SpFuncSharedMemoryView> {
+    static constexpr auto k_field_descs = std::make_tuple(
+        Msgpack::fieldDesc("id", &SpFuncSharedMemoryView::id_),
+        Msgpack::fieldDesc("num_bytes", &SpFuncSharedMemoryView::num_bytes_),
+        Msgpack::fieldDesc("usage_flags", &SpFuncSharedMemoryView::usage_flags_));
+};
+
 template <> // needed to receive a custom type as an arg
 struct clmdep_msgpack::adaptor::convert<SpFuncSharedMemoryView> {
     clmdep_msgpack::object const& operator()(clmdep_msgpack::object const& object, SpFuncSharedMemoryView& shared_memory_view) const {
-        std::map<std::string, clmdep_msgpack::object> map = Msgpack::toMap(object);
-        SP_ASSERT(map.size() == 3);
-        shared_memory_view.id_ = Msgpack::to<std::string>(map.at("id"));
-        shared_memory_view.num_bytes_ = Msgpack::to<int>(map.at("num_bytes"));
-        shared_memory_view.usage_flags_ = Msgpack::to<SpFuncSharedMemoryUsageFlags>(map.at("usage_flags"));
+        Msgpack::toStruct(object, shared_memory_view);
         return object;
     }
 };
@@ -221,10 +359,6 @@ struct clmdep_msgpack::adaptor::convert<SpFuncSharedMemoryView> {
 template <> // needed to send a custom type as a return value
 struct clmdep_msgpack::adaptor::object_with_zone<SpFuncSharedMemoryView> {
     void operator()(clmdep_msgpack::object::with_zone& object, SpFuncSharedMemoryView const& shared_memory_view) const {
-        std::map<std::string, clmdep_msgpack::object> map = {
-            {"id", clmdep_msgpack::object(shared_memory_view.id_, object.zone)},
-            {"num_bytes", clmdep_msgpack::object(shared_memory_view.num_bytes_, object.zone)},
-            {"usage_flags", clmdep_msgpack::object(shared_memory_view.usage_flags_, object.zone)}};
-        Msgpack::toObject(object, map);
+        Msgpack::toObject(object, shared_memory_view);
     }
 };
@@ -0,0 +1,355 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#include "SpServices/SpFuncSharedMemoryTransport.h"
+
+#include <stddef.h> // offsetof
+#include <stdint.h> // uint8_t, uint32_t, uint64_t
+#include <string.h> // memcpy, memset, strnlen
+
+#include <algorithm>  // std::min, std::ranges::copy
+#include <atomic>     // std::atomic_ref
+#include <chrono>     // std::chrono::microseconds, std::chrono::milliseconds
+#include <exception>
+#include <functional> // std::function
+#include <future>
+#include <limits>     // std::numeric_limits
+#include <memory>     // std::unique_ptr
+#include <stdexcept>  // std::runtime_error
+#include <string>
+#include <thread>     // std::this_thread::sleep_for, std::this_thread::yield
+#include <type_traits>
+#include <utility>    // std::move
+#include <vector>
+
+#include "SpCore/Assert.h"
+#include "SpCore/Boost.h"
+#include "SpCore/Log.h"
+#include "SpCore/SharedMemoryPool.h"
+#include "SpCore/SharedMemoryRegion.h"
+#include "SpCore/SpFuncArray.h"
+#include "SpCore/Std.h"
+
+#if BOOST_OS_LINUX
+    #include <linux/futex.h> // FUTEX_WAIT, FUTEX_WAKE
+    #include <sys/syscall.h> // SYS_futex
+    #include <time.h>        // timespec
+    #include <unistd.h>      // syscall
+#endif
+
+// the client is expected to write these structs directly, so they must have a predictable layout
+static_assert(std::is_standard_layout_v<SpFuncSharedMemoryTransportArrayDesc>);
+static_assert(std::is_standard_layout_v<SpFuncSharedMemoryTransportHeader>);
+static_assert(sizeof(SpFuncSharedMemoryTransportArrayDesc) == 224);
+static_assert(sizeof(SpFuncSharedMemoryTransportHeader) == 104 + 224*SpFuncSharedMemoryTransportHeader::k_max_num_arrays);
+static_assert(offsetof(SpFuncSharedMemoryTransportHeader, response_sequence_) == 8);
+static_assert(offsetof(SpFuncSharedMemoryTransportHeader, func_name_) == 16);
+
+// The server waits for the doorbell by spinning for a short time, and then blocking with a timeout. On Linux,
+// the client wakes the server up as soon as it rings the doorbell, so the timeout only matters on platforms
+// where we poll. The timeout doubles after each wait up to a maximum, so an idle server wakes up rarely, but
+// still notices a request within a few ms when polling. The destructor wakes the server up when it is asked
+// to stop.
+static constexpr int k_num_spin_iterations = 1000;
+static constexpr int k_min_sleep_duration_microseconds = 50;
+static constexpr int k_max_sleep_duration_microseconds = 4000;
+
+// while the game thread is executing an SpFunc, we check whether we have been asked to stop this often
+static constexpr int k_stop_poll_interval_milliseconds = 10;
+
+// arrays in the payload region are aligned to this many bytes, so the client can create aligned views into them
+static constexpr uint64_t k_payload_alignment = 16;
+
+static std::string toString(const char* chars, int max_length)
+{
+    return std::string(chars, strnlen(chars, max_length));
+}
+
+static void copyString(char* chars, const std::string& string, int max_length)
+{
+    // need space for the null terminator
+    if (string.size() >= max_length) {
+        throw std::runtime_error("The string \"" + string + "\" is too long for the shared memory control block, the maximum length is " + std::to_string(max_length - 1) + " characters.");
+    }
+    memset(chars, 0, max_length);
+    memcpy(chars, string.data(), string.size());
+}
+
+// Blocks until the value at address is no longer equal to expected_value, until another thread or process calls
+// wake(address), or until the timeout expires. Spurious wakeups are possible, so the caller needs to check the
+// value again. On platforms other than Linux, we sleep for the entire timeout.
+static void waitForChange(uint32_t* address, uint32_t expected_value, int timeout_microseconds)
+{
+    #if BOOST_OS_LINUX
+        // we use FUTEX_WAIT rather than FUTEX_WAIT_PRIVATE, because the other side is in a different process
+        timespec timeout = {timeout_microseconds / 1000000, (timeout_microseconds % 1000000)*1000};
+        syscall(SYS_futex, address, FUTEX_WAIT, expected_value, &timeout, nullptr, 0);
+    #else
+        std::this_thread::sleep_for(std::chrono::microseconds(timeout_microseconds));
+    #endif
+}
+
+static void wake(uint32_t* address)
+{
+    #if BOOST_OS_LINUX
+        syscall(SYS_futex, address, FUTEX_WAKE, std::numeric_limits<int>::max(), nullptr, nullptr, 0);
+    #endif
+}
+
+// The client writes the shape directly into the control block, so we check for overflow when computing the
+// number of bytes. As elsewhere, an empty shape describes an array with 0 elements.
+static uint64_t getNumBytes(const std::vector<uint64_t>& shape, SpFuncArrayDataType data_type)
+{
+    if (shape.empty()) {
+        return 0;
+    }
+    uint64_t num_bytes = SpFuncArrayDataTypeUtils::getSizeOf(data_type);
+    for (auto dim : shape) {
+        if (dim != 0 && num_bytes > std::numeric_limits<uint64_t>::max() / dim) {
+            throw std::runtime_error("The number of bytes in an array overflows a 64-bit integer.");
+        }
+        num_bytes *= dim;
+    }
+    return num_bytes;
+}
+
+SpFuncSharedMemoryTransport::SpFuncSharedMemoryTransport(int payload_num_bytes, const std::function<std::future<SpFuncDataBundle>(std::string&, SpFuncDataBundle&)>& call_func)
+{
+    SP_ASSERT(payload_num_bytes > 0);
+    SP_ASSERT(call_func);
+
+    call_func_ = call_func;
+
+    shared_memory_region_ = SharedMemoryPool::acquire(sizeof(SpFuncSharedMemoryTransportHeader) + payload_num_bytes);
+    SP_ASSERT(shared_memory_region_);
+
+    // the region might be larger than requested, because the pool rounds up to a size class, so we derive the
+    // size of our payload region from the size of the view, which is also what the client does
+    shared_memory_view_ = shared_memory_region_->getView();
+    header_ = static_cast<SpFuncSharedMemoryTransportHeader*>(shared_memory_view_.data_);
+    payload_ = static_cast<uint8_t*>(shared_memory_view_.data_) + sizeof(SpFuncSharedMemoryTransportHeader);
+    payload_num_bytes_ = shared_memory_view_.num_bytes_ - sizeof(SpFuncSharedMemoryTransportHeader);
+
+    memset(shared_memory_view_.data_, 0, shared_memory_view_.num_bytes_);
+
+    thread_ = std::thread(&SpFuncSharedMemoryTransport::waitForRequests, this);
+}
+
+SpFuncSharedMemoryTransport::~SpFuncSharedMemoryTransport()
+{
+    // Our internal thread might be waiting for the game thread to execute an SpFunc, and we might be running on
+    // the game thread, so we ask our internal thread to stop waiting before joining it.
+    stop_requested_ = true;
+    wake(&header_->request_sequence_);
+    SP_ASSERT(thread_.joinable());
+    thread_.join();
+
+    header_ = nullptr;
+    payload_ = nullptr;
+    payload_num_bytes_ = 0;
+
+    SP_ASSERT(shared_memory_region_);
+    SharedMemoryPool::release(std::move(shared_memory_region_));
+}
+
+SpFuncSharedMemoryView SpFuncSharedMemoryTransport::getView() const
+{
+    return SpFuncSharedMemoryView(shared_memory_view_, SpFuncSharedMemoryUsageFlags::Arg | SpFuncSharedMemoryUsageFlags::ReturnValue);
+}
+
+void SpFuncSharedMemoryTransport::waitForRequests()
+{
+    uint32_t previous_request_sequence = 0;
+    int num_idle_iterations = 0;
+    int sleep_duration_microseconds = k_min_sleep_duration_microseconds;
+
+    while (!stop_requested_) {
+        uint32_t request_sequence = std::atomic_ref<uint32_t>(header_->request_sequence_).load(std::memory_order_acquire);
+
+        if (request_sequence != previous_request_sequence) {
+            bool handled = handleRequest();
+            if (!handled) {
+                break;
+            }
+            std::atomic_ref<uint32_t>(header_->response_sequence_).store(request_sequence, std::memory_order_release);
+            wake(&header_->response_sequence_);
+            previous_request_sequence = request_sequence;
+            num_idle_iterations = 0;
+            sleep_duration_microseconds = k_min_sleep_duration_microseconds;
+        } else if (num_idle_iterations < k_num_spin_iterations) {
+            num_idle_iterations++;
+            std::this_thread::yield();
+        } else {
+            waitForChange(&header_->request_sequence_, previous_request_sequence, sleep_duration_microseconds);
+            sleep_duration_microseconds = std::min(2*sleep_duration_microseconds, k_max_sleep_duration_microseconds);
+        }
+    }
+}
+
+bool SpFuncSharedMemoryTransport::handleRequest()
+{
+    std::string func_name = toString(header_->func_name_, SpFuncSharedMemoryTransportHeader::k_max_name_length);
+
+    // Wait until the game thread has finished executing the SpFunc, or until we have been asked to stop, in
+    // which case we abandon the request. The abandoned task remains in the work queue, and owns copies of
+    // func_name and args, so it can still execute safely if the game thread runs the work queue again. If
+    // the request is invalid, if the SpFunc threw an exception, if the SpFunc couldn't be scheduled because
+    // the work queue is full, or if the return values don't fit in the control block, we return an empty data
+    // bundle to the client, with the error message in its info string, rather than letting the exception
+    // terminate our internal thread.
+    try {
+        SpFuncDataBundle args = readDataBundle();
+        std::future<SpFuncDataBundle> future = call_func_(func_name, args);
+        while (future.wait_for(std::chrono::milliseconds(k_stop_poll_interval_milliseconds)) != std::future_status::ready) {
+            if (stop_requested_) {
+                return false;
+            }
+        }
+        writeDataBundle(future.get());
+    } catch (const std::exception& e) {
+        SP_LOG("ERROR: SpFunc ", func_name, " failed: ", e.what());
+        writeErrorDataBundle(e.what());
+    }
+
+    return true;
+}
+
+SpFuncDataBundle SpFuncSharedMemoryTransport::readDataBundle() const
+{
+    SpFuncDataBundle data_bundle;
+
+    uint64_t num_arrays = header_->num_arrays_;
+    if (num_arrays > SpFuncSharedMemoryTransportHeader::k_max_num_arrays) {
+        throw std::runtime_error("The request contains " + std::to_string(num_arrays) + " arrays, but the maximum is " + std::to_string(SpFuncSharedMemoryTransportHeader::k_max_num_arrays) + ".");
+    }
+
+    for (int i = 0; i < num_arrays; i++) {
+        const SpFuncSharedMemoryTransportArrayDesc& array_desc = header_->arrays_[i];
+        std::string name = toString(array_desc.name_, SpFuncSharedMemoryTransportArrayDesc::k_max_name_length);
+
+        uint64_t num_dims = array_desc.num_dims_;
+        if (num_dims > SpFuncSharedMemoryTransportArrayDesc::k_max_num_dims) {
+            throw std::runtime_error("The array " + name + " has " + std::to_string(num_dims) + " dimensions, but the maximum is " + std::to_string(SpFuncSharedMemoryTransportArrayDesc::k_max_num_dims) + ".");
+        }
+
+        SpFuncPackedArray packed_array;
+        packed_array.data_source_ = static_cast<SpFuncArrayDataSource>(array_desc.data_source_);
+        packed_array.data_type_ = static_cast<SpFuncArrayDataType>(array_desc.data_type_);
+        packed_array.shape_ = std::vector<uint64_t>(array_desc.shape_, array_desc.shape_ + num_dims);
+
+        if (packed_array.data_type_ < SpFuncArrayDataType::UInt8 || packed_array.data_type_ > SpFuncArrayDataType::Float64) {
+            throw std::runtime_error("The array " + name + " has an unknown data type: " + std::to_string(array_desc.data_type_));
+        }
+
+        if (packed_array.data_source_ == SpFuncArrayDataSource::Internal) {
+            // we compare against the remaining space rather than adding to the offset, so we can't overflow
+            uint64_t data_offset = array_desc.data_offset_;
+            uint64_t data_num_bytes = array_desc.data_num_bytes_;
+            if (data_offset > payload_num_bytes_ || data_num_bytes > payload_num_bytes_ - data_offset) {
+                throw std::runtime_error("The data for the array " + name + " extends past the end of the payload region.");
+            }
+            if (data_num_bytes != getNumBytes(packed_array.shape_, packed_array.data_type_)) {
+                throw std::runtime_error("The number of bytes for the array " + name + " doesn't match its shape and data type.");
+            }
+            packed_array.data_ = std::vector<uint8_t>(payload_ + data_offset, payload_ + data_offset + data_num_bytes);
+            packed_array.view_ = packed_array.data_.data();
+
+        } else if (packed_array.data_source_ == SpFuncArrayDataSource::Shared) {
+            packed_array.shared_memory_name_ = toString(array_desc.shared_memory_name_, SpFuncSharedMemoryTransportArrayDesc::k_max_name_length);
+
+        } else {
+            throw std::runtime_error("The array " + name + " has an unsupported data source: " + std::to_string(array_desc.data_source_));
+        }
+
+        Std::insert(data_bundle.packed_arrays_, name, std::move(packed_array));
+    }
+
+    uint64_t info_offset = header_->info_offset_;
+    uint64_t info_num_bytes = header_->info_num_bytes_;
+    if (info_offset > payload_num_bytes_ || info_num_bytes > payload_num_bytes_ - info_offset) {
+        throw std::runtime_error("The info string extends past the end of the payload region.");
+    }
+    data_bundle.info_ = std::string(reinterpret_cast<const char*>(payload_ + info_offset), info_num_bytes);
+
+    return data_bundle;
+}
+
+void SpFuncSharedMemoryTransport::writeDataBundle(const SpFuncDataBundle& data_bundle)
+{
+    // unreal_obj_strings_ doesn't have a fixed-layout representation in the control block
+    if (!data_bundle.unreal_obj_strings_.empty()) {
+        throw std::runtime_error("The SpFunc returned Unreal object strings, which can't be returned via the shared memory transport.");
+    }
+    if (data_bundle.packed_arrays_.size() > SpFuncSharedMemoryTransportHeader::k_max_num_arrays) {
+        throw std::runtime_error("The SpFunc returned " + std::to_string(data_bundle.packed_arrays_.size()) + " arrays, but the maximum is " + std::to_string(SpFuncSharedMemoryTransportHeader::k_max_num_arrays) + ".");
+    }
+
+    uint64_t payload_offset = 0;
+    int i = 0;
+
+    for (auto& [name, packed_array] : data_bundle.packed_arrays_) {
+        if (packed_array.shape_.size() > SpFuncSharedMemoryTransportArrayDesc::k_max_num_dims) {
+            throw std::runtime_error("The array " + name + " has " + std::to_string(packed_array.shape_.size()) + " dimensions, but the maximum is " + std::to_string(SpFuncSharedMemoryTransportArrayDesc::k_max_num_dims) + ".");
+        }
+
+        SpFuncSharedMemoryTransportArrayDesc& array_desc = header_->arrays_[i];
+        memset(&array_desc, 0, sizeof(SpFuncSharedMemoryTransportArrayDesc));
+
+        copyString(array_desc.name_, name, SpFuncSharedMemoryTransportArrayDesc::k_max_name_length);
+        array_desc.data_type_ = static_cast<int8_t>(packed_array.data_type_);
+        array_desc.num_dims_ = packed_array.shape_.size();
+        std::ranges::copy(packed_array.shape_, array_desc.shape_);
+
+        switch (packed_array.data_source_) {
+
+            // Internal and External arrays are both copied into the payload region and returned to the client as Internal arrays
+            case SpFuncArrayDataSource::Internal:
+            case SpFuncArrayDataSource::External:
+            {
+                uint64_t num_bytes = getNumBytes(packed_array.shape_, packed_array.data_type_);
+
+                payload_offset = ((payload_offset + k_payload_alignment - 1) / k_payload_alignment) * k_payload_alignment;
+                if (payload_offset > payload_num_bytes_ || num_bytes > payload_num_bytes_ - payload_offset) {
+                    throw std::runtime_error("The return values don't fit in the payload region, which has " + std::to_string(payload_num_bytes_) + " bytes. Create the shared memory transport with a larger payload region.");
+                }
+                SP_ASSERT(num_bytes == 0 || packed_array.view_);
+                memcpy(payload_ + payload_offset, packed_array.view_, num_bytes);
+
+                array_desc.data_source_ = static_cast<int8_t>(SpFuncArrayDataSource::Internal);
+                array_desc.data_offset_ = payload_offset;
+                array_desc.data_num_bytes_ = num_bytes;
+                payload_offset += num_bytes;
+                break;
+            }
+
+            case SpFuncArrayDataSource::Shared:
+                array_desc.data_source_ = static_cast<int8_t>(SpFuncArrayDataSource::Shared);
+                copyString(array_desc.shared_memory_name_, packed_array.shared_memory_name_, SpFuncSharedMemoryTransportArrayDesc::k_max_name_length);
+                break;
+
+            default:
+                SP_ASSERT(false);
+                break;
+        }
+
+        i++;
+    }
+
+    if (payload_offset > payload_num_bytes_ || data_bundle.info_.size() > payload_num_bytes_ - payload_offset) {
+        throw std::runtime_error("The return values don't fit in the payload region, which has " + std::to_string(payload_num_bytes_) + " bytes. Create the shared memory transport with a larger payload region.");
+    }
+    memcpy(payload_ + payload_offset, data_bundle.info_.data(), data_bundle.info_.size());
+
+    header_->num_arrays_ = data_bundle.packed_arrays_.size();
+    header_->info_offset_ = payload_offset;
+    header_->info_num_bytes_ = data_bundle.info_.size();
+}
+
+void SpFuncSharedMemoryTransport::writeErrorDataBundle(const std::string& error)
+{
+    // the payload region might be too small for the entire error message, in which case we truncate it
+    SpFuncDataBundle data_bundle;
+    data_bundle.info_ = error.substr(0, payload_num_bytes_);
+    writeDataBundle(data_bundle);
+}
@@ -0,0 +1,100 @@
+//
+// Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+//
+
+#pragma once
+
+#include <stdint.h> // int8_t, uint8_t, uint32_t, uint64_t
+
+#include <atomic>
+#include <functional> // std::function
+#include <future>
+#include <memory>     // std::unique_ptr
+#include <string>
+#include <thread>
+
+#include "SpCore/SharedMemoryRegion.h"
+#include "SpCore/SpFuncArray.h"
+
+//
+// SpFuncSharedMemoryTransport enables a client on the same host to call an SpFunc without sending any data
+// over a socket. The client writes a fixed-layout request header into a shared memory control block, rings
+// a doorbell by incrementing request_sequence_, and waits until response_sequence_ is equal to
+// request_sequence_. Both sides spin briefly before blocking, so a client that calls an SpFunc every frame
+// sees low latency. On Linux, both sides block in the futex system call on the sequence number they are
+// waiting for, and the other side wakes them up with the futex system call after updating it. Futexes work
+// across processes on any shared mapping, and Python can call the futex system call via ctypes, so we don't
+// need to pass any file descriptors between processes. On other platforms, neither side has a blocking
+// primitive that works across Python and C++, so both sides poll, sleeping with exponential backoff. Arrays
+// whose data source is SpFuncArrayDataSource::Shared are described only by their shared memory name, shape,
+// and data type, so their data is never copied. Arrays whose data source is SpFuncArrayDataSource::Internal
+// are copied into the payload region that immediately follows the header. The response is written into the
+// same header and payload region, overwriting the request. The client writes the header directly, so we
+// validate it before using it, and if it is invalid, we return an error to the client in the response's info
+// string, in the same way that we return an exception thrown by the SpFunc.
+//
+// The layout of the structs below must match python/spear/sp_func_service.py.
+//
+
+struct SpFuncSharedMemoryTransportArrayDesc
+{
+    static constexpr int k_max_name_length = 64;
+    static constexpr int k_max_num_dims = 8;
+
+    char name_[k_max_name_length];
+    char shared_memory_name_[k_max_name_length];
+    int8_t data_source_;
+    int8_t data_type_;
+    uint8_t padding_[6];
+    uint64_t num_dims_;
+    uint64_t shape_[k_max_num_dims];
+    uint64_t data_offset_;    // offset into the payload region, only used for SpFuncArrayDataSource::Internal
+    uint64_t data_num_bytes_; // only used for SpFuncArrayDataSource::Internal
+};
+
+struct SpFuncSharedMemoryTransportHeader
+{
+    static constexpr int k_max_name_length = 64;
+    static constexpr int k_max_num_arrays = 32;
+
+    // the futex system call operates on 32-bit words, so our sequence numbers are 32-bit, and padded to 8 bytes
+    alignas(8) uint32_t request_sequence_;  // incremented by the client to submit a request
+    uint32_t request_sequence_padding_;
+    uint32_t response_sequence_;            // set equal to request_sequence_ by the server when the response is ready
+    uint32_t response_sequence_padding_;
+    char func_name_[k_max_name_length];     // only used for requests
+    uint64_t num_arrays_;
+    uint64_t info_offset_;
+    uint64_t info_num_bytes_;
+    SpFuncSharedMemoryTransportArrayDesc arrays_[k_max_num_arrays];
+};
+
+class SpFuncSharedMemoryTransport
+{
+public:
+    SpFuncSharedMemoryTransport() = delete;
+    SpFuncSharedMemoryTransport(int payload_num_bytes, const std::function<std::future<SpFuncDataBundle>(std::string&, SpFuncDataBundle&)>& call_func);
+    ~SpFuncSharedMemoryTransport();
+
+    SpFuncSharedMemoryView getView() const;
+
+private:
+    void waitForRequests();
+    bool handleRequest();
+
+    SpFuncDataBundle readDataBundle() const;
+    void writeDataBundle(const SpFuncDataBundle& data_bundle);
+    void writeErrorDataBundle(const std::string& error);
+
+    // called from our internal thread, expected to schedule the SpFunc to execute on the game thread and return immediately
+    std::function<std::future<SpFuncDataBundle>(std::string&, SpFuncDataBundle&)> call_func_;
+
+    std::unique_ptr<SharedMemoryRegion> shared_memory_region_ = nullptr;
+    SharedMemoryView shared_memory_view_;
+    SpFuncSharedMemoryTransportHeader* header_ = nullptr;
+    uint8_t* payload_ = nullptr;
+    uint64_t payload_num_bytes_ = 0;
+
+    std::thread thread_;
+    std::atomic<bool> stop_requested_ = false;
+};
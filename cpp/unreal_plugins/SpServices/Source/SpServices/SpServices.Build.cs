@@ -24,6 +24,9 @@ public class SpServices : SpModuleRules
         // SpModuleRules without needing to add clutter to our uplugin files.
 
         PublicDependencyModuleNames.AddRange(new string[] {"ChaosVehicles", "SpComponents", "SpCore", "UrdfRobot", "Vehicle"});
-        PrivateDependencyModuleNames.AddRange(new string[] {});
+        // Our NavMesh class reads and writes Detour tile data directly to cache navmeshes on disk, so we need the Navmesh
+        // module, which is defined here:
+        //     Engine/Source/Runtime/Navmesh
+        PrivateDependencyModuleNames.AddRange(new string[] {"Navmesh"});
     }
 }
@@ -45,7 +45,26 @@ void SpServices::StartupModule()
     sp_func_service_ = std::make_unique<SpFuncService>(engine_service_.get());
     unreal_service_ = std::make_unique<UnrealService>(engine_service_.get());
 
-    int num_worker_threads = 1;
+    // Entry points bound via bindFuncNoUnreal(...) can execute concurrently on any worker thread, whereas entry
+    // points bound via bindFuncUnreal(...) execute on the game thread, in the order they were scheduled in
+    // EngineService's work queue. So using multiple worker threads enables entry points that don't touch Unreal
+    // state (e.g., "engine_service.ping") to execute while other worker threads are blocked waiting for the game
+    // thread, e.g., when multiple clients are connected to the same instance. However, with more than one worker
+    // thread, rpclib may dispatch requests that a client has pipelined on the same connection to different worker
+    // threads concurrently, so these requests might be scheduled in the work queue, and therefore execute on the
+    // game thread, in a different order than they were sent. Clients that need a specific order must either wait
+    // for each response before sending the next request, or schedule their calls in a single request via
+    // "engine_service.call_async_batch" or "engine_service.step". Only one client can drive a frame at a time
+    // though, so concurrent calls to "engine_service.begin_tick" (or any other entry point that advances the
+    // frame) are rejected with an error, see EngineService.h. If the config system isn't initialized, we use a
+    // single worker thread, which preserves the order of all requests.
+    int num_worker_threads = -1;
+    if (Config::isInitialized()) {
+        num_worker_threads = Config::get<int>("SP_SERVICES.NUM_RPC_WORKER_THREADS");
+    } else {
+        num_worker_threads = 1;
+    }
+    SP_ASSERT(num_worker_threads >= 1);
     rpc_server_->async_run(num_worker_threads);
 }
 
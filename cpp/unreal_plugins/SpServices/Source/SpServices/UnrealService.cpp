@@ -4,14 +4,23 @@
 
 #include "SpServices/UnrealService.h"
 
-#include <string>
+#include <stdint.h> // uint64_t
+
+#include <map>
+#include <stdexcept> // std::runtime_error
+#include <string>    // std::string, std::to_string
+#include <utility>   // std::move
 #include <vector>
 
 #include <Engine/Engine.h> // GEngine
 #include <Engine/World.h>
+#include <UObject/Class.h> // UStruct
+#include <UObject/Object.h>
 
 #include "SpCore/Assert.h"
 #include "SpCore/Log.h"
+#include "SpCore/Std.h"
+#include "SpCore/Unreal.h"
 
 void UnrealService::postWorldInitializationHandler(UWorld* world, const UWorld::InitializationValues initialization_values)
 {
@@ -20,6 +29,7 @@ void UnrealService::postWorldInitializationHandler(UWorld* world, const UWorld::
     if (world->IsGameWorld() && GEngine->GetWorldContextFromWorld(world)) {
         SP_ASSERT(!world_);
         world_ = world;
+        world_generation_++;
     }
 }
 
@@ -29,5 +39,48 @@ void UnrealService::worldCleanupHandler(UWorld* world, bool session_ended, bool
     SP_ASSERT(world);
     if (world == world_) {
         world_ = nullptr;
+        prepared_functions_.clear();
+        property_chains_.clear();
     }
 }
+
+const Unreal::PreparedFunction& UnrealService::getPreparedFunction(uint64_t handle) const
+{
+    if (!Std::containsKey(prepared_functions_, handle)) {
+        throw std::runtime_error(
+            "Invalid prepared function handle " + std::to_string(handle) + ". Prepared functions are destroyed when the world is cleaned up, "
+            "so they need to be prepared again after opening a new level, e.g., see unreal_service.get_world_generation.");
+    }
+    return prepared_functions_.at(handle);
+}
+
+std::vector<Unreal::PropertyDesc> UnrealService::findPropertiesByName(const std::vector<uint64_t>& uobjects, const std::vector<std::string>& names)
+{
+    SP_ASSERT(uobjects.size() == names.size());
+
+    std::vector<Unreal::PropertyDesc> property_descs;
+    for (int i = 0; i < uobjects.size(); i++) {
+        UObject* uobject = toPtr<UObject>(uobjects.at(i));
+        SP_ASSERT(uobject);
+        const std::string& name = names.at(i);
+
+        const UStruct* ustruct = uobject->GetClass();
+        if (!Std::containsKey(property_chains_, ustruct)) {
+            Std::insert(property_chains_, ustruct, std::map<std::string, Unreal::PropertyChain>());
+        }
+        std::map<std::string, Unreal::PropertyChain>& property_chains = property_chains_.at(ustruct);
+        if (!Std::containsKey(property_chains, name)) {
+            Std::insert(property_chains, name, Unreal::getPropertyChain(uobject, name));
+        }
+
+        // If the chain passes through an object property, then it might not be valid for this object, in
+        // which case we fall back to the uncached path, see Unreal::PropertyChain for details.
+        Unreal::PropertyDesc property_desc = Unreal::findPropertyByChain(uobject, property_chains.at(name));
+        if (!property_desc.property_) {
+            property_desc = Unreal::findPropertyByName(uobject, name);
+        }
+        property_descs.push_back(std::move(property_desc));
+    }
+
+    return property_descs;
+}
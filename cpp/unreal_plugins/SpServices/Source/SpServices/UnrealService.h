@@ -4,10 +4,12 @@
 
 #pragma once
 
-#include <stdint.h> // uint64_t
+#include <stdint.h> // uint8_t, uint64_t
 
 #include <map>
+#include <stdexcept>   // std::runtime_error
 #include <string>
+#include <tuple>       // std::make_tuple
 #include <utility>     // std::make_pair, std::move
 #include <vector>
 
@@ -22,6 +24,7 @@
 #include <UObject/ObjectMacros.h>        // EObjectFlags, ELoadFlags
 #include <UObject/Package.h>
 
+#include "SpCore/ActorIndex.h"
 #include "SpCore/Assert.h"
 #include "SpCore/Log.h"
 #include "SpCore/Unreal.h"
@@ -254,6 +257,13 @@ public:
                 return Unreal::toStdString(world_->GetName());
             });
 
+        // incremented every time a new world is initialized, so clients can detect when handles that refer to
+        // the previous world (e.g., prepared functions) are no longer valid
+        unreal_entry_point_binder->bindFuncUnreal("unreal_service", "get_world_generation",
+            [this]() -> uint64_t {
+                return world_generation_;
+            });
+
         //
         // Get UClass from class name, get default object from UClass, get UClass from object
         //
@@ -301,6 +311,7 @@ public:
         unreal_entry_point_binder->bindFuncUnreal("unreal_service", "set_object_properties_from_string_for_uobject",
             [this](uint64_t& uobject, std::string& string) -> void {
                 Unreal::setObjectPropertiesFromString(toPtr<UObject>(uobject), string);
+                ActorIndex::updateObject(toPtr<UObject>(uobject)); // the string might modify an actor's tags or stable name
             });
 
         unreal_entry_point_binder->bindFuncUnreal("unreal_service", "set_object_properties_from_string_for_ustruct",
@@ -334,6 +345,25 @@ public:
         unreal_entry_point_binder->bindFuncUnreal("unreal_service", "set_property_value_from_string",
             [this](Unreal::PropertyDesc& property_desc, std::string& string) -> void {
                 Unreal::setPropertyValueFromString(property_desc, string);
+                ActorIndex::invalidateIfIndexedProperty(world_, property_desc.property_);
+            });
+
+        //
+        // Get and set many property values at once
+        //
+
+        unreal_entry_point_binder->bindFuncUnreal("unreal_service", "get_property_values_for_uobjects",
+            [this](std::vector<uint64_t>& uobjects, std::vector<std::string>& names) -> Unreal::PropertyValues {
+                return Unreal::getPropertyValues(findPropertiesByName(uobjects, names));
+            });
+
+        unreal_entry_point_binder->bindFuncUnreal("unreal_service", "set_property_values_for_uobjects",
+            [this](std::vector<uint64_t>& uobjects, std::vector<std::string>& names, std::vector<uint8_t>& packed_values, std::vector<int>& num_bytes, std::vector<std::string>& value_strings) -> void {
+                std::vector<Unreal::PropertyDesc> property_descs = findPropertiesByName(uobjects, names);
+                Unreal::setPropertyValues(property_descs, packed_values, num_bytes, value_strings);
+                for (auto& property_desc : property_descs) {
+                    ActorIndex::invalidateIfIndexedProperty(world_, property_desc.property_);
+                }
             });
 
         //
@@ -357,6 +387,32 @@ public:
                 return Unreal::callFunction(world_, toPtr<UObject>(uobject), toPtr<UFunction>(ufunction), args, world_context);
             });
 
+        //
+        // Prepare and call functions via a binary fast path
+        //
+
+        unreal_entry_point_binder->bindFuncUnreal("unreal_service", "prepare_function",
+            [this](uint64_t& uobject, uint64_t& ufunction, std::string& world_context) -> uint64_t {
+                uint64_t handle = next_prepared_function_handle_++;
+                Std::insert(prepared_functions_, handle, Unreal::prepareFunction(toPtr<UObject>(uobject), toPtr<UFunction>(ufunction), world_context));
+                return handle;
+            });
+
+        unreal_entry_point_binder->bindFuncUnreal("unreal_service", "get_prepared_function_desc",
+            [this](uint64_t& handle) -> Unreal::PreparedFunction {
+                return getPreparedFunction(handle);
+            });
+
+        unreal_entry_point_binder->bindFuncUnreal("unreal_service", "call_prepared_function",
+            [this](uint64_t& handle, std::vector<uint8_t>& packed_args, std::map<std::string, std::string>& arg_strings) -> Unreal::PreparedFunctionReturnValues {
+                return Unreal::callPreparedFunction(world_, getPreparedFunction(handle), packed_args, arg_strings);
+            });
+
+        unreal_entry_point_binder->bindFuncUnreal("unreal_service", "destroy_prepared_function",
+            [this](uint64_t& handle) -> void {
+                Std::remove(prepared_functions_, handle);
+            });
+
         //
         // Find actors unconditionally and return an std::vector or std::map
         //
@@ -1157,10 +1213,27 @@ private:
         return reinterpret_cast<T*>(src);
     }
 
+    // Find a property on each object using a cached Unreal::PropertyChain for each (UStruct, name) pair, so
+    // each name only needs to be tokenized and looked up once for each class.
+    std::vector<Unreal::PropertyDesc> findPropertiesByName(const std::vector<uint64_t>& uobjects, const std::vector<std::string>& names);
+
+    // Prepared functions are destroyed when the world is cleaned up, so a client can legitimately hold a handle
+    // that is no longer valid. We throw instead of asserting, so the error is returned to the client.
+    const Unreal::PreparedFunction& getPreparedFunction(uint64_t handle) const;
+
     FDelegateHandle post_world_initialization_handle_;
     FDelegateHandle world_cleanup_handle_;
 
     UWorld* world_ = nullptr;
+    uint64_t world_generation_ = 0;
+
+    // prepared functions refer to UObjects in the current world, so they are destroyed when the world is cleaned up
+    std::map<uint64_t, Unreal::PreparedFunction> prepared_functions_;
+    uint64_t next_prepared_function_handle_ = 1;
+
+    // property chains refer to FProperty objects owned by classes that might be unloaded along with the current
+    // world (e.g., Blueprint classes), so they are destroyed when the world is cleaned up
+    std::map<const UStruct*, std::map<std::string, Unreal::PropertyChain>> property_chains_;
 };
 
 //
@@ -1187,3 +1260,69 @@ struct clmdep_msgpack::adaptor::object_with_zone<Unreal::PropertyDesc> {
         Msgpack::toObject(object, map);
     }
 };
+
+//
+// Unreal::PropertyValues
+//
+
+template <>
+struct MsgpackStructDesc<Unreal::PropertyValues> {
+    static constexpr auto k_field_descs = std::make_tuple(
+        Msgpack::fieldDesc("packed_values", &Unreal::PropertyValues::packed_values_),
+        Msgpack::fieldDesc("num_bytes", &Unreal::PropertyValues::num_bytes_),
+        Msgpack::fieldDesc("cpp_types", &Unreal::PropertyValues::cpp_types_),
+        Msgpack::fieldDesc("value_strings", &Unreal::PropertyValues::value_strings_));
+};
+
+template <> // needed to send a custom type as a return value
+struct clmdep_msgpack::adaptor::object_with_zone<Unreal::PropertyValues> {
+    void operator()(clmdep_msgpack::object::with_zone& object, Unreal::PropertyValues const& property_values) const {
+        Msgpack::toObject(object, property_values);
+    }
+};
+
+//
+// Unreal::PreparedFunction
+//
+
+template <> // needed to send a custom type as a return value
+struct clmdep_msgpack::adaptor::object_with_zone<Unreal::PreparedFunction> {
+    void operator()(clmdep_msgpack::object::with_zone& object, Unreal::PreparedFunction const& prepared_function) const {
+        std::map<std::string, clmdep_msgpack::object> map = {
+            {"num_bytes", clmdep_msgpack::object(prepared_function.num_bytes_, object.zone)},
+            {"params", clmdep_msgpack::object(prepared_function.params_, object.zone)}};
+        Msgpack::toObject(object, map);
+    }
+};
+
+//
+// Unreal::PreparedFunctionParam
+//
+
+template <> // needed to send a custom type as a return value
+struct clmdep_msgpack::adaptor::object_with_zone<Unreal::PreparedFunctionParam> {
+    void operator()(clmdep_msgpack::object::with_zone& object, Unreal::PreparedFunctionParam const& param) const {
+        std::map<std::string, clmdep_msgpack::object> map = {
+            {"name", clmdep_msgpack::object(param.name_, object.zone)},
+            {"cpp_type", clmdep_msgpack::object(param.cpp_type_, object.zone)},
+            {"offset", clmdep_msgpack::object(param.offset_, object.zone)},
+            {"num_bytes", clmdep_msgpack::object(param.num_bytes_, object.zone)},
+            {"is_pod", clmdep_msgpack::object(param.is_pod_, object.zone)},
+            {"is_world_context", clmdep_msgpack::object(param.is_world_context_, object.zone)}};
+        Msgpack::toObject(object, map);
+    }
+};
+
+//
+// Unreal::PreparedFunctionReturnValues
+//
+
+template <> // needed to send a custom type as a return value
+struct clmdep_msgpack::adaptor::object_with_zone<Unreal::PreparedFunctionReturnValues> {
+    void operator()(clmdep_msgpack::object::with_zone& object, Unreal::PreparedFunctionReturnValues const& return_values) const {
+        std::map<std::string, clmdep_msgpack::object> map = {
+            {"packed_return_values", clmdep_msgpack::object(return_values.packed_return_values_, object.zone)},
+            {"return_value_strings", clmdep_msgpack::object(return_values.return_value_strings_, object.zone)}};
+        Msgpack::toObject(object, map);
+    }
+};
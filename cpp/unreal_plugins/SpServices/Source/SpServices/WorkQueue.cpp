@@ -4,26 +4,115 @@
 
 #include "SpServices/WorkQueue.h"
 
-#include <mutex>
+#include <stdint.h> // int64_t, uint32_t, uint64_t
 
-#include "SpCore/Boost.h"
+#include <atomic>
+#include <memory> // std::make_unique
+#include <thread> // std::this_thread::yield
+
+#include "SpCore/Assert.h"
+
+WorkQueue::WorkQueue()
+{
+    static_assert((k_num_slots & (k_num_slots - 1)) == 0);
+
+    slots_ = std::make_unique<Slot[]>(k_num_slots);
+    for (uint64_t i = 0; i < k_num_slots; i++) {
+        slots_[i].sequence_.store(i, std::memory_order_relaxed);
+    }
+}
 
 void WorkQueue::run()
 {
-    // run all scheduled work and wait for executor_work_guard_.reset() to be called from a worker thread
-    io_context_.run();
-
-    // reinitialize io_context_ and executor_work_guard_ to prepare for the next call to run()
-    mutex_.lock();
-    io_context_.restart();
-    new(&executor_work_guard_) boost::asio::executor_work_guard<boost::asio::io_context::executor_type>(io_context_.get_executor());
-    mutex_.unlock();
+    // run all scheduled work and wait for reset() to be called from a worker thread
+    while (true) {
+
+        // We need to read num_signals_ before executing tasks, so we don't miss any tasks that are posted
+        // after we finish executing tasks but before we start waiting.
+        uint32_t num_signals = num_signals_.load(std::memory_order_acquire);
+
+        while (tryExecuteNextTask()) {}
+
+        // If reset() has been called, then any tasks posted before it was called are guaranteed to be visible
+        // here, so we execute them before returning.
+        if (reset_requested_.load(std::memory_order_acquire)) {
+            while (tryExecuteNextTask()) {}
+            break;
+        }
+
+        num_signals_.wait(num_signals, std::memory_order_acquire);
+    }
+
+    // prepare for the next call to run()
+    reset_requested_.store(false, std::memory_order_release);
 }
 
 void WorkQueue::reset()
 {
-    // request io_context_.run() to stop executing once all of its scheduled work is finished
-    mutex_.lock();
-    executor_work_guard_.reset();
-    mutex_.unlock();
+    // request run() to stop executing once all of its scheduled work is finished
+    reset_requested_.store(true, std::memory_order_release);
+    num_signals_.fetch_add(1, std::memory_order_release);
+    num_signals_.notify_one();
+}
+
+WorkQueue::Slot& WorkQueue::beginPost()
+{
+    while (true) {
+        Slot* slot = tryBeginPost();
+        if (slot) {
+            return *slot;
+        }
+        // the queue is full, so we wait for the game thread to execute some tasks
+        std::this_thread::yield();
+    }
+}
+
+WorkQueue::Slot* WorkQueue::tryBeginPost()
+{
+    uint64_t position = post_position_.load(std::memory_order_relaxed);
+    while (true) {
+        Slot& slot = slots_[position & (k_num_slots - 1)];
+        int64_t diff = static_cast<int64_t>(slot.sequence_.load(std::memory_order_acquire)) - static_cast<int64_t>(position);
+
+        if (diff == 0) {
+            // the slot is ready to be written, so we try to claim it
+            if (post_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                return &slot;
+            }
+        } else if (diff < 0) {
+            // the queue is full
+            return nullptr;
+        } else {
+            // another producer has claimed the slot, so we try again with the next position
+            position = post_position_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void WorkQueue::endPost(Slot& slot)
+{
+    // We own the slot exclusively until we increment its sequence number, so it is safe to read the sequence
+    // number non-atomically. Incrementing the sequence number makes the task visible to the consumer.
+    slot.sequence_.store(slot.sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+    num_signals_.fetch_add(1, std::memory_order_release);
+    num_signals_.notify_one();
+}
+
+bool WorkQueue::tryExecuteNextTask()
+{
+    Slot& slot = slots_[execute_position_ & (k_num_slots - 1)];
+    if (slot.sequence_.load(std::memory_order_acquire) != execute_position_ + 1) {
+        return false;
+    }
+
+    SP_ASSERT(slot.task_.execute_and_destroy_func_);
+    slot.task_.execute_and_destroy_func_(slot.task_);
+    slot.task_.execute_and_destroy_func_ = nullptr;
+
+    // mark the slot as ready to be written by a producer on the next lap around the ring buffer
+    slot.sequence_.store(execute_position_ + k_num_slots, std::memory_order_release);
+    execute_position_++;
+
+    return true;
 }
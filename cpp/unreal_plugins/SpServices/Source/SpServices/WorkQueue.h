@@ -4,31 +4,49 @@
 
 #pragma once
 
-#include <concepts>    // std::same_as
+#include <stdint.h> // uint32_t, uint64_t
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>     // std::byte, std::max_align_t
+#include <exception>   // std::current_exception, std::exception_ptr, std::rethrow_exception
 #include <future>
-#include <map>
-#include <mutex>
-#include <string>
+#include <memory>      // std::unique_ptr
+#include <mutex>       // std::lock_guard, std::unique_lock
+#include <new>         // std::launder
+#include <optional>
+#include <stdexcept>   // std::runtime_error
+#include <string>      // std::to_string
+#include <thread>      // std::this_thread::yield
 #include <utility>     // std::forward, std::move
-#include <vector>
-#include <type_traits> // std::invoke_result_t
+#include <type_traits> // std::conditional_t, std::invoke_result_t, std::is_void_v, std::remove_cvref_t
 
 #include "SpCore/Assert.h"
-#include "SpCore/Boost.h"
+#include "SpCore/Profiler.h"
 
-template <typename TFunc>
-concept CFuncIsCallableWithNoArgs = std::is_invocable_v<TFunc>;
+#include "SpServices/FuncInfo.h"
 
-template <typename TFunc, typename... TArgs>
-concept CFuncIsCallableWithArgs = std::is_invocable_v<TFunc, TArgs...>;
+class WorkQueue {
 
-template <typename TFunc, typename TReturn, typename... TArgs>
-concept CFuncReturnsAndIsCallableWithArgs = std::same_as<TReturn, std::invoke_result_t<TFunc, TArgs...>>;
+private:
+    static constexpr int k_cache_line_num_bytes = 64;
 
-class WorkQueue {
+    struct Task
+    {
+        static constexpr int k_num_inline_bytes = 128;
+
+        void (*execute_and_destroy_func_)(Task& task) = nullptr;
+        alignas(std::max_align_t) std::byte storage_[k_num_inline_bytes];
+    };
+
+    struct alignas(k_cache_line_num_bytes) Slot
+    {
+        std::atomic<uint64_t> sequence_ = 0;
+        Task task_;
+    };
 
 public:
-    WorkQueue() : io_context_(), executor_work_guard_(io_context_.get_executor()) {}
+    WorkQueue();
 
     // typically called from the game thread in EngineService::beginFrameHandler(...) and EngineService::endFrameHandler(...)
     void run();
@@ -43,22 +61,17 @@ public:
         return wrapFuncToExecuteInWorkQueueBlockingImpl(work_queue, func, FuncInfo<TFunc>());
     }
 
-private:
-    template <typename TClass>
-    struct FuncInfo : public FuncInfo<decltype(&TClass::operator())> {};
-
-    template <typename TClass, typename TReturn, typename... TArgs>
-    struct FuncInfo<TReturn(TClass::*)(TArgs...)> : public FuncInfo<TReturn(*)(TArgs...)> {};
-
-    template <typename TClass, typename TReturn, typename... TArgs>
-    struct FuncInfo<TReturn(TClass::*)(TArgs...) const> : public FuncInfo<TReturn(*)(TArgs...)> {};
-
-    template <class T>
-    struct FuncInfo<T&> : public FuncInfo<T> {};
+    // typically called from the game thread in EngineService::EngineService(...)
+    template <typename TFunc>
+    static auto wrapFuncToExecuteInWorkQueueNonBlocking(WorkQueue& work_queue, const TFunc& func)
+    {
+        return wrapFuncToExecuteInWorkQueueNonBlockingImpl(work_queue, func, FuncInfo<TFunc>());
+    }
 
-    template <typename TReturn, typename... TArgs>
-    struct FuncInfo<TReturn(*)(TArgs...)> {};
+    // maximum number of tasks that can be scheduled before the game thread calls run()
+    static constexpr uint64_t getMaxNumTasks() { return k_num_slots; }
 
+private:
     template <typename TFunc, typename TReturn, typename... TArgs> requires
         CFuncReturnsAndIsCallableWithArgs<TFunc, TReturn, TArgs&...>
     static auto wrapFuncToExecuteInWorkQueueBlockingImpl(WorkQueue& work_queue, const TFunc& func, const FuncInfo<TReturn(*)(TArgs...)>& fi)
@@ -80,21 +93,103 @@ private:
         };
     }
 
+    template <typename TFunc, typename TReturn, typename... TArgs> requires
+        CFuncReturnsAndIsCallableWithArgs<TFunc, TReturn, TArgs&...>
+    static auto wrapFuncToExecuteInWorkQueueNonBlockingImpl(WorkQueue& work_queue, const TFunc& func, const FuncInfo<TReturn(*)(TArgs...)>& fi)
+    {
+        // The lambda returned here is typically called from a worker thread by the RPC server. It schedules
+        // the user's function and returns immediately, without waiting for the user's function to execute.
+        // The caller can wait for the user's function to finish executing, and retrieve its return value, by
+        // calling get() on the returned std::future. If the queue is full, the lambda throws an exception
+        // instead of waiting, because the caller might be the only worker thread that could otherwise serve
+        // the request that allows the game thread to execute tasks, e.g., "engine_service.begin_tick".
+
+        return [&work_queue, func](TArgs&... args) -> std::future<TReturn> {
+            return work_queue.scheduleFunc(func, args...);
+        };
+    }
+
     template <typename TFunc, typename... TArgs> requires
         CFuncIsCallableWithArgs<TFunc, TArgs&...>
     auto scheduleAndExecuteFuncBlocking(const TFunc& func, TArgs&... args)
     {
         using TReturn = std::invoke_result_t<TFunc, TArgs&...>;
 
+        // includes the time spent waiting for the game thread to call run()
+        SP_PROFILE_SCOPE("WorkQueue::scheduleAndExecuteFuncBlocking");
+
+        // We don't use std::packaged_task and std::future here, because they require a heap-allocated shared
+        // state for every call. Instead, we store the return value and a completion flag on the caller's stack,
+        // which is guaranteed to remain valid because we block until the task has finished executing. See the
+        // comments in scheduleFunc(...) below for a discussion of why we capture func and args... by value.
+
+        // Note that the game thread must call notify_one() while holding state.mutex_. Otherwise, this thread
+        // could observe state.done_ == true, return, and destroy state before notify_one() is called.
+
+        // Note also that we catch any exception thrown by the user's function on the game thread, and rethrow it
+        // on this thread after the task has finished executing, just like std::packaged_task and std::future
+        // would. This way, the RPC server can return the exception to the client as an error, and we always set
+        // state.done_, so this thread never waits forever for a task that has failed.
+
+        // Finally, note that we yield for a bounded number of iterations before waiting on the condition variable.
+        // If the game thread is already executing tasks, then it typically finishes our task within a few
+        // iterations, and we avoid the cost of sleeping and being woken up by the kernel, which otherwise dominates
+        // the round-trip time, see Benchmarks/WorkQueueBenchmark.cpp. We always lock state.mutex_ before returning,
+        // even if we observe state.done_ == true while yielding, because the game thread might still be holding
+        // state.mutex_.
+
+        BlockingTaskState<TReturn> state;
+
+        post([func, args..., &state]() mutable -> void {
+            try {
+                SP_PROFILE_SCOPE("WorkQueue::executeTask");
+                if constexpr (std::is_void_v<TReturn>) {
+                    func(args...);
+                } else {
+                    state.return_value_.emplace(func(args...));
+                }
+            } catch (...) {
+                state.exception_ = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(state.mutex_);
+            state.done_.store(true, std::memory_order_release);
+            state.condition_variable_.notify_one();
+        });
+
+        for (int i = 0; i < k_num_blocking_spin_iterations && !state.done_.load(std::memory_order_acquire); i++) {
+            std::this_thread::yield();
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(state.mutex_);
+            state.condition_variable_.wait(lock, [&state]() { return state.done_.load(std::memory_order_relaxed); });
+        }
+
+        if (state.exception_) {
+            std::rethrow_exception(state.exception_);
+        }
+
+        if constexpr (!std::is_void_v<TReturn>) {
+            return std::move(state.return_value_.value());
+        }
+    }
+
+    template <typename TFunc, typename... TArgs> requires
+        CFuncIsCallableWithArgs<TFunc, TArgs&...>
+    auto scheduleFunc(const TFunc& func, TArgs&... args)
+    {
+        using TReturn = std::invoke_result_t<TFunc, TArgs&...>;
+
         // The lambda declared below is typically executed on the game thread when run() is called, i.e.,
         // during EngineService::beginFrameHandler(...) or EngineService::endFrameHandler(...)
 
         // Note that we capture func and args... by value because we want to guarantee that they are both
-        // still accessible after scheduleAndExecuteTaskBlocking(...) returns. Strictly speaking, this
-        // guarantee is not necessary for this blocking implementation, but we capture by value anyway for
-        // consistency with a non-blocking implementation.
+        // still accessible after scheduleFunc(...) returns. Strictly speaking, this guarantee is not
+        // necessary when we're called from scheduleAndExecuteFuncBlocking(...), but it is necessary when
+        // we're called from the lambda declared in wrapFuncToExecuteInWorkQueueNonBlockingImpl(...), because
+        // the caller's args... might go out of scope before the task executes.
 
-        // Even in a non-blocking implementation, we could technically capture func by reference. This is
+        // Even in the non-blocking case, we could technically capture func by reference. This is
         // because, in practice, the lifetime of func corresponds to the lifetime of the lambda declared in
         // wrapFuncToExecuteInWorkQueueBlockingImpl(...) above, which in turn corresponds to the the lifetime
         // of the RPC server. Moreover, the lambda declared below only ever executes when run() is called,
@@ -102,7 +197,7 @@ private:
         // the RPC server (and therefore func) is guaranteed to be accessible inside these EngineService
         // functions. So, even if we capture func by reference, it is guaranteed to be accessible whenever
         // the lambda below is executed. However, the WorkQueue class should not depend on this high-level
-        // system behavior, so we insist on capturing func by value, even in a non-blocking implementation.
+        // system behavior, so we insist on capturing func by value, even in the non-blocking case.
 
         // Since we capture args... by value, it is deep-copied into the lambda object constructed below. But
         // the user's function accepts all arguments by non-const reference, so args... is not copied again
@@ -115,28 +210,97 @@ private:
         // to pass args... by non-const reference to the user's function. So we use the mutable keyword to
         // force args... to be treated as a non-const member variable inside the lambda body.
 
-        auto task = CopyConstructiblePackagedTask<TReturn>(
+        auto task = std::packaged_task<TReturn()>(
             [func, args...]() mutable -> TReturn {
+                SP_PROFILE_SCOPE("WorkQueue::executeTask");
                 return func(args...);
             });
 
         std::future<TReturn> future = task.get_future(); // need to call get_future() before calling std::move(...)
-        boost::asio::post(io_context_, std::move(task));
-        return future.get();
+        if (!tryPost(std::move(task))) {
+            throw std::runtime_error("The work queue is full, because more than " + std::to_string(k_num_slots) + " tasks have been scheduled without executing them.");
+        }
+        return future;
     }
 
-    // The purpose of this class is to provide a copy-constructible type that derives from std::packaged_task.
-    // This is necessary because boost::asio requires that task objects are copy-constructible, but std::packaged_task
-    // is not copy-constructible.
+    // Constructs a task in the next available slot, where TFunc is any callable type that accepts no arguments.
+    // Can be called from any thread. If the queue is full, post(...) waits for the game thread to execute some
+    // of its tasks, whereas tryPost(...) returns false without constructing the task.
 
-    // We use auto&& because we want to preserve and forward the const-ness and rvalue-ness of func.
+    // We use TFunc&& because we want to preserve and forward the const-ness and rvalue-ness of func.
+    template <typename TFunc>
+    void post(TFunc&& func)
+    {
+        Slot& slot = beginPost();
+        constructTask(slot, std::forward<TFunc>(func));
+        endPost(slot);
+    }
+
+    template <typename TFunc>
+    bool tryPost(TFunc&& func)
+    {
+        Slot* slot = tryBeginPost();
+        if (!slot) {
+            return false;
+        }
+        constructTask(*slot, std::forward<TFunc>(func));
+        endPost(*slot);
+        return true;
+    }
+
+    template <typename TFunc>
+    static void constructTask(Slot& slot, TFunc&& func)
+    {
+        using TFuncValue = std::remove_cvref_t<TFunc>;
+
+        if constexpr (sizeof(TFuncValue) <= Task::k_num_inline_bytes && alignof(TFuncValue) <= alignof(std::max_align_t)) {
+            new(slot.task_.storage_) TFuncValue(std::forward<TFunc>(func));
+            slot.task_.execute_and_destroy_func_ = [](Task& task) -> void {
+                TFuncValue* func = std::launder(reinterpret_cast<TFuncValue*>(task.storage_));
+                (*func)();
+                func->~TFuncValue();
+            };
+        } else {
+            // func is too large to be stored inline, so we store a pointer to a heap-allocated copy
+            new(slot.task_.storage_) TFuncValue*(new TFuncValue(std::forward<TFunc>(func)));
+            slot.task_.execute_and_destroy_func_ = [](Task& task) -> void {
+                TFuncValue* func = *std::launder(reinterpret_cast<TFuncValue**>(task.storage_));
+                (*func)();
+                delete func;
+            };
+        }
+    }
+
+    Slot& beginPost();
+    Slot* tryBeginPost();
+    void endPost(Slot& slot);
+    bool tryExecuteNextTask();
+
+    // std::optional<void> is ill-formed, so we store a dummy value type when TReturn is void
     template <typename TReturn>
-    struct CopyConstructiblePackagedTask : std::packaged_task<TReturn()>
+    struct BlockingTaskState
     {
-        CopyConstructiblePackagedTask(auto&& func) : std::packaged_task<TReturn()>(std::forward<decltype(func)>(func)) {};
+        std::optional<std::conditional_t<std::is_void_v<TReturn>, bool, TReturn>> return_value_;
+        std::exception_ptr exception_;
+        std::mutex mutex_;
+        std::condition_variable condition_variable_;
+        std::atomic<bool> done_ = false;
     };
 
-    boost::asio::io_context io_context_;
-    std::mutex mutex_;
-    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> executor_work_guard_;
+    // number of times scheduleAndExecuteFuncBlocking(...) yields before waiting on a condition variable
+    static constexpr int k_num_blocking_spin_iterations = 64;
+
+    // Our queue is a bounded multi-producer single-consumer ring buffer of slots, where each slot stores a
+    // type-erased task with inline storage, so scheduling a task doesn't require any heap allocations in the
+    // common case. Producers are typically RPC worker threads and the consumer is the game thread. Each slot
+    // has a sequence number that indicates whether it is ready to be written by a producer or read by the
+    // consumer, following the well-known bounded queue design by Dmitry Vyukov.
+
+    static constexpr uint64_t k_num_slots = 4096; // must be a power of two
+
+    alignas(k_cache_line_num_bytes) std::unique_ptr<Slot[]> slots_;
+    alignas(k_cache_line_num_bytes) std::atomic<uint64_t> post_position_ = 0;   // accessed by producers
+    alignas(k_cache_line_num_bytes) uint64_t execute_position_ = 0;             // only accessed by the consumer
+    alignas(k_cache_line_num_bytes) std::atomic<uint32_t> num_signals_ = 0;     // incremented by producers and reset(), waited on by run()
+    std::atomic<bool> reset_requested_ = false;
 };
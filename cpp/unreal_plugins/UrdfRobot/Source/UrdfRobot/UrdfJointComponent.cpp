@@ -6,9 +6,10 @@
 
 #include <stdint.h> // uint8_t
 
+#include <functional> // std::function
 #include <map>
 #include <string>
-#include <utility> // std::move
+#include <utility>    // std::pair
 #include <vector>
 
 #include <PhysicalMaterials/PhysicalMaterial.h>
@@ -63,10 +64,22 @@ void UUrdfJointComponent::BeginPlay()
 {
     UPhysicsConstraintComponent::BeginPlay();
 
+    // After pressing play in the editor, the Unreal Engine creates a new replica object for each object in the World
+    // Outliner, so we need to re-compute any local state that isn't visible to the Unreal reflection system.
+    initializeActionComponent();
+
     const std::map<std::string, std::pair<std::string, std::vector<double>>> user_input_actions = USER_INPUT_ACTIONS;
     SpUserInputComponent->subscribeToUserInputs(Std::keys(user_input_actions));
     SpUserInputComponent->setHandleUserInputFunc([this, user_input_actions](const std::string& key, float axis_value) -> void {
-        applyActionComponent(user_input_actions.at(key));
+        auto& [action_component_name, action_component_data] = user_input_actions.at(key);
+        bool found = action_component_name == action_component_name_;
+        SP_ASSERT(found || WITH_EDITOR); // defined in an auto-generated header
+        if (!found) {
+            SP_LOG("ERROR: Joint ", Unreal::toStdString(GetName()), " doesn't support action component: ", action_component_name);
+            return;
+        }
+        SP_ASSERT(action_component_data.size() == 3);
+        applyActionComponent(action_component_data.data());
     });
 
     // TODO (MR): generalize this code, which currently applies a hard-coded linear translation offset
@@ -234,34 +247,67 @@ void UUrdfJointComponent::initialize(const UrdfJointDesc* joint_desc, UUrdfLinkC
             }
             break;
     }
+
+    initializeActionComponent();
 }
 
-std::map<std::string, ArrayDesc> UUrdfJointComponent::getActionSpace() const
+const std::string& UUrdfJointComponent::getActionComponentName() const
 {
-    std::map<std::string, ArrayDesc> action_space;
+    return action_component_name_;
+}
 
-    ArrayDesc array_desc;
-    array_desc.low_ = std::numeric_limits<double>::lowest();
-    array_desc.high_ = std::numeric_limits<double>::max();
-    array_desc.shape_ = {3};
-    array_desc.datatype_ = DataType::Float64;
+void UUrdfJointComponent::applyActionComponent(const double* action_component_data)
+{
+    SP_ASSERT(action_component_data);
+    SP_ASSERT(apply_action_component_func_);
+    apply_action_component_func_(action_component_data);
+}
 
-    std::string separator = ".";
-    std::string action_name = Unreal::toStdString(GetName()) + separator;
+std::map<std::string, ArrayDesc> UUrdfJointComponent::getObservationSpace() const
+{
+    std::map<std::string, ArrayDesc> observation_space;
+
+    return observation_space;
+}
+
+std::map<std::string, std::vector<uint8_t>> UUrdfJointComponent::getObservation() const
+{
+    std::map<std::string, std::vector<uint8_t>> observation;
+    return observation;
+}
+
+void UUrdfJointComponent::initializeActionComponent()
+{
+    // We resolve our control type, joint type, and interface type into a single function here, so applying an action
+    // doesn't require any string processing or branching. If this joint can't be controlled, then the action component
+    // name is empty and there is no function.
+    action_component_name_ = "";
+    apply_action_component_func_ = nullptr;
 
     switch (JointControlType) {
+        case EJointControlType::NotActuated:
+            break;
+
+        // PositionAndVelocity joints are usually used to implement reasonable "position-based" control without excessive jittering.
+        // We assume in this function that the only reasonable control actions for PositionAndVelocity joints are the same as for Position joints.
         case EJointControlType::Position:
         case EJointControlType::PositionAndVelocity:
             switch (JointType) {
                 case EJointType::Continuous:
                 case EJointType::Revolute:
-                    switch(JointInterfaceType) {
+                    switch (JointInterfaceType) {
                         case EJointInterfaceType::Set:
-                            action_name += "set_angular_orientation_target";
+                            action_component_name_ = "set_angular_orientation_target";
+                            apply_action_component_func_ = [this](const double* data) -> void {
+                                SetAngularOrientationTarget({ data[0], data[1], data[2] });
+                            };
                             break;
 
                         case EJointInterfaceType::AddTo:
-                            action_name += "add_to_angular_orientation_target";
+                            action_component_name_ = "add_to_angular_orientation_target";
+                            apply_action_component_func_ = [this](const double* data) -> void {
+                                SetAngularOrientationTarget(ConstraintInstance.ProfileInstance.AngularDrive.OrientationTarget.Add(data[0], data[1], data[2]));
+                            };
                             break;
 
                         case EJointInterfaceType::NoInterface:
@@ -271,17 +317,25 @@ std::map<std::string, ArrayDesc> UUrdfJointComponent::getActionSpace() const
                             SP_ASSERT(false);
                             break;
                     }
-                    Std::insert(action_space, action_name, std::move(array_desc));
                     break;
 
                 case EJointType::Prismatic:
                     switch (JointInterfaceType) {
                         case EJointInterfaceType::Set:
-                            action_name += "set_linear_position_target";
+                            action_component_name_ = "set_linear_position_target";
+                            apply_action_component_func_ = [this](const double* data) -> void {
+                                SetLinearPositionTarget({ data[0], data[1], data[2] });
+                            };
                             break;
 
                         case EJointInterfaceType::AddTo:
-                            action_name += "add_to_linear_position_target";
+                            action_component_name_ = "add_to_linear_position_target";
+                            apply_action_component_func_ = [this](const double* data) -> void {
+                                SetLinearPositionTarget({
+                                    data[0] + ConstraintInstance.ProfileInstance.LinearDrive.PositionTarget.X,
+                                    data[1] + ConstraintInstance.ProfileInstance.LinearDrive.PositionTarget.Y,
+                                    data[2] + ConstraintInstance.ProfileInstance.LinearDrive.PositionTarget.Z });
+                            };
                             break;
 
                         case EJointInterfaceType::NoInterface:
@@ -291,7 +345,6 @@ std::map<std::string, ArrayDesc> UUrdfJointComponent::getActionSpace() const
                             SP_ASSERT(false);
                             break;
                     }
-                    Std::insert(action_space, action_name, std::move(array_desc));
                     break;
 
                 case EJointType::Fixed:
@@ -309,11 +362,20 @@ std::map<std::string, ArrayDesc> UUrdfJointComponent::getActionSpace() const
                 case EJointType::Revolute:
                     switch (JointInterfaceType) {
                         case EJointInterfaceType::Set:
-                            action_name += "set_angular_velocity_target";
+                            action_component_name_ = "set_angular_velocity_target";
+                            apply_action_component_func_ = [this](const double* data) -> void {
+                                SetAngularVelocityTarget({ data[0], data[1], data[2] });
+                            };
                             break;
 
                         case EJointInterfaceType::AddTo:
-                            action_name += "add_to_angular_velocity_target";
+                            action_component_name_ = "add_to_angular_velocity_target";
+                            apply_action_component_func_ = [this](const double* data) -> void {
+                                SetAngularVelocityTarget({
+                                    data[0] + ConstraintInstance.ProfileInstance.AngularDrive.AngularVelocityTarget.X,
+                                    data[1] + ConstraintInstance.ProfileInstance.AngularDrive.AngularVelocityTarget.Y,
+                                    data[2] + ConstraintInstance.ProfileInstance.AngularDrive.AngularVelocityTarget.Z });
+                            };
                             break;
 
                         case EJointInterfaceType::NoInterface:
@@ -323,17 +385,25 @@ std::map<std::string, ArrayDesc> UUrdfJointComponent::getActionSpace() const
                             SP_ASSERT(false);
                             break;
                     }
-                    Std::insert(action_space, action_name, std::move(array_desc));
                     break;
 
                 case EJointType::Prismatic:
                     switch (JointInterfaceType) {
                         case EJointInterfaceType::Set:
-                            action_name += "set_linear_velocity_target";
+                            action_component_name_ = "set_linear_velocity_target";
+                            apply_action_component_func_ = [this](const double* data) -> void {
+                                SetLinearVelocityTarget({ data[0], data[1], data[2] });
+                            };
                             break;
 
                         case EJointInterfaceType::AddTo:
-                            action_name += "add_to_linear_velocity_target";
+                            action_component_name_ = "add_to_linear_velocity_target";
+                            apply_action_component_func_ = [this](const double* data) -> void {
+                                SetLinearVelocityTarget({
+                                    data[0] + ConstraintInstance.ProfileInstance.LinearDrive.VelocityTarget.X,
+                                    data[1] + ConstraintInstance.ProfileInstance.LinearDrive.VelocityTarget.Y,
+                                    data[2] + ConstraintInstance.ProfileInstance.LinearDrive.VelocityTarget.Z });
+                            };
                             break;
 
                         case EJointInterfaceType::NoInterface:
@@ -343,131 +413,6 @@ std::map<std::string, ArrayDesc> UUrdfJointComponent::getActionSpace() const
                             SP_ASSERT(false);
                             break;
                     }
-                    Std::insert(action_space, action_name, std::move(array_desc));
-                    break;
-
-                case EJointType::Fixed:
-                    break;
-
-                default:
-                    SP_ASSERT(false); // TODO (MR): support planar joints
-                    break;
-            }
-            break;
-
-        case EJointControlType::Torque:
-            switch (JointType) {
-                case EJointType::Continuous:
-                case EJointType::Revolute:
-                    action_name += "add_torque_in_radians";
-                    Std::insert(action_space, action_name, std::move(array_desc));
-                    break;
-
-                case EJointType::Prismatic:
-                    action_name += "add_force";
-                    Std::insert(action_space, action_name, std::move(array_desc));
-                    break;
-
-                case EJointType::Fixed:
-                    break;
-
-                default:
-                    SP_ASSERT(false); // TODO (MR): support planar joints
-                    break;
-            }
-            break;
-    }
-
-    return action_space;
-}
-
-std::map<std::string, ArrayDesc> UUrdfJointComponent::getObservationSpace() const
-{
-    std::map<std::string, ArrayDesc> observation_space;
-
-    return observation_space;
-}
-
-void UUrdfJointComponent::applyActionComponent(const std::pair<std::string, std::vector<double>>& action_component)
-{
-    auto& [action_component_name_qualified, action_component_data] = action_component;
-
-    std::vector<std::string> tokens = Std::tokenize(action_component_name_qualified, ".");
-    SP_ASSERT(tokens.size() > 1);
-    std::string& action_component_name = tokens.at(1);
-
-    switch (JointControlType) {
-        case EJointControlType::NotActuated:
-            SP_ASSERT(WITH_EDITOR); // defined in an auto-generated header
-            break;
-
-        // PositionAndVelocity joints are usually used to implement reasonable "position-based" control without excessive jittering.
-        // We assume in this function that the only reasonable control actions for PositionAndVelocity joints are the same as for Position joints.
-        case EJointControlType::Position:
-        case EJointControlType::PositionAndVelocity:
-            switch (JointType) {
-                case EJointType::Continuous:
-                case EJointType::Revolute:
-                    if (action_component_name == "set_angular_orientation_target") {
-                        SetAngularOrientationTarget({ action_component_data.at(0), action_component_data.at(1), action_component_data.at(2) });
-                    } else if (action_component_name == "add_to_angular_orientation_target") {
-                        SetAngularOrientationTarget(
-                            ConstraintInstance.ProfileInstance.AngularDrive.OrientationTarget.Add(
-                                action_component_data.at(0), action_component_data.at(1), action_component_data.at(2)));
-                    } else {
-                        SP_ASSERT(WITH_EDITOR); // defined in an auto-generated header
-                    }
-                    break;
-
-                case EJointType::Prismatic:
-                    if (action_component_name == "set_linear_position_target") {
-                        SetLinearPositionTarget({ action_component_data.at(0), action_component_data.at(1), action_component_data.at(2) });
-                    } else if (action_component_name == "add_to_linear_position_target") {
-                        SetLinearPositionTarget({
-                            action_component_data.at(0) + ConstraintInstance.ProfileInstance.LinearDrive.PositionTarget.X,
-                            action_component_data.at(1) + ConstraintInstance.ProfileInstance.LinearDrive.PositionTarget.Y,
-                            action_component_data.at(2) + ConstraintInstance.ProfileInstance.LinearDrive.PositionTarget.Z });
-                    } else {
-                        SP_ASSERT(WITH_EDITOR); // defined in an auto-generated header
-                    }
-                    break;
-
-                case EJointType::Fixed:
-                    break;
-
-                default:
-                    SP_ASSERT(false); // TODO (MR): support planar joints
-                    break;
-            }
-            break;
-
-        case EJointControlType::Velocity:
-            switch (JointType) {
-                case EJointType::Continuous:
-                case EJointType::Revolute:
-                    if (action_component_name == "set_angular_velocity_target") {
-                        SetAngularVelocityTarget({ action_component_data.at(0), action_component_data.at(1), action_component_data.at(2) });
-                    } else if (action_component_name == "add_to_angular_velocity_target") {
-                        SetAngularVelocityTarget({
-                            action_component_data.at(0) + ConstraintInstance.ProfileInstance.AngularDrive.AngularVelocityTarget.X,
-                            action_component_data.at(1) + ConstraintInstance.ProfileInstance.AngularDrive.AngularVelocityTarget.Y,
-                            action_component_data.at(2) + ConstraintInstance.ProfileInstance.AngularDrive.AngularVelocityTarget.Z });
-                    } else {
-                        SP_ASSERT(WITH_EDITOR); // defined in an auto-generated header
-                    }
-                    break;
-
-                case EJointType::Prismatic:
-                    if (action_component_name == "set_linear_velocity_target") {
-                        SetLinearVelocityTarget({ action_component_data.at(0), action_component_data.at(1), action_component_data.at(2) });
-                    } else if (action_component_name == "add_to_linear_velocity_target") {
-                        SetLinearVelocityTarget({
-                            action_component_data.at(0) + ConstraintInstance.ProfileInstance.LinearDrive.VelocityTarget.X,
-                            action_component_data.at(1) + ConstraintInstance.ProfileInstance.LinearDrive.VelocityTarget.Y,
-                            action_component_data.at(2) + ConstraintInstance.ProfileInstance.LinearDrive.VelocityTarget.Z });
-                    } else {
-                        SP_ASSERT(WITH_EDITOR); // defined in an auto-generated header
-                    }
                     break;
 
                 case EJointType::Fixed:
@@ -483,31 +428,29 @@ void UUrdfJointComponent::applyActionComponent(const std::pair<std::string, std:
             switch (JointType) {
                 case EJointType::Continuous:
                 case EJointType::Revolute:
-                    if (action_component_name == "add_torque_in_radians") {
-                        FVector torque = GetComponentTransform().GetRotation().RotateVector({ action_component_data.at(0), action_component_data.at(1), action_component_data.at(2) });
+                    action_component_name_ = "add_torque_in_radians";
+                    apply_action_component_func_ = [this](const double* data) -> void {
+                        FVector torque = GetComponentTransform().GetRotation().RotateVector({ data[0], data[1], data[2] });
                         if (ChildStaticMeshComponent && ChildStaticMeshComponent->BodyInstance.ShouldInstanceSimulatingPhysics()) {
                             ChildStaticMeshComponent->AddTorqueInRadians(torque);
                         }
                         if (ParentStaticMeshComponent && ParentStaticMeshComponent->BodyInstance.ShouldInstanceSimulatingPhysics()) {
                             ParentStaticMeshComponent->AddTorqueInRadians(-torque);
                         }
-                    } else {
-                        SP_ASSERT(WITH_EDITOR); // defined in an auto-generated header
-                    }
+                    };
                     break;
 
                 case EJointType::Prismatic:
-                    if (action_component_name == "add_force") {
-                        FVector force = GetComponentTransform().GetRotation().RotateVector({ action_component_data.at(0), action_component_data.at(1), action_component_data.at(2) });
+                    action_component_name_ = "add_force";
+                    apply_action_component_func_ = [this](const double* data) -> void {
+                        FVector force = GetComponentTransform().GetRotation().RotateVector({ data[0], data[1], data[2] });
                         if (ChildStaticMeshComponent && ChildStaticMeshComponent->BodyInstance.ShouldInstanceSimulatingPhysics()) {
                             ChildStaticMeshComponent->AddForce(force);
                         }
                         if (ParentStaticMeshComponent && ParentStaticMeshComponent->BodyInstance.ShouldInstanceSimulatingPhysics()) {
                             ParentStaticMeshComponent->AddForce(-force);
                         }
-                    } else {
-                        SP_ASSERT(WITH_EDITOR); // defined in an auto-generated header
-                    }
+                    };
                     break;
 
                 case EJointType::Fixed:
@@ -518,11 +461,5 @@ void UUrdfJointComponent::applyActionComponent(const std::pair<std::string, std:
                     break;
             }
             break;
-        }
-}
-
-std::map<std::string, std::vector<uint8_t>> UUrdfJointComponent::getObservation() const
-{
-    std::map<std::string, std::vector<uint8_t>> observation;
-    return observation;
+    }
 }
@@ -6,6 +6,7 @@
 
 #include <stdint.h> // uint8_t
 
+#include <functional> // std::function
 #include <map>
 #include <string>
 #include <vector>
@@ -89,9 +90,16 @@ public:
     // This function configures all of the joint's properties, including configuring the joint to operate on the input parent link and child link.
     void initialize(const UrdfJointDesc* joint_desc, UUrdfLinkComponent* parent_link, UUrdfLinkComponent* child_link);
 
-    // Used by UrdfRobotComponent.
-    std::map<std::string, ArrayDesc> getActionSpace() const;
+    // Used by UrdfRobotComponent. getActionComponentName() returns an unqualified name, e.g., "add_torque_in_radians",
+    // or an empty string if this joint can't be controlled. applyActionComponent(...) expects an array of 3 doubles.
+    const std::string& getActionComponentName() const;
+    void applyActionComponent(const double* action_component_data);
     std::map<std::string, ArrayDesc> getObservationSpace() const;
-    void applyActionComponent(const std::pair<std::string, std::vector<double>>& action_component);
     std::map<std::string, std::vector<uint8_t>> getObservation() const;
+
+private:
+    void initializeActionComponent();
+
+    std::string action_component_name_;
+    std::function<void(const double*)> apply_action_component_func_;
 };
@@ -196,41 +196,20 @@ void UUrdfLinkComponent::initialize(const UrdfLinkDesc* link_desc)
     }
 }
 
-std::map<std::string, ArrayDesc> UUrdfLinkComponent::getObservationSpace() const
+void UUrdfLinkComponent::getObservation(double* location, double* rotation) const
 {
-    std::map<std::string, ArrayDesc> observation_space;
-
-    std::string name = Unreal::toStdString(GetName()) + ".location";
-    ArrayDesc array_desc;
-    array_desc.low_ = std::numeric_limits<double>::lowest();
-    array_desc.high_ = std::numeric_limits<double>::max();
-    array_desc.shape_ = {3}; // x, y, z in [cm] of each link relative to it's parent
-    array_desc.datatype_ = DataType::Float64;
-    Std::insert(observation_space, name, std::move(array_desc));
-
-    name = Unreal::toStdString(GetName()) + ".rotation";
-    array_desc.low_ = std::numeric_limits<double>::lowest();
-    array_desc.high_ = std::numeric_limits<double>::max();
-    array_desc.shape_ = {3}; // pitch, yaw, roll in [deg] of each link relative to it's parent
-    array_desc.datatype_ = DataType::Float64;
-    Std::insert(observation_space, name, std::move(array_desc));
-
-    return observation_space;
-}
-
-std::map<std::string, std::vector<uint8_t>> UUrdfLinkComponent::getObservation() const
-{
-    std::map<std::string, std::vector<uint8_t>> observation;
-
-    FVector location = GetRelativeLocation();
-    std::string name = Unreal::toStdString(GetName()) + ".location";
-    Std::insert(observation, name, Std::reinterpretAsVector<uint8_t, double>({location.X, location.Y, location.Z}));
-
-    FRotator rotation = GetRelativeRotation();
-    name = Unreal::toStdString(GetName()) + ".rotation";
-    Std::insert(observation, name, Std::reinterpretAsVector<uint8_t, double>({rotation.Pitch, rotation.Yaw, rotation.Roll}));
-
-    return observation;
+    SP_ASSERT(location);
+    SP_ASSERT(rotation);
+
+    FVector relative_location = GetRelativeLocation();
+    location[0] = relative_location.X;
+    location[1] = relative_location.Y;
+    location[2] = relative_location.Z;
+
+    FRotator relative_rotation = GetRelativeRotation();
+    rotation[0] = relative_rotation.Pitch;
+    rotation[1] = relative_rotation.Yaw;
+    rotation[2] = relative_rotation.Roll;
 }
 
 void UUrdfLinkComponent::reset()
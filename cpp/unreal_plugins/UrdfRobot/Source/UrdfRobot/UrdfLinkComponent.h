@@ -49,8 +49,9 @@ public:
     // higher-level code.
     void initialize(const UrdfLinkDesc* link_desc);
 
-    // Used by UrdfRobotComponent.
-    std::map<std::string, ArrayDesc> getObservationSpace() const;
-    std::map<std::string, std::vector<uint8_t>> getObservation() const;
+    // Used by UrdfRobotComponent. getObservation(...) writes x, y, z in [cm] and pitch, yaw, roll in [deg] of
+    // this link relative to it's parent into caller-owned arrays of 3 doubles each, so UrdfRobotComponent can
+    // gather the observations for all links into a single contiguous array without any intermediate allocations.
+    void getObservation(double* location, double* rotation) const;
     void reset();
 };
@@ -4,10 +4,12 @@
 
 #include "UrdfRobot/UrdfRobotComponent.h"
 
-#include <stdint.h> // uint8_t
+#include <stdint.h> // int64_t, uint8_t
 
+#include <limits>  // std::numeric_limits
 #include <map>
 #include <string>
+#include <utility> // std::move
 #include <vector>
 
 #include <Containers/Array.h>
@@ -109,9 +111,13 @@ std::map<std::string, ArrayDesc> UUrdfRobotComponent::getActionSpace() const
     std::map<std::string, ArrayDesc> action_space;
 
     if (Std::contains(action_components_, "control_joints")) {
-        for (auto joint_component : JointComponents) {
-            Std::insert(action_space, joint_component->getActionSpace());
-        }
+        ArrayDesc array_desc;
+        array_desc.low_ = std::numeric_limits<double>::lowest();
+        array_desc.high_ = std::numeric_limits<double>::max();
+        array_desc.shape_ = {static_cast<int64_t>(action_row_names_.size()), 3};
+        array_desc.datatype_ = DataType::Float64;
+        array_desc.row_names_ = action_row_names_;
+        Std::insert(action_space, "control_joints", std::move(array_desc));
     }
 
     return action_space;
@@ -122,9 +128,21 @@ std::map<std::string, ArrayDesc> UUrdfRobotComponent::getObservationSpace() cons
     std::map<std::string, ArrayDesc> observation_space;
 
     if (Std::contains(observation_components_, "link_configurations")) {
-        for (auto link_component : LinkComponents) {
-            Std::insert(observation_space, link_component->getObservationSpace());
-        }
+        ArrayDesc array_desc;
+        array_desc.low_ = std::numeric_limits<double>::lowest();
+        array_desc.high_ = std::numeric_limits<double>::max();
+        array_desc.shape_ = {static_cast<int64_t>(link_observation_row_names_.size()), 3}; // x, y, z in [cm] of each link relative to it's parent
+        array_desc.datatype_ = DataType::Float64;
+        array_desc.row_names_ = link_observation_row_names_;
+        Std::insert(observation_space, "link_configurations.location", std::move(array_desc));
+
+        array_desc = ArrayDesc();
+        array_desc.low_ = std::numeric_limits<double>::lowest();
+        array_desc.high_ = std::numeric_limits<double>::max();
+        array_desc.shape_ = {static_cast<int64_t>(link_observation_row_names_.size()), 3}; // pitch, yaw, roll in [deg] of each link relative to it's parent
+        array_desc.datatype_ = DataType::Float64;
+        array_desc.row_names_ = link_observation_row_names_;
+        Std::insert(observation_space, "link_configurations.rotation", std::move(array_desc));
     }
 
     if (Std::contains(observation_components_, "joint_configurations")) {
@@ -139,11 +157,14 @@ std::map<std::string, ArrayDesc> UUrdfRobotComponent::getObservationSpace() cons
 void UUrdfRobotComponent::applyAction(const std::map<std::string, std::vector<uint8_t>>& actions)
 {
     if (Std::contains(action_components_, "control_joints")) {
-        std::map <std::string, std::vector<double>> actions_reinterpreted;
-        for (auto& [action_component_name, action_component_data] : actions) {
-            Std::insert(actions_reinterpreted, action_component_name, Std::reinterpretAsVectorOf<double>(action_component_data));
+        const std::vector<uint8_t>& action_data = actions.at("control_joints");
+        int num_actions = action_joint_components_.size();
+        SP_ASSERT(action_data.size() == num_actions*3*sizeof(double));
+
+        const double* action_data_ptr = reinterpret_cast<const double*>(action_data.data());
+        for (int i = 0; i < num_actions; i++) {
+            action_joint_components_[i]->applyActionComponent(action_data_ptr + 3*i);
         }
-        applyAction(actions_reinterpreted);
     }
 }
 
@@ -152,9 +173,19 @@ std::map<std::string, std::vector<uint8_t>> UUrdfRobotComponent::getObservation(
     std::map<std::string, std::vector<uint8_t>> observation;
 
     if (Std::contains(observation_components_, "link_configurations")) {
-        for (auto link_component : LinkComponents) {
-            Std::insert(observation, link_component->getObservation());
+        int num_links = link_observation_row_names_.size();
+        SP_ASSERT(LinkComponents.Num() == num_links);
+
+        std::vector<uint8_t> locations(num_links*3*sizeof(double));
+        std::vector<uint8_t> rotations(num_links*3*sizeof(double));
+        double* location_ptr = reinterpret_cast<double*>(locations.data());
+        double* rotation_ptr = reinterpret_cast<double*>(rotations.data());
+        for (int i = 0; i < num_links; i++) {
+            LinkComponents[i]->getObservation(location_ptr + 3*i, rotation_ptr + 3*i);
         }
+
+        Std::insert(observation, "link_configurations.location", std::move(locations));
+        Std::insert(observation, "link_configurations.rotation", std::move(rotations));
     }
 
     if (Std::contains(observation_components_, "joint_configurations")) {
@@ -205,6 +236,12 @@ void UUrdfRobotComponent::initialize(const UrdfRobotDesc* robot_desc)
     LinkComponents.Add(RootLinkComponent);
 
     initialize(root_link_desc, RootLinkComponent);
+
+    // LinkComponents and JointComponents are complete at this point, so we can compute our observation layout and
+    // action dispatch table, which means that getObservationSpace() and getActionSpace() can be called before
+    // initializeDeferred()
+    initializeObservationLayout();
+    initializeActionDispatchTable();
 }
 
 void UUrdfRobotComponent::initialize(const UrdfLinkDesc* parent_link_desc, UUrdfLinkComponent* parent_link_component)
@@ -265,6 +302,38 @@ void UUrdfRobotComponent::initializeDeferred()
     for (auto joint_component : JointComponents) {
         Std::insert(joint_components_, Unreal::toStdString(joint_component->GetName()), joint_component);
     }
+
+    // we need to re-compute our observation layout and action dispatch table here for the same reason that we need to
+    // re-compute the maps above
+    initializeObservationLayout();
+    initializeActionDispatchTable();
+}
+
+void UUrdfRobotComponent::initializeObservationLayout()
+{
+    link_observation_row_names_.clear();
+    for (auto link_component : LinkComponents) {
+        SP_ASSERT(link_component);
+        link_observation_row_names_.push_back(Unreal::toStdString(link_component->GetName()));
+    }
+}
+
+void UUrdfRobotComponent::initializeActionDispatchTable()
+{
+    action_joint_components_.clear();
+    action_row_names_.clear();
+    action_row_indices_.clear();
+
+    for (auto joint_component : JointComponents) {
+        SP_ASSERT(joint_component);
+        const std::string& action_component_name = joint_component->getActionComponentName();
+        if (action_component_name != "") {
+            std::string action_row_name = Unreal::toStdString(joint_component->GetName()) + "." + action_component_name;
+            Std::insert(action_row_indices_, action_row_name, static_cast<int>(action_joint_components_.size()));
+            action_row_names_.push_back(action_row_name);
+            action_joint_components_.push_back(joint_component);
+        }
+    }
 }
 
 void UUrdfRobotComponent::applyAction(const std::map<std::string, std::vector<double>>& action)
@@ -272,24 +341,17 @@ void UUrdfRobotComponent::applyAction(const std::map<std::string, std::vector<do
     // Since this method is private, we assume that there is no need to check action_components_, either because we're
     // being called directly due to keyboard input, or because we've already checked it in the public applyAction method.
 
-    for (auto& action_component : action) { // don't use structured binding here because we need to refer to action_component below
-        const std::string& action_component_name = action_component.first;
-        std::vector<std::string> tokens = Std::tokenize(action_component_name, ".");
-        SP_ASSERT(tokens.size() == 2 || WITH_EDITOR); // defined in an auto-generated header
-        if (tokens.size() != 2) {
-            SP_LOG("ERROR: Can't parse action component name:", action_component_name);
-            continue;
-        }
-
-        bool found = Std::containsKey(joint_components_, tokens.at(0));
+    for (auto& [action_component_name, action_component_data] : action) {
+        bool found = Std::containsKey(action_row_indices_, action_component_name);
         SP_ASSERT(found || WITH_EDITOR); // defined in an auto-generated header
         if (!found) {
-            SP_LOG("ERROR: Can't find joint: ", tokens.at(0));
+            SP_LOG("ERROR: Can't find action component: ", action_component_name);
             continue;
         }
 
-        UUrdfJointComponent* joint_component = joint_components_.at(tokens.at(0));
+        SP_ASSERT(action_component_data.size() == 3);
+        UUrdfJointComponent* joint_component = action_joint_components_.at(action_row_indices_.at(action_component_name));
         SP_ASSERT(joint_component);
-        joint_component->applyActionComponent(action_component);
+        joint_component->applyActionComponent(action_component_data.data());
     }
 }
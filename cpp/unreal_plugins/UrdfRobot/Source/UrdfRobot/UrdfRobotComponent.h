@@ -69,6 +69,8 @@ public:
 private:
     void initialize(const UrdfLinkDesc* parent_link_desc, UUrdfLinkComponent* parent_link_component);
     void initializeDeferred();
+    void initializeObservationLayout();
+    void initializeActionDispatchTable();
 
     void applyAction(const std::map<std::string, std::vector<double>>& action);
 
@@ -78,5 +80,18 @@ private:
     std::map<std::string, UUrdfLinkComponent*> link_components_;
     std::map<std::string, UUrdfJointComponent*> joint_components_;
 
+    // Link observations are returned as contiguous num_links x 3 arrays, whose rows are ordered like LinkComponents.
+    // We compute the name of each row once in initializeObservationLayout(), so getObservation() doesn't need to
+    // build any strings, and the names only need to be sent to the client once as part of the observation space.
+    std::vector<std::string> link_observation_row_names_;
+
+    // Joint actions are received as a single contiguous num_actions x 3 array. Each row is applied by the joint at the
+    // same index in action_joint_components_, so applyAction(...) is a single linear pass without any string processing.
+    // We compute this dispatch table once in initializeActionDispatchTable(). action_row_indices_ is only used to apply
+    // named actions from user input.
+    std::vector<UUrdfJointComponent*> action_joint_components_;
+    std::vector<std::string> action_row_names_;
+    std::map<std::string, int> action_row_indices_;
+
     bool request_initialize_deferred_ = false;
 };
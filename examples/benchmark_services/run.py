@@ -0,0 +1,73 @@
+#
+# Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+#
+
+# Before running this file, rename user_config.yaml.example -> user_config.yaml and modify it with appropriate paths for your system.
+
+import argparse
+import os
+import spear
+import time
+
+
+if __name__ == "__main__":
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--num_frames", type=int, default=10)
+    parser.add_argument("--num_calls_per_frame", type=int, default=1000)
+    args = parser.parse_args()
+
+    # load config
+    config = spear.get_config(user_config_files=[os.path.realpath(os.path.join(os.path.dirname(__file__), "user_config.yaml"))])
+
+    spear.configure_system(config)
+    instance = spear.Instance(config)
+
+    num_calls = args.num_frames*args.num_calls_per_frame
+
+    #
+    # blocking: each call waits for the game thread to execute it before the next call is sent
+    #
+
+    start_time_seconds = time.time()
+    for i in range(args.num_frames):
+        instance.engine_service.begin_tick()
+        for j in range(args.num_calls_per_frame):
+            instance.unreal_service.get_world_name()
+        instance.engine_service.tick()
+        instance.engine_service.end_tick()
+    elapsed_time_seconds = time.time() - start_time_seconds
+
+    spear.log("Blocking:  %d calls in %0.4f s (%0.4f us per call, %0.1f calls per second)" % \
+        (num_calls, elapsed_time_seconds, (elapsed_time_seconds / num_calls)*1000000.0, num_calls / elapsed_time_seconds))
+
+    #
+    # pipelined: all calls are scheduled with a single call that doesn't wait for the game thread, and the
+    # return values are retrieved with a single call at the end of the frame
+    #
+
+    # We also measure the time required to drain the work queue, i.e., the time from when we call tick()
+    # until all scheduled calls have finished executing on the game thread and their return values have
+    # been retrieved.
+    drain_time_seconds = 0.0
+
+    start_time_seconds = time.time()
+    for i in range(args.num_frames):
+        instance.engine_service.begin_tick()
+        handles = instance.engine_service.call_async_batch([ ("unreal_service.get_world_name", []) for j in range(args.num_calls_per_frame) ])
+        drain_start_time_seconds = time.time()
+        instance.engine_service.tick()
+        return_values = instance.engine_service.get_future_results(handles)
+        drain_time_seconds += time.time() - drain_start_time_seconds
+        instance.engine_service.end_tick()
+        assert len(return_values) == args.num_calls_per_frame
+    elapsed_time_seconds = time.time() - start_time_seconds
+
+    spear.log("Pipelined: %d calls in %0.4f s (%0.4f us per call, %0.1f calls per second)" % \
+        (num_calls, elapsed_time_seconds, (elapsed_time_seconds / num_calls)*1000000.0, num_calls / elapsed_time_seconds))
+    spear.log("Pipelined: average drain time %0.4f ms per frame" % ((drain_time_seconds / args.num_frames)*1000.0))
+
+    # close the unreal instance and rpc connection
+    instance.close()
+
+    spear.log("Done.")
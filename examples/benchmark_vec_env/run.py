@@ -0,0 +1,62 @@
+#
+# Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+#
+
+# Before running this file, rename user_config.yaml.example -> user_config.yaml and modify it with appropriate paths for your system.
+
+import argparse
+import numpy as np
+import os
+import spear
+import time
+
+
+if __name__ == "__main__":
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--num_envs", type=int, nargs="+", default=[1, 2, 4])
+    parser.add_argument("--num_steps", type=int, default=100)
+    args = parser.parse_args()
+
+    # load config
+    config = spear.get_config(user_config_files=[os.path.realpath(os.path.join(os.path.dirname(__file__), "user_config.yaml"))])
+
+    spear.configure_system(config)
+
+    results = []
+
+    for num_envs in args.num_envs:
+
+        spear.log(f"Launching {num_envs} instances...")
+        vec_env = spear.VecEnv(config, num_envs=num_envs)
+
+        # the same action is applied to every instance
+        if config.SP_SERVICES.LEGACY_SERVICE.AGENT == "SphereAgent":
+            actions = {
+                "add_force": np.tile(np.array([10000.0, 0.0, 0.0], dtype=np.float64), (num_envs, 1)),
+                "add_to_rotation": np.tile(np.array([0.0, 1.0, 0.0], dtype=np.float64), (num_envs, 1))}
+        elif config.SP_SERVICES.LEGACY_SERVICE.AGENT == "NullAgent":
+            actions = {}
+        else:
+            assert False
+
+        vec_env.reset()
+
+        start_time_seconds = time.time()
+        for i in range(args.num_steps):
+            obs, rewards, dones, infos = vec_env.step(actions)
+        elapsed_time_seconds = time.time() - start_time_seconds
+
+        vec_env.close()
+
+        # each call to step(...) advances every instance by one frame
+        steps_per_second = num_envs*args.num_steps / elapsed_time_seconds
+        spear.log("%d instances: %d steps in %0.4f s (%0.1f aggregate steps per second)" % \
+            (num_envs, num_envs*args.num_steps, elapsed_time_seconds, steps_per_second))
+        results.append((num_envs, steps_per_second))
+
+    spear.log("Summary:")
+    for num_envs, steps_per_second in results:
+        spear.log("    %3d instances: %0.1f aggregate steps per second (%0.2fx)" % (num_envs, steps_per_second, steps_per_second / results[0][1]))
+
+    spear.log("Done.")
@@ -35,18 +35,18 @@ class OpenBotEnv(spear.Env):
         self._wheel_rotation_speeds = obs["wheel_rotation_speeds"]
         return obs
 
-    def _get_observation(self):
+    def _deserialize_observation(self, observation_non_shared_serialized):
 
-        obs = super()._get_observation()
+        obs = super()._deserialize_observation(observation_non_shared_serialized)
         assert "wheel_rotation_speeds" in obs.keys()
         self._wheel_rotation_speeds = obs["wheel_rotation_speeds"]
         return obs
 
-    def _apply_action(self, action):
+    def _serialize_action(self, action):
 
         assert "set_duty_cycles" in action.keys()
         assert action["set_duty_cycles"].shape[0] == 2
         assert self._wheel_rotation_speeds is not None
         duty_cycles = np.array([action["set_duty_cycles"][0], action["set_duty_cycles"][1], action["set_duty_cycles"][0], action["set_duty_cycles"][1]], dtype=np.float64)
         drive_torques = get_drive_torques(duty_cycles, self._wheel_rotation_speeds, self._config)
-        super()._apply_action(action={"set_drive_torques": drive_torques})
+        return super()._serialize_action(action={"set_drive_torques": drive_torques})
@@ -7,13 +7,12 @@ import numpy as np
 def get_depth_image_for_visualization(image):
 
     assert len(image.shape) == 3  # width, height, #channels
-    assert image.shape[2] == 4    # RGBA or BGRA
+    assert image.shape[2] in [1, 4]  # single-channel or RGBA
 
-    modified_image = image.copy()[:,:,[0,1,2]] # depth is returned as RGBA
+    modified_image = image[:,:,0].astype(np.float32) # depth is returned in the first channel
 
     # discard very large depth values
     max_depth_meters = 20.0
-    modified_image = modified_image[:,:,0]
     modified_image = np.clip(modified_image, 0.0, max_depth_meters)
 
     return modified_image
@@ -21,16 +20,22 @@ def get_depth_image_for_visualization(image):
 def get_final_color_image_for_visualization(image):
 
     assert len(image.shape) == 3  # width, height, #channels
-    assert image.shape[2] == 4    # RGBA or BGRA
+    assert image.shape[2] in [3, 4] # RGB or BGRA
+
+    if image.shape[2] == 3:
+        return image.copy() # final_color is returned as RGB
 
     return image.copy()[:,:,[2,1,0]] # final_color is returned as BGRA
 
 def get_normal_image_for_visualization(image):
 
     assert len(image.shape) == 3  # width, height, #channels
-    assert image.shape[2] == 4    # RGBA or BGRA
+    assert image.shape[2] in [2, 3, 4]  # octahedral, XYZ, or RGBA
 
-    modified_image = image.copy()[:,:,[0,1,2]] # normal is returned as RGBA
+    if image.shape[2] == 2:
+        modified_image = _decode_octahedral_normals(image)
+    else:
+        modified_image = image[:,:,[0,1,2]].astype(np.float32) # normal is returned as XYZ or RGBA
 
     # discard normals that aren't properly normalized, i.e., length of 1.0
     discard_mask = np.logical_not(np.isclose(np.linalg.norm(modified_image, axis=2), 1.0, rtol=0.001, atol=0.001))
@@ -42,6 +47,25 @@ def get_normal_image_for_visualization(image):
 def get_segmentation_image_for_visualization(image):
 
     assert len(image.shape) == 3  # width, height, #channels
-    assert image.shape[2] == 4    # RGBA or BGRA
+    assert image.shape[2] in [1, 4]  # segmentation ID or BGRA
+
+    if image.shape[2] == 1:
+        # the segmentation ID is (R << 16) | (G << 8) | B, truncated to 8, 16, or 32 bits depending on the format
+        segmentation_id = image[:,:,0].astype(np.uint32)
+        red = ((segmentation_id >> 16) & 0xff).astype(np.uint8)
+        green = ((segmentation_id >> 8) & 0xff).astype(np.uint8)
+        blue = (segmentation_id & 0xff).astype(np.uint8)
+        return np.stack([red, green, blue], axis=2)
 
     return image.copy()[:,:,[2,1,0]] # segmentation is returned as BGRA
+
+# see https://jcgt.org/published/0003/02/01
+def _decode_octahedral_normals(image):
+    x = image[:,:,0].astype(np.float32) / 32767.0
+    y = image[:,:,1].astype(np.float32) / 32767.0
+    z = 1.0 - np.abs(x) - np.abs(y)
+    t = np.maximum(-z, 0.0)
+    x = x - np.copysign(t, x)
+    y = y - np.copysign(t, y)
+    normals = np.stack([x, y, z], axis=2)
+    return normals / np.maximum(np.linalg.norm(normals, axis=2, keepdims=True), 1e-12)
@@ -20,10 +20,11 @@ import instance_utils
 import visualization_utils
 
 
-def get_action(row):
+def get_action(row, row_names):
     names = [ name[:-2] for name in row.dtype.names ][::3] # strip .x .y .z from each name, select every third entry
     data = np.array([ row[name] for name in row.dtype.names ], dtype=np.float64).reshape(-1,3) # get data as Nx3 array
-    return dict(zip(names, data))
+    action_components = dict(zip(names, data))
+    return {"control_joints": np.array([ action_components[name] for name in row_names ], dtype=np.float64)} # pack rows in the order expected by the robot
 
 
 if __name__ == "__main__":
@@ -67,7 +68,7 @@ if __name__ == "__main__":
         index = 0
 
     for row in df.to_records(index=False):
-        action = get_action(row)
+        action = get_action(row, row_names=env.action_space_row_names["control_joints"])
         obs, reward, done, info = env.step(action=action)
 
         # save images for each render pass
@@ -14,7 +14,9 @@ from spear.instance import Instance
 from spear.legacy_service import LegacyService
 from spear.log import log, log_current_function, log_no_prefix, log_get_prefix
 from spear.path import path_exists, remove_path
+from spear.sp_func_service import SpFuncService, SpFuncSharedArray
 from spear.unreal_service import UnrealService
+from spear.vec_env import VecEnv
 
 
 # ordered from low-level to high-level
@@ -20,6 +20,60 @@ class EngineService():
     def end_tick(self):
         self._rpc_client.call("engine_service.end_tick")
 
+    # Execute an entire frame in a single RPC round-trip. pre_tick_calls and post_tick_calls are lists of
+    # (name, args) pairs, where name is the fully qualified name of any entry point that executes on the game
+    # thread (e.g., "legacy_service.get_observation") and args is a list of arguments for that entry point.
+    # Returns a pair of lists containing the return values of all pre-tick and post-tick calls respectively.
+    def step(self, pre_tick_calls=[], post_tick_calls=[]):
+        return_values = self._rpc_client.call(
+            "engine_service.step",
+            [ {"name": name, "args": args} for name, args in pre_tick_calls ],
+            [ {"name": name, "args": args} for name, args in post_tick_calls ])
+        return return_values["pre_tick_return_values"], return_values["post_tick_return_values"]
+
+    # Same as step(...), but send the request and return immediately without waiting for the frame to execute.
+    # This is useful for stepping several Unreal instances concurrently. Returns a future whose get() method
+    # blocks until the frame has finished executing, and returns the same pair of lists as step(...).
+    def step_async(self, pre_tick_calls=[], post_tick_calls=[]):
+        future = self._rpc_client.call_async(
+            "engine_service.step",
+            [ {"name": name, "args": args} for name, args in pre_tick_calls ],
+            [ {"name": name, "args": args} for name, args in post_tick_calls ])
+        return StepFuture(future)
+
+    # Schedule a call to any entry point that executes on the game thread, and return a handle immediately
+    # without waiting for the call to execute. This function must be called between begin_tick() and end_tick().
+    # Many calls can be pipelined in this way, and the return values can be retrieved by passing a list of
+    # handles to get_future_results(...). At most 4096 calls can be scheduled per frame, and an exception is
+    # raised if more calls are scheduled.
+    def call_async(self, name, args=[]):
+        return self._rpc_client.call("engine_service.call_async", {"name": name, "args": args})
+
+    # Same as call_async(...), but schedule a list of (name, args) pairs in a single RPC round-trip, and return
+    # a list of handles. The calls within a batch are guaranteed to execute in the order they appear in the list.
+    # Separate calls to call_async(...) or call_async_batch(...) execute in the order they were made if they are
+    # made one after another from a single thread, but calls made concurrently (e.g., from multiple threads or
+    # clients) might be dispatched to different RPC worker threads on the server, and can execute in any order.
+    def call_async_batch(self, calls):
+        return self._rpc_client.call("engine_service.call_async_batch", [ {"name": name, "args": args} for name, args in calls ])
+
+    # Block until the calls corresponding to handles have finished executing, and return a list of their return
+    # values. Each handle can only be retrieved once, and must be retrieved before calling end_tick(), because
+    # end_tick() discards all return values that haven't been retrieved.
+    def get_future_results(self, handles):
+        return self._rpc_client.call("engine_service.get_future_results", handles)
+
+    # Return timing statistics (count, total_ms, mean_ms, p50_ms, p90_ms, p99_ms, max_ms) for each profiled scope,
+    # aggregated over all events recorded since the previous call. If chrome_trace_file is not empty, the recorded
+    # events are also written to chrome_trace_file on the machine running the Unreal instance, which can be viewed
+    # in chrome://tracing or https://ui.perfetto.dev. Profiling must be enabled via SP_CORE.PROFILER.ENABLED or
+    # set_profiler_enabled(...).
+    def get_frame_stats(self, chrome_trace_file=""):
+        return self._rpc_client.call("engine_service.get_frame_stats", chrome_trace_file)
+
+    def set_profiler_enabled(self, enabled):
+        self._rpc_client.call("engine_service.set_profiler_enabled", enabled)
+
     # TODO: Move to sp_func_service.py, because this is the only place where we need to concern ourselves
     # the endian-ness of the Unreal instance. All other services send and receive std::vector<T> where T is
     # not uint8_t, and therefore the endian-ness of the Unreal instance is handled implicitly at the msgpack
@@ -37,3 +91,12 @@ class EngineService():
             return ">"
         else:
             assert False
+
+
+class StepFuture():
+    def __init__(self, future):
+        self._future = future
+
+    def get(self):
+        return_values = self._future.get()
+        return return_values["pre_tick_return_values"], return_values["post_tick_return_values"]
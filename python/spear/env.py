@@ -2,13 +2,15 @@
 # Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
 #
 
+import copy
 from enum import Enum
 import gym.spaces
 import mmap
-import multiprocessing.shared_memory
 import numpy as np
 import sys
 
+from spear.shared_memory import open_shared_memory
+
 
 class Env(gym.Env):
     def __init__(self, instance, config):
@@ -26,29 +28,103 @@ class Env(gym.Env):
         self._agent_step_info_space_desc = SpaceDesc(self._get_agent_step_info_space(), dict_space_type=Dict, box_space_type=Box)
 
         self._ready = False
+        self._step_future = None
 
         self._instance.engine_service.begin_tick()
 
-        gameplay_statics_class = self._instance.unreal_service.get_static_class(class_name="UGameplayStatics")
-        self._gameplay_statics_default_object = self._instance.unreal_service.get_default_object(uclass=gameplay_statics_class, create_if_needed=False)
-        self._set_game_paused_func = self._instance.unreal_service.find_function_by_name(uclass=gameplay_statics_class, name="SetGamePaused")
-
+        self._world_generation = None
         self._instance.engine_service.tick()
+        self._prepare_set_game_paused_func_if_needed()
         self._instance.engine_service.end_tick()
 
+        # some arrays are packed, e.g., one row per joint, so we also expose the optional name of each row
+        self.action_space_row_names = { name:array_desc["row_names_"] for name, array_desc in self._action_space_desc.array_descs.items() }
+        self.observation_space_row_names = { name:array_desc["row_names_"] for name, array_desc in self._observation_space_desc.array_descs.items() }
+
+        # For backwards compatibility with code that expects one observation component per row, e.g.,
+        # "<link>.location" instead of "link_configurations.location", each row of a packed observation array named
+        # "<group>.<component>" is also exposed as "<row_name>.<component>". Each alias is a view into the packed
+        # array, so it doesn't need to be copied. New code should use the packed arrays and observation_space_row_names.
+        self._observation_row_aliases = {}
+        for name, row_names in self.observation_space_row_names.items():
+            if "." in name:
+                component = name.split(".", 1)[1]
+                for row, row_name in enumerate(row_names):
+                    alias = row_name + "." + component
+                    assert alias not in self._observation_space_desc.array_descs.keys()
+                    assert alias not in self._observation_row_aliases.keys()
+                    self._observation_row_aliases[alias] = (name, row)
+
+        observation_spaces = dict(self._observation_space_desc.space.spaces)
+        for alias, (name, row) in self._observation_row_aliases.items():
+            box = observation_spaces[name]
+            observation_spaces[alias] = gym.spaces.Box(low=box.low[row], high=box.high[row], shape=box.shape[1:], dtype=box.dtype)
+
         self.action_space = self._action_space_desc.space
-        self.observation_space = self._observation_space_desc.space
+        self.observation_space = gym.spaces.Dict(observation_spaces)
 
     def step(self, action):
-
-        self.begin_tick()
-        self._apply_action(action)
-        self.tick()
-        obs = self._get_observation()
-        reward = self._get_reward()
-        is_done = not self._ready or self._is_episode_done() # if the last call to reset() failed or the episode is done
-        step_info = self._get_step_info()
-        self.end_tick()
+        self.step_async(action)
+        return self.step_wait()
+
+    # Send the request for the next frame and return immediately. Every call to step_async(...) must be followed
+    # by a call to step_wait() before any other function is called on this object. Splitting step(...) in this
+    # way makes it possible to step several Env objects concurrently, e.g., see spear.VecEnv.
+    def step_async(self, action):
+
+        assert self._step_future is None
+
+        # Execute the entire frame in a single RPC round-trip. This is equivalent to calling begin_tick(),
+        # _apply_action(...), tick(), _get_observation(), _get_reward(), _is_episode_done(), _get_step_info(),
+        # and end_tick(), but avoids paying for the latency of each call separately. A new level can be opened
+        # during any tick, including this one, so we can't use our prepared SetGamePaused function after the
+        # tick. Instead, we call SetGamePaused via unreal_service.call_function after the tick, and we check the
+        # world generation, so step_wait() can detect if the prepared function has been destroyed. In this case,
+        # we don't use the prepared function before the tick either, and we prepare it again after the tick.
+        set_game_paused_is_prepared = self._world_generation is not None
+        if set_game_paused_is_prepared:
+            pre_tick_set_game_paused_call = self._get_set_game_paused_call(paused=False)
+        else:
+            pre_tick_set_game_paused_call = self._get_set_game_paused_unprepared_call(paused=False)
+
+        post_tick_calls = [
+            ("legacy_service.get_observation", []),
+            ("legacy_service.get_reward", []),
+            ("legacy_service.is_episode_done", []),
+            ("legacy_service.get_task_step_info", []),
+            ("legacy_service.get_agent_step_info", []),
+            ("unreal_service.get_world_generation", []),
+            self._get_set_game_paused_unprepared_call(paused=True)]
+        if not set_game_paused_is_prepared:
+            post_tick_calls.append(("unreal_service.prepare_function", [self._gameplay_statics_default_object, self._set_game_paused_func, "WorldContextObject"]))
+
+        self._step_future = self._instance.engine_service.step_async(
+            pre_tick_calls=[
+                pre_tick_set_game_paused_call,
+                ("legacy_service.apply_action", [self._serialize_action(action)])],
+            post_tick_calls=post_tick_calls)
+
+    # Block until the frame requested by step_async(...) has finished executing, and return the same values as step(...).
+    def step_wait(self):
+
+        assert self._step_future is not None
+        pre_tick_return_values, post_tick_return_values = self._step_future.get()
+        self._step_future = None
+
+        # if we prepared SetGamePaused again after the tick, then we store the new handle, otherwise we mark our
+        # prepared function as stale if the world has changed, see step_async(...)
+        world_generation = post_tick_return_values[5]
+        if len(post_tick_return_values) > 7:
+            set_game_paused_prepared_func = copy.copy(self._set_game_paused_prepared_func) # the desc doesn't depend on the world
+            set_game_paused_prepared_func.handle = post_tick_return_values[7]
+            self._set_set_game_paused_prepared_func(set_game_paused_prepared_func, world_generation)
+        elif world_generation != self._world_generation:
+            self._world_generation = None
+
+        obs = self._deserialize_observation(post_tick_return_values[0])
+        reward = post_tick_return_values[1]
+        is_done = not self._ready or post_tick_return_values[2] # if the last call to reset() failed or the episode is done
+        step_info = self._deserialize_step_info(post_tick_return_values[3], post_tick_return_values[4])
 
         return obs, reward, is_done, step_info
 
@@ -86,24 +162,24 @@ class Env(gym.Env):
 
     def begin_tick(self):
         self._instance.engine_service.begin_tick()
-        self._instance.unreal_service.call_function(uobject=self._gameplay_statics_default_object, ufunction=self._set_game_paused_func, args={"bPaused": False})
+        self._prepare_set_game_paused_func_if_needed() # reset() might have opened a new level
+        self._instance.unreal_service.call_prepared_function(self._set_game_paused_prepared_func, args={"bPaused": False})
 
     def tick(self):
         self._instance.engine_service.tick()
 
     def end_tick(self):
-        self._instance.unreal_service.call_function(uobject=self._gameplay_statics_default_object, ufunction=self._set_game_paused_func, args={"bPaused": True})
+        self._prepare_set_game_paused_func_if_needed() # a new level might have been opened during tick()
+        self._instance.unreal_service.call_prepared_function(self._set_game_paused_prepared_func, args={"bPaused": True})
         self._instance.engine_service.end_tick()
 
+    # may be empty, e.g., when using NullAgent
     def _get_action_space(self):
-        array_desc = self._instance.legacy_service.get_action_space()
-        assert len(array_desc) > 0
-        return array_desc
+        return self._instance.legacy_service.get_action_space()
 
+    # may be empty, e.g., when using NullAgent
     def _get_observation_space(self):
-        array_desc = self._instance.legacy_service.get_observation_space()
-        assert len(array_desc) > 0
-        return array_desc
+        return self._instance.legacy_service.get_observation_space()
 
     def _get_task_step_info_space(self):
         return self._instance.legacy_service.get_task_step_info_space()
@@ -112,6 +188,54 @@ class Env(gym.Env):
         return self._instance.legacy_service.get_agent_step_info_space()
 
     def _apply_action(self, action):
+        self._instance.legacy_service.apply_action(self._serialize_action(action))
+
+    def _get_observation(self):
+        return self._deserialize_observation(self._instance.legacy_service.get_observation())
+
+    def _get_reward(self):
+        return self._instance.legacy_service.get_reward()
+    
+    def _is_episode_done(self):
+        return self._instance.legacy_service.is_episode_done()
+
+    def _get_step_info(self):
+        return self._deserialize_step_info(self._instance.legacy_service.get_task_step_info(), self._instance.legacy_service.get_agent_step_info())
+
+    # SetGamePaused is called twice per frame, so we prepare it once and pack its args up front. Prepared functions
+    # are destroyed on the server when a new level is opened, so we prepare it again whenever the world generation
+    # has changed, or if step_wait() has marked it as stale by setting self._world_generation to None. Must be
+    # called between begin_tick() and end_tick().
+    def _prepare_set_game_paused_func_if_needed(self):
+        world_generation = self._instance.unreal_service.get_world_generation()
+        if world_generation == self._world_generation:
+            return
+
+        gameplay_statics_class = self._instance.unreal_service.get_static_class(class_name="UGameplayStatics")
+        self._gameplay_statics_default_object = self._instance.unreal_service.get_default_object(uclass=gameplay_statics_class, create_if_needed=False)
+        self._set_game_paused_func = self._instance.unreal_service.find_function_by_name(uclass=gameplay_statics_class, name="SetGamePaused")
+
+        set_game_paused_prepared_func = self._instance.unreal_service.prepare_function(uobject=self._gameplay_statics_default_object, ufunction=self._set_game_paused_func)
+        self._set_set_game_paused_prepared_func(set_game_paused_prepared_func, world_generation)
+
+    def _set_set_game_paused_prepared_func(self, set_game_paused_prepared_func, world_generation):
+        self._set_game_paused_prepared_func = set_game_paused_prepared_func
+        self._set_game_paused_args = {
+            paused:self._instance.unreal_service.get_prepared_function_args(self._set_game_paused_prepared_func, args={"bPaused": paused}) for paused in [False, True] }
+        self._world_generation = world_generation
+
+    # returns a (name, args) pair that can be passed to engine_service.step(...)
+    def _get_set_game_paused_call(self, paused):
+        return ("unreal_service.call_prepared_function", self._set_game_paused_args[paused])
+
+    # Returns a (name, args) pair that can be passed to engine_service.step(...), but doesn't use the prepared
+    # function, so it remains valid when a new level is opened. The default object and the function belong to
+    # the UGameplayStatics class rather than to the world, so they aren't destroyed when a new level is opened.
+    def _get_set_game_paused_unprepared_call(self, paused):
+        return ("unreal_service.call_function", [self._gameplay_statics_default_object, self._set_game_paused_func, {"bPaused": "true" if paused else "false"}, "WorldContextObject"])
+
+    # writes shared memory action components, and returns the remaining action components in a form that can be passed to legacy_service.apply_action
+    def _serialize_action(self, action):
 
         assert action.keys() == self._action_space_desc.space.spaces.keys()
 
@@ -119,35 +243,28 @@ class Env(gym.Env):
         self._action_space_desc.set_shared_memory_data(action_shared)
 
         action_non_shared = { name:component for name, component in action.items() if name in self._action_space_desc.space_non_shared.spaces.keys() }
-        action_non_shared_serialized = _serialize_arrays(
-            action_non_shared, space=self._action_space_desc.space_non_shared, byte_order=self._byte_order)
-        self._instance.legacy_service.apply_action(action_non_shared_serialized)
+        return _serialize_arrays(action_non_shared, space=self._action_space_desc.space_non_shared, byte_order=self._byte_order)
 
-    def _get_observation(self):
+    # combines shared memory observation components with the value returned by legacy_service.get_observation
+    def _deserialize_observation(self, observation_non_shared_serialized):
 
-        observation_shared = self._observation_space_desc.shared_memory_arrays
+        observation_shared = self._observation_space_desc.get_shared_memory_arrays()
 
-        observation_non_shared_serialized = self._instance.legacy_service.get_observation()
         observation_non_shared = _deserialize_arrays(
             observation_non_shared_serialized, space=self._observation_space_desc.space_non_shared, byte_order=self._byte_order)
 
         assert len(set(observation_shared.keys()) & set(observation_non_shared.keys())) == 0
 
-        return {**observation_shared, **observation_non_shared}
-
-    def _get_reward(self):
-        return self._instance.legacy_service.get_reward()
-    
-    def _is_episode_done(self):
-        return self._instance.legacy_service.is_episode_done()
+        observation = {**observation_shared, **observation_non_shared}
+        observation_row_aliases = { alias:observation[name][row] for alias, (name, row) in self._observation_row_aliases.items() }
 
-    def _get_step_info(self):
+        return {**observation, **observation_row_aliases}
 
-        task_step_info_shared = self._task_step_info_space_desc.shared_memory_arrays
-        agent_step_info_shared = self._agent_step_info_space_desc.shared_memory_arrays
+    # combines shared memory step info components with the values returned by legacy_service.get_task_step_info and legacy_service.get_agent_step_info
+    def _deserialize_step_info(self, task_step_info_non_shared_serialized, agent_step_info_non_shared_serialized):
 
-        task_step_info_non_shared_serialized = self._instance.legacy_service.get_task_step_info()
-        agent_step_info_non_shared_serialized = self._instance.legacy_service.get_agent_step_info()
+        task_step_info_shared = self._task_step_info_space_desc.get_shared_memory_arrays()
+        agent_step_info_shared = self._agent_step_info_space_desc.get_shared_memory_arrays()
 
         task_step_info_non_shared = _deserialize_arrays(
             task_step_info_non_shared_serialized, space=self._task_step_info_space_desc.space_non_shared, byte_order=self._byte_order)
@@ -188,32 +305,96 @@ class SpaceDesc():
         # shared memory
         self.shared_memory_objects = {}
         self.shared_memory_arrays = {}
+        self.shared_memory_ring_buffer_headers = {}
+        self.shared_memory_ring_buffer_slot_headers = {}
+        self.shared_memory_ring_buffer_arrays = {}
         for name, array_desc in self.array_descs_shared.items():
+            shape = tuple(array_desc["shape_"])
+            dtype = DATATYPE_TO_DTYPE[array_desc["datatype_"]]
+            num_slots = array_desc["shared_memory_num_slots_"]
+
+            if num_slots == 0:
+                num_bytes = np.prod(shape) * dtype.itemsize
+            else:
+                slot_num_bytes = _get_shared_memory_ring_buffer_slot_num_bytes(np.prod(shape) * dtype.itemsize)
+                num_bytes = SHARED_MEMORY_RING_BUFFER_HEADER_NUM_BYTES + num_slots*slot_num_bytes
+
             if sys.platform == "win32":
-                self.shared_memory_objects[name] = mmap.mmap(
-                    -1, np.prod(array_desc["shape_"]) * DATATYPE_TO_DTYPE[array_desc["datatype_"]].itemsize, array_desc["shared_memory_name_"])
-                self.shared_memory_arrays[name] = np.ndarray(
-                    shape=tuple(array_desc["shape_"]), dtype=DATATYPE_TO_DTYPE[array_desc["datatype_"]], buffer=self.shared_memory_objects[name])
+                self.shared_memory_objects[name] = mmap.mmap(-1, num_bytes, array_desc["shared_memory_name_"])
+                buffer = self.shared_memory_objects[name]
             elif sys.platform in ["darwin", "linux"]:
-                self.shared_memory_objects[name] = multiprocessing.shared_memory.SharedMemory(name=array_desc["shared_memory_name_"])
-                self.shared_memory_arrays[name] = np.ndarray(
-                    shape=tuple(array_desc["shape_"]), dtype=DATATYPE_TO_DTYPE[array_desc["datatype_"]], buffer=self.shared_memory_objects[name].buf)
+                self.shared_memory_objects[name] = open_shared_memory(name=array_desc["shared_memory_name_"])
+                buffer = self.shared_memory_objects[name].buf
             else:
                 assert False
 
+            if num_slots == 0:
+                self.shared_memory_arrays[name] = np.ndarray(shape=shape, dtype=dtype, buffer=buffer)
+            else:
+                # see cpp/unreal_plugins/SpCore/Source/SpCore/ArrayDesc.h for details on the memory layout
+                header = np.ndarray(shape=(3,), dtype=np.uint64, buffer=buffer) # num_slots, slot_num_bytes, latest_sequence
+                assert header[0] == num_slots
+                assert header[1] == slot_num_bytes
+                self.shared_memory_ring_buffer_headers[name] = header
+                self.shared_memory_ring_buffer_slot_headers[name] = [
+                    np.ndarray(shape=(1,), dtype=np.uint64, buffer=buffer, offset=SHARED_MEMORY_RING_BUFFER_HEADER_NUM_BYTES + i*slot_num_bytes) # sequence
+                    for i in range(num_slots) ]
+                self.shared_memory_ring_buffer_arrays[name] = [
+                    np.ndarray(
+                        shape=shape,
+                        dtype=dtype,
+                        buffer=buffer,
+                        offset=SHARED_MEMORY_RING_BUFFER_HEADER_NUM_BYTES + i*slot_num_bytes + SHARED_MEMORY_RING_BUFFER_SLOT_HEADER_NUM_BYTES)
+                    for i in range(num_slots) ]
+
     def terminate(self):
         self.shared_memory_arrays = {}
+        self.shared_memory_ring_buffer_headers = {}
+        self.shared_memory_ring_buffer_slot_headers = {}
+        self.shared_memory_ring_buffer_arrays = {}
         for name, shared_memory_object in self.shared_memory_objects.items():
             if sys.platform == "win32":
                 shared_memory_object.close()
             elif sys.platform in ["darwin", "linux"]:
+                # don't unlink, because shared memory objects are owned by the engine, which reuses them
                 shared_memory_object.close()
-                shared_memory_object.unlink()
             else:
                 assert False
 
+    # returns the slot index of the most recently written slot for each ring buffer
+    def get_shared_memory_slot_indices(self):
+        return { name:max(int(header[2]) - 1, 0) % int(header[0]) for name, header in self.shared_memory_ring_buffer_headers.items() }
+
+    # returns a view of each shared memory array that doesn't use a ring buffer, and a copy of the most recently
+    # written slot for each ring buffer
+    def get_shared_memory_arrays(self):
+        ring_buffer_arrays = { name:self._get_shared_memory_ring_buffer_array(name) for name in self.shared_memory_ring_buffer_headers.keys() }
+        return {**self.shared_memory_arrays, **ring_buffer_arrays}
+
+    # The engine stores 0 in a slot's sequence number before writing to the slot, and stores the slot's new
+    # sequence number after writing to it, so we check the slot's sequence number before and after copying the
+    # slot, and try again with the new latest slot if the engine started writing to the slot while we were
+    # copying it. See cpp/unreal_plugins/SpCore/Source/SpCore/ArrayDesc.h for details.
+    def _get_shared_memory_ring_buffer_array(self, name):
+        header = self.shared_memory_ring_buffer_headers[name]
+        slot_headers = self.shared_memory_ring_buffer_slot_headers[name]
+        arrays = self.shared_memory_ring_buffer_arrays[name]
+        num_slots = int(header[0])
+
+        while True:
+            latest_sequence = int(header[2])
+            if latest_sequence == 0: # no slots have been written
+                return arrays[0].copy()
+            slot_index = (latest_sequence - 1) % num_slots
+            if int(slot_headers[slot_index][0]) != latest_sequence:
+                continue
+            array = arrays[slot_index].copy()
+            if int(slot_headers[slot_index][0]) == latest_sequence:
+                return array
+
     def set_shared_memory_data(self, data):
         assert data.keys() == self.space_shared.spaces.keys()
+        assert len(self.shared_memory_ring_buffer_arrays) == 0
         for name, component in data.items():
             assert isinstance(component, np.ndarray)
             assert component.shape == self.space_shared.spaces[name].shape
@@ -263,6 +444,16 @@ DATATYPE_TO_DTYPE = {
     DataType.Float64.value:    np.dtype("f8")}
 
 
+# must match cpp/unreal_plugins/SpCore/Source/SpCore/ArrayDesc.h
+SHARED_MEMORY_RING_BUFFER_ALIGNMENT = 64
+SHARED_MEMORY_RING_BUFFER_HEADER_NUM_BYTES = 64
+SHARED_MEMORY_RING_BUFFER_SLOT_HEADER_NUM_BYTES = 64
+
+def _get_shared_memory_ring_buffer_slot_num_bytes(array_num_bytes):
+    alignment = SHARED_MEMORY_RING_BUFFER_ALIGNMENT
+    return SHARED_MEMORY_RING_BUFFER_SLOT_HEADER_NUM_BYTES + ((array_num_bytes + alignment - 1) // alignment) * alignment
+
+
 # functions for creating Python spaces from C++ array_descs
 def _create_dict_space(array_descs, dict_space_type, box_space_type):
     return dict_space_type({ name: _create_box_space(array_desc, box_space_type=box_space_type) for name, array_desc in array_descs.items() })
@@ -23,6 +23,7 @@ class Instance():
         # Need to do these after we have a valid rpc_client
         self.engine_service = spear.EngineService(self.rpc_client)
         self.legacy_service = spear.LegacyService(self.rpc_client)
+        self.sp_func_service = spear.SpFuncService(self.rpc_client)
         self.unreal_service = spear.UnrealService(self.rpc_client)
 
         # Need to do this after we have a valid EngineService object because we call begin_tick(), tick(), and end_tick() here.
@@ -192,10 +193,7 @@ class Instance():
                 # Once a connection has been established, the RPC client will wait for timeout seconds before
                 # throwing when calling a server function. The RPC client will try to connect reconnect_limit
                 # times before returning from its constructor.
-                self.rpc_client = msgpackrpc.Client(
-                    msgpackrpc.Address("127.0.0.1", self._config.SP_SERVICES.PORT),
-                    timeout=self._config.SPEAR.INSTANCE.RPC_CLIENT_INTERNAL_TIMEOUT_SECONDS,
-                    reconnect_limit=self._config.SPEAR.INSTANCE.RPC_CLIENT_INTERNAL_RECONNECT_LIMIT)
+                self.rpc_client = self._create_rpc_client()
                 self.rpc_client.call("engine_service.ping")
                 connected = True
 
@@ -223,10 +221,7 @@ class Instance():
                     # Once a connection has been established, the RPC client will wait for timeout seconds
                     # before throwing when calling a server function. The RPC client will try to connect
                     # reconnect_limit times before returning from its constructor.
-                    self.rpc_client = msgpackrpc.Client(
-                        msgpackrpc.Address("127.0.0.1", self._config.SP_SERVICES.PORT), 
-                        timeout=self._config.SPEAR.INSTANCE.RPC_CLIENT_INTERNAL_TIMEOUT_SECONDS, 
-                        reconnect_limit=self._config.SPEAR.INSTANCE.RPC_CLIENT_INTERNAL_RECONNECT_LIMIT)
+                    self.rpc_client = self._create_rpc_client()
                     self.rpc_client.call("engine_service.ping")
                     connected = True
                     break
@@ -253,10 +248,27 @@ class Instance():
 
         spear.log("Finished initializing RPC client.")
 
+    def _create_rpc_client(self):
+        if self._config.SPEAR.INSTANCE.RPC_CLIENT == "msgpackrpc":
+            return msgpackrpc.Client(
+                msgpackrpc.Address("127.0.0.1", self._config.SP_SERVICES.PORT),
+                timeout=self._config.SPEAR.INSTANCE.RPC_CLIENT_INTERNAL_TIMEOUT_SECONDS,
+                reconnect_limit=self._config.SPEAR.INSTANCE.RPC_CLIENT_INTERNAL_RECONNECT_LIMIT)
+        elif self._config.SPEAR.INSTANCE.RPC_CLIENT == "sp_client":
+            # import here, so users who haven't built our native client library can still use msgpackrpc
+            import spear.sp_client
+            return spear.sp_client.Client(
+                address="127.0.0.1",
+                port=self._config.SP_SERVICES.PORT,
+                timeout_seconds=self._config.SPEAR.INSTANCE.RPC_CLIENT_INTERNAL_TIMEOUT_SECONDS)
+        else:
+            assert False
+
     def _close_rpc_client(self, verbose):
         if verbose:
             spear.log("Closing RPC client...")
         self.rpc_client.close()
-        self.rpc_client._loop._ioloop.close()
+        if isinstance(self.rpc_client, msgpackrpc.Client):
+            self.rpc_client._loop._ioloop.close()
         if verbose:
             spear.log("Finished closing RPC client.")
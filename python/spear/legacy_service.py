@@ -8,20 +8,28 @@ class LegacyService():
     def __init__(self, rpc_client):
         self._rpc_client = rpc_client
 
+    # points are sent and received as packed float64 arrays
     def get_random_points(self, num_points):
         random_points = self._rpc_client.call("legacy_service.get_random_points", num_points)
-        return np.asarray(random_points, dtype=np.float64).reshape(num_points, 3)
+        return np.frombuffer(random_points, dtype=np.float64).reshape(num_points, 3)
 
     def get_random_reachable_points_in_radius(self, reference_points, radius):
         assert reference_points.shape[1] == 3
-        reachable_points = self._rpc_client.call("legacy_service.get_random_reachable_points_in_radius", reference_points.flatten().tolist(), radius)
-        return np.asarray(reachable_points, dtype=np.float64).reshape(reference_points.shape)
+        reference_points = np.ascontiguousarray(reference_points, dtype=np.float64)
+        reachable_points = self._rpc_client.call("legacy_service.get_random_reachable_points_in_radius", reference_points.data, radius)
+        return np.frombuffer(reachable_points, dtype=np.float64).reshape(reference_points.shape)
 
+    # paths are returned in a CSR layout, i.e., as a flat array of points and an array of offsets, so we
+    # return a list of views into the flat array rather than copying each path
     def get_paths(self, initial_points, goal_points):
         assert initial_points.shape[1] == 3
         assert goal_points.shape[1] == 3
-        paths = self._rpc_client.call("legacy_service.get_paths", initial_points.flatten().tolist(), goal_points.flatten().tolist())
-        return [ np.asarray(path, dtype=np.float64).reshape(-1, 3) for path in paths ]
+        initial_points = np.ascontiguousarray(initial_points, dtype=np.float64)
+        goal_points = np.ascontiguousarray(goal_points, dtype=np.float64)
+        paths = self._rpc_client.call("legacy_service.get_paths", initial_points.data, goal_points.data)
+        points = np.frombuffer(paths["points"], dtype=np.float64).reshape(-1, 3)
+        offsets = np.frombuffer(paths["offsets"], dtype=np.uint64).astype(np.int64)
+        return [ points[offsets[i]:offsets[i+1]] for i in range(offsets.shape[0] - 1) ]
 
     def get_action_space(self):
         return self._rpc_client.call("legacy_service.get_action_space")
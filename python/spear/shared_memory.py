@@ -0,0 +1,20 @@
+#
+# Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+#
+
+import multiprocessing.resource_tracker
+import multiprocessing.shared_memory
+import sys
+
+
+# Attach to an existing shared memory object on macOS or Linux that is owned by the Unreal instance. Before
+# Python 3.13, attaching to a shared memory object registers it with multiprocessing's resource tracker, which
+# unlinks it when this process exits. But the Unreal instance owns the object and might reuse it, e.g., for the
+# next client, so we tell the resource tracker not to track it.
+def open_shared_memory(name):
+    if sys.version_info >= (3, 13):
+        return multiprocessing.shared_memory.SharedMemory(name=name, track=False)
+
+    shared_memory = multiprocessing.shared_memory.SharedMemory(name=name)
+    multiprocessing.resource_tracker.unregister(shared_memory._name, "shared_memory")
+    return shared_memory
@@ -0,0 +1,303 @@
+#
+# Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+#
+
+import ctypes
+import mmap
+import msgpack
+import numpy as np
+import platform
+import struct
+import sys
+import time
+
+from spear.shared_memory import open_shared_memory
+
+# must match SpFuncArrayDataType in cpp/unreal_plugins/SpCore/Source/SpCore/SpFuncArray.h
+DATA_TYPE_TO_DTYPE = {
+    0: np.dtype(np.uint8),
+    1: np.dtype(np.int8),
+    2: np.dtype(np.uint16),
+    3: np.dtype(np.int16),
+    4: np.dtype(np.uint32),
+    5: np.dtype(np.int32),
+    6: np.dtype(np.uint64),
+    7: np.dtype(np.int64),
+    8: np.dtype(np.float32),
+    9: np.dtype(np.float64)}
+DTYPE_TO_DATA_TYPE = { dtype:data_type for data_type, dtype in DATA_TYPE_TO_DTYPE.items() }
+
+# must match SpFuncArrayDataSource in cpp/unreal_plugins/SpCore/Source/SpCore/SpFuncArray.h
+DATA_SOURCE_INTERNAL = 0
+DATA_SOURCE_SHARED = 2
+
+# must match SpFuncSharedMemoryTransportArrayDesc and SpFuncSharedMemoryTransportHeader in
+# cpp/unreal_plugins/SpServices/Source/SpServices/SpFuncSharedMemoryTransport.h
+MAX_NAME_LENGTH = 64
+MAX_NUM_DIMS = 8
+MAX_NUM_ARRAYS = 32
+PAYLOAD_ALIGNMENT = 16
+
+# While waiting for a response from the shared memory transport, we spin for a short time, and then block with
+# a timeout that doubles after each wait, so we see low latency for short calls without consuming an entire core
+# for long calls. On Linux, we block in the futex system call, and the server wakes us up as soon as its response
+# is ready, so the timeout only matters if we miss a wakeup. On other platforms, we sleep for the entire timeout.
+NUM_SPIN_ITERATIONS = 1000
+MIN_SLEEP_DURATION_SECONDS = 0.00001
+MAX_SLEEP_DURATION_SECONDS = 0.001
+
+# must match the futex system call numbers for each architecture, see linux/futex.h and asm/unistd.h
+FUTEX_WAIT = 0
+FUTEX_WAKE = 1
+SYS_FUTEX = {"x86_64": 202, "aarch64": 98}.get(platform.machine()) if sys.platform == "linux" else None
+
+class Timespec(ctypes.Structure):
+    _fields_ = [("tv_sec", ctypes.c_long), ("tv_nsec", ctypes.c_long)]
+
+ARRAY_DESC_DTYPE = np.dtype([
+    ("name", f"S{MAX_NAME_LENGTH}"),
+    ("shared_memory_name", f"S{MAX_NAME_LENGTH}"),
+    ("data_source", np.int8),
+    ("data_type", np.int8),
+    ("padding", np.uint8, (6,)),
+    ("num_dims", np.uint64),
+    ("shape", np.uint64, (MAX_NUM_DIMS,)),
+    ("data_offset", np.uint64),
+    ("data_num_bytes", np.uint64)])
+
+HEADER_DTYPE = np.dtype([
+    ("request_sequence", np.uint32),
+    ("request_sequence_padding", np.uint32),
+    ("response_sequence", np.uint32),
+    ("response_sequence_padding", np.uint32),
+    ("func_name", f"S{MAX_NAME_LENGTH}"),
+    ("num_arrays", np.uint64),
+    ("info_offset", np.uint64),
+    ("info_num_bytes", np.uint64),
+    ("arrays", ARRAY_DESC_DTYPE, (MAX_NUM_ARRAYS,))])
+
+assert ARRAY_DESC_DTYPE.itemsize == 224
+assert HEADER_DTYPE.itemsize == 104 + 224*MAX_NUM_ARRAYS
+
+# must match SpFuncPackedArrayExtHeader in cpp/unreal_plugins/SpServices/Source/SpServices/SpFuncService.h
+PACKED_ARRAY_EXT_TYPE = 1
+PACKED_ARRAY_EXT_HEADER_FORMAT = "=bcB4x" # data_type, byte_order, num_dims, padding
+PACKED_ARRAY_EXT_HEADER_NUM_BYTES = struct.calcsize(PACKED_ARRAY_EXT_HEADER_FORMAT)
+
+assert PACKED_ARRAY_EXT_HEADER_NUM_BYTES == 7
+
+# Describes an arg or return value that refers to an SpFunc shared memory region instead of containing data.
+class SpFuncSharedArray():
+    def __init__(self, shared_memory_name, shape, dtype):
+        self.shared_memory_name = shared_memory_name
+        self.shape = tuple(shape)
+        self.dtype = np.dtype(dtype)
+
+class SpFuncService():
+    def __init__(self, rpc_client):
+        self._rpc_client = rpc_client
+        self._shared_memory_object = None
+        self._syscall = None
+        if SYS_FUTEX is not None:
+            self._syscall = ctypes.CDLL(None, use_errno=True).syscall
+
+    def get_shared_memory_views(self):
+        return self._rpc_client.call("sp_func_service.get_shared_memory_views")
+
+    # Create a shared memory control block that can be used to call SpFuncs without sending any data over a
+    # socket. Only one transport can exist at a time.
+    def create_shared_memory_transport(self, payload_num_bytes=1024*1024):
+        assert self._shared_memory_object is None
+
+        view = self._rpc_client.call("sp_func_service.create_shared_memory_transport", payload_num_bytes)
+
+        if sys.platform == "win32":
+            self._shared_memory_object = mmap.mmap(-1, view["num_bytes"], view["id"])
+            buffer = self._shared_memory_object
+        elif sys.platform in ["darwin", "linux"]:
+            # SharedMemory expects a name without a leading slash
+            self._shared_memory_object = open_shared_memory(name=view["id"].lstrip("/"))
+            buffer = self._shared_memory_object.buf
+        else:
+            assert False
+
+        self._header = np.ndarray(shape=(), dtype=HEADER_DTYPE, buffer=buffer)
+        self._payload = np.ndarray(shape=(view["num_bytes"] - HEADER_DTYPE.itemsize,), dtype=np.uint8, buffer=buffer, offset=HEADER_DTYPE.itemsize)
+
+        # addresses of the sequence numbers, which we pass to the futex system call
+        self._request_sequence_address = self._header.ctypes.data + HEADER_DTYPE.fields["request_sequence"][1]
+        self._response_sequence_address = self._header.ctypes.data + HEADER_DTYPE.fields["response_sequence"][1]
+
+    def destroy_shared_memory_transport(self):
+        assert self._shared_memory_object is not None
+
+        self._header = None
+        self._payload = None
+        self._shared_memory_object.close()
+        self._shared_memory_object = None
+
+        self._rpc_client.call("sp_func_service.destroy_shared_memory_transport")
+
+    # Call an SpFunc via RPC. args is a dict of np.ndarray objects, which are sent as a msgpack ext type that the
+    # server can read without copying, or SpFuncSharedArray objects, which are never copied. Like all other calls
+    # that execute on the game thread, this function must be called between begin_tick() and end_tick(). Returns a
+    # dict of return values and an info string. Returned np.ndarray objects are read-only views into the received
+    # message.
+    def call_func(self, func_name, args=None, info=""):
+        if args is None:
+            args = {}
+        packed_args = { name: self._to_packed_array(arg) for name, arg in args.items() }
+        return_values = self._rpc_client.call(
+            "sp_func_service.call_func",
+            func_name,
+            {"packed_arrays": packed_args, "unreal_obj_strings": {}, "info": info})
+        return { name: self._from_packed_array(packed_array) for name, packed_array in return_values["packed_arrays"].items() }, return_values["info"]
+
+    # Call an SpFunc via the shared memory transport. args is a dict of np.ndarray objects, which are copied into
+    # the control block, or SpFuncSharedArray objects, which are never copied. Like all other calls that execute on
+    # the game thread, this function must be called between begin_tick() and end_tick(). Returns a dict of return
+    # values and an info string. If the SpFunc fails on the server, the dict is empty and the info string contains
+    # the error message.
+    def call_func_shared_memory(self, func_name, args=None, info=""):
+        if args is None:
+            args = {}
+        assert self._shared_memory_object is not None
+        assert len(args) <= MAX_NUM_ARRAYS
+
+        header = self._header
+        header["func_name"] = self._encode_name(func_name)
+
+        # we index by field first, so each assignment writes directly into the control block
+        arrays = header["arrays"]
+        arrays[...] = np.zeros((), dtype=ARRAY_DESC_DTYPE)
+
+        payload_offset = 0
+        for i, (name, arg) in enumerate(args.items()):
+            arrays["name"][i] = self._encode_name(name)
+
+            if isinstance(arg, SpFuncSharedArray):
+                shape = arg.shape
+                arrays["data_source"][i] = DATA_SOURCE_SHARED
+                arrays["data_type"][i] = DTYPE_TO_DATA_TYPE[arg.dtype]
+                arrays["shared_memory_name"][i] = self._encode_name(arg.shared_memory_name)
+            else:
+                # the server interprets an empty shape as an array with 0 elements, so we send 0-d arrays with shape [1]
+                arg = np.ascontiguousarray(arg).reshape(np.shape(arg) or (1,))
+                shape = arg.shape
+                payload_offset = self._align(payload_offset)
+                assert payload_offset + arg.nbytes <= self._payload.shape[0]
+                self._payload[payload_offset:payload_offset + arg.nbytes] = arg.reshape(-1).view(np.uint8)
+                arrays["data_source"][i] = DATA_SOURCE_INTERNAL
+                arrays["data_type"][i] = DTYPE_TO_DATA_TYPE[arg.dtype]
+                arrays["data_offset"][i] = payload_offset
+                arrays["data_num_bytes"][i] = arg.nbytes
+                payload_offset += arg.nbytes
+
+            assert len(shape) <= MAX_NUM_DIMS
+            arrays["num_dims"][i] = len(shape)
+            arrays["shape"][i, :len(shape)] = shape
+
+        info_bytes = np.frombuffer(info.encode("utf-8"), dtype=np.uint8)
+        assert payload_offset + info_bytes.shape[0] <= self._payload.shape[0]
+        self._payload[payload_offset:payload_offset + info_bytes.shape[0]] = info_bytes
+        header["num_arrays"] = len(args)
+        header["info_offset"] = payload_offset
+        header["info_num_bytes"] = info_bytes.shape[0]
+
+        # ring the doorbell, wake the server up, and wait for the server to finish writing its response
+        request_sequence = np.uint32((int(header["request_sequence"]) + 1) % 2**32)
+        header["request_sequence"] = request_sequence
+        self._wake(self._request_sequence_address)
+        self._wait_for_response(header, request_sequence)
+
+        return_values = {}
+        for i in range(int(header["num_arrays"])):
+            name = arrays["name"][i].decode("utf-8")
+            shape = tuple(int(dim) for dim in arrays["shape"][i, :arrays["num_dims"][i]])
+            dtype = DATA_TYPE_TO_DTYPE[int(arrays["data_type"][i])]
+
+            if arrays["data_source"][i] == DATA_SOURCE_SHARED:
+                return_values[name] = SpFuncSharedArray(arrays["shared_memory_name"][i].decode("utf-8"), shape, dtype)
+            elif arrays["data_source"][i] == DATA_SOURCE_INTERNAL:
+                # copy out of the control block, because it will be overwritten by the next call
+                data_offset = int(arrays["data_offset"][i])
+                data_num_bytes = int(arrays["data_num_bytes"][i])
+                return_values[name] = self._payload[data_offset:data_offset + data_num_bytes].view(dtype).reshape(shape).copy()
+            else:
+                assert False
+
+        info_offset = int(header["info_offset"])
+        info_num_bytes = int(header["info_num_bytes"])
+        return_info = self._payload[info_offset:info_offset + info_num_bytes].tobytes().decode("utf-8")
+
+        return return_values, return_info
+
+    def _to_packed_array(self, arg):
+        if isinstance(arg, SpFuncSharedArray):
+            return {
+                "data": b"",
+                "data_source": DATA_SOURCE_SHARED,
+                "shape": list(arg.shape),
+                "data_type": DTYPE_TO_DATA_TYPE[arg.dtype],
+                "shared_memory_name": arg.shared_memory_name}
+
+        # the server interprets an empty shape as an array with 0 elements, so we send 0-d arrays with shape [1],
+        # and the server only accepts data in its native byte order, which we assume is the same as ours
+        arg = np.ascontiguousarray(arg, dtype=np.asarray(arg).dtype.newbyteorder("=")).reshape(np.shape(arg) or (1,))
+        byte_order = "<" if sys.byteorder == "little" else ">"
+        header = struct.pack(PACKED_ARRAY_EXT_HEADER_FORMAT, DTYPE_TO_DATA_TYPE[arg.dtype], byte_order.encode("ascii"), arg.ndim)
+        shape = np.array(arg.shape, dtype=np.uint64).tobytes()
+        return msgpack.ExtType(PACKED_ARRAY_EXT_TYPE, header + shape + arg.tobytes())
+
+    def _from_packed_array(self, packed_array):
+        if isinstance(packed_array, msgpack.ExtType):
+            assert packed_array.code == PACKED_ARRAY_EXT_TYPE
+            payload = packed_array.data
+            data_type, byte_order, num_dims = struct.unpack_from(PACKED_ARRAY_EXT_HEADER_FORMAT, payload)
+            byte_order = byte_order.decode("ascii")
+            shape = np.frombuffer(payload, dtype=np.dtype(np.uint64).newbyteorder(byte_order), count=num_dims, offset=PACKED_ARRAY_EXT_HEADER_NUM_BYTES)
+            dtype = DATA_TYPE_TO_DTYPE[data_type].newbyteorder(byte_order)
+            data_offset = PACKED_ARRAY_EXT_HEADER_NUM_BYTES + shape.nbytes
+            array = np.frombuffer(payload, dtype=dtype, offset=data_offset)
+            return array.reshape(tuple(int(dim) for dim in shape)) if num_dims > 0 else array
+
+        assert packed_array["data_source"] == DATA_SOURCE_SHARED
+        return SpFuncSharedArray(packed_array["shared_memory_name"], packed_array["shape"], DATA_TYPE_TO_DTYPE[packed_array["data_type"]])
+
+    def _wait_for_response(self, header, request_sequence):
+        for i in range(NUM_SPIN_ITERATIONS):
+            if header["response_sequence"] == request_sequence:
+                return
+        sleep_duration_seconds = MIN_SLEEP_DURATION_SECONDS
+        while True:
+            response_sequence = header["response_sequence"]
+            if response_sequence == request_sequence:
+                return
+            self._wait_for_change(self._response_sequence_address, response_sequence, sleep_duration_seconds)
+            sleep_duration_seconds = min(2.0*sleep_duration_seconds, MAX_SLEEP_DURATION_SECONDS)
+
+    # Block until the 32-bit value at address is no longer equal to expected_value, until the server wakes us up,
+    # or until the timeout expires. Spurious wakeups are possible, so the caller needs to check the value again.
+    def _wait_for_change(self, address, expected_value, timeout_seconds):
+        if self._syscall is None:
+            time.sleep(timeout_seconds)
+            return
+        timeout = Timespec(int(timeout_seconds), int((timeout_seconds % 1.0)*1000000000))
+        self._syscall(
+            ctypes.c_long(SYS_FUTEX), ctypes.c_void_p(address), ctypes.c_int(FUTEX_WAIT), ctypes.c_uint32(int(expected_value)),
+            ctypes.byref(timeout), ctypes.c_void_p(None), ctypes.c_int(0))
+
+    def _wake(self, address):
+        if self._syscall is None:
+            return
+        self._syscall(
+            ctypes.c_long(SYS_FUTEX), ctypes.c_void_p(address), ctypes.c_int(FUTEX_WAKE), ctypes.c_int(2**31 - 1),
+            ctypes.c_void_p(None), ctypes.c_void_p(None), ctypes.c_int(0))
+
+    def _encode_name(self, name):
+        encoded_name = name.encode("utf-8")
+        assert len(encoded_name) < MAX_NAME_LENGTH # need space for the null terminator
+        return encoded_name
+
+    def _align(self, offset):
+        return ((offset + PAYLOAD_ALIGNMENT - 1) // PAYLOAD_ALIGNMENT) * PAYLOAD_ALIGNMENT
@@ -3,6 +3,7 @@
 #
 
 import json
+import numpy as np
 
 
 class UnrealService():
@@ -68,6 +69,73 @@ class UnrealService():
     def set_property_value_as_string(self, property_desc, property_value):
         return self._rpc_client.call("unreal_service.set_property_value_from_string", property_desc, property_value)
 
+    #
+    # Get and set many property values at once. uobjects and names are lists of the same length, and the
+    # property names can be dotted paths in the same format as find_property_by_name_on_uobject(...), e.g.,
+    #
+    #     uobjects = [ root_component_0, root_component_1, ... ]
+    #     names = [ "RelativeLocation" ] * len(uobjects)
+    #     locations = unreal_service.get_property_values_as_array(uobjects, names, dtype=np.float64) # shape is (len(uobjects), 3)
+    #     unreal_service.set_property_values(uobjects, names, locations + 1.0)
+    #
+    # Each call executes in a single round-trip. POD values (e.g., bool, int32, float, double, FVector) are
+    # returned as NumPy scalars if their C++ type is listed in CPP_TYPE_TO_DTYPE, and as bytes otherwise.
+    # Non-POD values are returned in the same way as in unreal_service.call_function(...).
+    #
+
+    def get_property_values(self, uobjects, names):
+        property_values = self._rpc_client.call("unreal_service.get_property_values_for_uobjects", uobjects, names)
+        packed_values = property_values["packed_values"]
+        parsed_values = []
+        offset = 0
+        for num_bytes, cpp_type, value_string in zip(property_values["num_bytes"], property_values["cpp_types"], property_values["value_strings"]):
+            if num_bytes > 0:
+                value_bytes = packed_values[offset:offset + num_bytes]
+                offset += num_bytes
+                if cpp_type in UnrealService.CPP_TYPE_TO_DTYPE:
+                    parsed_values.append(np.frombuffer(value_bytes, dtype=UnrealService.CPP_TYPE_TO_DTYPE[cpp_type])[0])
+                else:
+                    parsed_values.append(value_bytes)
+            else:
+                parsed_values.append(self._get_return_value(value_string))
+        return parsed_values
+
+    # Returns all values as a single array with shape (len(uobjects), -1), which is useful if all properties have
+    # the same POD type, e.g., the RelativeLocation property of many components.
+    def get_property_values_as_array(self, uobjects, names, dtype):
+        property_values = self._rpc_client.call("unreal_service.get_property_values_for_uobjects", uobjects, names)
+        assert len(set(property_values["num_bytes"])) == 1
+        assert property_values["num_bytes"][0] > 0
+        return np.frombuffer(property_values["packed_values"], dtype=dtype).reshape(len(uobjects), -1)
+
+    # If values is a NumPy array, then each row is copied directly into the corresponding POD property. Otherwise,
+    # values must be a list, and each value is handled in the same way as the args in call_prepared_function(...),
+    # except that POD values must be specified as a NumPy array or NumPy scalar with the property's C++ type.
+    def set_property_values(self, uobjects, names, values):
+        assert len(uobjects) == len(names)
+        if isinstance(values, np.ndarray):
+            assert values.shape[0] == len(uobjects)
+            values = np.ascontiguousarray(values)
+            packed_values = values.tobytes()
+            num_bytes = [ values[0].nbytes ] * len(uobjects)
+            value_strings = [ "" ] * len(uobjects)
+        else:
+            assert len(values) == len(uobjects)
+            packed_values = bytearray()
+            num_bytes = []
+            value_strings = []
+            for value in values:
+                if isinstance(value, (np.ndarray, np.generic)):
+                    value_bytes = value.tobytes()
+                    packed_values += value_bytes
+                    num_bytes.append(len(value_bytes))
+                    value_strings.append("")
+                else:
+                    num_bytes.append(0)
+                    value_strings.append(self._get_arg_string(value))
+            packed_values = bytes(packed_values)
+        self._rpc_client.call("unreal_service.set_property_values_for_uobjects", uobjects, names, packed_values, num_bytes, value_strings)
+
     #
     # Find and call functions
     #
@@ -114,30 +182,102 @@ class UnrealService():
 
         # If an arg is a string, then don't convert. If an arg is a Ptr, then use Ptr.to_string() to convert.
         # If an arg is any other type, then assume it is valid JSON and use json.dumps(...) to convert.
-        arg_strings = {}
-        for arg_name, arg in args.items():
-            if isinstance(arg, str):
-                arg_string = arg
-            elif isinstance(arg, UnrealService.Ptr):
-                arg_string = arg.to_string()
-            else:
-                arg_string = json.dumps(arg)
-            arg_strings[arg_name] = arg_string
+        arg_strings = { arg_name:self._get_arg_string(arg) for arg_name, arg in args.items() }
 
         return_value_strings = self._rpc_client.call("unreal_service.call_function", uobject, ufunction, arg_strings, world_context)
 
         # Try to parse each return value string as JSON, and if that doesn't work, then return the string
         # directly. If the returned string is intended to be a pointer, then the user can get it as a pointer
         # by calling unreal_service.from_ptr(...).
-        return_values = {}
-        for return_value_name, return_value_string in return_value_strings.items():
-            try:
-                return_value = json.loads(return_value_string)
-            except:
-                return_value = return_value_string 
-            return_values[return_value_name] = return_value
-
-        return return_values
+        return { return_value_name:self._get_return_value(return_value_string) for return_value_name, return_value_string in return_value_strings.items() }
+
+    #
+    # Interface for calling functions via a binary fast path. A prepared function caches the parameter layout
+    # of a UFunction on the server, so it can be called repeatedly with minimal overhead. POD args and return
+    # values (e.g., bool, int32, float, double, FVector) are copied directly to and from a packed buffer
+    # instead of being converted to and from JSON strings, e.g.,
+    #
+    #     prepared_function = unreal_service.prepare_function(uobject, ufunction)
+    #     return_values = unreal_service.call_prepared_function(prepared_function, args={"bPaused": True})
+    #
+    # POD args can be specified as Python scalars if their C++ type is listed in CPP_TYPE_TO_DTYPE, or as any
+    # object that supports the buffer protocol (e.g., a NumPy array) otherwise. POD return values are returned
+    # as NumPy scalars if their C++ type is listed in CPP_TYPE_TO_DTYPE, and as bytes otherwise. Non-POD args
+    # and return values are handled in the same way as in unreal_service.call_function(...).
+    #
+
+    CPP_TYPE_TO_DTYPE = {
+        "bool": np.dtype(np.bool_),
+        "uint8": np.dtype(np.uint8),
+        "int8": np.dtype(np.int8),
+        "uint16": np.dtype(np.uint16),
+        "int16": np.dtype(np.int16),
+        "uint32": np.dtype(np.uint32),
+        "int32": np.dtype(np.int32),
+        "uint64": np.dtype(np.uint64),
+        "int64": np.dtype(np.int64),
+        "float": np.dtype(np.float32),
+        "double": np.dtype(np.float64)}
+
+    # The PreparedFunction class is for internal use, and does not need to be instantiated directly by users.
+    class PreparedFunction:
+        def __init__(self, handle, desc):
+            self.handle = handle
+            self.num_bytes = desc["num_bytes"]
+            self.params = { param["name"]:param for param in desc["params"] }
+
+    # Prepared functions are destroyed on the server when the world is cleaned up, e.g., when a new level is
+    # opened. Calling a prepared function after that raises an error, so clients that hold onto prepared
+    # functions across level transitions should compare get_world_generation() with the value it had when
+    # the function was prepared, and prepare the function again if it has changed.
+    def get_world_generation(self):
+        return self._rpc_client.call("unreal_service.get_world_generation")
+
+    def prepare_function(self, uobject, ufunction, world_context="WorldContextObject"):
+        handle = self._rpc_client.call("unreal_service.prepare_function", uobject, ufunction, world_context)
+        desc = self._rpc_client.call("unreal_service.get_prepared_function_desc", handle)
+        return UnrealService.PreparedFunction(handle, desc)
+
+    def destroy_prepared_function(self, prepared_function):
+        self._rpc_client.call("unreal_service.destroy_prepared_function", prepared_function.handle)
+
+    # Returns the args that should be passed to unreal_service.call_prepared_function, which is useful for
+    # constructing calls that will be executed via engine_service.step(...) or engine_service.call_async(...).
+    def get_prepared_function_args(self, prepared_function, args={}):
+        packed_args = np.zeros(prepared_function.num_bytes, dtype=np.uint8)
+        arg_strings = {}
+        for arg_name, arg in args.items():
+            param = prepared_function.params[arg_name]
+            assert not param["is_world_context"]
+            if param["is_pod"]:
+                if param["cpp_type"] in UnrealService.CPP_TYPE_TO_DTYPE:
+                    arg = np.array(arg, dtype=UnrealService.CPP_TYPE_TO_DTYPE[param["cpp_type"]])
+                arg_bytes = np.frombuffer(arg, dtype=np.uint8)
+                assert arg_bytes.shape[0] == param["num_bytes"]
+                packed_args[param["offset"]:param["offset"] + param["num_bytes"]] = arg_bytes
+            else:
+                arg_strings[arg_name] = self._get_arg_string(arg)
+        return [prepared_function.handle, packed_args.tobytes(), arg_strings]
+
+    def call_prepared_function(self, prepared_function, args={}):
+        return_values = self._rpc_client.call("unreal_service.call_prepared_function", *self.get_prepared_function_args(prepared_function, args))
+        return self.get_prepared_function_return_values(prepared_function, return_values)
+
+    # Converts the raw return value of unreal_service.call_prepared_function into a dict of return values.
+    def get_prepared_function_return_values(self, prepared_function, return_values):
+        packed_return_values = return_values["packed_return_values"]
+        return_value_strings = return_values["return_value_strings"]
+        parsed_return_values = {}
+        for param_name, param in prepared_function.params.items():
+            if param["is_pod"]:
+                return_value_bytes = packed_return_values[param["offset"]:param["offset"] + param["num_bytes"]]
+                if param["cpp_type"] in UnrealService.CPP_TYPE_TO_DTYPE:
+                    parsed_return_values[param_name] = np.frombuffer(return_value_bytes, dtype=UnrealService.CPP_TYPE_TO_DTYPE[param["cpp_type"]])[0]
+                else:
+                    parsed_return_values[param_name] = return_value_bytes
+            else:
+                parsed_return_values[param_name] = self._get_return_value(return_value_strings[param_name])
+        return parsed_return_values
 
     #
     # Find actors unconditionally and return a list or dict
@@ -575,3 +715,17 @@ class UnrealService():
 
     def get_component_tags(self, actor):
         return self._rpc_client.call("unreal_service.get_component_tags", actor)
+
+    def _get_arg_string(self, arg):
+        if isinstance(arg, str):
+            return arg
+        elif isinstance(arg, UnrealService.Ptr):
+            return arg.to_string()
+        else:
+            return json.dumps(arg)
+
+    def _get_return_value(self, return_value_string):
+        try:
+            return json.loads(return_value_string)
+        except:
+            return return_value_string
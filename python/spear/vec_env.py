@@ -0,0 +1,121 @@
+#
+# Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+#
+
+import numpy as np
+import os
+import spear
+
+
+# Manages several Unreal instances, each with its own Env object, and steps all of them in lock-step. Each
+# instance is launched with a different SP_SERVICES.PORT, SP_CORE.SHARED_MEMORY_NAME_PREFIX, and temp config
+# file, so the instances don't interfere with each other. step(...) sends the request for the next frame to all
+# instances before waiting for any of them, so the instances execute their frames concurrently.
+class VecEnv():
+    def __init__(self, config, num_envs):
+
+        assert num_envs > 0
+
+        self.num_envs = num_envs
+
+        self._configs = [ _get_env_config(config, env_index=i) for i in range(self.num_envs) ]
+        self._instances = []
+        self._envs = []
+
+        # launch instances one at a time, because launching many instances at once can cause some of them to
+        # time out while they are loading
+        for env_config in self._configs:
+            instance = spear.Instance(env_config)
+            self._instances.append(instance)
+            self._envs.append(spear.Env(instance, env_config))
+
+        self.action_space = self._envs[0].action_space
+        self.observation_space = self._envs[0].observation_space
+
+        for env in self._envs:
+            assert env.action_space.spaces.keys() == self.action_space.spaces.keys()
+            assert env.observation_space.spaces.keys() == self.observation_space.spaces.keys()
+
+        # Preallocate a batched [num_envs, ...] array for each observation component, so we don't need to
+        # allocate anything in step(...). Each instance writes its observations into its own shared memory
+        # region, so we copy from each instance's region into the corresponding row of the batched array.
+        self._obs = {
+            name:np.zeros(shape=(self.num_envs,) + space.shape, dtype=space.dtype) for name, space in self.observation_space.spaces.items() }
+        self._rewards = np.zeros(shape=(self.num_envs,), dtype=np.float64)
+        self._dones = np.zeros(shape=(self.num_envs,), dtype=bool)
+
+    # actions is a dict of [num_envs, ...] arrays, or a list of num_envs dicts. Returns a dict of [num_envs, ...]
+    # observation arrays, a [num_envs] array of rewards, a [num_envs] array of done flags, and a list of num_envs
+    # step info dicts. The returned arrays are reused by subsequent calls to step(...) and reset(...), so the
+    # caller should copy them if they need to be preserved.
+    def step(self, actions):
+
+        env_actions = self._get_env_actions(actions)
+
+        for env, action in zip(self._envs, env_actions):
+            env.step_async(action)
+
+        infos = []
+        for i, env in enumerate(self._envs):
+            obs, reward, done, info = env.step_wait()
+            self._set_obs(env_index=i, obs=obs)
+            self._rewards[i] = reward
+            self._dones[i] = done
+            infos.append(info)
+
+        return self._obs, self._rewards, self._dones, infos
+
+    # Reset the instances corresponding to env_indices, or all instances if env_indices is None, and return the
+    # batched observation arrays. The rows corresponding to instances that are not reset are left unchanged.
+    def reset(self, env_indices=None):
+
+        if env_indices is None:
+            env_indices = range(self.num_envs)
+
+        for i in env_indices:
+            obs = self._envs[i].reset()
+            self._set_obs(env_index=i, obs=obs)
+
+        return self._obs
+
+    def close(self):
+        for env in self._envs:
+            env.close()
+        for instance in self._instances:
+            instance.close()
+        self._envs = []
+        self._instances = []
+
+    def _get_env_actions(self, actions):
+        if isinstance(actions, dict):
+            assert actions.keys() == self.action_space.spaces.keys()
+            for name, component in actions.items():
+                assert component.shape[0] == self.num_envs
+            return [ { name:component[i] for name, component in actions.items() } for i in range(self.num_envs) ]
+        else:
+            assert len(actions) == self.num_envs
+            return actions
+
+    def _set_obs(self, env_index, obs):
+        assert obs.keys() == self._obs.keys()
+        for name, component in obs.items():
+            np.copyto(self._obs[name][env_index], component)
+
+
+# Returns a copy of config with the values that must be unique to each instance set based on env_index.
+def _get_env_config(config, env_index):
+
+    env_config = config.clone()
+    env_config.defrost()
+
+    # we use the port as the shared memory prefix, because it must already be unique among all instances running on the same machine
+    port = config.SP_SERVICES.PORT + env_index
+    env_config.SP_SERVICES.PORT = port
+    env_config.SP_CORE.SHARED_MEMORY_NAME_PREFIX = str(port)
+
+    temp_config_file_name, temp_config_file_ext = os.path.splitext(config.SPEAR.INSTANCE.TEMP_CONFIG_FILE)
+    env_config.SPEAR.INSTANCE.TEMP_CONFIG_FILE = f"{temp_config_file_name}.{env_index}{temp_config_file_ext}"
+
+    env_config.freeze()
+
+    return env_config
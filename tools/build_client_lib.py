@@ -0,0 +1,137 @@
+#
+# Copyright(c) 2022 Intel. Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+#
+
+# Builds our native C++ client library (cpp/client/SpClient), the sp_client Python module (cpp/client/SpClientPython),
+# and the policy_runner example (cpp/client/Examples). Before running this tool, you must build our third-party
+# libraries using tools/build_third_party_libs.py, and you must install pybind11 into your Python environment
+# (e.g., pip install pybind11). The sp_client module is written to python/spear, so it can be selected by setting
+# SPEAR.INSTANCE.RPC_CLIENT to "sp_client".
+
+import argparse
+import os
+import spear
+import subprocess
+import sys
+import sysconfig
+
+
+if __name__ == "__main__":
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--build_dir", default=os.path.realpath(os.path.join(os.path.dirname(__file__), "..", "cpp", "client", "BUILD")))
+    parser.add_argument("--cxx_compiler", default="clang++")
+    parser.add_argument("--verbose", action="store_true")
+    args = parser.parse_args()
+
+    # SpCore/Windows.h depends on Unreal headers, so we only support macOS and Linux for now
+    assert sys.platform in ["darwin", "linux"]
+
+    import pybind11
+
+    repo_dir        = os.path.realpath(os.path.join(os.path.dirname(__file__), ".."))
+    cpp_dir         = os.path.join(repo_dir, "cpp")
+    third_party_dir = os.path.join(repo_dir, "third_party")
+    build_dir       = os.path.realpath(args.build_dir)
+
+    if sys.platform == "darwin":
+        platform_dir = "Mac"
+    elif sys.platform == "linux":
+        platform_dir = "Linux"
+    else:
+        assert False
+
+    cxx_flags = ["-std=c++20", "-O2", "-fPIC", "-pthread", "-Wno-deprecated-declarations", "-DSPCORE_API="]
+
+    # rpclib is built against libc++ on Linux (see tools/build_third_party_libs.py), so we need to do the same here
+    if sys.platform == "linux":
+        cxx_flags.append("-stdlib=libc++")
+
+    include_dirs = [
+        os.path.join(cpp_dir, "client"),
+        os.path.join(cpp_dir, "unreal_plugins", "SpCore", "Source"),
+        os.path.join(cpp_dir, "unreal_plugins", "SpServices", "Source"),
+        os.path.join(third_party_dir, "boost"),
+        os.path.join(third_party_dir, "rpclib", "include")]
+
+    # we reuse the platform-independent parts of SpCore and SpServices, so the client and server share the same
+    # msgpack adaptors and ArrayDesc layout
+    lib_src_files = [
+        os.path.join(cpp_dir, "client", "SpClient", "Client.cpp"),
+        os.path.join(cpp_dir, "client", "SpClient", "EngineServiceClient.cpp"),
+        os.path.join(cpp_dir, "client", "SpClient", "LegacyServiceClient.cpp"),
+        os.path.join(cpp_dir, "client", "SpClient", "SpaceDesc.cpp"),
+        os.path.join(cpp_dir, "client", "SpClient", "SpFuncServiceClient.cpp"),
+        os.path.join(cpp_dir, "client", "SpClient", "UnrealServiceClient.cpp"),
+        os.path.join(cpp_dir, "unreal_plugins", "SpCore", "Source", "SpCore", "Assert.cpp"),
+        os.path.join(cpp_dir, "unreal_plugins", "SpServices", "Source", "SpServices", "Msgpack.cpp")]
+
+    lib_files = [os.path.join(third_party_dir, "rpclib", "BUILD", platform_dir, "librpc.a")]
+    if sys.platform == "linux":
+        lib_files.append("-lrt") # needed for shm_open
+
+    include_args = [ f"-I{include_dir}" for include_dir in include_dirs ]
+
+    def run(cmd):
+        if args.verbose:
+            spear.log(f"Executing: {' '.join(cmd)}")
+        subprocess.run(cmd, check=True)
+
+    spear.log(f"Creating directory: {build_dir}")
+    os.makedirs(build_dir, exist_ok=True)
+
+    #
+    # SpClient
+    #
+
+    spear.log("Building SpClient...")
+
+    obj_files = []
+    for src_file in lib_src_files:
+        obj_file = os.path.join(build_dir, os.path.splitext(os.path.basename(src_file))[0] + ".o")
+        run([args.cxx_compiler, *cxx_flags, *include_args, "-c", src_file, "-o", obj_file])
+        obj_files.append(obj_file)
+
+    lib_file = os.path.join(build_dir, "libsp_client.a")
+    if os.path.exists(lib_file):
+        os.remove(lib_file)
+    run(["ar", "rcs", lib_file, *obj_files])
+
+    spear.log("Built SpClient successfully.")
+
+    #
+    # SpClientPython
+    #
+
+    spear.log("Building SpClientPython...")
+
+    python_module_file = os.path.join(repo_dir, "python", "spear", "sp_client" + sysconfig.get_config_var("EXT_SUFFIX"))
+    python_include_args = [f"-I{pybind11.get_include()}", f"-I{sysconfig.get_paths()['include']}"]
+
+    if sys.platform == "darwin":
+        python_link_args = ["-undefined", "dynamic_lookup"]
+    elif sys.platform == "linux":
+        python_link_args = []
+    else:
+        assert False
+
+    run([
+        args.cxx_compiler, *cxx_flags, *include_args, *python_include_args, "-shared",
+        os.path.join(cpp_dir, "client", "SpClientPython", "SpClientPython.cpp"),
+        lib_file, *lib_files, *python_link_args, "-o", python_module_file])
+
+    spear.log(f"Built SpClientPython successfully: {python_module_file}")
+
+    #
+    # Examples
+    #
+
+    spear.log("Building Examples...")
+
+    policy_runner_file = os.path.join(build_dir, "policy_runner")
+    run([
+        args.cxx_compiler, *cxx_flags, *include_args,
+        os.path.join(cpp_dir, "client", "Examples", "PolicyRunner.cpp"),
+        lib_file, *lib_files, "-o", policy_runner_file])
+
+    spear.log(f"Built Examples successfully: {policy_runner_file}")